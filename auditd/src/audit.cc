@@ -41,12 +41,17 @@
 
 using namespace std::string_view_literals;
 
+/// Used to generate the identifier of each instance of the audit daemon
+static std::atomic<uint64_t> next_instance_id{0};
+
 AuditImpl::AuditImpl(std::string config_file,
                      ServerCookieIface* sapi,
                      const std::string& host)
     : Audit(),
       auditfile(host),
+      prepared_state(std::make_shared<const PreparedState>()),
       configfile(std::move(config_file)),
+      instance_id(++next_instance_id),
       cookie_api(sapi),
       hostname(host) {
     if (!configfile.empty() && !configure()) {
@@ -173,6 +178,9 @@ bool AuditImpl::process_module_descriptor(const nlohmann::json& json) {
 }
 
 bool AuditImpl::reconfigure(std::string file) {
+    // The events received before the reconfiguration should end up in
+    // the current audit log
+    write_batch();
     configfile = std::move(file);
     return configure();
 }
@@ -279,6 +287,8 @@ bool AuditImpl::configure() {
         }
     }
 
+    update_prepared_state();
+
     /*
      * We need to notify if the audit daemon is turned on or off during a
      * reconfigure.  It is also possible that particular audit events may
@@ -343,15 +353,8 @@ bool AuditImpl::put_event(uint32_t event_id, std::string_view payload) {
     //       in the correct fields.. if not we should add an
     //       event to the audit trail saying it is one in an illegal
     //       format (or missing fields)
-    try {
-        auto new_event = std::make_unique<Event>(event_id, payload);
-        std::lock_guard<std::mutex> guard(producer_consumer_lock);
-        if (filleventqueue.size() < max_audit_queue) {
-            filleventqueue.push(std::move(new_event));
-            events_arrived.notify_all();
-            return true;
-        }
-    } catch (const std::bad_alloc&) {
+    if (queue_event(EventRing::Type::Json, event_id, payload)) {
+        return true;
     }
 
     dropped_events++;
@@ -361,11 +364,225 @@ bool AuditImpl::put_event(uint32_t event_id, std::string_view payload) {
     return false;
 }
 
+bool AuditImpl::begin_event(
+        cb::audit::EventBuilder& event,
+        uint32_t event_id,
+        const cb::audit::Userid& real_userid,
+        const std::optional<cb::audit::Userid>& effective_userid) {
+    if (event.generation != prepared_state_generation.load()) {
+        std::lock_guard<std::mutex> guard(prepared_state_mutex);
+        event.state = prepared_state;
+        event.generation = prepared_state_generation.load();
+    }
+    const auto& state = *static_cast<const PreparedState*>(event.state.get());
+    if (!state.enabled) {
+        // Audit is disabled
+        return false;
+    }
+
+    const auto iter = state.descriptors.find(event_id);
+    if (iter == state.descriptors.end()) {
+        // it is an unknown event
+        LOG_WARNING("Audit: error: unknown event {}", event_id);
+        dropped_events++;
+        return false;
+    }
+    const auto& descriptor = iter->second;
+    if (!descriptor.enabled) {
+        return false;
+    }
+
+    if (state.filtering && descriptor.filteringPermitted &&
+        (state.isFiltered(real_userid) ||
+         (effective_userid && state.isFiltered(*effective_userid)))) {
+        return false;
+    }
+
+    event.reset(event_id, descriptor.name, descriptor.description);
+    return true;
+}
+
+bool AuditImpl::put_event(cb::audit::EventBuilder& event) {
+    event.finish();
+    const auto payload = event.getPayload();
+    if (queue_event(EventRing::Type::Prepared, event.id, payload)) {
+        return true;
+    }
+
+    dropped_events++;
+    LOG_WARNING("Audit: Dropping audit event {}: {}",
+                event.id,
+                cb::UserDataView(payload));
+    return false;
+}
+
+bool AuditImpl::queue_event(EventRing::Type type,
+                            uint32_t event_id,
+                            std::string_view payload) {
+    if (queued_events.fetch_add(1) >= max_audit_queue) {
+        queued_events--;
+        return false;
+    }
+    try {
+        if (get_event_ring().push(type, event_id, payload)) {
+            notify_consumer();
+            return true;
+        }
+    } catch (const std::bad_alloc&) {
+    }
+    queued_events--;
+
+    // The ring is full (or the event doesn't fit in it), fall back to
+    // the queue
+    try {
+        if (type == EventRing::Type::Prepared) {
+            return queue_event(
+                    std::make_unique<PreparedEvent>(event_id, payload));
+        }
+        return queue_event(std::make_unique<Event>(event_id, payload));
+    } catch (const std::bad_alloc&) {
+    }
+    return false;
+}
+
+bool AuditImpl::queue_event(std::unique_ptr<Event> event) {
+    std::lock_guard<std::mutex> guard(producer_consumer_lock);
+    // The events already in the rings (including the calling thread's)
+    // must be processed before this one
+    RingPositions positions;
+    get_ring_positions(positions);
+    if (queued_events.fetch_add(1) < max_audit_queue) {
+        filleventqueue.push({std::move(event), std::move(positions)});
+        events_arrived.notify_all();
+        return true;
+    }
+    queued_events--;
+    return false;
+}
+
+EventRing& AuditImpl::get_event_ring() {
+    // The ring of the calling thread, and the instance it belongs to
+    thread_local uint64_t ring_instance = 0;
+    thread_local EventRing* ring = nullptr;
+    if (ring_instance == instance_id) {
+        return *ring;
+    }
+
+    std::lock_guard<std::mutex> guard(rings_mutex);
+    const auto self = std::this_thread::get_id();
+    auto iter = std::find_if(rings.begin(), rings.end(), [self](auto& r) {
+        return r->owner == self;
+    });
+    if (iter == rings.end()) {
+        rings.push_back(std::make_unique<EventRing>(event_ring_size));
+        iter = rings.end() - 1;
+    }
+    ring = iter->get();
+    ring_instance = instance_id;
+    return *ring;
+}
+
+void AuditImpl::notify_consumer() {
+    // Pairs with the fence in consume_events() so that either the consumer
+    // sees the new event, or we see it is waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (consumer_waiting.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> guard(producer_consumer_lock);
+        events_arrived.notify_all();
+    }
+}
+
+bool AuditImpl::has_ring_events() {
+    std::lock_guard<std::mutex> guard(rings_mutex);
+    return std::any_of(rings.begin(), rings.end(), [](auto& ring) {
+        return !ring->empty();
+    });
+}
+
+void AuditImpl::get_ring_positions(RingPositions& positions) {
+    std::lock_guard<std::mutex> guard(rings_mutex);
+    positions.clear();
+    for (auto& ring : rings) {
+        positions.emplace_back(ring.get(), ring->position());
+    }
+}
+
+void AuditImpl::add_prepared_event(std::string_view event) {
+    if (config.is_auditd_enabled()) {
+        add_to_batch(event);
+    }
+}
+
+void AuditImpl::add_to_batch(std::string_view event) {
+    batch.append(event);
+    batch.push_back('\n');
+    ++batch_events;
+    if (batch.size() >= max_batch_size) {
+        write_batch();
+    }
+}
+
+void AuditImpl::write_batch() {
+    if (batch.empty()) {
+        return;
+    }
+
+    if (!auditfile.ensure_open()) {
+        LOG_WARNING("Audit: error opening audit file. Dropping {} events",
+                    batch_events);
+        dropped_events += batch_events;
+    } else if (!auditfile.write_events_to_disk(batch)) {
+        LOG_WARNING("Audit: error writing events to disk. Dropping {} events",
+                    batch_events);
+        dropped_events += batch_events;
+        // If the write_events_to_disk function returns false then it is
+        // possible the audit file has been closed.  Therefore ensure
+        // the file is open.
+        auditfile.ensure_open();
+    }
+    batch.clear();
+    batch_events = 0;
+}
+
+bool AuditImpl::PreparedState::isFiltered(
+        const cb::audit::Userid& userid) const {
+    return std::find_if(disabled_userids.begin(),
+                        disabled_userids.end(),
+                        [&userid](const auto& disabled) {
+                            return disabled.first == userid.domain &&
+                                   disabled.second == userid.user;
+                        }) != disabled_userids.end();
+}
+
+void AuditImpl::update_prepared_state() {
+    auto state = std::make_shared<PreparedState>();
+    state->enabled = config.is_auditd_enabled();
+    state->filtering = config.is_filtering_enabled();
+    state->disabled_userids = config.get_disabled_userids();
+    for (const auto& [id, descriptor] : events) {
+        state->descriptors.emplace(
+                id,
+                PreparedDescriptor{descriptor->getName(),
+                                   descriptor->getDescription(),
+                                   descriptor->isEnabled(),
+                                   descriptor->isFilteringPermitted()});
+    }
+
+    std::lock_guard<std::mutex> guard(prepared_state_mutex);
+    prepared_state = std::move(state);
+    prepared_state_generation++;
+}
+
 bool AuditImpl::configure_auditdaemon(const std::string& configfile,
                                       gsl::not_null<const void*> cookie) {
     auto new_event = std::make_unique<ConfigureEvent>(configfile, cookie.get());
     std::lock_guard<std::mutex> guard(producer_consumer_lock);
-    filleventqueue.push(std::move(new_event));
+    // The events submitted so far are processed with the old configuration
+    RingPositions positions;
+    get_ring_positions(positions);
+    // The configure events aren't subject to max_audit_queue
+    queued_events++;
+    filleventqueue.push({std::move(new_event), std::move(positions)});
     events_arrived.notify_all();
     return true;
 }
@@ -408,11 +625,20 @@ void AuditImpl::consume_events() {
     events_arrived.notify_one();
 
     while (!stop_audit_consumer) {
-        if (filleventqueue.empty()) {
-            events_arrived.wait_for(
-                    lock,
-                    std::chrono::seconds(auditfile.get_seconds_to_rotation()));
-            if (filleventqueue.empty()) {
+        if (filleventqueue.empty() && !has_ring_events()) {
+            // The producers only notify us of events added to the rings
+            // while we're waiting. Pairs with the fence in
+            // notify_consumer()
+            consumer_waiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!has_ring_events()) {
+                events_arrived.wait_for(
+                        lock,
+                        std::chrono::seconds(
+                                auditfile.get_seconds_to_rotation()));
+            }
+            consumer_waiting.store(false, std::memory_order_relaxed);
+            if (filleventqueue.empty() && !has_ring_events()) {
                 // We timed out, so just rotate the files
                 if (auditfile.maybe_rotate_files()) {
                     // If the file was rotated then we need to open a new
@@ -425,20 +651,68 @@ void AuditImpl::consume_events() {
          * event(s) have arrived or shutdown requested
          */
         processeventqueue.swap(filleventqueue);
+        get_ring_positions(rings_snapshot);
         lock.unlock();
         // Now outside of the producer_consumer_lock
-
-        while (!processeventqueue.empty()) {
-            auto& event = processeventqueue.front();
-            if (!event->process(*this)) {
-                dropped_events++;
-            }
-            processeventqueue.pop();
-        }
-        auditfile.flush();
+        process_events();
         lock.lock();
     }
 
+    // Process the events submitted before we were asked to stop (the
+    // shutdown event)
+    processeventqueue.swap(filleventqueue);
+    get_ring_positions(rings_snapshot);
+    lock.unlock();
+    process_events();
+
     // close the auditfile
     auditfile.close();
 }
+
+void AuditImpl::process_events() {
+    queued_events -= processeventqueue.size();
+
+    // Each queued event goes after the events which were in the rings when
+    // it was queued
+    while (!processeventqueue.empty()) {
+        auto& queued = processeventqueue.front();
+        for (const auto& [ring, position] : queued.ring_positions) {
+            consume_ring(*ring, position);
+        }
+        if (!queued.event->process(*this)) {
+            dropped_events++;
+        }
+        processeventqueue.pop();
+    }
+
+    // The events added to the rings after the queues were swapped may
+    // belong after an event queued since, so they are left for next time
+    for (const auto& [ring, position] : rings_snapshot) {
+        consume_ring(*ring, position);
+    }
+
+    // Write all of the events in one go
+    write_batch();
+    auditfile.flush();
+}
+
+void AuditImpl::consume_ring(EventRing& ring, size_t until) {
+    queued_events -= ring.consume(
+            [this](EventRing::Type type,
+                   uint32_t id,
+                   std::string_view payload) {
+                if (type == EventRing::Type::Prepared) {
+                    add_prepared_event(payload);
+                    return;
+                }
+                try {
+                    Event event(id, payload);
+                    if (!event.process(*this)) {
+                        dropped_events++;
+                    }
+                } catch (const std::bad_alloc&) {
+                    dropped_events++;
+                }
+            },
+            until);
+}
@@ -19,6 +19,7 @@
 #include "auditconfig.h"
 #include "auditfile.h"
 #include "event.h"
+#include "event_ring.h"
 #include "eventdescriptor.h"
 
 #include <memcached/audit_interface.h>
@@ -29,13 +30,22 @@
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 class AuditImpl : public cb::audit::Audit {
 public:
     // Implementation of the public API
     bool put_event(uint32_t event_id, std::string_view payload) override;
+    bool begin_event(
+            cb::audit::EventBuilder& event,
+            uint32_t event_id,
+            const cb::audit::Userid& real_userid,
+            const std::optional<cb::audit::Userid>& effective_userid) override;
+    bool put_event(cb::audit::EventBuilder& event) override;
     void add_event_state_listener(
             cb::audit::EventStateListener listener) override;
     void notify_all_event_states() override;
@@ -79,6 +89,7 @@ protected:
     /// and the event descriptors as part of filtering events (it'll be
     /// fixed in a later commit)
     friend class Event;
+    friend class PreparedEvent;
 
     /// The AuditDaemonFilteringTest tries to add it's own event descriptor
     /// to use in the unit tests
@@ -103,6 +114,69 @@ protected:
      */
     void create_audit_event(uint32_t event_id, nlohmann::json& payload);
 
+    /**
+     * Add the event to the ring of the calling thread, or (if it doesn't
+     * fit) the queue of events to process
+     *
+     * @return false if there are already max_audit_queue events waiting
+     *         to be processed
+     */
+    bool queue_event(EventRing::Type type,
+                     uint32_t event_id,
+                     std::string_view payload);
+
+    /**
+     * Add the event to the queue of events to process
+     *
+     * @return false if there are already max_audit_queue events waiting
+     *         to be processed
+     */
+    bool queue_event(std::unique_ptr<Event> event);
+
+    /// Get the event ring of the calling thread (creating it if needed)
+    EventRing& get_event_ring();
+
+    /// Wake up the consumer thread if it is waiting for events
+    void notify_consumer();
+
+    /// Do any of the event rings contain events?
+    bool has_ring_events();
+
+    /// The positions of the event rings at some point in time
+    using RingPositions = std::vector<std::pair<EventRing*, size_t>>;
+
+    /// Get the current position of each of the event rings
+    void get_ring_positions(RingPositions& positions);
+
+    /**
+     * Process the events in the event rings and the (swapped) queue of
+     * events in the order they were submitted, and write them to the
+     * audit trail
+     */
+    void process_events();
+
+    /// Process the events of the ring up to the given position
+    void consume_ring(EventRing& ring, size_t until);
+
+    /// Add an event built with the EventBuilder to the audit trail
+    void add_prepared_event(std::string_view event);
+
+    /**
+     * Add the (JSON) event to the batch of events to write to the audit
+     * trail, writing out the batch if it is full.
+     */
+    void add_to_batch(std::string_view event);
+
+    /// Write the batch of events to the audit trail
+    void write_batch();
+
+    /**
+     * Update the state used to build events in the front end threads
+     * (with begin_event()) to match the current configuration and
+     * event descriptors
+     */
+    void update_prepared_state();
+
     void notify_event_state_changed(uint32_t id, bool enabled) const;
     struct {
         mutable std::mutex mutex;
@@ -118,6 +192,37 @@ protected:
     /// The current audit log file we're using
     AuditFile auditfile;
 
+    /// The events processed by the consumer thread which are yet to be
+    /// written to the audit log, and the number of them
+    std::string batch;
+    size_t batch_events = 0;
+
+    /// The subset of the configuration and event descriptors needed to
+    /// decide if an event should be built and to complete it, so that
+    /// begin_event() doesn't have to access the descriptors the consumer
+    /// thread may be reconfiguring
+    struct PreparedDescriptor {
+        std::string name;
+        std::string description;
+        bool enabled;
+        bool filteringPermitted;
+    };
+    struct PreparedState {
+        bool isFiltered(const cb::audit::Userid& userid) const;
+
+        bool enabled = false;
+        bool filtering = false;
+        std::unordered_map<uint32_t, PreparedDescriptor> descriptors;
+        std::vector<std::pair<std::string, std::string>> disabled_userids;
+    };
+
+    /// A new PreparedState is created (and the generation bumped) whenever
+    /// the daemon is reconfigured; the builders keep a reference to the
+    /// state they've used and only fetch it again if the generation changes
+    std::mutex prepared_state_mutex;
+    std::shared_ptr<const PreparedState> prepared_state;
+    std::atomic<uint64_t> prepared_state_generation{1};
+
     /// The name of the configuration file currently in use
     std::string configfile;
 
@@ -127,14 +232,44 @@ protected:
     /// The consumer should run until this flag is set to true
     bool stop_audit_consumer = {false};
 
+    /// An event in the queues, and the positions of the rings when it was
+    /// queued: the events in the rings up to them were submitted before it
+    struct QueuedEvent {
+        std::unique_ptr<Event> event;
+        RingPositions ring_positions;
+    };
+
     // We maintain two Event queues. At any one time one will be used to accept
     // new events, and the other will be processed. The two queues are swapped
     // periodically.
-    std::queue<std::unique_ptr<Event>> processeventqueue;
-    std::queue<std::unique_ptr<Event>> filleventqueue;
+    std::queue<QueuedEvent> processeventqueue;
+    std::queue<QueuedEvent> filleventqueue;
     std::condition_variable events_arrived;
     std::mutex producer_consumer_lock;
 
+    /// Each thread submitting events has its own ring to pass them to the
+    /// consumer thread, so submitting an event doesn't need to lock
+    /// producer_consumer_lock or allocate memory. The queues are only used
+    /// for the configure events, and events which don't fit in the ring.
+    /// The rings live as long as the audit daemon.
+    std::mutex rings_mutex;
+    std::vector<std::unique_ptr<EventRing>> rings;
+    /// [consumer] The positions of the rings when the queues were swapped;
+    /// the events after them are processed with the next queue
+    RingPositions rings_snapshot;
+
+    /// The identifier of this instance of the audit daemon, used to
+    /// identify the rings the threads have created for it
+    const uint64_t instance_id;
+
+    /// The number of events waiting to be processed (in the rings and
+    /// the filleventqueue)
+    std::atomic<size_t> queued_events{0};
+
+    /// Set when the consumer thread is about to wait for events, so the
+    /// producers must notify it of new events
+    std::atomic_bool consumer_waiting{false};
+
     /// The number of events currently dropped.
     std::atomic<uint32_t> dropped_events = {0};
 
@@ -145,4 +280,11 @@ protected:
 
 private:
     const size_t max_audit_queue = 50000;
+
+    /// The size of the event ring of each thread
+    const size_t event_ring_size = 256 * 1024;
+
+    /// The batch is written once it reaches this size, to bound the memory
+    /// used by it
+    const size_t max_batch_size = 1024 * 1024;
 };
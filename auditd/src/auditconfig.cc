@@ -230,6 +230,12 @@ bool AuditConfig::is_event_filtered(
                      userid) != disabled_userids.end();
 }
 
+std::vector<std::pair<std::string, std::string>>
+AuditConfig::get_disabled_userids() const {
+    std::lock_guard<std::mutex> guard(disabled_userids_mutex);
+    return disabled_userids;
+}
+
 void AuditConfig::set_filtering_enabled(bool value) {
     filtering_enabled = value;
 }
@@ -83,6 +83,8 @@ public:
     AuditConfig::EventState get_event_state(uint32_t id) const;
     bool is_event_filtered(
             const std::pair<std::string, std::string>& userid) const;
+    std::vector<std::pair<std::string, std::string>> get_disabled_userids()
+            const;
     bool is_filtering_enabled() const;
     void set_filtering_enabled(bool value);
     void set_uuid(const std::string &uuid);
@@ -221,17 +221,8 @@ void AuditFile::cleanup_old_logfile(const std::string& log_path) {
 }
 
 bool AuditFile::write_event_to_disk(nlohmann::json& output) {
-    bool ret = true;
     try {
-        const auto content = output.dump();
-        current_size += fprintf(file.get(), "%s\n", content.c_str());
-        if (ferror(file.get())) {
-            LOG_WARNING("Audit: writing to disk error: {}", cb_strerror());
-            ret = false;
-            close_and_rotate_log();
-        } else if (!buffered) {
-            ret = flush();
-        }
+        return write_events_to_disk(output.dump() + "\n");
     } catch (const std::bad_alloc&) {
         LOG_WARNING(
                 "Audit: memory allocation error for writing audit event to "
@@ -239,11 +230,22 @@ bool AuditFile::write_event_to_disk(nlohmann::json& output) {
         // Failed to write event to disk.
         return false;
     }
+}
+
+bool AuditFile::write_events_to_disk(std::string_view events) {
+    bool ret = true;
+    current_size += fwrite(events.data(), 1, events.size(), file.get());
+    if (ferror(file.get())) {
+        LOG_WARNING("Audit: writing to disk error: {}", cb_strerror());
+        ret = false;
+        close_and_rotate_log();
+    } else if (!buffered) {
+        ret = flush();
+    }
 
     return ret;
 }
 
-
 void AuditFile::set_log_directory(const std::string &new_directory) {
     if (log_directory == new_directory) {
         // No change
@@ -24,6 +24,7 @@
 #include <ctime>
 #include <memory>
 #include <string>
+#include <string_view>
 
 class AuditFile {
 public:
@@ -68,6 +69,14 @@ public:
      */
     bool write_event_to_disk(nlohmann::json& output);
 
+    /**
+     * Write a batch of events (each a line of JSON) to the disk
+     *
+     * @param events the data to write
+     * @return true if success, false otherwise
+     */
+    bool write_events_to_disk(std::string_view events);
+
     /**
      * Is the audit file open already?
      */
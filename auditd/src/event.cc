@@ -125,25 +125,16 @@ bool Event::process(AuditImpl& audit) {
         return true;
     }
 
-    if (!audit.auditfile.ensure_open()) {
-        LOG_WARNING("Audit: error opening audit file. Dropping event: {}",
-                    cb::UserDataView(json_payload.dump()));
-        return false;
-    }
     json_payload["id"] = id;
     json_payload["name"] = evt->second->getName();
     json_payload["description"] = evt->second->getDescription();
 
-    if (audit.auditfile.write_event_to_disk(json_payload)) {
-        return true;
-    }
-
-    LOG_WARNING("Audit: error writing event to disk. Dropping event: {}",
-                cb::UserDataView(json_payload.dump()));
+    audit.add_to_batch(json_payload.dump());
+    return true;
+}
 
-    // If the write_event_to_disk function returns false then it is
-    // possible the audit file has been closed.  Therefore ensure
-    // the file is open.
-    audit.auditfile.ensure_open();
-    return false;
+bool PreparedEvent::process(AuditImpl& audit) {
+    // The event was filtered and completed when it was built
+    audit.add_prepared_event(payload);
+    return true;
 }
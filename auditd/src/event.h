@@ -64,3 +64,16 @@ public:
     virtual ~Event() {}
 
 };
+
+/**
+ * An event built with the cb::audit::EventBuilder; it has already been
+ * filtered and its payload is the complete line to add to the audit trail.
+ */
+class PreparedEvent : public Event {
+public:
+    PreparedEvent(const uint32_t event_id, std::string_view payload)
+        : Event(event_id, payload) {
+    }
+
+    bool process(AuditImpl& audit) override;
+};
@@ -0,0 +1,228 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#include <memcached/audit_event_builder.h>
+#include <memcached/isotime.h>
+
+#include <charconv>
+#include <chrono>
+#include <cstring>
+
+namespace cb::audit {
+
+/**
+ * Get the length of the (valid) UTF-8 multi-byte sequence starting at ptr
+ *
+ * @return the length of the sequence, or 0 if it is invalid
+ */
+static size_t utf8SequenceLength(const uint8_t* ptr, const uint8_t* end) {
+    const auto lead = ptr[0];
+    size_t length;
+    // The range of the second byte (which excludes overlong encodings,
+    // surrogates and code points above U+10FFFF)
+    uint8_t min = 0x80;
+    uint8_t max = 0xbf;
+    if (lead >= 0xc2 && lead <= 0xdf) {
+        length = 2;
+    } else if (lead >= 0xe0 && lead <= 0xef) {
+        length = 3;
+        if (lead == 0xe0) {
+            min = 0xa0;
+        } else if (lead == 0xed) {
+            max = 0x9f;
+        }
+    } else if (lead >= 0xf0 && lead <= 0xf4) {
+        length = 4;
+        if (lead == 0xf0) {
+            min = 0x90;
+        } else if (lead == 0xf4) {
+            max = 0x8f;
+        }
+    } else {
+        return 0;
+    }
+
+    if (size_t(end - ptr) < length || ptr[1] < min || ptr[1] > max) {
+        return 0;
+    }
+    for (size_t ii = 2; ii < length; ++ii) {
+        if ((ptr[ii] & 0xc0) != 0x80) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+EventBuilder::EventBuilder() {
+    // Big enough for the typical event
+    buffer.reserve(1024);
+}
+
+void EventBuilder::reset(uint32_t event_id,
+                         std::string_view event_name,
+                         std::string_view event_description) {
+    buffer.assign(1, '{');
+    id = event_id;
+    name = event_name;
+    description = event_description;
+}
+
+void EventBuilder::finish() {
+    add("id", id);
+    add("name", name);
+    add("description", description);
+    buffer.push_back('}');
+}
+
+void EventBuilder::addKey(std::string_view key) {
+    if (buffer.back() != '{') {
+        buffer.push_back(',');
+    }
+    // The keys are all literals which don't need escaping
+    buffer.push_back('"');
+    buffer.append(key);
+    buffer.append("\":");
+}
+
+void EventBuilder::addString(std::string_view value) {
+    static const char hex[] = "0123456789abcdef";
+
+    buffer.push_back('"');
+    const auto* ptr = reinterpret_cast<const uint8_t*>(value.data());
+    const auto* end = ptr + value.size();
+    while (ptr < end) {
+        // Copy the characters which don't need escaping in one go
+        const auto* start = ptr;
+        while (ptr < end && *ptr >= 0x20 && *ptr < 0x80 && *ptr != '"' &&
+               *ptr != '\\') {
+            ++ptr;
+        }
+        buffer.append(reinterpret_cast<const char*>(start), ptr - start);
+        if (ptr == end) {
+            break;
+        }
+
+        const auto c = *ptr;
+        if (c >= 0x80) {
+            // Keep valid UTF-8 as is, and replace anything else with the
+            // replacement character so the event is still valid JSON
+            const auto length = utf8SequenceLength(ptr, end);
+            if (length == 0) {
+                buffer.append("\\ufffd");
+                ++ptr;
+            } else {
+                buffer.append(reinterpret_cast<const char*>(ptr), length);
+                ptr += length;
+            }
+            continue;
+        }
+
+        switch (c) {
+        case '"':
+            buffer.append("\\\"");
+            break;
+        case '\\':
+            buffer.append("\\\\");
+            break;
+        case '\b':
+            buffer.append("\\b");
+            break;
+        case '\f':
+            buffer.append("\\f");
+            break;
+        case '\n':
+            buffer.append("\\n");
+            break;
+        case '\r':
+            buffer.append("\\r");
+            break;
+        case '\t':
+            buffer.append("\\t");
+            break;
+        default:
+            buffer.append("\\u00");
+            buffer.push_back(hex[c >> 4]);
+            buffer.push_back(hex[c & 0xf]);
+        }
+        ++ptr;
+    }
+    buffer.push_back('"');
+}
+
+void EventBuilder::add(std::string_view key, std::string_view value) {
+    addKey(key);
+    addString(value);
+}
+
+void EventBuilder::add(std::string_view key, bool value) {
+    addKey(key);
+    buffer.append(value ? "true" : "false");
+}
+
+void EventBuilder::addNumber(std::string_view key, int64_t value) {
+    addKey(key);
+    char number[24];
+    const auto result =
+            std::to_chars(number, number + sizeof(number), value);
+    buffer.append(number, result.ptr - number);
+}
+
+void EventBuilder::addNumber(std::string_view key, uint64_t value) {
+    addKey(key);
+    char number[24];
+    const auto result =
+            std::to_chars(number, number + sizeof(number), value);
+    buffer.append(number, result.ptr - number);
+}
+
+void EventBuilder::add(std::string_view key, const Userid& userid) {
+    addKey(key);
+    buffer.append(R"({"domain":)");
+    addString(userid.domain);
+    buffer.append(R"(,"user":)");
+    addString(userid.user);
+    buffer.push_back('}');
+}
+
+void EventBuilder::addTimestamp() {
+    using namespace std::chrono;
+    const auto now = system_clock::now().time_since_epoch();
+    const auto seconds = duration_cast<std::chrono::seconds>(now);
+    const auto usec =
+            uint32_t(duration_cast<microseconds>(now - seconds).count());
+    const auto now_t = time_t(seconds.count());
+
+    // Formatting the timestamp is expensive (and serialised by ISOTime),
+    // so only do so once a second and patch in the fraction of the second
+    if (timestampLength == 0 || now_t != timestampSecond) {
+        timestampLength = ISOTime::generatetimestamp(timestamp, now_t, usec);
+        timestampSecond = now_t;
+    } else {
+        auto* fraction = std::strchr(timestamp.data(), '.') + 6;
+        auto value = usec;
+        for (int ii = 0; ii < 6; ++ii) {
+            *fraction-- = char('0' + value % 10);
+            value /= 10;
+        }
+    }
+
+    addKey("timestamp");
+    buffer.push_back('"');
+    buffer.append(timestamp.data(), timestampLength);
+    buffer.push_back('"');
+}
+
+} // namespace cb::audit
@@ -0,0 +1,61 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#include "event_ring.h"
+
+#include <stdexcept>
+
+EventRing::EventRing(size_t size)
+    : owner(std::this_thread::get_id()),
+      capacity(size),
+      mask(size - 1),
+      buffer(std::make_unique<char[]>(size)) {
+    if (size < sizeof(Header) || (size & mask) != 0) {
+        throw std::invalid_argument(
+                "EventRing::EventRing(): size must be a power of two");
+    }
+}
+
+bool EventRing::push(Type type, uint32_t id, std::string_view payload) {
+    const auto size = recordSize(payload.size());
+    if (size > capacity) {
+        return false;
+    }
+
+    auto position = head.load(std::memory_order_relaxed);
+    const auto used = position - tail.load(std::memory_order_acquire);
+    const auto contiguous = capacity - (position & mask);
+    // The record doesn't fit before the end of the buffer, so it must be
+    // preceded by a padding record
+    const auto padding = size > contiguous ? contiguous : 0;
+    if (capacity - used < size + padding) {
+        return false;
+    }
+
+    if (padding != 0) {
+        const Header header{
+                Type::Padding, 0, uint32_t(padding - sizeof(Header)), 0};
+        std::memcpy(buffer.get() + (position & mask), &header, sizeof(header));
+        position += padding;
+    }
+
+    auto* record = buffer.get() + (position & mask);
+    const Header header{type, id, uint32_t(payload.size()), 0};
+    std::memcpy(record, &header, sizeof(header));
+    std::memcpy(record + sizeof(header), payload.data(), payload.size());
+    head.store(position + size, std::memory_order_release);
+    return true;
+}
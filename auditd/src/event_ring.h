@@ -0,0 +1,131 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <thread>
+
+/**
+ * A single producer, single consumer ring buffer of audit events, used to
+ * pass the events from a thread submitting them to the audit consumer thread
+ * without taking a lock or allocating memory.
+ *
+ * The events are copied into the ring as records holding their type,
+ * identifier and payload. Records are padded to the size of the header and
+ * never wrap around the end of the buffer; a padding record fills the
+ * remainder of the buffer instead.
+ */
+class EventRing {
+public:
+    enum class Type : uint32_t {
+        /// Built with the EventBuilder, to add to the audit trail as is
+        Prepared,
+        /// JSON to be processed by Event::process()
+        Json,
+        /// Skip to the start of the buffer
+        Padding
+    };
+
+    /**
+     * @param size the size of the buffer, which must be a power of two
+     */
+    explicit EventRing(size_t size);
+
+    /**
+     * [Producer] Add an event to the ring
+     *
+     * @return false if there isn't space for the event
+     */
+    bool push(Type type, uint32_t id, std::string_view payload);
+
+    /// [Consumer] Is the ring empty?
+    bool empty() const {
+        return head.load(std::memory_order_acquire) ==
+               tail.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * [Any] The position following the events added so far, to consume
+     * only the events added before some point in time
+     */
+    size_t position() const {
+        return head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * [Consumer] Consume the events in the ring (up to the given position),
+     * calling the callback with the type, identifier and payload of each of
+     * them.
+     *
+     * @return the number of events consumed
+     */
+    template <typename Callback>
+    size_t consume(Callback&& callback,
+                   size_t until = std::numeric_limits<size_t>::max()) {
+        auto position = tail.load(std::memory_order_relaxed);
+        const auto end = std::min(head.load(std::memory_order_acquire), until);
+        size_t count = 0;
+        while (position < end) {
+            const auto* record = buffer.get() + (position & mask);
+            Header header;
+            std::memcpy(&header, record, sizeof(header));
+            if (header.type != Type::Padding) {
+                callback(header.type,
+                         header.id,
+                         std::string_view{record + sizeof(header),
+                                          header.size});
+                ++count;
+            }
+            position += recordSize(header.size);
+            // Release the space as we go so the producer may reuse it
+            tail.store(position, std::memory_order_release);
+        }
+        return count;
+    }
+
+    /// The thread producing the events
+    const std::thread::id owner;
+
+protected:
+    struct Header {
+        Type type;
+        uint32_t id;
+        uint32_t size;
+        uint32_t reserved;
+    };
+
+    static size_t recordSize(size_t payload) {
+        return sizeof(Header) +
+               ((payload + sizeof(Header) - 1) & ~(sizeof(Header) - 1));
+    }
+
+    const size_t capacity;
+    const size_t mask;
+    std::unique_ptr<char[]> buffer;
+
+    /// The positions (which are never wrapped) the producer writes the next
+    /// record at, and the consumer reads the next record from. Kept on
+    /// separate cache lines to avoid false sharing.
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+};
@@ -0,0 +1,131 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Benchmarks of the number of audit events per second each front end
+ * thread may submit to the audit daemon; building the event as a JSON
+ * object (which the audit daemon parses, filters and dumps again) versus
+ * building it with the cb::audit::EventBuilder.
+ *
+ * The audit daemon drops the events it can't keep up with, so the number
+ * of dropped events is reported as well.
+ */
+
+#include <benchmark/benchmark.h>
+#include <logger/logger.h>
+#include <memcached/audit_interface.h>
+#include <memcached/isotime.h>
+#include <nlohmann/json.hpp>
+#include <platform/dirutils.h>
+
+#include <fstream>
+#include <iostream>
+
+/// An event enabled by default (and permitted to be filtered)
+static const uint32_t EventId = 20480;
+
+static cb::audit::UniqueAuditPtr auditHandle;
+
+static uint64_t getDroppedEvents() {
+    uint64_t dropped = 0;
+    auditHandle->stats(
+            [&dropped](std::string_view key, std::string_view value, auto) {
+                if (key == "dropped_events") {
+                    dropped = std::stoull(std::string{value});
+                }
+            },
+            &dropped);
+    return dropped;
+}
+
+static void setDroppedCounter(benchmark::State& state, uint64_t before) {
+    if (state.thread_index == 0) {
+        state.counters["dropped"] = double(getDroppedEvents() - before);
+    }
+}
+
+static void bench_put_event_json(benchmark::State& state) {
+    const auto before = getDroppedEvents();
+    while (state.KeepRunning()) {
+        nlohmann::json root;
+        root["timestamp"] = ISOTime::generatetimestamp();
+        root["peername"] = "127.0.0.1:34512";
+        root["sockname"] = "127.0.0.1:11210";
+        root["real_userid"] = {{"domain", "local"}, {"user", "johndoe"}};
+        root["bucket"] = "default";
+        auditHandle->put_event(EventId, root.dump());
+    }
+    state.SetItemsProcessed(state.iterations());
+    setDroppedCounter(state, before);
+}
+
+static void bench_put_event_builder(benchmark::State& state) {
+    const auto before = getDroppedEvents();
+    cb::audit::EventBuilder event;
+    const cb::audit::Userid userid{"local", "johndoe"};
+    while (state.KeepRunning()) {
+        if (auditHandle->begin_event(event, EventId, userid, {})) {
+            event.addTimestamp();
+            event.add("peername", "127.0.0.1:34512");
+            event.add("sockname", "127.0.0.1:11210");
+            event.add("real_userid", userid);
+            event.add("bucket", "default");
+            auditHandle->put_event(event);
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    setDroppedCounter(state, before);
+}
+
+BENCHMARK(bench_put_event_json)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(bench_put_event_builder)->ThreadRange(1, 8)->UseRealTime();
+
+int main(int argc, char** argv) {
+    // Don't let logging the dropped events affect the results
+    cb::logger::createBlackholeLogger();
+
+    const auto logdir = cb::io::mktemp("audit-bench-");
+    cb::io::rmrf(logdir);
+    cb::io::mkdirp(logdir);
+    const auto cfgfile = cb::io::mktemp("audit-bench-config-");
+    nlohmann::json config = {{"version", 2},
+                             {"uuid", "audit_bench"},
+                             {"auditd_enabled", true},
+                             {"rotate_size", 20 * 1024 * 1024},
+                             {"rotate_interval", 900},
+                             {"buffered", true},
+                             {"log_path", logdir},
+                             {"descriptors_path", AUDIT_DESCRIPTORS_PATH},
+                             {"sync", nlohmann::json::array()},
+                             {"filtering_enabled", true},
+                             {"disabled_userids", nlohmann::json::array()}};
+    std::ofstream(cfgfile) << config.dump() << std::endl;
+
+    auditHandle = cb::audit::create_audit_daemon(cfgfile, nullptr);
+    if (!auditHandle) {
+        std::cerr << "Failed to start the audit daemon" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    ::benchmark::Initialize(&argc, argv);
+    ::benchmark::RunSpecifiedBenchmarks();
+
+    auditHandle.reset();
+    cb::io::rmrf(logdir);
+    cb::io::rmrf(cfgfile);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include <folly/portability/GTest.h>
+#include <memcached/audit_event_builder.h>
+#include <memcached/isotime.h>
+#include <nlohmann/json.hpp>
+
+#include <limits>
+
+/// Expose the methods used by the audit daemon to start and complete events
+class MockEventBuilder : public cb::audit::EventBuilder {
+public:
+    using EventBuilder::finish;
+    using EventBuilder::reset;
+};
+
+class EventBuilderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        builder.reset(1234, "name", "description");
+    }
+
+    nlohmann::json finish() {
+        builder.finish();
+        return nlohmann::json::parse(builder.getPayload());
+    }
+
+    MockEventBuilder builder;
+};
+
+TEST_F(EventBuilderTest, Event) {
+    builder.addTimestamp();
+    builder.add("real_userid", cb::audit::Userid{"local", "johndoe"});
+    builder.add("bucket", "default");
+    builder.add("enable", true);
+
+    const auto json = finish();
+    EXPECT_EQ(1234, json["id"].get<int>());
+    EXPECT_EQ("name", json["name"].get<std::string>());
+    EXPECT_EQ("description", json["description"].get<std::string>());
+    EXPECT_TRUE(json["timestamp"].is_string());
+    EXPECT_EQ("local", json["real_userid"]["domain"].get<std::string>());
+    EXPECT_EQ("johndoe", json["real_userid"]["user"].get<std::string>());
+    EXPECT_EQ("default", json["bucket"].get<std::string>());
+    EXPECT_TRUE(json["enable"].get<bool>());
+}
+
+TEST_F(EventBuilderTest, Numbers) {
+    builder.add("min", std::numeric_limits<int64_t>::min());
+    builder.add("max", std::numeric_limits<uint64_t>::max());
+    builder.add("zero", 0);
+
+    const auto json = finish();
+    EXPECT_EQ(std::numeric_limits<int64_t>::min(), json["min"].get<int64_t>());
+    EXPECT_EQ(std::numeric_limits<uint64_t>::max(),
+              json["max"].get<uint64_t>());
+    EXPECT_EQ(0, json["zero"].get<int>());
+}
+
+TEST_F(EventBuilderTest, Escaping) {
+    std::string value = "\"quoted\" back\\slash \b\f\n\r\t";
+    for (char c = 0; c < 0x20; ++c) {
+        value.push_back(c);
+    }
+    value.append("\x7f \xc3\xa6\xc3\xb8\xc3\xa5 \xe2\x82\xac \xf0\x9f\x98\x80");
+    builder.add("value", value);
+
+    EXPECT_EQ(value, finish()["value"].get<std::string>());
+}
+
+// Invalid UTF-8 is replaced so the event is still valid JSON
+TEST_F(EventBuilderTest, InvalidUtf8) {
+    builder.add("value",
+                std::string_view{"a\xff"
+                                 "b\xc3"
+                                 "c\xc0\xaf"
+                                 "d\xed\xa0\x80"});
+    EXPECT_EQ(
+            "a\xef\xbf\xbd"
+            "b\xef\xbf\xbd"
+            "c\xef\xbf\xbd\xef\xbf\xbd"
+            "d\xef\xbf\xbd\xef\xbf\xbd\xef\xbf\xbd",
+            finish()["value"].get<std::string>());
+}
+
+// The timestamps are only formatted once a second, check they're the same
+// as those generated by ISOTime
+TEST_F(EventBuilderTest, Timestamp) {
+    for (int ii = 0; ii < 1000; ++ii) {
+        builder.reset(1234, "name", "description");
+        const auto before = ISOTime::generatetimestamp();
+        builder.addTimestamp();
+        const auto after = ISOTime::generatetimestamp();
+        const auto timestamp = finish()["timestamp"].get<std::string>();
+        ASSERT_EQ(before.size(), timestamp.size()) << timestamp;
+        ASSERT_LE(before, timestamp);
+        ASSERT_GE(after, timestamp);
+    }
+}
+
+// A builder is reused for the next event
+TEST_F(EventBuilderTest, Reset) {
+    builder.add("bucket", "default");
+    finish();
+
+    builder.reset(4321, "other", "other description");
+    builder.add("key", "foo");
+    const auto json = finish();
+    EXPECT_EQ(4321, json["id"].get<int>());
+    EXPECT_EQ("other", json["name"].get<std::string>());
+    EXPECT_EQ("foo", json["key"].get<std::string>());
+    EXPECT_EQ(json.end(), json.find("bucket"));
+}
@@ -0,0 +1,142 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "event_ring.h"
+
+#include <folly/portability/GTest.h>
+
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using Record = std::tuple<EventRing::Type, uint32_t, std::string>;
+
+static std::vector<Record> consumeAll(EventRing& ring) {
+    std::vector<Record> records;
+    const auto count = ring.consume(
+            [&records](EventRing::Type type, uint32_t id, std::string_view p) {
+                records.emplace_back(type, id, std::string{p});
+            });
+    EXPECT_EQ(records.size(), count);
+    return records;
+}
+
+TEST(EventRingTest, InvalidSize) {
+    EXPECT_THROW(EventRing(0), std::invalid_argument);
+    EXPECT_THROW(EventRing(1000), std::invalid_argument);
+}
+
+TEST(EventRingTest, PushConsume) {
+    EventRing ring(1024);
+    EXPECT_TRUE(ring.empty());
+    EXPECT_TRUE(ring.push(EventRing::Type::Prepared, 1, "first"));
+    EXPECT_TRUE(ring.push(EventRing::Type::Json, 2, ""));
+    EXPECT_FALSE(ring.empty());
+
+    const std::vector<Record> expected = {
+            {EventRing::Type::Prepared, 1, "first"},
+            {EventRing::Type::Json, 2, ""}};
+    EXPECT_EQ(expected, consumeAll(ring));
+    EXPECT_TRUE(ring.empty());
+    EXPECT_TRUE(consumeAll(ring).empty());
+}
+
+// Only the events added before the given position are consumed
+TEST(EventRingTest, ConsumeUntil) {
+    EventRing ring(256);
+    EXPECT_TRUE(ring.push(EventRing::Type::Json, 1, "first"));
+    const auto position = ring.position();
+    EXPECT_TRUE(ring.push(EventRing::Type::Json, 2, "second"));
+
+    std::vector<Record> records;
+    auto callback = [&records](EventRing::Type type,
+                               uint32_t id,
+                               std::string_view p) {
+        records.emplace_back(type, id, std::string{p});
+    };
+    EXPECT_EQ(1, ring.consume(callback, position));
+    EXPECT_EQ(1, records.size());
+    // Nothing more up to that position
+    EXPECT_EQ(0, ring.consume(callback, position));
+    EXPECT_FALSE(ring.empty());
+
+    EXPECT_EQ(1, ring.consume(callback, ring.position()));
+    const std::vector<Record> expected = {{EventRing::Type::Json, 1, "first"},
+                                          {EventRing::Type::Json, 2, "second"}};
+    EXPECT_EQ(expected, records);
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(EventRingTest, Full) {
+    EventRing ring(256);
+    // Each record is a 16 byte header and a payload padded to 16 bytes
+    const std::string payload(48, 'x');
+    for (uint32_t id = 0; id < 4; ++id) {
+        EXPECT_TRUE(ring.push(EventRing::Type::Prepared, id, payload));
+    }
+    EXPECT_FALSE(ring.push(EventRing::Type::Prepared, 4, payload));
+    EXPECT_FALSE(ring.push(EventRing::Type::Prepared, 4, std::string(512, 'x')));
+
+    EXPECT_EQ(4, consumeAll(ring).size());
+    EXPECT_TRUE(ring.push(EventRing::Type::Prepared, 4, payload));
+}
+
+// A record which doesn't fit before the end of the buffer is preceded by
+// padding (which isn't returned to the consumer)
+TEST(EventRingTest, Wrap) {
+    EventRing ring(256);
+    const std::string payload(80, 'x');
+    for (uint32_t id = 0; id < 100; ++id) {
+        ASSERT_TRUE(ring.push(EventRing::Type::Json, id, payload));
+        const auto records = consumeAll(ring);
+        ASSERT_EQ(1, records.size());
+        EXPECT_EQ(Record(EventRing::Type::Json, id, payload), records.front());
+    }
+}
+
+TEST(EventRingTest, ProducerConsumer) {
+    EventRing* ring = nullptr;
+    std::atomic_bool ready{false};
+    const uint32_t events = 100000;
+
+    std::thread producer([&ring, &ready, events]() {
+        static EventRing producerRing(4096);
+        ring = &producerRing;
+        ready = true;
+        for (uint32_t id = 0; id < events; ++id) {
+            const auto payload = std::to_string(id);
+            while (!producerRing.push(EventRing::Type::Json, id, payload)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    while (!ready) {
+        std::this_thread::yield();
+    }
+
+    uint32_t next = 0;
+    while (next < events) {
+        ring->consume([&next](EventRing::Type, uint32_t id, std::string_view p) {
+            EXPECT_EQ(next, id);
+            EXPECT_EQ(std::to_string(id), p);
+            ++next;
+        });
+    }
+    producer.join();
+    EXPECT_TRUE(ring->empty());
+}
@@ -324,7 +324,39 @@ protected:
         json["sync"] = false;
         json["enabled"] = true;
         json["filtering_permitted"] = filteringPermitted;
-        dynamic_cast<AuditImpl*>(auditHandle.get())->add_event_descriptor(json);
+        auto* audit = dynamic_cast<AuditImpl*>(auditHandle.get());
+        audit->add_event_descriptor(json);
+        // Make the new event available to begin_event()
+        audit->update_prepared_state();
+    }
+
+    // Wait for "another" to appear in the audit log, and check if "johndoe"
+    // was filtered out (as expected)
+    void checkJohndoeFiltered() {
+        bool globalFilterSetting = std::get<0>(GetParam());
+        bool eventFilteringPermitted = std::get<1>(GetParam());
+
+        // Check the audit log exists
+        assertNumberOfFiles(1);
+
+        // wait up to 10 seconds for "another" to appear in the audit log
+        uint16_t waitIteration = 0;
+        while (!existsInAuditLog("another") && (waitIteration < 200)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            waitIteration++;
+        }
+
+        // Check to see if "johndoe" exists or not in the audit log
+        bool foundJohndoe = existsInAuditLog("johndoe");
+
+        // If filtering is enabled and the event is permitted to be filtered
+        // then the event should not be found in the audit log.
+        if (globalFilterSetting && eventFilteringPermitted) {
+            EXPECT_FALSE(foundJohndoe);
+        } else {
+            // exists in audit log
+            EXPECT_TRUE(foundJohndoe);
+        }
     }
 };
 
@@ -338,7 +370,6 @@ protected:
 TEST_P(AuditDaemonFilteringTest, AuditFilteringTest) {
     bool globalFilterSetting = std::get<0>(GetParam());
     bool eventFilteringPermitted = std::get<1>(GetParam());
-    bool foundJohndoe{false};
 
     const std::string payloadjohndoe =
             R"({"id": 1234, "timestamp": "test", "real_userid":
@@ -357,27 +388,78 @@ TEST_P(AuditDaemonFilteringTest, AuditFilteringTest) {
     // generate the 1234 event with real_userid:user = another
     auditHandle->put_event(1234, payloadanother);
 
-    // Check the audit log exists
-    assertNumberOfFiles(1);
+    checkJohndoeFiltered();
+}
+
+/**
+ * The same as AuditFilteringTest, but building the events with the
+ * EventBuilder (where the filtering happens in begin_event())
+ */
+TEST_P(AuditDaemonFilteringTest, EventBuilderFilteringTest) {
+    bool globalFilterSetting = std::get<0>(GetParam());
+    bool eventFilteringPermitted = std::get<1>(GetParam());
 
-    // wait up to 10 seconds for "another" to appear in the audit log
+    config.set_filtering_enabled(globalFilterSetting);
+    enable();
+    addEvent(eventFilteringPermitted);
+
+    cb::audit::EventBuilder event;
+    for (const auto* user : {"johndoe", "another"}) {
+        const cb::audit::Userid userid{"internal", user};
+        if (auditHandle->begin_event(event, 1234, userid, {})) {
+            event.add("timestamp", "test");
+            event.add("real_userid", userid);
+            EXPECT_TRUE(auditHandle->put_event(event));
+        }
+    }
+
+    checkJohndoeFiltered();
+}
+
+/**
+ * The events are written in the order they were submitted, also when one
+ * of them doesn't fit in the submitting thread's event ring and has to go
+ * through the queue.
+ */
+TEST_P(AuditDaemonFilteringTest, SubmissionOrder) {
+    config.set_rotate_size(10 * 1024 * 1024);
+    enable();
+    addEvent(std::get<1>(GetParam()));
+
+    auto payload = [](const std::string& order, size_t padding = 0) {
+        nlohmann::json json;
+        json["id"] = 1234;
+        json["timestamp"] = "test";
+        json["real_userid"] = {{"source", "internal"}, {"user", "another"}};
+        json["order"] = order;
+        json["padding"] = std::string(padding, 'x');
+        return json.dump();
+    };
+    EXPECT_TRUE(auditHandle->put_event(1234, payload("first")));
+    // Larger than the event ring
+    EXPECT_TRUE(
+            auditHandle->put_event(1234, payload("second", 512 * 1024)));
+    EXPECT_TRUE(auditHandle->put_event(1234, payload("third")));
+
+    // wait up to 10 seconds for the last event to appear in the audit log
     uint16_t waitIteration = 0;
-    while (!existsInAuditLog("another") && (waitIteration < 200)) {
+    while (!existsInAuditLog(R"("order":"third")") && (waitIteration < 200)) {
         std::this_thread::sleep_for(std::chrono::milliseconds(50));
         waitIteration++;
     }
 
-    // Check to see if "johndoe" exists or not in the audit log
-    foundJohndoe = existsInAuditLog("johndoe");
-
-    // If filtering is enabled and the event is permitted to be filtered
-    // then the event should not be found in the audit log.
-    if (globalFilterSetting && eventFilteringPermitted) {
-        EXPECT_FALSE(foundJohndoe);
-    } else {
-        // exists in audit log
-        EXPECT_TRUE(foundJohndoe);
+    auto vec = cb::io::findFilesContaining(testdir, "");
+    ASSERT_EQ(1, vec.size());
+    std::ifstream auditFile(vec.front());
+    std::vector<std::string> order;
+    std::string line;
+    while (std::getline(auditFile, line)) {
+        auto json = nlohmann::json::parse(line);
+        if (json.find("order") != json.end()) {
+            order.push_back(json["order"].get<std::string>());
+        }
     }
+    EXPECT_EQ(std::vector<std::string>({"first", "second", "third"}), order);
 }
 
 // Check to see if "uuid":"12345" is reported
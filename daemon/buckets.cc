@@ -37,6 +37,8 @@ void Bucket::reset() {
     }
     subjson_operation_times.reset();
     timings.reset();
+    slowOps.reset();
+    statGroupCosts.lock()->clear();
     for (auto& s : stats) {
         s.reset();
     }
@@ -19,16 +19,21 @@
 #include "bucket_type.h"
 #include "cluster_config.h"
 #include "mcbp_validators.h"
+#include "slow_op_recorder.h"
 #include "timings.h"
 
+#include <folly/Synchronized.h>
 #include <memcached/engine.h>
 #include <memcached/limits.h>
 #include <memcached/types.h>
 #include <nlohmann/json_fwd.hpp>
 #include <utilities/hdrhistogram.h>
 
+#include <chrono>
 #include <condition_variable>
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 struct thread_stats;
 struct DcpIface;
@@ -37,6 +42,20 @@ class Connection;
 
 #define MAX_BUCKET_NAME_LENGTH 100
 
+/**
+ * The cost of producing a group of stats
+ */
+struct StatGroupCost {
+    /// The number of times the group was requested (successfully)
+    uint64_t count = 0;
+    /// The total and maximum time spent producing the stats
+    std::chrono::microseconds total{0};
+    std::chrono::microseconds max{0};
+    /// The size of the stats the last time the group was collected off the
+    /// front-end thread (used to size the buffer for the next time)
+    size_t size = 0;
+};
+
 class Bucket {
 public:
     enum class State : uint8_t {
@@ -121,6 +140,19 @@ public:
      */
     Timings timings;
 
+    /**
+     * The slowest operations of the recent intervals
+     */
+    SlowOpRecorder slowOps;
+
+    /**
+     * The cost of each of the stat groups requested, keyed by the name
+     * of the group
+     */
+    folly::Synchronized<std::unordered_map<std::string, StatGroupCost>,
+                        std::mutex>
+            statGroupCosts;
+
     /**
      *  Sub-document JSON parser (subjson) operation execution time histogram.
      */
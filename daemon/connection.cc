@@ -242,7 +242,7 @@ cb::engine_errc Connection::dropPrivilege(cb::rbac::Privilege privilege) {
     return cb::engine_errc::success;
 }
 
-cb::rbac::PrivilegeContext Connection::getPrivilegeContext() {
+const cb::rbac::PrivilegeContext& Connection::getPrivilegeContext() {
     if (privilegeContext.isStale()) {
         try {
             privilegeContext = cb::rbac::createContext(user, getBucket().name);
@@ -205,7 +205,7 @@ public:
      * @return The privilege context object to use, or {} if no access
      *         exists for the user at all.
      */
-    cb::rbac::PrivilegeContext getPrivilegeContext();
+    const cb::rbac::PrivilegeContext& getPrivilegeContext();
 
     /**
      * Try to drop the specified privilege from the current context
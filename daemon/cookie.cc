@@ -416,6 +416,47 @@ void Cookie::maybeLogSlowCommand(
     }
 }
 
+void Cookie::maybeRecordSlowCommand(
+        SlowOpRecorder& recorder,
+        std::chrono::steady_clock::time_point endTime) const {
+    const auto elapsed = endTime - start;
+    if (!recorder.isCandidate(elapsed)) {
+        return;
+    }
+
+    SlowOpRecorder::Operation op;
+    op.start = start;
+    op.completed = std::chrono::system_clock::now();
+    op.duration = elapsed;
+    op.opcode = getRequest().getClientOpcode();
+    op.opaque = ntohl(getHeader().getOpaque());
+    if (validated) {
+        try {
+            const auto key = getRequestKey();
+            const auto k = key.makeDocKeyWithoutCollectionID();
+            op.keyHash = std::hash<std::string_view>{}(
+                    {reinterpret_cast<const char*>(k.data()), k.size()});
+            op.collection = key.getCollectionID();
+        } catch (const std::exception&) {
+            // Leave out the key
+        }
+    }
+    op.connectionId = connection.getId();
+    op.peer = connection.getPeername();
+    op.spans = tracer.getSpans();
+
+    if (recorder.record(std::move(op))) {
+        TRACE_COMPLETE2("memcached/slow_ops",
+                        "Slowest cmd",
+                        start,
+                        endTime,
+                        "opcode",
+                        getHeader().getOpcode(),
+                        "connection_id",
+                        connection.getId());
+    }
+}
+
 Cookie::Cookie(Connection& conn)
     : connection(conn), privilegeContext(conn.getUser().domain) {
 }
@@ -513,7 +554,12 @@ void Cookie::reset() {
     reorder = connection.allowUnorderedExecution();
     inflated_input_payload.reset();
     currentCollectionInfo.reset();
-    privilegeContext = connection.getPrivilegeContext();
+    // Avoid copying the context (and the references it holds) for every
+    // command when the connection's context hasn't changed
+    const auto& context = connection.getPrivilegeContext();
+    if (!privilegeContext.isSameContext(context)) {
+        privilegeContext = context;
+    }
     euid.reset();
     euidPrivilegeContext.reset();
 }
@@ -569,6 +615,7 @@ void Cookie::collectTimings() {
      */
     if (bucketid != 0) {
         all_buckets[bucketid].timings.collect(opcode, elapsed);
+        maybeRecordSlowCommand(all_buckets[bucketid].slowOps, endTime);
     }
 
     // Log operations taking longer than the "slow" threshold for the opcode.
@@ -30,6 +30,7 @@
 class Connection;
 class CommandContext;
 struct CookieTraceContext;
+class SlowOpRecorder;
 class Task;
 namespace cb {
 namespace mcbp {
@@ -397,6 +398,17 @@ public:
      */
     void maybeLogSlowCommand(std::chrono::steady_clock::duration elapsed) const;
 
+    /**
+     * Record the command in the recorder if it is one of the slowest
+     * commands of the current interval
+     *
+     * @param recorder the recorder of the bucket the command was for
+     * @param endTime the time the command completed
+     */
+    void maybeRecordSlowCommand(SlowOpRecorder& recorder,
+                                std::chrono::steady_clock::time_point endTime)
+            const;
+
     uint8_t getRefcount() {
         return refcount;
     }
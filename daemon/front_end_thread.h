@@ -17,13 +17,15 @@
 
 #pragma once
 
-#include <JSON_checker.h>
+#include "subdocument_index.h"
+
 #include <event.h>
 #include <memcached/engine_error.h>
 #include <platform/platform_thread.h>
 #include <platform/sized_buffer.h>
 #include <platform/socket.h>
 #include <subdoc/operations.h>
+#include <utilities/json_validator.h>
 
 #include <array>
 #include <atomic>
@@ -122,11 +124,17 @@ struct FrontEndThread {
      */
     Subdoc::Operation subdoc_op;
 
+    /**
+     * Index of the document most recently accessed by a multi-path lookup
+     * on this thread, which the lookups resolve their paths against
+     */
+    SubdocDocumentIndex subdoc_index;
+
     /**
      * Shared validator used by all connections serviced by this thread
      * when they need to validate a JSON document
      */
-    JSON_checker::Validator validator;
+    cb::json::Validator validator;
 
     /// Is the thread running or not
     std::atomic_bool running{false};
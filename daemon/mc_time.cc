@@ -258,6 +258,7 @@ void mc_time_clock_tick() {
 static void mc_gather_timing_samples() {
     bucketsForEach([](Bucket& bucket, void *) -> bool {
         bucket.timings.sample(std::chrono::seconds(1));
+        bucket.slowOps.sample(std::chrono::seconds(1));
         return true;
     }, nullptr);
 }
@@ -28,11 +28,9 @@
 #include "settings.h"
 
 #include <memcached/audit_interface.h>
-#include <memcached/isotime.h>
 #include <platform/string_hex.h>
 
 #include <folly/Synchronized.h>
-#include <nlohmann/json.hpp>
 
 #include <sstream>
 
@@ -83,68 +81,90 @@ void setEnabled(uint32_t id, bool enable) {
 }
 
 /**
- * Create the typical memcached audit object. It consists of a
- * timestamp, the socket endpoints and the creds. Then each audit event
- * may add event-specific content.
+ * Build an audit event and send it to the audit framework. The typical
+ * memcached audit event consists of a timestamp, the socket endpoints and
+ * the creds, then each audit event may add event-specific content.
  *
+ * The event is only built if the audit daemon wants it (it may be
+ * disabled or filtered out for the user), and is rendered directly into
+ * the JSON written to the audit trail.
+ *
+ * @param id the audit identifier
  * @param c the connection object
- * @return the json object containing the basic information
+ * @param euid the effective user (if any)
+ * @param warn what to log if we're failing to put the audit event
+ * @param addFields callback to add the event-specific content
  */
-static nlohmann::json create_memcached_audit_object(
-        const Connection& c, const std::optional<cb::rbac::UserIdent>& euid) {
-    nlohmann::json root;
+template <typename AddFields>
+static void do_audit(uint32_t id,
+                     const Connection& c,
+                     const std::optional<cb::rbac::UserIdent>& euid,
+                     const char* warn,
+                     AddFields&& addFields) {
+    // The builder keeps its buffer between events. Events are sent from
+    // the front end threads as well as the executor threads (for SASL)
+    thread_local cb::audit::EventBuilder builder;
+
+    auditHandle.withRLock([id, &c, &euid, warn, &addFields](auto& handle) {
+        if (!handle) {
+            return;
+        }
 
-    root["timestamp"] = ISOTime::generatetimestamp();
-    root["peername"] = c.getPeername();
-    root["sockname"] = c.getSockname();
-    root["real_userid"] = c.getUser().to_json();
+        const auto& user = c.getUser();
+        const auto domain = ::to_string(user.domain);
+        const cb::audit::Userid real{domain, user.name};
+        std::string effectiveDomain;
+        std::optional<cb::audit::Userid> effective;
+        if (euid) {
+            effectiveDomain = ::to_string(euid->domain);
+            effective = cb::audit::Userid{effectiveDomain, euid->name};
+        }
 
-    if (euid) {
-        root["effective_userid"] = euid->to_json();
-    }
+        if (!handle->begin_event(builder, id, real, effective)) {
+            return;
+        }
 
-    return root;
+        builder.addTimestamp();
+        builder.add("peername", c.getPeername());
+        builder.add("sockname", c.getSockname());
+        builder.add("real_userid", real);
+        if (effective) {
+            builder.add("effective_userid", *effective);
+        }
+        addFields(builder);
+
+        if (!handle->put_event(builder)) {
+            LOG_WARNING("{}: {}", warn, builder.getPayload());
+        }
+    });
 }
 
-/**
- * Convert the JSON object to text and send it to the audit framework
- *
- * @param id the audit identifier
- * @param event the payload of the audit description
- * @param warn what to log if we're failing to put the audit event
- */
+/// do_audit() for events with no event-specific content
 static void do_audit(uint32_t id,
-                     const nlohmann::json& event,
+                     const Connection& c,
+                     const std::optional<cb::rbac::UserIdent>& euid,
                      const char* warn) {
-    auto text = event.dump();
-    auditHandle.withRLock([id, warn, &text](auto& handle) {
-        if (handle) {
-            if (!handle->put_event(id, text)) {
-                LOG_WARNING("{}: {}", warn, text);
-            }
-        }
-    });
+    do_audit(id, c, euid, warn, [](auto&) {});
 }
 
 void audit_auth_failure(const Connection& c, const char* reason) {
     if (!isEnabled(MEMCACHED_AUDIT_AUTHENTICATION_FAILED)) {
         return;
     }
-    auto root = create_memcached_audit_object(c, {});
-    root["reason"] = reason;
-
     do_audit(MEMCACHED_AUDIT_AUTHENTICATION_FAILED,
-             root,
-             "Failed to send AUTH FAILED audit event");
+             c,
+             {},
+             "Failed to send AUTH FAILED audit event",
+             [reason](auto& event) { event.add("reason", reason); });
 }
 
 void audit_auth_success(const Connection& c) {
     if (!isEnabled(MEMCACHED_AUDIT_AUTHENTICATION_SUCCEEDED)) {
         return;
     }
-    auto root = create_memcached_audit_object(c, {});
     do_audit(MEMCACHED_AUDIT_AUTHENTICATION_SUCCEEDED,
-             root,
+             c,
+             {},
              "Failed to send AUTH SUCCESS audit event");
 }
 
@@ -155,11 +175,11 @@ void audit_bucket_selection(const Connection& c) {
     const auto& bucket = c.getBucket();
     // Don't audit that we're jumping into the "no bucket"
     if (bucket.type != BucketType::NoBucket) {
-        auto root = create_memcached_audit_object(c, {});
-        root["bucket"] = c.getBucket().name;
         do_audit(MEMCACHED_AUDIT_SELECT_BUCKET,
-                 root,
-                 "Failed to send SELECT BUCKET audit event");
+                 c,
+                 {},
+                 "Failed to send SELECT BUCKET audit event",
+                 [&bucket](auto& event) { event.add("bucket", bucket.name); });
     }
 }
 
@@ -167,12 +187,11 @@ void audit_bucket_flush(const Connection& c, const char* bucket) {
     if (!isEnabled(MEMCACHED_AUDIT_EXTERNAL_MEMCACHED_BUCKET_FLUSH)) {
         return;
     }
-    auto root = create_memcached_audit_object(c, {});
-    root["bucket"] = bucket;
-
     do_audit(MEMCACHED_AUDIT_EXTERNAL_MEMCACHED_BUCKET_FLUSH,
-             root,
-             "Failed to send EXTERNAL_MEMCACHED_BUCKET_FLUSH audit event");
+             c,
+             {},
+             "Failed to send EXTERNAL_MEMCACHED_BUCKET_FLUSH audit event",
+             [bucket](auto& event) { event.add("bucket", bucket); });
 }
 
 void audit_dcp_open(const Connection& c) {
@@ -182,13 +201,14 @@ void audit_dcp_open(const Connection& c) {
     if (c.isInternal()) {
         LOG_INFO("Open DCP stream with admin credentials");
     } else {
-        auto root = create_memcached_audit_object(c, {});
-        root["bucket"] = c.getBucket().name;
-
         do_audit(MEMCACHED_AUDIT_OPENED_DCP_CONNECTION,
-                 root,
+                 c,
+                 {},
                  "Failed to send DCP open connection "
-                 "audit event to audit daemon");
+                 "audit event to audit daemon",
+                 [&c](auto& event) {
+                     event.add("bucket", c.getBucket().name);
+                 });
     }
 }
 
@@ -196,12 +216,12 @@ void audit_set_privilege_debug_mode(const Connection& c, bool enable) {
     if (!isEnabled(MEMCACHED_AUDIT_PRIVILEGE_DEBUG_CONFIGURED)) {
         return;
     }
-    auto root = create_memcached_audit_object(c, {});
-    root["enable"] = enable;
     do_audit(MEMCACHED_AUDIT_PRIVILEGE_DEBUG_CONFIGURED,
-             root,
+             c,
+             {},
              "Failed to send modifications in privilege debug state "
-             "audit event to audit daemon");
+             "audit event to audit daemon",
+             [enable](auto& event) { event.add("enable", enable); });
 }
 
 void audit_privilege_debug(const Connection& c,
@@ -212,15 +232,16 @@ void audit_privilege_debug(const Connection& c,
     if (!isEnabled(MEMCACHED_AUDIT_PRIVILEGE_DEBUG)) {
         return;
     }
-    auto root = create_memcached_audit_object(c, {});
-    root["command"] = command;
-    root["bucket"] = bucket;
-    root["privilege"] = privilege;
-    root["context"] = context;
-
     do_audit(MEMCACHED_AUDIT_PRIVILEGE_DEBUG,
-             root,
-             "Failed to send privilege debug audit event to audit daemon");
+             c,
+             {},
+             "Failed to send privilege debug audit event to audit daemon",
+             [&](auto& event) {
+                 event.add("command", command);
+                 event.add("bucket", bucket);
+                 event.add("privilege", privilege);
+                 event.add("context", context);
+             });
 }
 
 void audit_command_access_failed(const Cookie& cookie) {
@@ -228,8 +249,6 @@ void audit_command_access_failed(const Cookie& cookie) {
         return;
     }
     const auto& connection = cookie.getConnection();
-    auto root = create_memcached_audit_object(connection,
-                                              cookie.getEffectiveUser());
     char buffer[256];
     memset(buffer, 0, sizeof(buffer));
     const auto packet = cookie.getPacket();
@@ -242,15 +261,17 @@ void audit_command_access_failed(const Cookie& cookie) {
                            "Access to command is not allowed:",
                            reinterpret_cast<const char*>(packet.data()),
                            packet.size());
-    root["packet"] = buffer;
-    do_audit(MEMCACHED_AUDIT_COMMAND_ACCESS_FAILURE, root, buffer);
+    do_audit(MEMCACHED_AUDIT_COMMAND_ACCESS_FAILURE,
+             connection,
+             cookie.getEffectiveUser(),
+             buffer,
+             [&buffer](auto& event) { event.add("packet", buffer); });
 }
 
 void audit_invalid_packet(const Connection& c, cb::const_byte_buffer packet) {
     if (!isEnabled(MEMCACHED_AUDIT_INVALID_PACKET)) {
         return;
     }
-    auto root = create_memcached_audit_object(c, {});
     std::stringstream ss;
     std::string trunc;
     const cb::const_byte_buffer::size_type max_dump_size = 256;
@@ -261,8 +282,14 @@ void audit_invalid_packet(const Connection& c, cb::const_byte_buffer packet) {
     }
     ss << "Invalid packet: " << cb::to_hex(packet) << trunc;
     const auto message = ss.str();
-    root["packet"] = message.c_str() + strlen("Invalid packet: ");
-    do_audit(MEMCACHED_AUDIT_INVALID_PACKET, root, message.c_str());
+    do_audit(MEMCACHED_AUDIT_INVALID_PACKET,
+             c,
+             {},
+             message.c_str(),
+             [&message](auto& event) {
+                 event.add("packet",
+                           message.c_str() + strlen("Invalid packet: "));
+             });
 }
 
 bool mc_audit_event(uint32_t audit_eventid, cb::const_byte_buffer payload) {
@@ -287,33 +314,39 @@ void addSessionTerminated(const Connection& c) {
         !c.isAuthenticated()) {
         return;
     }
-    auto root = create_memcached_audit_object(c, {});
-    const auto& reason = c.getTerminationReason();
-    if (!reason.empty()) {
-        root["reason_for_termination"] = reason;
-    }
-
     do_audit(MEMCACHED_AUDIT_SESSION_TERMINATED,
-             root,
-             "Failed to audit session terminated");
+             c,
+             {},
+             "Failed to audit session terminated",
+             [&c](auto& event) {
+                 const auto& reason = c.getTerminationReason();
+                 if (!reason.empty()) {
+                     event.add("reason_for_termination", reason);
+                 }
+             });
 }
 
 namespace document {
 
 void add(const Cookie& cookie, Operation operation) {
     uint32_t id = 0;
+    const char* warn = nullptr;
     switch (operation) {
     case Operation::Read:
         id = MEMCACHED_AUDIT_DOCUMENT_READ;
+        warn = "Failed to send document read audit event to audit daemon";
         break;
     case Operation::Lock:
         id = MEMCACHED_AUDIT_DOCUMENT_LOCKED;
+        warn = "Failed to send document locked audit event to audit daemon";
         break;
     case Operation::Modify:
         id = MEMCACHED_AUDIT_DOCUMENT_MODIFY;
+        warn = "Failed to send document modify audit event to audit daemon";
         break;
     case Operation::Delete:
         id = MEMCACHED_AUDIT_DOCUMENT_DELETE;
+        warn = "Failed to send document delete audit event to audit daemon";
         break;
     }
 
@@ -327,33 +360,14 @@ void add(const Cookie& cookie, Operation operation) {
     }
 
     const auto& connection = cookie.getConnection();
-    auto root = create_memcached_audit_object(connection,
-                                              cookie.getEffectiveUser());
-    root["bucket"] = connection.getBucket().name;
-    root["key"] = cookie.getPrintableRequestKey();
-
-    switch (operation) {
-    case Operation::Read:
-        do_audit(MEMCACHED_AUDIT_DOCUMENT_READ,
-                 root,
-                 "Failed to send document read audit event to audit daemon");
-        break;
-    case Operation::Lock:
-        do_audit(MEMCACHED_AUDIT_DOCUMENT_LOCKED,
-                 root,
-                 "Failed to send document locked audit event to audit daemon");
-        break;
-    case Operation::Modify:
-        do_audit(MEMCACHED_AUDIT_DOCUMENT_MODIFY,
-                 root,
-                 "Failed to send document modify audit event to audit daemon");
-        break;
-    case Operation::Delete:
-        do_audit(MEMCACHED_AUDIT_DOCUMENT_DELETE,
-                 root,
-                 "Failed to send document delete audit event to audit daemon");
-        break;
-    }
+    do_audit(id,
+             connection,
+             cookie.getEffectiveUser(),
+             warn,
+             [&connection, &cookie](auto& event) {
+                 event.add("bucket", connection.getBucket().name);
+                 event.add("key", cookie.getPrintableRequestKey());
+             });
 }
 
 } // namespace cb::audit::document
@@ -64,19 +64,25 @@ std::array<bool, 0x100>&  topkey_commands = get_mcbp_topkeys();
  * Triggers topkeys_update (i.e., increments topkeys stats) if called by a
  * valid operation.
  */
-void update_topkeys(const Cookie& cookie) {
+void update_topkeys(const Cookie& cookie, size_t responseBytes) {
     const auto opcode = cookie.getHeader().getOpcode();
     if (topkey_commands[opcode]) {
         auto& bucket = cookie.getConnection().getBucket();
-        const auto key = cookie.getRequestKey();
-        // MB-32828: ChesireCat will deprecate top-keys and until removal
-        // only the default collection will be tracked
-        if (bucket.topkeys && key.isInDefaultCollection()) {
-            // Update top-keys using the un-prefixed key (logical key)
-            const auto defaultKey = key.makeDocKeyWithoutCollectionID();
-            bucket.topkeys->updateKey(defaultKey.data(),
-                                      defaultKey.size(),
-                                      mc_time_get_current_time());
+        if (bucket.topkeys) {
+            const auto& request = cookie.getRequest();
+            const auto key = cookie.getRequestKey();
+            // MB-32828: ChesireCat will deprecate top-keys and until removal
+            // only keys in the default collection are tracked individually;
+            // other collections are only tracked as a whole (TopKeys ignores
+            // the key). Update top-keys using the un-prefixed key (logical
+            // key)
+            const auto logicalKey = key.makeDocKeyWithoutCollectionID();
+            bucket.topkeys->updateKey(logicalKey.data(),
+                                      logicalKey.size(),
+                                      mc_time_get_current_time(),
+                                      request.getValue().size() + responseBytes,
+                                      key.getCollectionID(),
+                                      request.getVBucket());
         }
     }
 }
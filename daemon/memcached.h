@@ -82,8 +82,11 @@ bool is_memcached_shutting_down();
 /**
  * Increments topkeys count for the key specified within the command context
  * provided by the cookie.
+ *
+ * @param responseBytes number of value bytes returned to the client (the
+ *        value bytes of the request are accounted automatically)
  */
-void update_topkeys(const Cookie& cookie);
+void update_topkeys(const Cookie& cookie, size_t responseBytes = 0);
 
 SERVER_HANDLE_V1* get_server_api();
 
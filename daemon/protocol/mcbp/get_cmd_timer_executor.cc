@@ -64,7 +64,7 @@ static std::pair<ENGINE_ERROR_CODE, Hdr1sfMicroSecHistogram> get_timings(
         }
     }
 
-    auto* histo = bucket.timings.get_timing_histogram(opcode);
+    auto histo = bucket.timings.get_timing_histogram(opcode);
     if (histo) {
         return {ENGINE_SUCCESS, *histo};
     } else {
@@ -122,7 +122,7 @@ ENGINE_ERROR_CODE GetCommandContext::sendResponse() {
     cb::audit::document::add(cookie, cb::audit::document::Operation::Read);
 
     STATS_HIT(&connection, get);
-    update_topkeys(cookie);
+    update_topkeys(cookie, payload.size());
 
     state = State::Done;
     return ENGINE_SUCCESS;
@@ -530,6 +530,29 @@ static ENGINE_ERROR_CODE stat_responses_json_executor(const std::string& arg,
     }
 }
 
+/**
+ * Handler for the <code>stats slow_ops</code> command used to retrieve
+ * a JSON document containing the slowest operations of the recent
+ * intervals in the attached bucket.
+ *
+ * @param arg - should be empty
+ * @param cookie the command context
+ */
+static ENGINE_ERROR_CODE stat_slow_ops_executor(const std::string& arg,
+                                                Cookie& cookie) {
+    if (!arg.empty()) {
+        return ENGINE_EINVAL;
+    }
+
+    try {
+        auto& bucket = cookie.getConnection().getBucket();
+        append_stats("slow_ops"sv, bucket.slowOps.to_json().dump(), &cookie);
+        return ENGINE_SUCCESS;
+    } catch (const std::bad_alloc&) {
+        return ENGINE_ENOMEM;
+    }
+}
+
 static ENGINE_ERROR_CODE stat_tracing_executor(const std::string& arg,
                                                Cookie& cookie) {
     class MemcachedCallback : public phosphor::StatsCallback {
@@ -590,6 +613,80 @@ static ENGINE_ERROR_CODE stat_bucket_stats(const std::string& arg,
     return bucket_get_stats(cookie, arg, value, appendStatsFn);
 }
 
+/**
+ * The bucket stat groups which may produce a lot of stats (for every
+ * vbucket, DCP connection or item in a vbucket), so are collected by a
+ * StatsTaskBucketStats rather than on the front-end thread.
+ */
+static bool isStreamedStatGroup(std::string_view group) {
+    return group == "vbucket-details"sv || group == "dcp"sv ||
+           group == "_hash-dump"sv || group == "_checkpoint-dump"sv;
+}
+
+/// Get the name of the stat group the stat key is for
+static std::string_view getStatGroup(std::string_view key) {
+    return key.substr(0, key.find(' '));
+}
+
+static ENGINE_ERROR_CODE stat_bucket_stats_task(const std::string& arg,
+                                                Cookie& cookie) {
+    auto& connection = cookie.getConnection();
+    size_t sizeHint = 0;
+    connection.getBucket().statGroupCosts.withLock([&arg, &sizeHint](
+                                                           auto& costs) {
+        auto iter = costs.find(std::string{getStatGroup(arg)});
+        if (iter != costs.end()) {
+            sizeHint = iter->second.size;
+        }
+    });
+
+    const auto value = cookie.getRequest().getValue();
+    std::shared_ptr<Task> task = std::make_shared<StatsTaskBucketStats>(
+            connection,
+            cookie,
+            arg,
+            std::string{reinterpret_cast<const char*>(value.data()),
+                        value.size()},
+            sizeHint);
+    cookie.obtainContext<StatsCommandContext>(cookie).setTask(task);
+    std::lock_guard<std::mutex> guard(task->getMutex());
+    executorPool->schedule(task, true);
+
+    return ENGINE_EWOULDBLOCK;
+}
+
+/**
+ * Handler for the <code>stats stat_costs</code> command used to retrieve
+ * a JSON document containing the cost of producing each of the stat groups
+ * requested for the attached bucket.
+ *
+ * @param arg - should be empty
+ * @param cookie the command context
+ */
+static ENGINE_ERROR_CODE stat_costs_executor(const std::string& arg,
+                                             Cookie& cookie) {
+    if (!arg.empty()) {
+        return ENGINE_EINVAL;
+    }
+
+    try {
+        nlohmann::json json = nlohmann::json::object();
+        cookie.getConnection().getBucket().statGroupCosts.withLock(
+                [&json](auto& costs) {
+                    for (const auto& [group, cost] : costs) {
+                        json[group] = {{"count", cost.count},
+                                       {"total_us", cost.total.count()},
+                                       {"max_us", cost.max.count()},
+                                       {"size", cost.size}};
+                    }
+                });
+        append_stats("stat_costs"sv, json.dump(), &cookie);
+        return ENGINE_SUCCESS;
+    } catch (const std::bad_alloc&) {
+        return ENGINE_ENOMEM;
+    }
+}
+
 // handler for scopes/collections - engine needs the key for processing
 static ENGINE_ERROR_CODE stat_bucket_collections_stats(const std::string&,
                                                        Cookie& cookie) {
@@ -685,6 +782,8 @@ static std::unordered_map<std::string, struct command_stat_handler>
                  {false, true, true, stat_subdoc_execute_executor}},
                 {"responses",
                  {false, true, true, stat_responses_json_executor}},
+                {"slow_ops", {true, true, true, stat_slow_ops_executor}},
+                {"stat_costs", {true, true, true, stat_costs_executor}},
                 {"tracing", {true, false, true, stat_tracing_executor}},
                 {"allocator", {true, false, true, stat_allocator_executor}},
                 {"scopes", {false, true, false, stat_bucket_collections_stats}},
@@ -705,6 +804,12 @@ static std::pair<command_stat_handler, bool> getStatHandler(
         const std::string& key) {
     auto iter = stat_handlers.find(key);
     if (iter == stat_handlers.end()) {
+        if (isStreamedStatGroup(key)) {
+            return std::make_pair(
+                    command_stat_handler{
+                            false, true, true, stat_bucket_stats_task},
+                    false);
+        }
         return std::make_pair(
                 command_stat_handler{false, true, true, stat_bucket_stats},
                 false);
@@ -802,6 +907,7 @@ ENGINE_ERROR_CODE StatsCommandContext::checkPrivilege() {
 ENGINE_ERROR_CODE StatsCommandContext::doStats() {
     auto handler_pair = getStatHandler(command);
 
+    const auto start = std::chrono::steady_clock::now();
     if (!handler_pair.second) {
         const auto key = cookie.getRequest().getKey();
         command_exit_code = handler_pair.first.handler(
@@ -819,6 +925,9 @@ ENGINE_ERROR_CODE StatsCommandContext::doStats() {
         return ENGINE_EWOULDBLOCK;
     }
 
+    if (command_exit_code == ENGINE_SUCCESS) {
+        recordCost(std::chrono::steady_clock::now() - start, 0);
+    }
     state = State::CommandComplete;
     return ENGINE_SUCCESS;
 }
@@ -826,16 +935,45 @@ ENGINE_ERROR_CODE StatsCommandContext::doStats() {
 ENGINE_ERROR_CODE StatsCommandContext::getTaskResult() {
     auto& stats_task = dynamic_cast<StatsTask&>(*task);
 
+    // The engine may notify the cookie before the executor is done with
+    // the task (if it would block), so wait for it to complete
+    {
+        std::lock_guard<std::mutex> guard(stats_task.getMutex());
+        command_exit_code = stats_task.getCommandError();
+    }
+    if (command_exit_code == ENGINE_EWOULDBLOCK) {
+        // The engine notified the cookie, so retry the stats
+        task.reset();
+        state = State::DoStats;
+        return ENGINE_SUCCESS;
+    }
+
     state = State::CommandComplete;
-    command_exit_code = stats_task.getCommandError();
     if (command_exit_code == ENGINE_SUCCESS) {
-        for (const auto& s : stats_task.getStats()) {
-            append_stats(s.first, s.second, static_cast<const void*>(&cookie));
-        }
+        // The stats are already encoded as the response packets
+        const auto stats = stats_task.getStats();
+        connection.copyToOutputStream(stats);
+        recordCost(stats_task.getRuntime(), stats.size());
     }
     return ENGINE_SUCCESS;
 }
 
+void StatsCommandContext::recordCost(std::chrono::steady_clock::duration cost,
+                                     size_t size) {
+    const auto micros =
+            std::chrono::duration_cast<std::chrono::microseconds>(cost);
+    connection.getBucket().statGroupCosts.withLock(
+            [this, micros, size](auto& costs) {
+                auto& entry = costs[command.empty() ? "default" : command];
+                ++entry.count;
+                entry.total += micros;
+                entry.max = std::max(entry.max, micros);
+                if (size != 0) {
+                    entry.size = size;
+                }
+            });
+}
+
 ENGINE_ERROR_CODE StatsCommandContext::commandComplete() {
     switch (command_exit_code) {
     case ENGINE_SUCCESS:
@@ -19,6 +19,7 @@
 #include "steppable_command_context.h"
 
 #include <daemon/cookie.h>
+#include <chrono>
 class Task;
 
 /**
@@ -70,6 +71,14 @@ protected:
 
     ENGINE_ERROR_CODE commandComplete();
 
+    /**
+     * Record the cost of producing the stats for the command
+     *
+     * @param cost the time spent producing the stats
+     * @param size the size of the stats (if known)
+     */
+    void recordCost(std::chrono::steady_clock::duration cost, size_t size);
+
 private:
 
     /**
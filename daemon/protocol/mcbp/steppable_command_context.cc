@@ -62,7 +62,18 @@ void SteppableCommandContext::setDatatypeJSONFromValue(
         protocol_binary_datatype_t& datatype) {
     // Determine if document is JSON or not. We do not trust what the client
     // sent - instead we check for ourselves.
-    if (connection.getThread().validator.validate(value.data(), value.size())) {
+    const bool tracing = cookie.isTracingEnabled();
+    cb::tracing::SpanId spanId = 0;
+    if (tracing) {
+        spanId = cookie.getTracer().begin(cb::tracing::Code::JsonValidate);
+    }
+    const bool json =
+            connection.getThread().validator.validate(value.data(), value.size());
+    if (tracing) {
+        cookie.getTracer().end(spanId);
+    }
+
+    if (json) {
         datatype |= PROTOCOL_BINARY_DATATYPE_JSON;
     } else {
         datatype &= ~PROTOCOL_BINARY_DATATYPE_JSON;
@@ -0,0 +1,123 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#include "slow_op_recorder.h"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+
+static bool slower(const SlowOpRecorder::Operation& a,
+                   const SlowOpRecorder::Operation& b) {
+    return a.duration > b.duration;
+}
+
+bool SlowOpRecorder::record(Operation operation) {
+    if (operation.spans.size() > MaxSpans) {
+        operation.spans.resize(MaxSpans);
+    }
+
+    std::lock_guard<std::mutex> guard(mutex);
+    auto& ops = intervals[current];
+    if (ops.size() < OpsPerInterval) {
+        ops.push_back(std::move(operation));
+    } else {
+        // Replace the fastest operation
+        auto fastest = std::max_element(ops.begin(), ops.end(), slower);
+        if (operation.duration <= fastest->duration) {
+            // Another operation raised the threshold in the meantime
+            return false;
+        }
+        *fastest = std::move(operation);
+    }
+
+    if (ops.size() == OpsPerInterval) {
+        const auto fastest = std::max_element(ops.begin(), ops.end(), slower);
+        threshold.store(fastest->duration.count() + 1,
+                        std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void SlowOpRecorder::sample(std::chrono::seconds elapsed) {
+    std::lock_guard<std::mutex> guard(mutex);
+    currentDuration += elapsed;
+    if (currentDuration < IntervalDuration) {
+        return;
+    }
+    currentDuration = {};
+    current = (current + 1) % Intervals;
+    intervals[current].clear();
+    threshold.store(0, std::memory_order_relaxed);
+}
+
+void SlowOpRecorder::reset() {
+    std::lock_guard<std::mutex> guard(mutex);
+    for (auto& ops : intervals) {
+        ops.clear();
+    }
+    currentDuration = {};
+    threshold.store(0, std::memory_order_relaxed);
+}
+
+static nlohmann::json to_json(const SlowOpRecorder::Operation& op) {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    nlohmann::json ret;
+    try {
+        ret["opcode"] = to_string(op.opcode);
+    } catch (const std::exception&) {
+        ret["opcode"] = uint8_t(op.opcode);
+    }
+    ret["duration_us"] = duration_cast<microseconds>(op.duration).count();
+    ret["completed_us"] =
+            duration_cast<microseconds>(op.completed.time_since_epoch())
+                    .count();
+    ret["opaque"] = op.opaque;
+    ret["key_hash"] = op.keyHash;
+    ret["cid"] = op.collection.to_string();
+    ret["connection_id"] = op.connectionId;
+    ret["peer"] = op.peer;
+
+    auto spans = nlohmann::json::array();
+    for (const auto& span : op.spans) {
+        nlohmann::json entry;
+        entry["code"] = to_string(span.code);
+        entry["offset_us"] =
+                duration_cast<microseconds>(span.start - op.start).count();
+        if (span.duration != cb::tracing::Span::Duration::max()) {
+            entry["duration_us"] = span.duration.count();
+        }
+        spans.push_back(std::move(entry));
+    }
+    ret["spans"] = std::move(spans);
+    return ret;
+}
+
+nlohmann::json SlowOpRecorder::to_json() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto ret = nlohmann::json::array();
+    for (size_t ii = 0; ii < Intervals; ++ii) {
+        auto ops = intervals[(current + Intervals - ii) % Intervals];
+        std::sort(ops.begin(), ops.end(), slower);
+        auto interval = nlohmann::json::array();
+        for (const auto& op : ops) {
+            interval.push_back(::to_json(op));
+        }
+        ret.push_back(std::move(interval));
+    }
+    return ret;
+}
@@ -0,0 +1,119 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include <mcbp/protocol/opcode.h>
+#include <memcached/dockey.h>
+#include <memcached/tracer.h>
+#include <nlohmann/json_fwd.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Records the slowest operations of a bucket over each of the last few
+ * intervals (with the breakdown of where the time was spent), so tail
+ * latency can be diagnosed after the fact without enabling verbose tracing
+ * or waiting for the operations to cross the "slow operation" threshold.
+ *
+ * The recorder is always on; an operation is only considered if it is
+ * slower than the fastest operation recorded in the current interval (once
+ * that is full), which is a single relaxed load for the vast majority of
+ * operations. The memory used is bounded by the number of intervals kept
+ * and operations per interval.
+ */
+class SlowOpRecorder {
+public:
+    /// The number of operations recorded per interval
+    static constexpr size_t OpsPerInterval = 10;
+    /// The number of intervals kept (including the current)
+    static constexpr size_t Intervals = 6;
+    /// The length of an interval
+    static constexpr std::chrono::seconds IntervalDuration{10};
+    /// The maximum number of spans kept for an operation
+    static constexpr size_t MaxSpans = cb::tracing::Tracer::InlineSpans;
+
+    struct Operation {
+        /// When the operation started / completed
+        std::chrono::steady_clock::time_point start;
+        std::chrono::system_clock::time_point completed;
+        std::chrono::nanoseconds duration;
+        cb::mcbp::ClientOpcode opcode;
+        uint32_t opaque = 0;
+        /// A hash of the key (rather than the key, which is user data)
+        uint64_t keyHash = 0;
+        CollectionID collection;
+        /// The identity of the connection
+        uint32_t connectionId = 0;
+        std::string peer;
+        /// The tracing spans of the operation (when tracing was enabled)
+        std::vector<cb::tracing::Span> spans;
+    };
+
+    SlowOpRecorder() = default;
+    SlowOpRecorder(const SlowOpRecorder&) = delete;
+
+    /**
+     * Could an operation of the given duration be recorded? Cheap enough to
+     * be called for every operation, and only if it returns true should the
+     * Operation be built and passed to record().
+     */
+    bool isCandidate(std::chrono::nanoseconds duration) const {
+        return duration.count() >= threshold.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Record the operation if it is one of the slowest of the current
+     * interval.
+     *
+     * @return true if the operation was recorded
+     */
+    bool record(Operation operation);
+
+    /**
+     * Move on to a new interval once the current has lasted long enough.
+     * Called periodically (with the time since the last call).
+     */
+    void sample(std::chrono::seconds elapsed);
+
+    /// Drop everything recorded
+    void reset();
+
+    /**
+     * Get the recorded operations; an array of the intervals (newest
+     * first) each holding its operations (slowest first).
+     */
+    nlohmann::json to_json() const;
+
+protected:
+    mutable std::mutex mutex;
+
+    /// The operations of each interval, indexed from current
+    std::array<std::vector<Operation>, Intervals> intervals;
+    size_t current = 0;
+
+    /// The time spent in the current interval
+    std::chrono::seconds currentDuration{0};
+
+    /// The duration (in ns) an operation must reach to be recorded; the
+    /// fastest operation recorded in the current interval once it is full
+    std::atomic<int64_t> threshold{0};
+};
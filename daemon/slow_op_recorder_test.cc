@@ -0,0 +1,174 @@
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "slow_op_recorder.h"
+
+#include <folly/portability/GTest.h>
+#include <nlohmann/json.hpp>
+
+class SlowOpRecorderTest : public ::testing::Test {
+protected:
+    /// Record an operation taking the given number of microseconds
+    bool record(int micros) {
+        const std::chrono::microseconds duration{micros};
+        if (!recorder.isCandidate(duration)) {
+            return false;
+        }
+        SlowOpRecorder::Operation op;
+        op.start = start;
+        op.duration = duration;
+        op.opcode = cb::mcbp::ClientOpcode::Get;
+        op.opaque = micros;
+        op.spans.emplace_back(cb::tracing::Code::Request,
+                              start,
+                              std::chrono::duration_cast<
+                                      cb::tracing::Span::Duration>(duration));
+        return recorder.record(std::move(op));
+    }
+
+    /// Get the durations of the operations recorded in each interval
+    std::vector<std::vector<int>> getDurations() {
+        std::vector<std::vector<int>> ret;
+        for (const auto& interval : recorder.to_json()) {
+            ret.emplace_back();
+            for (const auto& op : interval) {
+                ret.back().push_back(op["duration_us"].get<int>());
+            }
+        }
+        return ret;
+    }
+
+    SlowOpRecorder recorder;
+    const std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
+};
+
+TEST_F(SlowOpRecorderTest, KeepsSlowest) {
+    const int count = SlowOpRecorder::OpsPerInterval * 3;
+    for (int ii = 1; ii <= count; ++ii) {
+        EXPECT_TRUE(record(ii));
+    }
+
+    // The interval is full, so anything faster isn't a candidate
+    EXPECT_FALSE(record(count - SlowOpRecorder::OpsPerInterval));
+    EXPECT_FALSE(record(1));
+    EXPECT_TRUE(record(count + 1));
+
+    const auto durations = getDurations();
+    ASSERT_EQ(SlowOpRecorder::Intervals, durations.size());
+    std::vector<int> expected;
+    for (size_t ii = 0; ii < SlowOpRecorder::OpsPerInterval; ++ii) {
+        expected.push_back(count + 1 - int(ii));
+    }
+    EXPECT_EQ(expected, durations[0]);
+    for (size_t ii = 1; ii < durations.size(); ++ii) {
+        EXPECT_TRUE(durations[ii].empty());
+    }
+}
+
+TEST_F(SlowOpRecorderTest, Intervals) {
+    for (size_t ii = 0; ii < SlowOpRecorder::OpsPerInterval; ++ii) {
+        EXPECT_TRUE(record(1000));
+    }
+    EXPECT_FALSE(record(10));
+
+    // A new interval starts once the current has lasted long enough, and
+    // accepts any operation
+    recorder.sample(SlowOpRecorder::IntervalDuration / 2);
+    EXPECT_FALSE(record(10));
+    recorder.sample(SlowOpRecorder::IntervalDuration / 2);
+    EXPECT_TRUE(record(10));
+
+    auto durations = getDurations();
+    EXPECT_EQ(std::vector<int>{10}, durations[0]);
+    EXPECT_EQ(SlowOpRecorder::OpsPerInterval, durations[1].size());
+
+    // Only the last Intervals intervals are kept
+    for (size_t ii = 1; ii < SlowOpRecorder::Intervals; ++ii) {
+        recorder.sample(SlowOpRecorder::IntervalDuration);
+    }
+    durations = getDurations();
+    EXPECT_EQ(std::vector<int>{10}, durations.back());
+    for (size_t ii = 0; ii < durations.size() - 1; ++ii) {
+        EXPECT_TRUE(durations[ii].empty());
+    }
+
+    recorder.reset();
+    for (const auto& interval : getDurations()) {
+        EXPECT_TRUE(interval.empty());
+    }
+}
+
+TEST_F(SlowOpRecorderTest, Operation) {
+    SlowOpRecorder::Operation op;
+    op.start = start;
+    op.duration = std::chrono::microseconds(500);
+    op.opcode = cb::mcbp::ClientOpcode::Set;
+    op.opaque = 0xdeadbeef;
+    op.keyHash = 1234;
+    op.collection = CollectionID(8);
+    op.connectionId = 5;
+    op.peer = "127.0.0.1:1234";
+    op.spans.emplace_back(cb::tracing::Code::Request,
+                          start,
+                          std::chrono::microseconds(500));
+    for (size_t ii = 0; ii < SlowOpRecorder::MaxSpans; ++ii) {
+        op.spans.emplace_back(cb::tracing::Code::JsonValidate,
+                              start + std::chrono::microseconds(100));
+    }
+    ASSERT_TRUE(recorder.record(op));
+
+    const auto json = recorder.to_json()[0][0];
+    EXPECT_EQ(to_string(cb::mcbp::ClientOpcode::Set), json["opcode"]);
+    EXPECT_EQ(500, json["duration_us"]);
+    EXPECT_EQ(0xdeadbeef, json["opaque"]);
+    EXPECT_EQ(1234, json["key_hash"]);
+    EXPECT_EQ("0x8", json["cid"]);
+    EXPECT_EQ(5, json["connection_id"]);
+    EXPECT_EQ("127.0.0.1:1234", json["peer"]);
+
+    // The spans are limited, and relative to the start of the operation
+    const auto& spans = json["spans"];
+    ASSERT_EQ(SlowOpRecorder::MaxSpans, spans.size());
+    EXPECT_EQ("request", spans[0]["code"]);
+    EXPECT_EQ(0, spans[0]["offset_us"]);
+    EXPECT_EQ(500, spans[0]["duration_us"]);
+    EXPECT_EQ("json.validate", spans[1]["code"]);
+    EXPECT_EQ(100, spans[1]["offset_us"]);
+    // The span wasn't closed
+    EXPECT_EQ(spans[1].end(), spans[1].find("duration_us"));
+}
+
+// A mutation delayed by the bucket's throttle shows where its time went
+TEST_F(SlowOpRecorderTest, ThrottledSpan) {
+    SlowOpRecorder::Operation op;
+    op.start = start;
+    op.duration = std::chrono::microseconds(2000);
+    op.opcode = cb::mcbp::ClientOpcode::Set;
+    op.spans.emplace_back(cb::tracing::Code::Request,
+                          start,
+                          std::chrono::microseconds(2000));
+    op.spans.emplace_back(cb::tracing::Code::Throttled,
+                          start + std::chrono::microseconds(10),
+                          std::chrono::microseconds(1500));
+    ASSERT_TRUE(recorder.record(op));
+
+    const auto spans = recorder.to_json()[0][0]["spans"];
+    ASSERT_EQ(2, spans.size());
+    EXPECT_EQ("throttled", spans[1]["code"]);
+    EXPECT_EQ(10, spans[1]["offset_us"]);
+    EXPECT_EQ(1500, spans[1]["duration_us"]);
+}
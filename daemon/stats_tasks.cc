@@ -19,7 +19,10 @@
 #include "connection.h"
 #include "cookie.h"
 #include "memcached.h"
+#include "protocol/mcbp/engine_wrapper.h"
 #include <logger/logger.h>
+#include <mcbp/protocol/header.h>
+#include <mcbp/protocol/response.h>
 #include <nlohmann/json.hpp>
 
 StatsTaskConnectionStats::StatsTaskConnectionStats(Connection& connection_,
@@ -38,11 +41,11 @@ Task::Status StatsTaskConnectionStats::execute() {
     // thread.
     // No one is using this task so we can safely release the lock
     getMutex().unlock();
+    const auto start = std::chrono::steady_clock::now();
     try {
         iterate_all_connections([this](Connection& c) -> void {
             if (fd == -1 || c.getId() == fd) {
-                stats.emplace_back(std::make_pair<std::string, std::string>(
-                        {}, c.toJSON().dump()));
+                addStat({}, c.toJSON().dump());
             }
         });
     } catch (const std::exception& exception) {
@@ -54,15 +57,70 @@ Task::Status StatsTaskConnectionStats::execute() {
         cookie.setErrorContext("An exception occurred");
         command_error = ENGINE_FAILED;
     }
+    runtime = std::chrono::steady_clock::now() - start;
     getMutex().lock();
 
     return Task::Status::Finished;
 }
 
+StatsTaskBucketStats::StatsTaskBucketStats(Connection& connection_,
+                                           Cookie& cookie_,
+                                           std::string key_,
+                                           std::string value_,
+                                           size_t sizeHint)
+    : StatsTask(connection_, cookie_),
+      key(std::move(key_)),
+      value(std::move(value_)) {
+    stats.reserve(sizeHint + sizeHint / 8);
+}
+
+Task::Status StatsTaskBucketStats::execute() {
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        command_error = bucket_get_stats(
+                cookie,
+                key,
+                {reinterpret_cast<const uint8_t*>(value.data()), value.size()},
+                [this](std::string_view k,
+                       std::string_view v,
+                       gsl::not_null<const void*>) { addStat(k, v); });
+    } catch (const std::bad_alloc&) {
+        command_error = ENGINE_ENOMEM;
+    }
+    runtime = std::chrono::steady_clock::now() - start;
+    return Task::Status::Finished;
+}
+
+void StatsTaskBucketStats::notifyExecutionComplete() {
+    // If the engine blocked it notifies the cookie once it may be retried
+    if (command_error != ENGINE_EWOULDBLOCK) {
+        StatsTask::notifyExecutionComplete();
+    }
+}
+
 StatsTask::StatsTask(Connection& connection_, Cookie& cookie_)
-    : connection(connection_), cookie(cookie_), command_error(ENGINE_SUCCESS) {
+    : connection(connection_),
+      cookie(cookie_),
+      command_error(ENGINE_SUCCESS),
+      opaque(cookie_.getHeader().getOpaque()) {
 }
 
 void StatsTask::notifyExecutionComplete() {
     notify_io_complete(static_cast<void*>(&cookie), ENGINE_SUCCESS);
 }
+
+void StatsTask::addStat(std::string_view key, std::string_view value) {
+    cb::mcbp::Response header = {};
+    header.setMagic(cb::mcbp::Magic::ClientResponse);
+    header.setOpcode(cb::mcbp::ClientOpcode::Stat);
+    header.setDatatype(cb::mcbp::Datatype::Raw);
+    header.setStatus(cb::mcbp::Status::Success);
+    header.setFramingExtraslen(0);
+    header.setExtlen(0);
+    header.setKeylen(key.size());
+    header.setBodylen(key.size() + value.size());
+    header.setOpaque(opaque);
+    stats.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    stats.append(key);
+    stats.append(value);
+}
@@ -20,6 +20,10 @@
 #include <memcached/engine_common.h>
 #include <memcached/engine_error.h>
 
+#include <chrono>
+#include <string>
+#include <string_view>
+
 class Connection;
 
 class Cookie;
@@ -42,16 +46,28 @@ public:
         return command_error;
     }
 
-    /// get all of the stats pairs produced by the task
-    const std::vector<std::pair<std::string, std::string>>& getStats() const {
+    /// get all of the stats produced by the task, already encoded as the
+    /// Stat response packets to send to the client
+    std::string_view getStats() const {
         return stats;
     }
 
+    /// get the time spent producing the stats
+    std::chrono::steady_clock::duration getRuntime() const {
+        return runtime;
+    }
+
 protected:
+    /// Add a stat to the result (encoding it as a Stat response packet)
+    void addStat(std::string_view key, std::string_view value);
+
     Connection& connection;
     Cookie& cookie;
     ENGINE_ERROR_CODE command_error;
-    std::vector<std::pair<std::string, std::string>> stats;
+    /// The opaque of the request (in network byte order)
+    const uint32_t opaque;
+    std::string stats;
+    std::chrono::steady_clock::duration runtime{};
 };
 
 class StatsTaskConnectionStats : public StatsTask {
@@ -69,3 +85,36 @@ public:
 protected:
     const int64_t fd;
 };
+
+/**
+ * Task to collect a group of bucket stats from the engine on the executor
+ * rather than the front-end thread, used for the groups which produce a lot
+ * of stats (as collecting and sending them would otherwise stall the other
+ * connections served by the front-end thread).
+ */
+class StatsTaskBucketStats : public StatsTask {
+public:
+    StatsTaskBucketStats() = delete;
+
+    StatsTaskBucketStats(const StatsTaskBucketStats&) = delete;
+
+    /**
+     * @param key_ the stat key (group and arguments) to request
+     * @param value_ the value of the stat request
+     * @param sizeHint the expected size of the stats (used to size the
+     *                 buffer up front)
+     */
+    StatsTaskBucketStats(Connection& connection_,
+                         Cookie& cookie_,
+                         std::string key_,
+                         std::string value_,
+                         size_t sizeHint);
+
+    Status execute() override;
+
+    void notifyExecutionComplete() override;
+
+protected:
+    const std::string key;
+    const std::string value;
+};
@@ -26,6 +26,7 @@
 #include "settings.h"
 #include "subdoc/util.h"
 #include "subdocument_context.h"
+#include "subdocument_index.h"
 #include "subdocument_parser.h"
 #include "subdocument_traits.h"
 #include "subdocument_validators.h"
@@ -690,6 +691,65 @@ static cb::mcbp::Status subdoc_operate_one_path(
     }
 }
 
+/**
+ * Prepare the front-end thread's document index for the lookups of the
+ * current phase, if they can use it.
+ *
+ * @return the index, or nullptr if the lookups should each use subjson
+ */
+static SubdocDocumentIndex* subdoc_prepare_index(SubdocCmdContext& context,
+                                                 std::string_view doc) {
+    // Only multi-path lookups of the body benefit; a single path is quicker
+    // to find with subjson (which stops parsing once it has been found) and
+    // every mutation changes the document.
+    if (context.getCurrentPhase() != SubdocCmdContext::Phase::Body ||
+        context.traits.path != SubdocPath::MULTI ||
+        context.traits.is_mutator) {
+        return nullptr;
+    }
+
+    // The CAS identifies the version of the document unless it was supplied
+    // by the client for a locked document, in which case it can't be
+    // trusted and the index is rebuilt.
+    const auto& request = context.cookie.getRequest();
+    SubdocDocumentIndex::DocumentId id;
+    if (request.getCas() == 0 && context.in_cas != LOCKED_CAS) {
+        const auto key = request.getKey();
+        id.bucket = context.connection.getBucketIndex();
+        id.vbid = context.vbucket;
+        id.key.assign(reinterpret_cast<const char*>(key.data()), key.size());
+        id.cas = context.in_cas;
+        id.size = doc.size();
+    }
+
+    auto& index = context.connection.getThread().subdoc_index;
+    return index.prepare(id, doc) ? &index : nullptr;
+}
+
+/**
+ * Perform the lookup specified by {spec} using the document index.
+ *
+ * @return the status of the lookup, or an empty optional if it must be
+ *         performed by subjson instead
+ */
+static std::optional<cb::mcbp::Status> subdoc_lookup_indexed(
+        const SubdocDocumentIndex& index,
+        SubdocCmdContext::OperationSpec& spec,
+        std::string_view doc) {
+    if (spec.traits.subdocCommand != Subdoc::Command::GET &&
+        spec.traits.subdocCommand != Subdoc::Command::EXISTS) {
+        return {};
+    }
+
+    Subdoc::Loc loc;
+    const auto status = index.lookup(doc, spec.path, loc);
+    if (status == cb::mcbp::Status::Success &&
+        spec.traits.subdocCommand == Subdoc::Command::GET) {
+        spec.result.set_matchloc(loc);
+    }
+    return status;
+}
+
 /**
  * Perform the wholedoc (mcbp) operation defined by spec
  */
@@ -732,6 +792,10 @@ static cb::mcbp::Status subdoc_operate_wholedoc(
  *                    allocations if we need to change the doc.
  * @param modified set to true upon return if any modifications happened
  *                 to the input document.
+ * @param segments if non-null, and the final operation is a successful
+ *                 path mutation, set to the segments making up the new
+ *                 document instead of copying them to temp_buffer (doc is
+ *                 then left as the input to that operation)
  * @return true if we should continue processing this request,
  *         false if we've sent the error packet and should temrinate
  *               execution for this request
@@ -742,17 +806,28 @@ static bool operate_single_doc(SubdocCmdContext& context,
                                std::string_view& doc,
                                protocol_binary_datatype_t& doc_datatype,
                                std::unique_ptr<char[]>& temp_buffer,
-                               bool& modified) {
+                               bool& modified,
+                               std::vector<std::string_view>* segments) {
     modified = false;
     auto& operations = context.getOperations();
 
+    SubdocDocumentIndex* index = nullptr;
+    if (mcbp::datatype::is_json(doc_datatype)) {
+        index = subdoc_prepare_index(context, doc);
+    }
+
     // 2. Perform each of the operations on document.
     for (auto& op : operations) {
         switch (op.traits.scope) {
         case CommandScope::SubJSON:
             if (mcbp::datatype::is_json(doc_datatype)) {
                 // Got JSON, perform the operation.
-                op.status = subdoc_operate_one_path(context, op, doc);
+                std::optional<cb::mcbp::Status> status;
+                if (index) {
+                    status = subdoc_lookup_indexed(*index, op, doc);
+                }
+                op.status = status ? *status
+                                   : subdoc_operate_one_path(context, op, doc);
             } else {
                 // No good; need to have JSON.
                 op.status = cb::mcbp::Status::SubdocDocNotJson;
@@ -767,6 +842,19 @@ static bool operate_single_doc(SubdocCmdContext& context,
             if (context.traits.is_mutator) {
                 modified = true;
 
+                if (segments && &op == &operations.back() &&
+                    op.traits.scope == CommandScope::SubJSON &&
+                    !op.result.newdoc().empty()) {
+                    // Nothing further will operate on the document, so
+                    // there's no need for a contiguous copy of it; the
+                    // caller splices the segments into the new item.
+                    segments->clear();
+                    for (auto& loc : op.result.newdoc()) {
+                        segments->emplace_back(loc.at, loc.length);
+                    }
+                    continue;
+                }
+
                 // Determine how much space we now need.
                 size_t new_doc_len = 0;
                 for (auto& loc : op.result.newdoc()) {
@@ -799,7 +887,7 @@ static bool operate_single_doc(SubdocCmdContext& context,
                 if (op.traits.scope == CommandScope::WholeDoc) {
                     // the entire document has been replaced as part of a
                     // wholedoc op update the datatype to match
-                    JSON_checker::Validator validator;
+                    auto& validator = context.connection.getThread().validator;
                     bool isValidJson = validator.validate(doc);
 
                     // don't alter context.in_datatype directly here in case we
@@ -1069,7 +1157,8 @@ static bool do_xattr_phase(SubdocCmdContext& context) {
 
     bool modified;
     auto datatype = PROTOCOL_BINARY_DATATYPE_JSON;
-    if (!operate_single_doc(context, document, datatype, temp_doc, modified)) {
+    if (!operate_single_doc(
+                context, document, datatype, temp_doc, modified, nullptr)) {
         // Something failed..
         return false;
     }
@@ -1131,9 +1220,14 @@ static bool do_body_phase(SubdocCmdContext& context) {
 
     std::unique_ptr<char[]> temp_doc;
     bool modified;
-
-    if (!operate_single_doc(
-                context, document, context.in_datatype, temp_doc, modified)) {
+    std::vector<std::string_view> segments;
+
+    if (!operate_single_doc(context,
+                            document,
+                            context.in_datatype,
+                            temp_doc,
+                            modified,
+                            &segments)) {
         return false;
     }
 
@@ -1142,6 +1236,23 @@ static bool do_body_phase(SubdocCmdContext& context) {
         return true;
     }
 
+    if (!segments.empty()) {
+        // The new document is the xattrs (as left by the xattr phase)
+        // followed by the segments of the new body; keep them for
+        // subdoc_update() to copy straight into the new item rather than
+        // building it here.
+        context.intermediate_body.swap(temp_doc);
+        context.out_doc_segments.clear();
+        if (xattrsize != 0) {
+            context.out_doc_segments.emplace_back(context.in_doc.data(),
+                                                  xattrsize);
+        }
+        context.out_doc_segments.insert(context.out_doc_segments.end(),
+                                        segments.begin(),
+                                        segments.end());
+        return true;
+    }
+
     // There isn't any xattrs associated with the document. We shouldn't
     // reallocate and move things around but just reuse the temporary
     // buffer we've already created.
@@ -1230,7 +1341,14 @@ static ENGINE_ERROR_CODE subdoc_update(SubdocCmdContext& context,
         !(context.no_sys_xattrs && context.do_delete_doc)) {
 
         if (ret == ENGINE_SUCCESS) {
-            context.out_doc_len = context.in_doc.size();
+            if (context.out_doc_segments.empty()) {
+                context.out_doc_len = context.in_doc.size();
+            } else {
+                context.out_doc_len = 0;
+                for (const auto& segment : context.out_doc_segments) {
+                    context.out_doc_len += segment.size();
+                }
+            }
             auto allocate_key = cookie.getConnection().makeDocKey(key);
             const size_t priv_bytes =
                 cb::xattr::get_system_xattr_size(context.in_datatype,
@@ -1291,7 +1409,15 @@ static ENGINE_ERROR_CODE subdoc_update(SubdocCmdContext& context,
 
         // Copy the new document into the item.
         char* write_ptr = static_cast<char*>(new_doc_info.value[0].iov_base);
-        std::memcpy(write_ptr, context.in_doc.data(), context.in_doc.size());
+        if (context.out_doc_segments.empty()) {
+            std::memcpy(
+                    write_ptr, context.in_doc.data(), context.in_doc.size());
+        } else {
+            for (const auto& segment : context.out_doc_segments) {
+                std::memcpy(write_ptr, segment.data(), segment.size());
+                write_ptr += segment.size();
+            }
+        }
     }
 
     // And finally, store the new document.
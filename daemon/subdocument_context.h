@@ -169,6 +169,18 @@ public:
     // as input for the next multi-path mutation.
     std::unique_ptr<char[]> temp_doc;
 
+    // [Mutations only] The new document as a sequence of segments, which
+    // subdoc_update() copies directly into the new item. The segments refer
+    // to in_doc (for the xattrs and unchanged parts of the body), to
+    // {intermediate_body} and to the operation results. Empty if the new
+    // document is held in in_doc.
+    std::vector<std::string_view> out_doc_segments;
+
+    // [Mutations only] The body the final path mutation was applied to,
+    // if it isn't part of in_doc (i.e. a multi-path mutation applied
+    // earlier paths to it).
+    std::unique_ptr<char[]> intermediate_body;
+
     // Temporary buffer used to hold the xattrs in use, as a get request
     // may hold pointers into the repacked xattr buckets
     std::unique_ptr<char[]> xattr_buffer;
@@ -0,0 +1,301 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "subdocument_index.h"
+
+#include <cstring>
+#include <limits>
+
+static bool isWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool SubdocDocumentIndex::prepare(const DocumentId& docId,
+                                  std::string_view doc) {
+    if (docId.cas != 0 && docId == id) {
+        return valid;
+    }
+    id = docId;
+    valid = build(doc);
+    return valid;
+}
+
+bool SubdocDocumentIndex::build(std::string_view doc) {
+    nodes.clear();
+    // The open containers; the index of the container and of its last child
+    stack.clear();
+
+    if (doc.size() >= std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+
+    const auto size = uint32_t(doc.size());
+    uint32_t pos = 0;
+    auto skipWhitespace = [&doc, &pos, size]() {
+        while (pos < size && isWhitespace(doc[pos])) {
+            ++pos;
+        }
+    };
+
+    // Scan the string starting at pos, leaving pos after its closing quote.
+    // @return false if the string isn't terminated
+    bool escaped;
+    auto scanString = [&doc, &pos, &escaped, size]() {
+        escaped = false;
+        for (++pos; pos < size; ++pos) {
+            if (doc[pos] == '"') {
+                ++pos;
+                return true;
+            }
+            if (doc[pos] == '\\') {
+                escaped = true;
+                ++pos;
+            }
+        }
+        return false;
+    };
+
+    // Add a node for the value starting at pos, linking it to its parent
+    auto addNode = [this, &pos](uint32_t keyStart,
+                                uint32_t keyLength,
+                                bool keyEscaped) {
+        const auto index = uint32_t(nodes.size());
+        nodes.push_back(
+                {pos, 0, keyStart, keyLength, 0, 0, Type::Primitive, keyEscaped});
+        if (!stack.empty()) {
+            auto& [parent, lastChild] = stack.back();
+            if (lastChild != 0) {
+                nodes[lastChild].next = index;
+            }
+            lastChild = index;
+            ++nodes[parent].size;
+        }
+        return index;
+    };
+
+    skipWhitespace();
+    uint32_t keyStart = 0;
+    uint32_t keyLength = 0;
+    bool keyEscaped = false;
+    while (true) {
+        // Parse a value
+        if (pos == size) {
+            return false;
+        }
+        const auto index = addNode(keyStart, keyLength, keyEscaped);
+        const auto c = doc[pos];
+        bool complete = true;
+        if (c == '{' || c == '[') {
+            if (stack.size() == MaxDepth - 1) {
+                return false;
+            }
+            nodes[index].type = c == '{' ? Type::Object : Type::Array;
+            stack.emplace_back(index, 0);
+            ++pos;
+            skipWhitespace();
+            complete = pos < size && doc[pos] == (c == '{' ? '}' : ']');
+            if (complete) {
+                ++pos;
+                stack.pop_back();
+            }
+        } else if (c == '"') {
+            if (!scanString()) {
+                return false;
+            }
+        } else if (c == ',' || c == ':' || c == '}' || c == ']') {
+            return false;
+        } else {
+            // Number, true, false or null
+            while (pos < size && !isWhitespace(doc[pos]) && doc[pos] != ',' &&
+                   doc[pos] != '}' && doc[pos] != ']') {
+                ++pos;
+            }
+        }
+        if (complete) {
+            nodes[index].end = pos;
+        }
+
+        // Close any finished containers, and move on to the next value
+        skipWhitespace();
+        while (complete && !stack.empty()) {
+            if (pos == size) {
+                return false;
+            }
+            const auto container = stack.back().first;
+            const auto close =
+                    nodes[container].type == Type::Object ? '}' : ']';
+            if (doc[pos] == close) {
+                ++pos;
+                nodes[container].end = pos;
+                stack.pop_back();
+                skipWhitespace();
+            } else if (doc[pos] == ',') {
+                ++pos;
+                skipWhitespace();
+                break;
+            } else {
+                return false;
+            }
+        }
+        if (stack.empty()) {
+            return pos == size;
+        }
+
+        // The next value is within an object (so has a key) or array
+        keyStart = keyLength = 0;
+        keyEscaped = false;
+        if (nodes[stack.back().first].type == Type::Object) {
+            if (pos == size || doc[pos] != '"') {
+                return false;
+            }
+            keyStart = pos + 1;
+            if (!scanString()) {
+                return false;
+            }
+            keyLength = pos - 1 - keyStart;
+            keyEscaped = escaped;
+            skipWhitespace();
+            if (pos == size || doc[pos] != ':') {
+                return false;
+            }
+            ++pos;
+            skipWhitespace();
+        }
+    }
+}
+
+bool SubdocDocumentIndex::parsePath(std::string_view path,
+                                    std::vector<Component>& components) {
+    components.clear();
+    if (path.empty()) {
+        return false;
+    }
+
+    size_t pos = 0;
+    while (pos < path.size()) {
+        if (components.size() == MaxDepth - 1) {
+            return false;
+        }
+        if (path[pos] == '[') {
+            const auto close = path.find(']', pos);
+            if (close == std::string_view::npos) {
+                return false;
+            }
+            const auto digits = path.substr(pos + 1, close - pos - 1);
+            int64_t index = 0;
+            if (digits == "-1") {
+                index = -1;
+            } else if (digits.empty() || digits.size() > 9 ||
+                       (digits[0] == '0' && digits.size() > 1)) {
+                return false;
+            } else {
+                for (const auto c : digits) {
+                    if (!isDigit(c)) {
+                        return false;
+                    }
+                    index = index * 10 + (c - '0');
+                }
+            }
+            components.push_back({{}, index, true});
+            pos = close + 1;
+            if (pos < path.size() && path[pos] != '.' && path[pos] != '[') {
+                return false;
+            }
+        } else {
+            const auto end = path.find_first_of(".[", pos);
+            const auto key = path.substr(pos, end - pos);
+            if (key.empty()) {
+                return false;
+            }
+            for (const auto c : key) {
+                // Escaped components, and those which would need escaping
+                // in the document, are left to subjson.
+                if (c == '`' || c == '\\' || c == '"' || c == ']' ||
+                    uint8_t(c) < 0x20) {
+                    return false;
+                }
+            }
+            components.push_back({key, 0, false});
+            pos = end == std::string_view::npos ? path.size() : end;
+        }
+
+        if (pos < path.size() && path[pos] == '.') {
+            ++pos;
+            if (pos == path.size() || path[pos] == '[') {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::optional<cb::mcbp::Status> SubdocDocumentIndex::lookup(
+        std::string_view doc, std::string_view path, Subdoc::Loc& loc) const {
+    if (!valid || !parsePath(path, components)) {
+        return {};
+    }
+
+    uint32_t current = 0;
+    for (const auto& component : components) {
+        const auto& node = nodes[current];
+        if (component.isIndex) {
+            if (node.type != Type::Array) {
+                return cb::mcbp::Status::SubdocPathMismatch;
+            }
+            if (node.size == 0 || component.index >= node.size) {
+                return cb::mcbp::Status::SubdocPathEnoent;
+            }
+            const auto index =
+                    component.index == -1 ? node.size - 1 : component.index;
+            current = current + 1;
+            for (int64_t ii = 0; ii < index; ++ii) {
+                current = nodes[current].next;
+            }
+        } else {
+            if (node.type != Type::Object) {
+                return cb::mcbp::Status::SubdocPathMismatch;
+            }
+            uint32_t child = node.size == 0 ? 0 : current + 1;
+            for (; child != 0; child = nodes[child].next) {
+                const auto& member = nodes[child];
+                if (member.keyEscaped) {
+                    // Can't compare without unescaping the key
+                    return {};
+                }
+                if (member.keyLength == component.key.size() &&
+                    std::memcmp(doc.data() + member.keyStart,
+                                component.key.data(),
+                                member.keyLength) == 0) {
+                    break;
+                }
+            }
+            if (child == 0) {
+                return cb::mcbp::Status::SubdocPathEnoent;
+            }
+            current = child;
+        }
+    }
+
+    const auto& node = nodes[current];
+    loc.at = doc.data() + node.start;
+    loc.length = node.end - node.start;
+    return cb::mcbp::Status::Success;
+}
@@ -0,0 +1,133 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include <mcbp/protocol/status.h>
+#include <memcached/vbucket.h>
+#include <subdoc/operations.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * A structural index of a JSON document, built in a single pass, which
+ * sub-document lookups can resolve their paths against rather than each
+ * re-parsing the document with subjson.
+ *
+ * The index is an offset table holding a node for every value in the
+ * document in document order; each container's children follow it, linked
+ * together as siblings. As the offsets are relative to the start of the
+ * document the index remains usable for another copy of the same document
+ * version, so one is kept per front-end thread and reused while requests
+ * keep looking up the same item.
+ *
+ * Only the common cases are handled: lookup() returns an empty optional for
+ * anything else (paths with escaped components, keys with escape sequences,
+ * documents nested deeper than subjson allows etc.) and the caller must
+ * fall back to subjson, so the results are always identical to subjson's.
+ */
+class SubdocDocumentIndex {
+public:
+    /// Identifies a version of a document
+    struct DocumentId {
+        int bucket = -1;
+        Vbid vbid;
+        std::string key;
+        uint64_t cas = 0;
+        size_t size = 0;
+
+        bool operator==(const DocumentId& other) const {
+            return bucket == other.bucket && vbid == other.vbid &&
+                   key == other.key && cas == other.cas && size == other.size;
+        }
+    };
+
+    /**
+     * Prepare the index for the given document, building it unless it
+     * already indexes this version of the document.
+     *
+     * @param id the version of the document; a cas of zero means the
+     *           version isn't known and the index is always rebuilt
+     * @param doc the (JSON) document
+     * @return true if the document could be indexed
+     */
+    bool prepare(const DocumentId& id, std::string_view doc);
+
+    /**
+     * Resolve the path of a lookup against the document last passed to
+     * prepare().
+     *
+     * @param doc the document (which must be identical to that indexed)
+     * @param path the path to look up
+     * @param [out] loc the location of the value at the path (on success)
+     * @return the status of the lookup, or an empty optional if the path
+     *         can't be resolved using the index
+     */
+    std::optional<cb::mcbp::Status> lookup(std::string_view doc,
+                                           std::string_view path,
+                                           Subdoc::Loc& loc) const;
+
+    /// The maximum depth of document subjson will parse.
+    static constexpr size_t MaxDepth = 32;
+
+protected:
+    enum class Type : uint8_t { Object, Array, Primitive };
+
+    struct Node {
+        /// Offset of the first byte of the value
+        uint32_t start;
+        /// Offset of the byte following the value
+        uint32_t end;
+        /// [Object members only] Offset and length of the key (without
+        /// the quotes)
+        uint32_t keyStart;
+        uint32_t keyLength;
+        /// Index of the following sibling, or zero if this is the last child
+        uint32_t next;
+        /// [Containers only] The number of children
+        uint32_t size;
+        Type type;
+        /// [Object members only] Does the key contain an escape sequence?
+        bool keyEscaped;
+    };
+
+    /// A component of a path; either an object key or an array index
+    struct Component {
+        std::string_view key;
+        /// The array index, or -1 for the last element
+        int64_t index;
+        bool isIndex;
+    };
+
+    bool build(std::string_view doc);
+
+    /// @return false if the path is invalid or not handled by the index
+    static bool parsePath(std::string_view path,
+                          std::vector<Component>& components);
+
+    DocumentId id;
+    bool valid = false;
+    std::vector<Node> nodes;
+
+    /// Scratch space used whilst building the index / parsing paths
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    mutable std::vector<Component> components;
+};
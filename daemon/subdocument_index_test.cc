@@ -0,0 +1,154 @@
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "subdocument_index.h"
+
+#include <folly/portability/GTest.h>
+
+/**
+ * Checks lookups using the SubdocDocumentIndex give the same results as
+ * subjson.
+ */
+class SubdocDocumentIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ASSERT_TRUE(index.prepare({}, doc));
+    }
+
+    /// Look up the path with subjson
+    std::pair<cb::mcbp::Status, std::string> subjsonLookup(
+            std::string_view path) {
+        Subdoc::Operation op;
+        Subdoc::Result result;
+        op.set_result_buf(&result);
+        op.set_code(Subdoc::Command::GET);
+        op.set_doc(doc.data(), doc.size());
+        op.set_value(nullptr, 0);
+        switch (op.op_exec(path.data(), path.size())) {
+        case Subdoc::Error::SUCCESS: {
+            const auto loc = result.matchloc();
+            return {cb::mcbp::Status::Success, {loc.at, loc.length}};
+        }
+        case Subdoc::Error::PATH_ENOENT:
+            return {cb::mcbp::Status::SubdocPathEnoent, {}};
+        case Subdoc::Error::PATH_MISMATCH:
+            return {cb::mcbp::Status::SubdocPathMismatch, {}};
+        default:
+            return {cb::mcbp::Status::Einval, {}};
+        }
+    }
+
+    /// Look up the path with the index, expecting it to be handled
+    std::pair<cb::mcbp::Status, std::string> indexLookup(
+            std::string_view path) {
+        Subdoc::Loc loc;
+        const auto status = index.lookup(doc, path, loc);
+        EXPECT_TRUE(status) << "path: " << path;
+        if (status == cb::mcbp::Status::Success) {
+            return {*status, {loc.at, loc.length}};
+        }
+        return {status.value_or(cb::mcbp::Status::Einval), {}};
+    }
+
+    const std::string doc = R"({
+        "name": "kv",
+        "ids": [1, 22, 333],
+        "nested": {"array": [{"a": true}, [], {}, null],
+                   "number": -1.5e10,
+                   "dup": 1, "dup": 2,
+                   "escaped\"key": "value with \"quotes\""},
+        "empty": {}
+    })";
+    SubdocDocumentIndex index;
+};
+
+TEST_F(SubdocDocumentIndexTest, SameAsSubjson) {
+    for (const std::string path :
+         {"name",
+          "ids",
+          "ids[0]",
+          "ids[2]",
+          "ids[-1]",
+          "ids[3]",
+          "ids.x",
+          "name.x",
+          "name[0]",
+          "[0]",
+          "missing",
+          "missing.x",
+          "empty",
+          "empty.x",
+          "nested.array[0].a",
+          "nested.array[0].b",
+          "nested.array[1]",
+          "nested.array[1][0]",
+          "nested.array[2]",
+          "nested.array[-1]",
+          "nested.number",
+          "nested.dup"}) {
+        EXPECT_EQ(subjsonLookup(path), indexLookup(path)) << "path: " << path;
+    }
+}
+
+// Paths the index doesn't handle are left to subjson
+TEST_F(SubdocDocumentIndexTest, Unhandled) {
+    Subdoc::Loc loc;
+    for (const std::string path : {"",
+                                   "`name`",
+                                   "name.",
+                                   "nested..number",
+                                   "ids[01]",
+                                   "ids[-2]",
+                                   "ids[x]",
+                                   "ids[0]x",
+                                   "nested.escaped\\\"key",
+                                   // The search passes a key with an escape
+                                   "nested.missing"}) {
+        EXPECT_FALSE(index.lookup(doc, path, loc)) << "path: " << path;
+    }
+}
+
+TEST_F(SubdocDocumentIndexTest, TooDeep) {
+    const std::string deep = std::string(SubdocDocumentIndex::MaxDepth, '[') +
+                             std::string(SubdocDocumentIndex::MaxDepth, ']');
+    EXPECT_FALSE(index.prepare({}, deep));
+    Subdoc::Loc loc;
+    EXPECT_FALSE(index.lookup(deep, "[0]", loc));
+}
+
+// The index is only rebuilt for a different version of the document
+TEST_F(SubdocDocumentIndexTest, Reused) {
+    SubdocDocumentIndex::DocumentId id;
+    id.key = "key";
+    id.cas = 1;
+    id.size = doc.size();
+    ASSERT_TRUE(index.prepare(id, doc));
+
+    // A copy of the same version resolves against the existing index
+    const std::string copy = doc;
+    Subdoc::Loc loc;
+    ASSERT_TRUE(index.prepare(id, R"("not this document")"));
+    EXPECT_EQ(cb::mcbp::Status::Success, index.lookup(copy, "name", loc));
+    EXPECT_EQ(R"("kv")", std::string(loc.at, loc.length));
+
+    // A new version is indexed
+    const std::string updated = R"({"name":"updated"})";
+    id.cas = 2;
+    id.size = updated.size();
+    ASSERT_TRUE(index.prepare(id, updated));
+    EXPECT_EQ(cb::mcbp::Status::Success, index.lookup(updated, "name", loc));
+    EXPECT_EQ(R"("updated")", std::string(loc.at, loc.length));
+}
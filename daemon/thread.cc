@@ -444,13 +444,19 @@ int add_conn_to_pending_io_list(Connection* c,
     auto& thread = c->getThread();
 
     std::lock_guard<std::mutex> lock(thread.pending_io.mutex);
+    // The worker thread drains its notification channel *before* swapping
+    // out the pending_io map, so if the map is already non-empty a wakeup is
+    // still outstanding and will pick up this entry too. Only the first
+    // entry after a swap needs to notify the thread; this coalesces bursts of
+    // notifications (e.g. a batch of completed SyncWrites) into one wakeup.
+    const bool notify = thread.pending_io.map.empty();
     auto iter = thread.pending_io.map.find(c);
     if (iter == thread.pending_io.map.end()) {
         thread.pending_io.map.emplace(
                 c,
                 std::vector<std::pair<Cookie*, ENGINE_ERROR_CODE>>{
                         {cookie, status}});
-        return 1;
+        return notify ? 1 : 0;
     }
 
     for (const auto& pair : iter->second) {
@@ -461,5 +467,5 @@ int add_conn_to_pending_io_list(Connection* c,
         }
     }
     iter->second.emplace_back(cookie, status);
-    return 1;
+    return notify ? 1 : 0;
 }
@@ -22,17 +22,21 @@ Timings::Timings() {
 
 Timings::~Timings() {
     std::lock_guard<std::mutex> lg(histogram_mutex);
-    for (auto& t : timings) {
-        delete t;
+    for (auto& core : timings) {
+        for (auto& t : core) {
+            delete t;
+        }
     }
 }
 
 void Timings::reset() {
     {
         std::lock_guard<std::mutex> lg(histogram_mutex);
-        for (auto& t : timings) {
-            if (t) {
-                t.load()->reset();
+        for (auto& core : timings) {
+            for (auto& t : core) {
+                if (t) {
+                    t.load()->reset();
+                }
             }
         }
     }
@@ -59,9 +63,8 @@ void Timings::collect(cb::mcbp::ClientOpcode opcode,
 }
 
 std::string Timings::generate(cb::mcbp::ClientOpcode opcode) {
-    auto* histoPtr =
-            timings[std::underlying_type<cb::mcbp::ClientOpcode>::type(opcode)]
-                    .load();
+    auto histoPtr = get_timing_histogram(
+            std::underlying_type<cb::mcbp::ClientOpcode>::type(opcode));
     if (histoPtr) {
         return histoPtr->to_string();
     }
@@ -118,12 +121,8 @@ uint64_t Timings::get_aggregated_mutation_stats() {
 
     uint64_t ret = 0;
     for (auto cmd : timings_mutations) {
-        auto* histoPtr =
-                timings[std::underlying_type<cb::mcbp::ClientOpcode>::type(cmd)]
-                        .load();
-        if (histoPtr) {
-            ret += histoPtr->getValueCount();
-        }
+        ret += get_value_count(
+                std::underlying_type<cb::mcbp::ClientOpcode>::type(cmd));
     }
     return ret;
 }
@@ -132,12 +131,8 @@ uint64_t Timings::get_aggregated_retrieval_stats() {
 
     uint64_t ret = 0;
     for (auto cmd : timings_retrievals) {
-        auto* histoPtr =
-                timings[std::underlying_type<cb::mcbp::ClientOpcode>::type(cmd)]
-                        .load();
-        if (histoPtr) {
-            ret += histoPtr->getValueCount();
-        }
+        ret += get_value_count(
+                std::underlying_type<cb::mcbp::ClientOpcode>::type(cmd));
     }
     return ret;
 }
@@ -154,17 +149,45 @@ cb::sampling::Interval Timings::get_interval_lookup_latency() {
 
 Hdr1sfMicroSecHistogram& Timings::get_or_create_timing_histogram(
         uint8_t opcode) {
-    if (!timings[opcode]) {
+    auto& histo = timings.get()[opcode];
+    auto* ptr = histo.load(std::memory_order_acquire);
+    if (!ptr) {
         std::lock_guard<std::mutex> allocLock(histogram_mutex);
-        if (!timings[opcode]) {
-            timings[opcode] = new Hdr1sfMicroSecHistogram();
+        ptr = histo.load();
+        if (!ptr) {
+            ptr = new Hdr1sfMicroSecHistogram();
+            histo.store(ptr, std::memory_order_release);
         }
     }
-    return *(timings[opcode].load());
+    return *ptr;
 }
 
-Hdr1sfMicroSecHistogram* Timings::get_timing_histogram(uint8_t opcode) const {
-    return timings[opcode].load();
+std::unique_ptr<Hdr1sfMicroSecHistogram> Timings::get_timing_histogram(
+        uint8_t opcode) const {
+    std::unique_ptr<Hdr1sfMicroSecHistogram> ret;
+    for (const auto& core : timings) {
+        const auto* histo = core[opcode].load(std::memory_order_acquire);
+        if (!histo) {
+            continue;
+        }
+        if (ret) {
+            *ret += *histo;
+        } else {
+            ret = std::make_unique<Hdr1sfMicroSecHistogram>(*histo);
+        }
+    }
+    return ret;
+}
+
+uint64_t Timings::get_value_count(uint8_t opcode) const {
+    uint64_t ret = 0;
+    for (const auto& core : timings) {
+        const auto* histo = core[opcode].load(std::memory_order_acquire);
+        if (histo) {
+            ret += histo->getValueCount();
+        }
+    }
+    return ret;
 }
 
 void Timings::sample(std::chrono::seconds sample_interval) {
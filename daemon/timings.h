@@ -23,6 +23,7 @@
 #include <platform/corestore.h>
 #include <utilities/hdrhistogram.h>
 #include <array>
+#include <memory>
 #include <mutex>
 #include <string>
 
@@ -48,19 +49,28 @@ public:
     cb::sampling::Interval get_interval_lookup_latency();
 
     /**
-     * Get a pointer to the underlying histogram for the specified opcode
-     * @return a pointer to the underling HdrMicroSecHistogram for this opcode
-     * if there isn't one allocated already a nullptr will be returned.
+     * Get the histogram for the specified opcode, merged from all of the
+     * per-core histograms.
+     * @return a newly allocated HdrMicroSecHistogram for this opcode, or
+     * nullptr if no core has recorded a timing for it yet.
      */
-    Hdr1sfMicroSecHistogram* get_timing_histogram(uint8_t opcode) const;
+    std::unique_ptr<Hdr1sfMicroSecHistogram> get_timing_histogram(
+            uint8_t opcode) const;
 
 private:
+    using HistogramArray =
+            std::array<std::atomic<Hdr1sfMicroSecHistogram*>, MAX_NUM_OPCODES>;
+
     /**
-     * Method to get histogram for timing, if the histogram hasn't been created
-     * yet, for the given opcode then we will allocate one
+     * Method to get the calling core's histogram for timing, if the
+     * histogram hasn't been created yet, for the given opcode then we will
+     * allocate one
      */
     Hdr1sfMicroSecHistogram& get_or_create_timing_histogram(uint8_t opcode);
 
+    /// @return the sum of the value counts of all cores for the opcode
+    uint64_t get_value_count(uint8_t opcode) const;
+
     // This lock is only held by sample() and some blocks within generate().
     // It guards the various IntervalSeries variables which internally
     // contain cb::RingBuffer objects which are not thread safe.
@@ -68,10 +78,13 @@ private:
 
     cb::sampling::IntervalSeries interval_latency_lookups;
     cb::sampling::IntervalSeries interval_latency_mutations;
-    // create an array of unique_ptrs as we want to create HdrHistograms
-    // in a lazy manner as their foot print is larger than our old
-    // histogram class
-    std::array<std::atomic<Hdr1sfMicroSecHistogram*>, MAX_NUM_OPCODES> timings;
+    // Sharded by core so that front-end threads record into their own
+    // histogram instead of bouncing the same buckets between caches. The
+    // histograms are created in a lazy manner (per core and opcode) as their
+    // foot print is larger than our old histogram class, and are only merged
+    // when somebody asks for them.
+    CoreStore<HistogramArray> timings;
+    // Only held when allocating or freeing a histogram, never when recording
     std::mutex histogram_mutex;
 
     // Sharded by core as cache contention was observed due to the number of
@@ -26,8 +26,8 @@
 
 #include <algorithm>
 #include <gsl/gsl>
-#include <set>
 #include <stdexcept>
+#include <thread>
 #include <utility>
 
 /*
@@ -39,13 +39,12 @@
  * shard per (logical) core to:
  *
  * a) prevent any cache contention
- * b) allow as much concurrent access as possible (each shard is guarded by a
- *    mutex)
+ * b) allow as much concurrent access as possible
  *
- * Topkeys passes on requests to the correct Shard (determined by the core id of
- * the calling thread), and when statistics are requested it aggregates
+ * Topkeys passes on requests to a Shard (preferably the one for the core id
+ * of the calling thread), and when statistics are requested it aggregates
  * information from each shard. When aggregating information, the TopKeys class
- * has to remove duplicates from the possible pool of top keys because we shard
+ * has to merge duplicates from the possible pool of top keys because we shard
  * per core for performance. Previously, TopKeys would create 8 shards
  * (regardless of machine size), each with storage for a configurably amount of
  * keys and shard by key hash (which meant that we would not have duplicate keys
@@ -55,51 +54,23 @@
  *
  * === TopKeys::Shard ===
  *
- * This is where the action happens. Each Shard maintains an ordered
- * list of key names and related statistics, orded by when they were
- * last accessed. There is a fixed number of keys each Shard tracks.
-
- * Given we generally track only a small number of keys per shard (10
- * by default), it's highly likely that any one key access will 'miss'
- * - i.e. not find an existing topkey. Therefore this class is
- * optimized for that case, attempting to minimise memory allocation
- * in steady-state.
- *
- * Internally Shard consists of a vector of topkey_t, storing the
- * current max_keys top_keys, and a list of topkey_t pointers, used to
- * main the current most -> least recently used ordering:
-
- * max_keys elements. Each element is a tuple of
- * {hash(key), key, topkey_stats}:
- *
- *
- *       vector<topkey_t>
- *   +----------+-------------+---------------+
- *   | size_t   | std::string | topkey_item_t |
- *   +----------+-------------+---------------+
- *   | <hash 1> | <key 1>     | stats 1       | <--- Node1
- *   | <hash 2> | <key 2>     | stats 2       | <--- Node2
- *   | <hash 3> | <key 3>     | stats 3       | <--- Node3
- *   . ....                                   .
- *   | <hash N> | <key N>     | stats N       | <--- NodeN
- *   +----------------------------------------+
- *
- *   Node3 <---> Node1 <---> ... <---> Node2
- *   ^^^                               ^^^
- *   MRU                               LRU
+ * Each Shard holds three fixed-size Space-Saving summaries, tracking the
+ * most frequently accessed keys, collections and vBuckets (with the number
+ * of accesses and value bytes of each). A Shard is never locked on the
+ * request path: a thread claims a shard by atomically setting its 'busy'
+ * flag, and if the flag was already set (another thread mapped to the same
+ * core, or a stats call is reading the shard) it simply moves on to the next
+ * shard. Only if every shard is busy is the access not recorded.
  *
+ * Given we track only a small number of identifiers per summary, lookups are
+ * a linear scan comparing the (pre-computed) hash of the key, and the victim
+ * for replacement is the entry with the lowest count. Storage is reserved
+ * up-front, so in steady state an update does not allocate (a replaced key
+ * re-uses the string capacity of its victim).
  *
- * Upon a key 'hit', TopKeys::updateKey() is called. That hashes the
- * key, and finds the Shard responsible for that
- * key. TopKeys::Shard::updateKey() is then called.
- *
- * Shard::updateKey() iterates over the vector, searching for a hash
- * match with an existing element, using the actual key string to
- * validate (in case of a hash collision). If it is found, then the
- * stats are simply updated.  If it is not found, then the
- * least-recently-used element is selected as a 'victim' and it's
- * contents is replaced by the incoming key.  Finally the linked-list
- * is updated to move the updated element to the head of the list.
+ * Space-Saving summaries of different shards can be merged by summing the
+ * counts of each identifier; the result still over-estimates (by at most
+ * the summed error) and never misses a true heavy hitter.
  */
 TopKeys::TopKeys(int mkeys)
     : keys_to_return(mkeys * legacy_multiplier), shards(cb::get_cpu_count()) {
@@ -113,9 +84,12 @@ TopKeys::~TopKeys() {
 
 void TopKeys::updateKey(const void* key,
                         size_t nkey,
-                        rel_time_t operation_time) {
+                        rel_time_t operation_time,
+                        size_t nbytes,
+                        CollectionID collection,
+                        Vbid vbid) {
     if (Settings::instance().isTopkeysEnabled()) {
-        doUpdateKey(key, nkey, operation_time);
+        doUpdateKey(key, nkey, operation_time, nbytes, collection, vbid);
     }
 }
 
@@ -138,91 +112,171 @@ ENGINE_ERROR_CODE TopKeys::json_stats(nlohmann::json& object,
     return ENGINE_SUCCESS;
 }
 
-TopKeys::Shard& TopKeys::getShard() {
-    auto stripe =
-            folly::AccessSpreader<std::atomic>::cachedCurrent(shards.size());
-    return *shards[stripe];
+template <typename Id>
+void TopKeys::SpaceSaving<Id>::setCapacity(size_t newCapacity) {
+    capacity = newCapacity;
+    entries.clear();
+    entries.reserve(capacity);
+}
+
+/**
+ * Non-owning reference to a key, used to look up (and, if needed, overwrite)
+ * a KeyId without allocating a std::string for every access.
+ */
+struct KeyRef {
+    size_t hash;
+    std::string_view key;
+};
+
+static bool matches(const TopKeys::KeyId& id, const KeyRef& ref) {
+    return id.hash == ref.hash && id.key == ref.key;
+}
+
+static void assignId(TopKeys::KeyId& id, const KeyRef& ref) {
+    id.hash = ref.hash;
+    // Re-uses the existing string capacity where possible.
+    id.key.assign(ref.key.data(), ref.key.size());
+}
+
+static TopKeys::KeyId makeId(const KeyRef& ref) {
+    return {ref.hash, std::string(ref.key)};
+}
+
+template <typename Id>
+static bool matches(const Id& id, const Id& other) {
+    return id == other;
+}
+
+template <typename Id>
+static void assignId(Id& id, const Id& other) {
+    id = other;
+}
+
+template <typename Id>
+static Id makeId(const Id& id) {
+    return id;
 }
 
-TopKeys::topkey_t* TopKeys::Shard::searchForKey(size_t key_hash,
-                                                std::string_view key) {
-    for (auto& topkey : storage) {
-        if (topkey.first.hash == key_hash) {
-            // Double-check with full compare
-            if (topkey.first.key == key) {
-                // Match found.
-                return &topkey;
-            }
+template <typename Id>
+template <typename Probe>
+void TopKeys::SpaceSaving<Id>::record(const Probe& probe,
+                                      rel_time_t operation_time,
+                                      size_t nbytes) {
+    for (auto& entry : entries) {
+        if (matches(entry.first, probe)) {
+            entry.second.ti_access_count++;
+            entry.second.ti_bytes += nbytes;
+            return;
         }
     }
-    return nullptr;
+
+    if (entries.size() < capacity) {
+        entries.emplace_back(makeId(probe), topkey_item_t(operation_time));
+        entries.back().second.ti_access_count = 1;
+        entries.back().second.ti_bytes = nbytes;
+        return;
+    }
+
+    if (entries.empty()) {
+        return;
+    }
+
+    // Replace the entry with the lowest count; the new entry inherits that
+    // count as its (over-estimated) starting point.
+    auto victim = std::min_element(
+            entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+                return a.second.ti_access_count < b.second.ti_access_count;
+            });
+    const auto minCount = victim->second.ti_access_count;
+    assignId(victim->first, probe);
+    victim->second = topkey_item_t(operation_time);
+    victim->second.ti_access_count = minCount + 1;
+    victim->second.ti_error = minCount;
+    victim->second.ti_bytes = nbytes;
 }
 
-bool TopKeys::Shard::updateKey(std::string_view key,
-                               size_t key_hash,
-                               const rel_time_t ct) {
-    try {
-        std::lock_guard<std::mutex> lock(mutex);
-
-        topkey_t* found_key = searchForKey(key_hash, key);
-
-        if (!found_key) {
-            // Key not found.
-            if (storage.size() == max_keys) {
-                // Re-use the lowest keys' storage.
-                found_key = list.back();
-                found_key->first.hash = key_hash;
-                found_key->first.key = key;
-                found_key->second = topkey_item_t(ct);
-
-                // Move back element to the front, shuffling down the
-                // rest.
-                list.splice(list.begin(), list, --list.end());
-
-            } else {
-                // add a new element to the storage array.
-
-                storage.emplace_back(std::make_pair(
-                        KeyId{key_hash, std::string(key)}, topkey_item_t(ct)));
-                found_key = &storage.back();
-
-                // Insert the new item to the front of the list
-                list.push_front(found_key);
-            }
-        } else {
-            // Found - shuffle to the front.
-            auto it = std::find(list.begin(), list.end(), found_key);
-            list.splice(list.begin(), list, it);
-        }
+void TopKeys::Shard::setMaxKeys(size_t mkeys) {
+    keys.setCapacity(mkeys);
+    collections.setCapacity(mkeys);
+    vbuckets.setCapacity(mkeys);
+}
 
-        // Increment access count.
-        found_key->second.ti_access_count++;
-        return true;
+bool TopKeys::Shard::tryUpdateKey(std::string_view key,
+                                  size_t key_hash,
+                                  const rel_time_t ct,
+                                  size_t nbytes,
+                                  CollectionID collection,
+                                  Vbid vbid) {
+    if (busy.exchange(true, std::memory_order_acquire)) {
+        return false;
+    }
 
+    try {
+        if (!key.empty()) {
+            keys.record(KeyRef{key_hash, key}, ct, nbytes);
+        }
+        collections.record(collection, ct, nbytes);
+        vbuckets.record(vbid, ct, nbytes);
     } catch (const std::bad_alloc&) {
         // Failed to update.
-        return false;
     }
+
+    busy.store(false, std::memory_order_release);
+    return true;
+}
+
+void TopKeys::Shard::snapshot(
+        std::vector<SpaceSaving<KeyId>::Entry>& keysOut,
+        std::vector<SpaceSaving<CollectionID>::Entry>& collOut,
+        std::vector<SpaceSaving<Vbid>::Entry>& vbOut) {
+    while (busy.exchange(true, std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+    auto release = gsl::finally(
+            [this]() { busy.store(false, std::memory_order_release); });
+
+    keysOut.insert(keysOut.end(),
+                   keys.getEntries().begin(),
+                   keys.getEntries().end());
+    collOut.insert(collOut.end(),
+                   collections.getEntries().begin(),
+                   collections.getEntries().end());
+    vbOut.insert(vbOut.end(),
+                 vbuckets.getEntries().begin(),
+                 vbuckets.getEntries().end());
 }
 
 void TopKeys::doUpdateKey(const void* key,
                           size_t nkey,
-                          rel_time_t operation_time) {
+                          rel_time_t operation_time,
+                          size_t nbytes,
+                          CollectionID collection,
+                          Vbid vbid) {
     if (key == nullptr || nkey == 0) {
         throw std::invalid_argument(
                 "TopKeys::doUpdateKey: key must be specified");
     }
 
-    try {
-        // We store a key hash to make lookup of topkeys faster and because the
-        // memory footprint is relatively small.
-        std::string_view key_buf(static_cast<const char*>(key), nkey);
-        std::hash<std::string_view> hash_fn;
-        const size_t key_hash = hash_fn(key_buf);
+    // We store a key hash to make lookup of topkeys faster and because the
+    // memory footprint is relatively small. Keys outside of the default
+    // collection are only accounted to their collection and vBucket.
+    std::string_view key_buf;
+    size_t key_hash = 0;
+    if (collection.isDefaultCollection()) {
+        key_buf = {static_cast<const char*>(key), nkey};
+        key_hash = std::hash<std::string_view>()(key_buf);
+    }
 
-        getShard().updateKey(key_buf, key_hash, operation_time);
-    } catch (const std::bad_alloc&) {
-        // Failed to increment topkeys, continue...
+    // Start with the shard of the current core, and move on if it is in
+    // use by another thread.
+    const auto stripe =
+            folly::AccessSpreader<std::atomic>::cachedCurrent(shards.size());
+    for (size_t ii = 0; ii < shards.size(); ++ii) {
+        auto& shard = *shards[(stripe + ii) % shards.size()];
+        if (shard.tryUpdateKey(
+                    key_buf, key_hash, operation_time, nbytes, collection, vbid)) {
+            return;
+        }
     }
 }
 
@@ -234,12 +288,14 @@ struct tk_context {
                AddStatFn a,
                rel_time_t t,
                nlohmann::json* arr,
-               CallbackFn callbackFn)
+               CallbackFn callbackFn,
+               nlohmann::json* dims = nullptr)
         : cookie(c),
           add_stat(std::move(a)),
           current_time(t),
           array(arr),
-          callbackFunction(callbackFn) {
+          callbackFunction(callbackFn),
+          dimensions(dims) {
         // empty
     }
 
@@ -248,6 +304,9 @@ struct tk_context {
     rel_time_t current_time;
     nlohmann::json* array;
     CallbackFn callbackFunction;
+    /// If non-null, the hot collections and vBuckets are added to this
+    /// object.
+    nlohmann::json* dimensions;
 };
 
 static void tk_iterfunc(const std::string& key,
@@ -262,7 +321,7 @@ static void tk_iterfunc(const std::string& key,
     rel_time_t created_time = c->current_time - it.ti_ctime;
     int vlen = snprintf(val_str,
                         sizeof(val_str) - 1,
-                        "get_hits=%d,"
+                        "get_hits=%" PRIu64 ","
                         "get_misses=0,cmd_set=0,incr_hits=0,incr_misses=0,"
                         "decr_hits=0,decr_misses=0,delete_hits=0,"
                         "delete_misses=0,evictions=0,cas_hits=0,cas_badval=0,"
@@ -283,8 +342,8 @@ static void tk_iterfunc(const std::string& key,
  * {
  *    "key": "somekey",
  *    "access_count": nnn,
- *    "ctime": ccc,
- *    "atime": aaa
+ *    "bytes": bbb,
+ *    "ctime": ccc
  * }
  */
 static void tk_jsonfunc(const std::string& key,
@@ -298,21 +357,46 @@ static void tk_jsonfunc(const std::string& key,
     nlohmann::json obj;
     obj["key"] = key;
     obj["access_count"] = it.ti_access_count;
+    obj["bytes"] = it.ti_bytes;
     obj["ctime"] = c->current_time - it.ti_ctime;
 
     c->array->push_back(obj);
 }
 
-static void tk_aggregate_func(const TopKeys::topkey_t& it, void* arg) {
-    auto* map =
-            static_cast<std::unordered_map<std::string, topkey_item_t>*>(arg);
-
-    auto res = map->insert(std::make_pair(it.first.key, it.second));
-
-    // If insert failed, then we have a duplicate top key. Add the stats
-    if (!res.second) {
-        res.first->second.ti_access_count += it.second.ti_access_count;
+/**
+ * Merge the Space-Saving entries from all shards (summing the stats of
+ * duplicates), and return them sorted by number of accesses.
+ *
+ * @param entries entries of all shards
+ * @param toKey function returning the key to merge an entry's id by
+ */
+template <typename Id, typename ToKey>
+static auto mergeAndSort(const std::vector<std::pair<Id, topkey_item_t>>& entries,
+                         ToKey toKey) {
+    using Key = decltype(toKey(entries.front().first));
+    std::unordered_map<Key, topkey_item_t> map;
+    for (const auto& entry : entries) {
+        auto res = map.insert(std::make_pair(toKey(entry.first), entry.second));
+
+        // If insert failed, then we have a duplicate. Add the stats
+        if (!res.second) {
+            auto& merged = res.first->second;
+            merged.ti_access_count += entry.second.ti_access_count;
+            merged.ti_bytes += entry.second.ti_bytes;
+            merged.ti_error += entry.second.ti_error;
+            merged.ti_ctime = std::min(merged.ti_ctime, entry.second.ti_ctime);
+        }
     }
+
+    // Easiest way to sort this by access_count is to drop the contents of the
+    // map into a vector and sort that.
+    auto items = std::vector<std::pair<Key, topkey_item_t>>(map.begin(),
+                                                            map.end());
+    std::sort(items.begin(), items.end(), [](const auto& a, const auto& b) {
+        // Sort by number of accesses
+        return a.second.ti_access_count > b.second.ti_access_count;
+    });
+    return items;
 }
 
 ENGINE_ERROR_CODE TopKeys::doStats(const void* cookie,
@@ -328,10 +412,17 @@ ENGINE_ERROR_CODE TopKeys::doStats(const void* cookie,
 /**
  * Passing a set of topkeys, and relevant context data will
  * return a json object containing an array of topkeys (with each key
- * appearing as in the example above for tk_jsonfunc):
+ * appearing as in the example above for tk_jsonfunc), and of the hottest
+ * collections and vBuckets:
  * {
  *   "topkeys": [
  *      { ... }, ..., { ... }
+ *    ],
+ *   "collections": [
+ *      { ... }, ..., { ... }
+ *    ],
+ *   "vbuckets": [
+ *      { ... }, ..., { ... }
  *    ]
  * }
  */
@@ -339,42 +430,26 @@ ENGINE_ERROR_CODE TopKeys::do_json_stats(nlohmann::json& object,
                                          rel_time_t current_time) {
     nlohmann::json topkeys = nlohmann::json::array();
     struct tk_context context(
-            nullptr, nullptr, current_time, &topkeys, &tk_jsonfunc);
+            nullptr, nullptr, current_time, &topkeys, &tk_jsonfunc, &object);
     doStatsInner(context);
 
-    auto str = topkeys.dump();
     object["topkeys"] = topkeys;
 
     return ENGINE_SUCCESS;
 }
 
-void TopKeys::Shard::accept_visitor(iterfunc_t visitor_func,
-                                    void* visitor_ctx) {
-    std::lock_guard<std::mutex> lock(mutex);
-    for (const auto* key : list) {
-        visitor_func(*key, visitor_ctx);
-    }
-}
-
 void TopKeys::doStatsInner(const tk_context& stat_context) {
-    // 1) Find the unique set of top keys by putting every top key in a map
-    std::unordered_map<std::string, topkey_item_t> map =
-            std::unordered_map<std::string, topkey_item_t>();
-
+    // 1) Take a copy of every shard, and merge them into the unique set of
+    // top keys.
+    std::vector<SpaceSaving<KeyId>::Entry> keys;
+    std::vector<SpaceSaving<CollectionID>::Entry> collections;
+    std::vector<SpaceSaving<Vbid>::Entry> vbuckets;
     for (auto& shard : shards) {
-        shard->accept_visitor(tk_aggregate_func, &map);
+        shard->snapshot(keys, collections, vbuckets);
     }
 
-    // Easiest way to sort this by access_count is to drop the contents of the
-    // map into a vector and sort that.
-    auto items = std::vector<topkey_stat_t>(map.begin(), map.end());
-    std::sort(items.begin(),
-              items.end(),
-              [](const TopKeys::topkey_stat_t& a,
-                 const TopKeys::topkey_stat_t& b) {
-                  // Sort by number of accesses
-                  return a.second.ti_access_count > b.second.ti_access_count;
-              });
+    auto items =
+            mergeAndSort(keys, [](const KeyId& id) { return id.key; });
 
     // 2) Iterate on this set making the required callback for each key.
     // Call for no more than keys_to_return times.
@@ -385,4 +460,33 @@ void TopKeys::doStatsInner(const tk_context& stat_context) {
         }
         stat_context.callbackFunction(t.first, t.second, (void*)&stat_context);
     }
+
+    if (stat_context.dimensions == nullptr) {
+        return;
+    }
+
+    // 3) Add the hottest collections and vBuckets
+    auto& collArray = (*stat_context.dimensions)["collections"];
+    collArray = nlohmann::json::array();
+    for (const auto& t : mergeAndSort(collections,
+                                      [](CollectionID cid) { return cid; })) {
+        if (collArray.size() == keys_to_return) {
+            break;
+        }
+        collArray.push_back({{"cid", t.first.to_string()},
+                             {"access_count", t.second.ti_access_count},
+                             {"bytes", t.second.ti_bytes}});
+    }
+
+    auto& vbArray = (*stat_context.dimensions)["vbuckets"];
+    vbArray = nlohmann::json::array();
+    for (const auto& t : mergeAndSort(
+                 vbuckets, [](Vbid vbid) { return uint16_t(vbid.get()); })) {
+        if (vbArray.size() == keys_to_return) {
+            break;
+        }
+        vbArray.push_back({{"vbid", t.first},
+                           {"access_count", t.second.ti_access_count},
+                           {"bytes", t.second.ti_bytes}});
+    }
 }
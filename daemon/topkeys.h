@@ -16,12 +16,14 @@
  */
 #pragma once
 
+#include <memcached/dockey.h>
 #include <memcached/engine.h>
+#include <memcached/vbucket.h>
 #include <nlohmann/json_fwd.hpp>
 #include <array>
 
 #include <folly/CachelinePadded.h>
-#include <list>
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -30,9 +32,9 @@ struct tk_context;
 /*
  * TopKeys
  *
- * Tracks the top N most recently accessed keys. The details are
- * accessible by a stats call, which is used by ns_server to print the
- * top keys list in the GUI.
+ * Tracks the top N most frequently accessed keys (and the most frequently
+ * accessed collections and vBuckets). The details are accessible by a stats
+ * call, which is used by ns_server to print the top keys list in the GUI.
  */
 
 struct topkey_item_t {
@@ -41,8 +43,11 @@ struct topkey_item_t {
     }
 
     rel_time_t ti_ctime; /* Time this item was created */
-    int ti_access_count; /* Int count for number of times key has been accessed
-                          */
+    uint64_t ti_access_count; /* Count for number of times key has been
+                                 accessed */
+    uint64_t ti_bytes = 0; /* Number of value bytes transferred */
+    uint64_t ti_error = 0; /* Upper bound of the over-estimation of
+                              ti_access_count (see Space-Saving) */
 };
 
 /* Class to track the "top" keys in a bucket.
@@ -67,7 +72,25 @@ public:
     typedef std::pair<KeyId, topkey_item_t> topkey_t;
     typedef std::pair<std::string, topkey_item_t> topkey_stat_t;
 
-    void updateKey(const void* key, size_t nkey, rel_time_t operation_time);
+    /**
+     * Record an access to the given key.
+     *
+     * @param key the logical key (without collection prefix)
+     * @param nkey length of key
+     * @param operation_time time of the access
+     * @param nbytes number of value bytes read or written by the access
+     * @param collection the collection the key belongs to. Only keys in the
+     *        default collection are tracked individually (the stats output
+     *        has no notion of collections), but every access is accounted
+     *        to its collection and vBucket.
+     * @param vbid the vBucket the key belongs to
+     */
+    void updateKey(const void* key,
+                   size_t nkey,
+                   rel_time_t operation_time,
+                   size_t nbytes = 0,
+                   CollectionID collection = CollectionID::Default,
+                   Vbid vbid = Vbid(0));
 
     ENGINE_ERROR_CODE stats(const void* cookie,
                             rel_time_t current_time,
@@ -75,15 +98,22 @@ public:
 
     /**
      * Passing a set of topkeys, and relevant context data will
-     * return a json object containing an array of topkeys:
+     * return a json object containing an array of topkeys, and arrays of
+     * the hottest collections and vBuckets:
      * {
      *   "topkeys": [
      *      {
      *          "key": "somekey",
      *          "access_count": nnn,
-     *          "ctime": ccc,
-     *          "atime": aaa
+     *          "bytes": bbb,
+     *          "ctime": ccc
      *      }, ..., { ... }
+     *    ],
+     *   "collections": [
+     *      {"cid": "0x8", "access_count": nnn, "bytes": bbb}, ..., { ... }
+     *    ],
+     *   "vbuckets": [
+     *      {"vbid": 12, "access_count": nnn, "bytes": bbb}, ..., { ... }
      *    ]
      * }
      */
@@ -91,7 +121,12 @@ public:
                                  rel_time_t current_time);
 
 protected:
-    void doUpdateKey(const void* key, size_t nkey, rel_time_t operation_time);
+    void doUpdateKey(const void* key,
+                     size_t nkey,
+                     rel_time_t operation_time,
+                     size_t nbytes,
+                     CollectionID collection,
+                     Vbid vbid);
 
     void doStatsInner(const tk_context& stat_context);
     ENGINE_ERROR_CODE doStats(const void* cookie,
@@ -114,61 +149,80 @@ private:
      */
     const size_t keys_to_return;
 
-    class Shard;
+    /**
+     * Space-Saving summary of the top {capacity} identifiers in a stream of
+     * accesses. Uses constant memory: once full, an access to an identifier
+     * which isn't tracked replaces the identifier with the lowest count, and
+     * inherits that count (recorded as the error bound of the new entry).
+     * Any identifier with more than 1/capacity of all accesses is
+     * guaranteed to be tracked.
+     *
+     * Not thread safe; see Shard.
+     */
+    template <typename Id>
+    class SpaceSaving {
+    public:
+        using Entry = std::pair<Id, topkey_item_t>;
+
+        void setCapacity(size_t capacity);
 
-    Shard& getShard();
+        /**
+         * Record an access to the identifier described by 'probe' (either an
+         * Id, or a non-owning reference which can be compared with and
+         * assigned to an Id - see KeyRef).
+         */
+        template <typename Probe>
+        void record(const Probe& probe,
+                    rel_time_t operation_time,
+                    size_t nbytes);
+
+        const std::vector<Entry>& getEntries() const {
+            return entries;
+        }
+
+    private:
+        size_t capacity = 0;
+        std::vector<Entry> entries;
+    };
 
     // One of N Shards which the keyspace has been broken
     // into.
     // Responsible for tracking the top {mkeys} within it's keyspace.
     class Shard {
     public:
-        void setMaxKeys(size_t mkeys) {
-            max_keys = mkeys;
-            storage.reserve(max_keys);
-            // reallocating storage invalidates the LRU list.
-            list.clear();
-        }
-
-        // Updates the topkey 'ranking' for the specified key.
-        // If the item does not exist it will be created (with it's creation
-        // time set to operation_time), otherwise the existing item will be
-        // updated.
-        // On success returns true, If insufficient memory to create a
-        // new item, returns false.
-        bool updateKey(std::string_view key,
-                       size_t key_hash,
-                       rel_time_t operation_time);
-
-        typedef void (*iterfunc_t)(const topkey_t& it, void* arg);
-
-        /* For each key in this shard, invoke the given callback function.
+        void setMaxKeys(size_t mkeys);
+
+        /**
+         * Record an access in this shard, unless the shard is currently in
+         * use by another thread (in which case the caller should try
+         * another shard). Never blocks.
+         *
+         * @return true if the access was recorded.
+         */
+        bool tryUpdateKey(std::string_view key,
+                          size_t key_hash,
+                          rel_time_t operation_time,
+                          size_t nbytes,
+                          CollectionID collection,
+                          Vbid vbid);
+
+        /**
+         * Copy the contents of this shard; waits for any in-progress update
+         * to complete.
          */
-        void accept_visitor(iterfunc_t visitor_func, void* visitor_ctx);
+        void snapshot(std::vector<SpaceSaving<KeyId>::Entry>& keysOut,
+                      std::vector<SpaceSaving<CollectionID>::Entry>& collOut,
+                      std::vector<SpaceSaving<Vbid>::Entry>& vbOut);
 
     private:
-        // An ordered list of topkey_t*, used for LRU.
-        typedef std::list<topkey_t*> key_history_t;
-
-        // Vector topkey_t, used for actual topkey storage.
-        typedef std::vector<topkey_t> key_storage_t;
-
-        // Searches for the given key. If found returns a pointer to the
-        // topkey_t, else returns NULL.
-        topkey_t* searchForKey(size_t hash, std::string_view key);
-
-        // Maximum numbers of keys to be tracked per shard.
-        size_t max_keys;
-
-        // list of keys, ordered from most-recently used (front) to least
-        // recently used (back).
-        key_history_t list;
-
-        // Underlying topkey storage.
-        key_storage_t storage;
-
-        // Mutex to serialize access to this shard.
-        std::mutex mutex;
+        SpaceSaving<KeyId> keys;
+        SpaceSaving<CollectionID> collections;
+        SpaceSaving<Vbid> vbuckets;
+
+        // Set while a thread is updating or reading the shard. Writers only
+        // ever try to set it (and move on to another shard if it is taken),
+        // so the request path never waits.
+        std::atomic<bool> busy{false};
     };
 
     // Array of topkey shards. We have one shard per core so we need to
@@ -29,6 +29,10 @@
 #include "engine_fixture.h"
 #include "item.h"
 #include "kv_bucket.h"
+#include "seqno_access_log.h"
+
+#include <fstream>
+#include <numeric>
 
 class AccessLogBenchEngine : public EngineFixture {
 protected:
@@ -113,3 +117,114 @@ static void AccessScannerArguments(benchmark::internal::Benchmark* b) {
 BENCHMARK_REGISTER_F(AccessLogBenchEngine, MemoryOverhead)
         ->Apply(AccessScannerArguments)
         ->MinTime(0.000001);
+
+/*
+ * Fixture for comparing the access log formats; range(0) selects the format
+ * (0: mutation_log, 1: seqno).
+ */
+class AccessLogFormatBenchEngine : public EngineFixture {
+protected:
+    void SetUp(const benchmark::State& state) override {
+        varConfig = "alog_resident_ratio_threshold=100;alog_path=" +
+                    alogPath + ";alog_format=" +
+                    (state.range(0) == 1 ? "seqno" : "mutation_log");
+        EngineFixture::SetUp(state);
+    }
+
+    std::string getLogFile(const benchmark::State& state) const {
+        return alogPath + ".0" + (state.range(0) == 1 ? ".seqno" : "");
+    }
+
+    const std::string alogPath = "benchmarks-test/access.log";
+};
+
+/*
+ * Measures the time to generate the access log of a vBucket, and the size of
+ * the resulting file.
+ * Variables:
+ *  - range(0) : The access log format (0: mutation_log, 1: seqno)
+ *  - range(1) : The number of items to fill the vbucket with
+ */
+BENCHMARK_DEFINE_F(AccessLogFormatBenchEngine, Generate)
+(benchmark::State& state) {
+    state.SetLabel(state.range(0) == 1 ? "seqno" : "mutation_log");
+    engine->getKVBucket()->setVBucketState(Vbid(0), vbucket_state_active);
+    ExTask task = std::make_shared<AccessScanner>(*(engine->getKVBucket()),
+                                                  engine->getConfiguration(),
+                                                  engine->getEpStats(),
+                                                  1000);
+    ExecutorPool::get()->schedule(task);
+
+    std::string value(200, 'x');
+    std::string keyPrefixPre(20, 'a');
+    for (int i = 0; i < state.range(1); ++i) {
+        auto item = make_item(vbid, keyPrefixPre + std::to_string(i), value);
+        engine->getKVBucket()->set(item, cookie);
+    }
+
+    while (state.KeepRunning()) {
+        executorPool->wake(task->getId());
+        executorPool->runNextTask(AUXIO_TASK_IDX, "Generating access log");
+        executorPool->runNextTask(AUXIO_TASK_IDX,
+                                  "Item Access Scanner on vb:0");
+    }
+
+    std::ifstream log(getLogFile(state), std::ios::binary | std::ios::ate);
+    state.counters["BytesPerItem"] =
+            double(log.tellg()) / double(state.range(1));
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+static void AccessLogFormatArguments(benchmark::internal::Benchmark* b) {
+    for (int format : {0, 1}) {
+        for (int items : {32768, 262144}) {
+            b->Args({format, items});
+        }
+    }
+}
+
+BENCHMARK_REGISTER_F(AccessLogFormatBenchEngine, Generate)
+        ->Apply(AccessLogFormatArguments);
+
+/*
+ * Measures reading back a seqno access log, which warmup does a vBucket at a
+ * time before scanning it.
+ * Variables:
+ *  - range(0) : The number of seqnos per vBucket
+ *  - range(1) : The stride between the logged seqnos (1: every item is hot)
+ */
+static void SeqnoAccessLogRead(benchmark::State& state) {
+    const std::string path = "seqno_access_log_bench.log";
+    const size_t numVBuckets = 16;
+    {
+        SeqnoAccessLog::Writer writer(path, 4096);
+        for (uint16_t vb = 0; vb < numVBuckets; ++vb) {
+            std::vector<uint64_t> seqnos(state.range(0));
+            std::iota(seqnos.begin(), seqnos.end(), 0);
+            for (auto& seqno : seqnos) {
+                seqno *= state.range(1);
+            }
+            writer.write(Vbid(vb), seqnos);
+        }
+        if (!writer.close()) {
+            state.SkipWithError("Failed to write the seqno access log");
+            return;
+        }
+    }
+
+    Vbid vbid;
+    std::vector<uint64_t> seqnos;
+    while (state.KeepRunning()) {
+        SeqnoAccessLog::Reader reader(path);
+        while (reader.next(vbid, seqnos)) {
+            benchmark::DoNotOptimize(seqnos.data());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numVBuckets *
+                            state.range(0));
+    remove(path.c_str());
+}
+
+BENCHMARK(SeqnoAccessLogRead)
+        ->Args({65536, 1})
+        ->Args({65536, 100});
@@ -0,0 +1,137 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Benchmarks for the PagingVisitor - measuring the time to evict a memory
+ * deficit from a vBucket, and how many frequently accessed items it evicts
+ * doing so.
+ */
+
+#include "engine_fixture.h"
+#include "ep_bucket.h"
+#include "item.h"
+#include "kv_bucket.h"
+#include "paging_visitor.h"
+#include "vb_filter.h"
+#include "vbucket.h"
+
+#include <fakes/fake_executorpool.h>
+
+class ItemPagerBench : public EngineFixture {
+protected:
+    void SetUp(const benchmark::State& state) override {
+        varConfig = "max_size=1000000000";
+        EngineFixture::SetUp(state);
+        if (state.thread_index == 0) {
+            engine->getKVBucket()->setVBucketState(vbid, vbucket_state_active);
+        }
+    }
+
+    /**
+     * (Re)store all of the items with their values resident and clean, every
+     * hotRatio'th item with a high frequency counter.
+     */
+    void populate(size_t numItems, size_t hotRatio) {
+        const std::string value(256, 'x');
+        auto& bucket = dynamic_cast<EPBucket&>(*engine->getKVBucket());
+        for (size_t i = 0; i < numItems; ++i) {
+            auto item = make_item(vbid, "key_" + std::to_string(i), value);
+            bucket.set(item, cookie);
+        }
+        bucket.flushVBucket(vbid);
+
+        auto vb = bucket.getVBucket(vbid);
+        for (size_t i = 0; i < numItems; i += hotRatio) {
+            auto result = vb->ht.findForWrite(
+                    makeKey("key_" + std::to_string(i)), WantsDeleted::No);
+            vb->ht.setFreqCounterValue(*result.storedValue, hotFreqCounter);
+        }
+    }
+
+    static StoredDocKey makeKey(const std::string& key) {
+        return StoredDocKey(key, CollectionID::Default);
+    }
+
+    const uint8_t hotFreqCounter = 64;
+};
+
+/*
+ * Visit a vBucket whose bucket is above the low watermark by a given
+ * percentage of its value bytes.
+ * Variables:
+ *  - range(0) : The number of items in the vBucket
+ *  - range(1) : The memory deficit, as a percentage of the value bytes
+ */
+BENCHMARK_DEFINE_F(ItemPagerBench, EvictDeficit)(benchmark::State& state) {
+    const size_t numItems = state.range(0);
+    const size_t hotRatio = 10;
+    auto& bucket = *engine->getKVBucket();
+    auto& stats = engine->getEpStats();
+    auto& config = engine->getConfiguration();
+
+    size_t ejected = 0;
+    size_t hotEjected = 0;
+    while (state.KeepRunning()) {
+        state.PauseTiming();
+        populate(numItems, hotRatio);
+        auto vb = bucket.getVBucket(vbid);
+        const auto valueBytes =
+                vb->ht.getCacheSize() - vb->ht.getMetadataMemory();
+        config.setMemLowWat(stats.getPreciseTotalMemoryUsed() -
+                            valueBytes * state.range(1) / 100);
+
+        std::shared_ptr<std::atomic<bool>> available;
+        std::atomic<item_pager_phase> phase{ACTIVE_AND_PENDING_ONLY};
+        PagingVisitor pv(bucket,
+                         stats,
+                         1.0,
+                         available,
+                         ITEM_PAGER,
+                         false,
+                         0.5,
+                         VBucketFilter(),
+                         &phase,
+                         false,
+                         config.getItemEvictionAgePercentage(),
+                         config.getItemEvictionFreqCounterAgeThreshold());
+        const auto before = vb->getNumNonResidentItems();
+        state.ResumeTiming();
+
+        pv.visitBucket(vb);
+
+        state.PauseTiming();
+        ejected += vb->getNumNonResidentItems() - before;
+        for (size_t i = 0; i < numItems; i += hotRatio) {
+            auto result = vb->ht.findForRead(
+                    makeKey("key_" + std::to_string(i)), TrackReference::No);
+            if (result.storedValue && !result.storedValue->isResident()) {
+                ++hotEjected;
+            }
+        }
+        state.ResumeTiming();
+    }
+
+    state.counters["ItemsEvicted"] = double(ejected) / state.iterations();
+    state.counters["HotItemsEvicted"] =
+            double(hotEjected) / state.iterations();
+    state.SetItemsProcessed(state.iterations() * numItems);
+}
+
+BENCHMARK_REGISTER_F(ItemPagerBench, EvictDeficit)
+        ->Args({100000, 10})
+        ->Args({100000, 30})
+        ->Args({1000000, 30});
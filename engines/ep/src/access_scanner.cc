@@ -21,8 +21,10 @@
 #include "hash_table.h"
 #include "kv_bucket.h"
 #include "mutation_log.h"
+#include "seqno_access_log.h"
 #include "stats.h"
 #include "vb_count_visitor.h"
+#include "warmup.h"
 
 #include <phosphor/phosphor.h>
 #include <platform/dirutils.h>
@@ -49,19 +51,37 @@ public:
           stateFinalizer(sfin),
           as(aS),
           items_scanned(0),
-          items_to_scan(items_to_scan) {
+          items_to_scan(items_to_scan),
+          minFreqCount(conf.getAlogMinFreqCount()) {
         setVBucketFilter(VBucketFilter(
                 _store.getVBuckets().getShard(sh)->getVBuckets()));
         name = conf.getAlogPath();
         name = name + "." + std::to_string(shardID);
+        // The log of the other format is removed once this one is in place,
+        // so that warmup doesn't load a stale one.
+        if (conf.getAlogFormat() == "seqno") {
+            otherName = name;
+            name.append(".seqno");
+        } else {
+            otherName = name + ".seqno";
+        }
         prev = name + ".old";
         next = name + ".next";
 
-        log = std::make_unique<MutationLog>(next, conf.getAlogBlockSize());
-        log->open();
-        if (!log->isOpen()) {
+        bool opened;
+        if (conf.getAlogFormat() == "seqno") {
+            seqnoLog = std::make_unique<SeqnoAccessLog::Writer>(
+                    next, conf.getAlogBlockSize());
+            opened = seqnoLog->isOpen();
+        } else {
+            log = std::make_unique<MutationLog>(next, conf.getAlogBlockSize());
+            log->open();
+            opened = log->isOpen();
+        }
+        if (!opened) {
             EP_LOG_WARN("Failed to open access log: '{}'", next);
             log.reset();
+            seqnoLog.reset();
         } else {
             EP_LOG_INFO(
                     "Attempting to generate new access file "
@@ -71,13 +91,19 @@ public:
     }
 
     bool visit(const HashTable::HashBucketLock& lh, StoredValue& v) override {
-        // Record resident, Committed HashTable items as 'accessed'.
-        if (log && v.isResident() && v.isCommitted()) {
+        // Record resident, Committed HashTable items as 'accessed', unless
+        // they've not been accessed frequently enough.
+        if ((log || seqnoLog) && v.isResident() && v.isCommitted() &&
+            v.getFreqCounterValue() >= minFreqCount) {
             if (v.isExpired(startTime) || v.isDeleted()) {
                 EP_LOG_DEBUG("Skipping expired/deleted item: {}",
                              v.getBySeqno());
             } else {
-                accessed.push_back(StoredDocKey(v.getKey()));
+                if (seqnoLog) {
+                    accessedSeqnos.push_back(v.getBySeqno());
+                } else {
+                    accessed.push_back(StoredDocKey(v.getKey()));
+                }
                 return ++items_scanned < items_to_scan;
             }
         }
@@ -94,6 +120,11 @@ public:
     }
 
     void visitBucket(const VBucketPtr& vb) override {
+        if (seqnoLog) {
+            visitBucketSeqnos(*vb);
+            return;
+        }
+
         update(vb->getId());
 
         if (log == nullptr) {
@@ -111,15 +142,46 @@ public:
         }
     }
 
+    /**
+     * Record the seqnos of the vBucket's accessed items. They must be sorted
+     * so are all held until the vBucket is visited - at 8 bytes per item
+     * rather than a key.
+     */
+    void visitBucketSeqnos(VBucket& vb) {
+        if (!vBucketFilter(vb.getId())) {
+            return;
+        }
+        HashTable::Position ht_start;
+        while (ht_start != vb.ht.endPosition()) {
+            ht_start = vb.ht.pauseResumeVisit(*this, ht_start);
+            items_scanned = 0;
+        }
+        seqnoLog->write(vb.getId(), accessedSeqnos);
+        accessedSeqnos.clear();
+        accessedSeqnos.shrink_to_fit();
+    }
+
     void complete() override {
 
-        if (log == nullptr) {
+        if (log == nullptr && seqnoLog == nullptr) {
             updateStateFinalizer(false);
         } else {
-            size_t num_items = log->itemsLogged[int(MutationLogType::New)];
-            log->commit1();
-            log->commit2();
-            log.reset();
+            size_t num_items;
+            if (seqnoLog) {
+                num_items = seqnoLog->getNumItems();
+                const bool written = seqnoLog->close();
+                seqnoLog.reset();
+                if (!written) {
+                    EP_LOG_WARN("Failed to write access log: '{}'", next);
+                    updateStateFinalizer(false);
+                    return;
+                }
+            } else {
+                num_items = log->itemsLogged[int(MutationLogType::New)];
+                log->commit1();
+                log->commit2();
+                log.reset();
+            }
             stats.alogRuntime.store(ep_real_time() - startTime);
             stats.alogNumItems.store(num_items);
             stats.accessScannerHisto.add(
@@ -180,6 +242,13 @@ public:
                     "{} keys",
                     name,
                     static_cast<uint64_t>(num_items));
+            for (const auto& other : {otherName, otherName + ".old"}) {
+                if (cb::io::isFile(other) && remove(other.c_str()) == -1) {
+                    EP_LOG_WARN("Failed to remove access log file '{}': {}",
+                                other,
+                                strerror(errno));
+                }
+            }
             updateStateFinalizer(true);
         }
     }
@@ -213,11 +282,15 @@ private:
     std::string prev;
     std::string next;
     std::string name;
+    /// The access log of the format not being generated
+    std::string otherName;
     uint16_t shardID;
 
     std::vector<StoredDocKey> accessed;
+    std::vector<uint64_t> accessedSeqnos;
 
     std::unique_ptr<MutationLog> log;
+    std::unique_ptr<SeqnoAccessLog::Writer> seqnoLog;
     std::atomic<bool> &stateFinalizer;
     AccessScanner &as;
 
@@ -225,6 +298,8 @@ private:
     uint64_t items_scanned;
     // The number of items to scan before we pause
     const uint64_t items_to_scan;
+    // Items with a lower frequency counter aren't recorded
+    const size_t minFreqCount;
 };
 
 AccessScanner::AccessScanner(KVBucket& _store,
@@ -285,6 +360,19 @@ AccessScanner::AccessScanner(KVBucket& _store,
 bool AccessScanner::run() {
     TRACE_EVENT0("ep-engine/task", "AccessScanner");
 
+    // Don't replace the access log whilst an online warmup is still loading
+    // from it; the resident set isn't representative yet either.
+    auto* warmup = store.getWarmup();
+    if (warmup && warmup->isBackgroundLoading()) {
+        EP_LOG_INFO(
+                "AccessScanner::run: Skipping as warmup is loading data in "
+                "the background");
+        ++stats.accessScannerSkips;
+        snooze(sleepTime);
+        updateAlogTime(sleepTime);
+        return true;
+    }
+
     bool inverse = true;
     if (available.compare_exchange_strong(inverse, false)) {
         store.resetAccessScannerTasktime();
@@ -324,6 +412,9 @@ bool AccessScanner::run() {
                 deleteAlogFile(prev);
                 /* Remove shard access log file */
                 deleteAlogFile(name);
+                /* And the same for the seqno format */
+                deleteAlogFile(name + ".seqno.old");
+                deleteAlogFile(name + ".seqno");
                 stats.accessScannerSkips++;
             } else {
                 createAndScheduleTask(i);
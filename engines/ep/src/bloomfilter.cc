@@ -21,7 +21,15 @@
 
 #include "murmurhash3.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CB_BLOOMFILTER_X86 1
+#include <immintrin.h>
+#endif
 
 #if __x86_64__ || __ppc64__
 #define MURMURHASH_3 MurmurHash3_x64_128
@@ -29,37 +37,177 @@
 #define MURMURHASH_3 MurmurHash3_x86_128
 #endif
 
+/**
+ * Odd constants used to derive the bit to set in each word of a block from
+ * the low 32 bits of the key's hash (the same salts as the Parquet / Impala
+ * split block bloom filters).
+ */
+static const uint32_t blockSalts[] = {0x47b6137bU,
+                                      0x44974d91U,
+                                      0x8824ad5bU,
+                                      0xa2b7289dU,
+                                      0x705495c7U,
+                                      0x2df1424bU,
+                                      0x9efc4947U,
+                                      0x5c6bfb31U};
+
+/// Header of a saved filter; followed by the blocks.
+struct BloomFilterFileHeader {
+    static constexpr uint32_t currentMagic = 0xcbb1f002;
+
+    uint32_t magic;
+    uint32_t status;
+    uint64_t seqno;
+    uint64_t keyCounter;
+    uint64_t numBlocks;
+};
+
 BloomFilter::BloomFilter(size_t key_count, double false_positive_prob,
                          bfilter_status_t new_status) {
 
     status = new_status;
-    filterSize = estimateFilterSize(key_count, false_positive_prob);
-    noOfHashes = estimateNoOfHashes(key_count);
     keyCounter = 0;
-    bitArray.assign(filterSize, false);
+    blocks.assign(estimateNoOfBlocks(key_count, false_positive_prob),
+                  Block{});
+}
+
+BloomFilter::BloomFilter(std::vector<Block> blocks,
+                         size_t keyCounter,
+                         bfilter_status_t newStatus)
+    : keyCounter(keyCounter), status(newStatus), blocks(std::move(blocks)) {
 }
 
 BloomFilter::~BloomFilter() {
     status = BFILTER_DISABLED;
-    bitArray.clear();
+    blocks.clear();
 }
 
-size_t BloomFilter::estimateFilterSize(size_t key_count,
-                                       double false_positive_prob) {
-    return round(-(((double)(key_count) * log(false_positive_prob))
-                                                    / (pow(log(2.0), 2))));
+double BloomFilter::estimateFalsePositiveRate(double keysPerBlock) {
+    // The number of keys landing in a block is Poisson distributed, and a
+    // lookup in a block holding j keys hits if all of its eight bits were
+    // set by one of them: (1 - (1 - 1/32)^j)^8. Sum over the likely loads.
+    const auto maxLoad =
+            size_t(keysPerBlock + 12 * std::sqrt(keysPerBlock) + 12);
+    double probOfLoad = std::exp(-keysPerBlock);
+    double rate = 0;
+    for (size_t load = 0; load <= maxLoad; ++load) {
+        rate += probOfLoad *
+                std::pow(1 - std::pow(31.0 / 32.0, double(load)),
+                         double(wordsPerBlock));
+        probOfLoad *= keysPerBlock / double(load + 1);
+    }
+    return rate;
 }
 
-size_t BloomFilter::estimateNoOfHashes(size_t key_count) {
-    return round(((double) filterSize / key_count) * (log(2.0)));
+size_t BloomFilter::estimateNoOfBlocks(size_t key_count,
+                                       double false_positive_prob) {
+    // Blocks are not uniformly loaded, so the classic m = -n*ln(p)/ln(2)^2
+    // undersizes the filter. Binary search for the smallest number of blocks
+    // whose expected false positive rate meets the target instead.
+    key_count = std::max(key_count, size_t(1));
+    size_t lo = (key_count + bitsPerBlock - 1) / bitsPerBlock;
+    size_t hi = std::max(lo, key_count);
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (estimateFalsePositiveRate(double(key_count) / mid) <=
+            false_positive_prob) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
 }
 
-uint64_t BloomFilter::hashDocKey(const DocKey& key, uint32_t iteration) {
-    uint64_t result = 0;
+uint64_t BloomFilter::hashDocKey(const DocKey& key) {
+    uint64_t result[2] = {0, 0};
     auto hashable = key.getIdAndKey();
-    uint32_t seed = iteration + (uint32_t(hashable.first) * noOfHashes);
-    MURMURHASH_3(hashable.second.data(), hashable.second.size(), seed, &result);
-    return result;
+    uint32_t seed = uint32_t(hashable.first);
+    MURMURHASH_3(hashable.second.data(), hashable.second.size(), seed, result);
+    return result[0];
+}
+
+BloomFilter::Block& BloomFilter::getBlock(uint64_t hash) {
+    // Map the upper half of the hash onto [0, blocks) without a division
+    return blocks[((hash >> 32) * blocks.size()) >> 32];
+}
+
+BloomFilter::Block BloomFilter::makeMask(uint64_t hash) {
+    // The portable version of makeMaskAVX2()
+    const auto key = uint32_t(hash);
+    Block mask;
+    for (size_t ii = 0; ii < wordsPerBlock; ++ii) {
+        mask.words[ii] = uint32_t(1) << ((key * blockSalts[ii]) >> 27);
+    }
+    return mask;
+}
+
+bool BloomFilter::addToBlockScalar(Block& block, uint64_t hash) {
+    const auto mask = makeMask(hash);
+    uint32_t missing = 0;
+    for (size_t ii = 0; ii < wordsPerBlock; ++ii) {
+        missing |= mask.words[ii] & ~block.words[ii];
+        block.words[ii] |= mask.words[ii];
+    }
+    return missing != 0;
+}
+
+bool BloomFilter::blockContainsScalar(const Block& block, uint64_t hash) {
+    const auto mask = makeMask(hash);
+    uint32_t missing = 0;
+    for (size_t ii = 0; ii < wordsPerBlock; ++ii) {
+        missing |= mask.words[ii] & ~block.words[ii];
+    }
+    return missing == 0;
+}
+
+#ifdef CB_BLOOMFILTER_X86
+// A block is exactly one AVX2 register, so the mask is built and applied
+// with a handful of instructions. SSE2 would need two of everything and
+// lacks a variable shift, so anything without AVX2 uses the scalar loops.
+
+__attribute__((target("avx2"))) static __m256i makeMaskAVX2(uint64_t hash) {
+    const auto salts =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blockSalts));
+    const auto bits = _mm256_srli_epi32(
+            _mm256_mullo_epi32(_mm256_set1_epi32(int(uint32_t(hash))), salts),
+            27);
+    return _mm256_sllv_epi32(_mm256_set1_epi32(1), bits);
+}
+
+__attribute__((target("avx2"))) bool BloomFilter::addToBlockAVX2(
+        Block& block, uint64_t hash) {
+    const auto mask = makeMaskAVX2(hash);
+    auto* words = reinterpret_cast<__m256i*>(block.words.data());
+    const auto current = _mm256_loadu_si256(words);
+    // testc is set if every bit of the mask is already in the block
+    const bool present = _mm256_testc_si256(current, mask);
+    _mm256_storeu_si256(words, _mm256_or_si256(current, mask));
+    return !present;
+}
+
+__attribute__((target("avx2"))) bool BloomFilter::blockContainsAVX2(
+        const Block& block, uint64_t hash) {
+    const auto mask = makeMaskAVX2(hash);
+    const auto current = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(block.words.data()));
+    return _mm256_testc_si256(current, mask);
+}
+#endif
+
+BloomFilter::BlockOps BloomFilter::selectBlockOps() {
+#ifdef CB_BLOOMFILTER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {addToBlockAVX2, blockContainsAVX2};
+    }
+#endif
+    return {addToBlockScalar, blockContainsScalar};
+}
+
+const BloomFilter::BlockOps& BloomFilter::selectedBlockOps() {
+    static const BlockOps ops = selectBlockOps();
+    return ops;
 }
 
 void BloomFilter::setStatus(bfilter_status_t to) {
@@ -72,7 +220,7 @@ void BloomFilter::setStatus(bfilter_status_t to) {
         case BFILTER_PENDING:
             if (to == BFILTER_DISABLED) {
                 status = to;
-                bitArray.clear();
+                blocks.clear();
             } else if (to == BFILTER_COMPACTING) {
                 status = to;
             }
@@ -80,7 +228,7 @@ void BloomFilter::setStatus(bfilter_status_t to) {
         case BFILTER_COMPACTING:
             if (to == BFILTER_DISABLED) {
                 status = to;
-                bitArray.clear();
+                blocks.clear();
             } else if (to == BFILTER_ENABLED) {
                 status = to;
             }
@@ -88,7 +236,7 @@ void BloomFilter::setStatus(bfilter_status_t to) {
         case BFILTER_ENABLED:
             if (to == BFILTER_DISABLED) {
                 status = to;
-                bitArray.clear();
+                blocks.clear();
             } else if (to == BFILTER_COMPACTING) {
                 status = to;
             }
@@ -115,29 +263,22 @@ std::string BloomFilter::getStatusString() {
 }
 
 void BloomFilter::addKey(const DocKey& key) {
-    if (status == BFILTER_COMPACTING || status == BFILTER_ENABLED) {
-        bool overlap = true;
-        for (uint32_t i = 0; i < noOfHashes; i++) {
-            uint64_t result = hashDocKey(key, i);
-            if (overlap && bitArray[result % filterSize] == 0) {
-                overlap = false;
-            }
-            bitArray[result % filterSize] = true;
-        }
-        if (!overlap) {
+    if ((status == BFILTER_COMPACTING || status == BFILTER_ENABLED) &&
+        !blocks.empty()) {
+        const auto hash = hashDocKey(key);
+        if (selectedBlockOps().add(getBlock(hash), hash)) {
             keyCounter++;
         }
     }
 }
 
 bool BloomFilter::maybeKeyExists(const DocKey& key) {
-    if (status == BFILTER_COMPACTING || status == BFILTER_ENABLED) {
-        for (uint32_t i = 0; i < noOfHashes; i++) {
-            uint64_t result = hashDocKey(key, i);
-            if (bitArray[result % filterSize] == 0) {
-                // The key does NOT exist.
-                return false;
-            }
+    if ((status == BFILTER_COMPACTING || status == BFILTER_ENABLED) &&
+        !blocks.empty()) {
+        const auto hash = hashDocKey(key);
+        if (!selectedBlockOps().contains(getBlock(hash), hash)) {
+            // The key does NOT exist.
+            return false;
         }
     }
     // The key may exist.
@@ -154,7 +295,7 @@ size_t BloomFilter::getNumOfKeysInFilter() {
 
 size_t BloomFilter::getFilterSize() {
     if (status == BFILTER_COMPACTING || status == BFILTER_ENABLED) {
-        return filterSize;
+        return blocks.size() * bitsPerBlock;
     } else {
         return 0;
     }
@@ -162,8 +303,80 @@ size_t BloomFilter::getFilterSize() {
 
 size_t BloomFilter::getNoOfHashes() const {
     if (status == BFILTER_COMPACTING || status == BFILTER_ENABLED) {
-        return noOfHashes;
+        return wordsPerBlock;
     } else {
         return 0;
     }
 }
+
+bool BloomFilter::save(const std::string& fname, uint64_t seqno) const {
+    FILE* fp = fopen(fname.c_str(), "wb");
+    if (fp == nullptr) {
+        return false;
+    }
+
+    BloomFilterFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = BloomFilterFileHeader::currentMagic;
+    header.status = status;
+    header.seqno = seqno;
+    header.keyCounter = keyCounter;
+    header.numBlocks = blocks.size();
+
+    bool rv = fwrite(&header, sizeof(header), 1, fp) == 1;
+    if (rv && !blocks.empty()) {
+        rv = fwrite(blocks.data(), sizeof(Block), blocks.size(), fp) ==
+             blocks.size();
+    }
+    if (fclose(fp) != 0) {
+        rv = false;
+    }
+    if (!rv) {
+        remove(fname.c_str());
+    }
+    return rv;
+}
+
+/**
+ * Does the rest of the file hold exactly the given number of blocks? The
+ * count comes from the file, so must be checked before it is used to size
+ * anything (a corrupt count could ask for any amount of memory).
+ * Leaves the file positioned where it was.
+ */
+static bool hasBlocks(FILE* fp, uint64_t numBlocks, size_t blockSize) {
+    const auto start = ftell(fp);
+    if (start < 0 || fseek(fp, 0, SEEK_END) != 0) {
+        return false;
+    }
+    const auto end = ftell(fp);
+    if (end < start || fseek(fp, start, SEEK_SET) != 0) {
+        return false;
+    }
+    const auto remaining = uint64_t(end - start);
+    return remaining % blockSize == 0 && remaining / blockSize == numBlocks;
+}
+
+std::unique_ptr<BloomFilter> BloomFilter::load(const std::string& fname,
+                                               uint64_t seqno) {
+    FILE* fp = fopen(fname.c_str(), "rb");
+    if (fp == nullptr) {
+        return {};
+    }
+
+    std::unique_ptr<BloomFilter> ret;
+    BloomFilterFileHeader header;
+    if (fread(&header, sizeof(header), 1, fp) == 1 &&
+        header.magic == BloomFilterFileHeader::currentMagic &&
+        header.status == BFILTER_ENABLED && header.seqno == seqno &&
+        header.numBlocks > 0 && hasBlocks(fp, header.numBlocks, sizeof(Block))) {
+        std::vector<Block> blocks(header.numBlocks);
+        if (fread(blocks.data(), sizeof(Block), blocks.size(), fp) ==
+                    blocks.size() &&
+            fgetc(fp) == EOF) {
+            ret.reset(new BloomFilter(
+                    std::move(blocks), header.keyCounter, BFILTER_ENABLED));
+        }
+    }
+    fclose(fp);
+    return ret;
+}
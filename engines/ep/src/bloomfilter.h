@@ -16,6 +16,9 @@
  */
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -33,6 +36,13 @@ enum bfilter_status_t {
  * We are to maintain the vbucket-number of these instances.
  *
  * Each vbucket will hold one such object.
+ *
+ * The filter is a split block bloom filter: the bit array is divided into
+ * 256-bit blocks (each within a single cache line) and a key only ever sets
+ * or tests bits in one block. A single 64-bit hash of the key selects the
+ * block (upper 32 bits) and one bit in each of the block's eight 32-bit
+ * words (lower 32 bits multiplied by a per-word salt), so a lookup costs one
+ * hash and one cache line, and the eight words are tested in lock-step.
  */
 class BloomFilter {
 public:
@@ -51,17 +61,74 @@ public:
     size_t getFilterSize();
     size_t getNoOfHashes() const;
 
+    /**
+     * Write the filter to the given file, tagged with the seqno the filter
+     * is known to be complete up to (the vBucket's persisted seqno).
+     *
+     * @return true if the file was written successfully
+     */
+    bool save(const std::string& fname, uint64_t seqno) const;
+
+    /**
+     * Read a filter previously written by save().
+     *
+     * @param fname the file to read
+     * @param seqno the seqno the caller expects the filter to have been
+     *        saved at; a filter saved at any other seqno is discarded as it
+     *        may not cover every key on disk.
+     * @return the loaded filter (with status BFILTER_ENABLED) or nullptr if
+     *         the file doesn't exist, is corrupt or is for another seqno.
+     */
+    static std::unique_ptr<BloomFilter> load(const std::string& fname,
+                                             uint64_t seqno);
+
 protected:
-    size_t estimateFilterSize(size_t key_count, double false_positive_prob);
-    size_t estimateNoOfHashes(size_t key_count);
+    /// Number of 32-bit words in a block, and hence bits set per key
+    static constexpr size_t wordsPerBlock = 8;
+    static constexpr size_t bitsPerBlock = wordsPerBlock * 32;
+
+    struct alignas(32) Block {
+        std::array<uint32_t, wordsPerBlock> words;
+    };
+
+    BloomFilter(std::vector<Block> blocks,
+                size_t keyCounter,
+                bfilter_status_t newStatus);
+
+    size_t estimateNoOfBlocks(size_t key_count, double false_positive_prob);
+
+    /// @return the expected false positive rate when the blocks hold on
+    ///         average keysPerBlock keys each
+    static double estimateFalsePositiveRate(double keysPerBlock);
+
+    uint64_t hashDocKey(const DocKey& key);
+
+    /// @return the block the given hash maps to
+    Block& getBlock(uint64_t hash);
+
+    /// @return the bit to set in each word of the block for the given hash
+    static Block makeMask(uint64_t hash);
 
-    uint64_t hashDocKey(const DocKey& key, uint32_t iteration);
+    /**
+     * The operations on a block, picked at runtime for the CPU (as for
+     * cb::json::Validator) as the build only targets the x86-64 baseline.
+     * add() sets the hash's bits in the block and returns true if any of
+     * them wasn't already set; contains() returns true if all of them are.
+     */
+    struct BlockOps {
+        bool (*add)(Block& block, uint64_t hash);
+        bool (*contains)(const Block& block, uint64_t hash);
+    };
 
-    size_t filterSize;
-    size_t noOfHashes;
+    static bool addToBlockScalar(Block& block, uint64_t hash);
+    static bool blockContainsScalar(const Block& block, uint64_t hash);
+    static bool addToBlockAVX2(Block& block, uint64_t hash);
+    static bool blockContainsAVX2(const Block& block, uint64_t hash);
+    static BlockOps selectBlockOps();
+    static const BlockOps& selectedBlockOps();
 
     size_t keyCounter;
 
     bfilter_status_t status;
-    std::vector<bool> bitArray;
+    std::vector<Block> blocks;
 };
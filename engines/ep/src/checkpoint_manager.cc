@@ -826,7 +826,38 @@ bool CheckpointManager::queueDirty(
         const GenerateCas generateCas,
         PreLinkDocumentContext* preLinkDocumentContext) {
     LockHolder lh(queueLock);
+    return queueDirty_UNLOCKED(
+            lh, vb, qi, generateBySeqno, generateCas, preLinkDocumentContext);
+}
+
+bool CheckpointManager::queueDirty(
+        CheckpointQueueBatch& batch,
+        VBucket& vb,
+        queued_item& qi,
+        const GenerateBySeqno generateBySeqno,
+        const GenerateCas generateCas,
+        PreLinkDocumentContext* preLinkDocumentContext) {
+    if (&batch.manager != this) {
+        throw std::invalid_argument(
+                "CheckpointManager::queueDirty(" + vbucketId.to_string() +
+                ") - batch belongs to a different CheckpointManager");
+    }
+    ++batch.numQueued;
+    return queueDirty_UNLOCKED(batch.lh,
+                               vb,
+                               qi,
+                               generateBySeqno,
+                               generateCas,
+                               preLinkDocumentContext);
+}
 
+bool CheckpointManager::queueDirty_UNLOCKED(
+        const LockHolder& lh,
+        VBucket& vb,
+        queued_item& qi,
+        const GenerateBySeqno generateBySeqno,
+        const GenerateCas generateCas,
+        PreLinkDocumentContext* preLinkDocumentContext) {
     bool canCreateNewCheckpoint = false;
     if (checkpointList.size() < checkpointConfig.getMaxCheckpoints() ||
         (checkpointList.size() == checkpointConfig.getMaxCheckpoints() &&
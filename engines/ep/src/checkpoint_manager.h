@@ -33,6 +33,7 @@
 class Checkpoint;
 class CheckpointConfig;
 class CheckpointCursor;
+class CheckpointQueueBatch;
 class EPStats;
 class PreLinkDocumentContext;
 class VBucket;
@@ -75,6 +76,7 @@ class CheckpointManager {
     friend class EventuallyPersistentEngine;
     friend class Consumer;
     friend class CheckpointManagerTestIntrospector;
+    friend class CheckpointQueueBatch;
 
 public:
     typedef std::shared_ptr<Callback<Vbid>> FlusherCallback;
@@ -235,6 +237,21 @@ public:
                     const GenerateCas generateCas,
                     PreLinkDocumentContext* preLinkDocumentContext);
 
+    /**
+     * Queue an item to be written to persistent layer, using the queueLock
+     * already held by the given batch (see CheckpointQueueBatch).
+     * Parameters and return value as for queueDirty() above.
+     *
+     * @throws std::invalid_argument if the batch was not created against
+     *         this CheckpointManager.
+     */
+    bool queueDirty(CheckpointQueueBatch& batch,
+                    VBucket& vb,
+                    queued_item& qi,
+                    const GenerateBySeqno generateBySeqno,
+                    const GenerateCas generateCas,
+                    PreLinkDocumentContext* preLinkDocumentContext);
+
     /*
      * Queue writing of the VBucket's state to persistent layer.
      * @param vb the vbucket that a new item is pushed into.
@@ -612,6 +629,13 @@ protected:
 
     bool isLastMutationItemInCheckpoint(CheckpointCursor &cursor);
 
+    bool queueDirty_UNLOCKED(const LockHolder& lh,
+                             VBucket& vb,
+                             queued_item& qi,
+                             const GenerateBySeqno generateBySeqno,
+                             const GenerateCas generateCas,
+                             PreLinkDocumentContext* preLinkDocumentContext);
+
     bool isCheckpointCreationForHighMemUsage_UNLOCKED(const LockHolder& lh,
                                                       const VBucket& vbucket);
 
@@ -671,3 +695,34 @@ protected:
 
 // Outputs a textual description of the CheckpointManager.
 std::ostream& operator<<(std::ostream& os, const CheckpointManager& m);
+
+/**
+ * RAII holder of a CheckpointManager's queueLock, allowing multiple items to
+ * be queued via CheckpointManager::queueDirty(batch, ...) with a single
+ * acquisition of the lock - e.g. when completing a batch of SyncWrites.
+ *
+ * Lock ordering is the same as for a single queueDirty(): any HashBucketLocks
+ * (and Ephemeral seqList locks) for the items must be acquired *before* the
+ * batch is created.
+ */
+class CheckpointQueueBatch {
+public:
+    explicit CheckpointQueueBatch(CheckpointManager& manager)
+        : manager(manager), lh(manager.queueLock) {
+    }
+
+    CheckpointQueueBatch(const CheckpointQueueBatch&) = delete;
+    CheckpointQueueBatch& operator=(const CheckpointQueueBatch&) = delete;
+
+    /// @returns the number of items queued under this batch so far.
+    size_t getNumQueued() const {
+        return numQueued;
+    }
+
+private:
+    friend class CheckpointManager;
+
+    CheckpointManager& manager;
+    LockHolder lh;
+    size_t numQueued = 0;
+};
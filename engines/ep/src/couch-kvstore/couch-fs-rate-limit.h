@@ -0,0 +1,94 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include <libcouchstore/couch_db.h>
+
+#include <chrono>
+
+class IORateLimiter;
+
+/**
+ * FileOpsInterface implementation which passes every operation through to
+ * another FileOpsInterface, but first accounts each write against an
+ * IORateLimiter (putting the writer to sleep if it's going too fast).
+ *
+ * Used by compaction so that rewriting vBucket files cannot saturate the
+ * disk at the expense of the flusher. Compaction runs on the AuxIO threads,
+ * so sleeping doesn't hold up the flusher's writer threads. File handles
+ * are those of the wrapped implementation.
+ */
+class RateLimitedOps : public FileOpsInterface {
+public:
+    RateLimitedOps(IORateLimiter& limiter, FileOpsInterface& ops)
+        : limiter(limiter), wrapped_ops(ops) {
+    }
+
+    couch_file_handle constructor(couchstore_error_info_t* errinfo) override;
+    couchstore_error_t open(couchstore_error_info_t* errinfo,
+                            couch_file_handle* handle,
+                            const char* path,
+                            int oflag) override;
+    couchstore_error_t close(couchstore_error_info_t* errinfo,
+                             couch_file_handle handle) override;
+    couchstore_error_t set_periodic_sync(couch_file_handle handle,
+                                         uint64_t period_bytes) override;
+    couchstore_error_t set_tracing_enabled(couch_file_handle handle) override;
+    couchstore_error_t set_write_validation_enabled(
+            couch_file_handle handle) override;
+    couchstore_error_t set_mprotect_enabled(couch_file_handle handle) override;
+
+    ssize_t pread(couchstore_error_info_t* errinfo,
+                  couch_file_handle handle,
+                  void* buf,
+                  size_t nbytes,
+                  cs_off_t offset) override;
+    ssize_t pwrite(couchstore_error_info_t* errinfo,
+                   couch_file_handle handle,
+                   const void* buf,
+                   size_t nbytes,
+                   cs_off_t offset) override;
+    cs_off_t goto_eof(couchstore_error_info_t* errinfo,
+                      couch_file_handle handle) override;
+    couchstore_error_t sync(couchstore_error_info_t* errinfo,
+                            couch_file_handle handle) override;
+    couchstore_error_t advise(couchstore_error_info_t* errinfo,
+                              couch_file_handle handle,
+                              cs_off_t offset,
+                              cs_off_t len,
+                              couchstore_file_advice_t advice) override;
+    FHStats* get_stats(couch_file_handle handle) override;
+    void destructor(couch_file_handle handle) override;
+
+    /// @return the number of bytes written through this instance
+    size_t getBytesWritten() const {
+        return bytesWritten;
+    }
+
+    /// @return the total time writers were made to sleep by the limiter
+    std::chrono::nanoseconds getThrottledTime() const {
+        return throttledTime;
+    }
+
+protected:
+    IORateLimiter& limiter;
+    FileOpsInterface& wrapped_ops;
+
+    size_t bytesWritten = 0;
+    std::chrono::nanoseconds throttledTime{0};
+};
@@ -19,6 +19,7 @@
 #include "bucket_logger.h"
 #include "collections/collection_persisted_stats.h"
 #include "couch-kvstore-config.h"
+#include "couch-kvstore/couch-fs-rate-limit.h"
 #include "diskdockey.h"
 #include "ep_time.h"
 #include "getkeys.h"
@@ -956,7 +957,24 @@ bool CouchKVStore::compactDBInternal(
         throw std::logic_error("CouchKVStore::compactDB: Cannot perform "
                         "on a read-only instance.");
     }
-    auto* def_iops = statCollectingFileOpsCompaction.get();
+    FileOpsInterface* def_iops = statCollectingFileOpsCompaction.get();
+
+    // Throttle the writes of the compacted file if the bucket asked us to,
+    // so that compaction doesn't starve the flusher of disk bandwidth.
+    std::unique_ptr<RateLimitedOps> rateLimitedOps;
+    if (hook_ctx->writeRateLimiter) {
+        rateLimitedOps = std::make_unique<RateLimitedOps>(
+                *hook_ctx->writeRateLimiter, *def_iops);
+        def_iops = rateLimitedOps.get();
+    }
+    auto recordWrites = gsl::finally([&rateLimitedOps, hook_ctx]() {
+        if (rateLimitedOps) {
+            hook_ctx->stats.bytesWritten = rateLimitedOps->getBytesWritten();
+            hook_ctx->stats.writeThrottledTime =
+                    rateLimitedOps->getThrottledTime();
+        }
+    });
+
     DbHolder compactdb(*this);
     DbHolder targetDb(*this);
     couchstore_error_t         errCode = COUCHSTORE_SUCCESS;
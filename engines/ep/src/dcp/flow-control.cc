@@ -21,8 +21,52 @@
 #include "dcp/flow-control-manager.h"
 #include "ep_engine.h"
 #include "ep_time.h"
+#include "executorpool.h"
+#include "globaltask.h"
+#include "kv_bucket.h"
+#include "mutation_throttle.h"
 #include "objectregistry.h"
 
+#include <phosphor/phosphor.h>
+
+/**
+ * Wakes a DCP consumer once the buffer ack it held back because of memory
+ * pressure may be sent, rather than waiting for it to next be stepped.
+ */
+class DcpAckThrottleNotification : public GlobalTask {
+public:
+    DcpAckThrottleNotification(EventuallyPersistentEngine& e,
+                               std::weak_ptr<DcpConsumer> consumer,
+                               std::chrono::nanoseconds delay)
+        : GlobalTask(&e,
+                     TaskId::DcpAckThrottleNotification,
+                     std::chrono::duration<double>(delay).count(),
+                     true /*completeBeforeShutdown*/),
+          consumer(std::move(consumer)) {
+    }
+
+    std::string getDescription() override {
+        return "Notify DCP consumer delayed by memory pressure";
+    }
+
+    std::chrono::microseconds maxExpectedDuration() override {
+        // Just notifies a single connection.
+        return std::chrono::milliseconds(1);
+    }
+
+    bool run() override {
+        TRACE_EVENT0("ep-engine/task", "DcpAckThrottleNotification");
+        auto conn = consumer.lock();
+        if (conn) {
+            conn->scheduleNotify();
+        }
+        return false;
+    }
+
+private:
+    const std::weak_ptr<DcpConsumer> consumer;
+};
+
 FlowControl::FlowControl(EventuallyPersistentEngine &engine,
                          DcpConsumer* consumer) :
     consumerConn(consumer),
@@ -60,20 +104,16 @@ ENGINE_ERROR_CODE FlowControl::handleFlowCtl(
             NonBucketAllocationGuard guard;
             ret = producers->control(opaque, controlMsgKey, buf_size);
             return ret;
-        } else if (isBufferSufficientlyDrained_UNLOCKED(ackable_bytes)) {
-            lh.unlock();
-            /* Send a buffer ack when at least 20% of the buffer is drained */
-            uint64_t opaque = consumerConn->incrOpaqueCounter();
-            ret = producers->buffer_acknowledgement(
-                    opaque, Vbid(0), ackable_bytes);
-            lastBufferAck = ep_current_time();
-            ackedBytes.fetch_add(ackable_bytes);
-            freedBytes.fetch_sub(ackable_bytes);
-            return ret;
-        } else if (ackable_bytes > 0 &&
-                   (ep_current_time() - lastBufferAck) > 5) {
+        } else if (isBufferSufficientlyDrained_UNLOCKED(ackable_bytes) ||
+                   (ackable_bytes > 0 &&
+                    (ep_current_time() - lastBufferAck) > 5)) {
             lh.unlock();
-            /* Ack at least every 5 seconds */
+            /* Send a buffer ack when at least 20% of the buffer is drained,
+               and at least every 5 seconds - unless memory pressure means
+               the producer should be held back for a while */
+            if (isAckDelayed(ackable_bytes)) {
+                return ENGINE_FAILED;
+            }
             uint64_t opaque = consumerConn->incrOpaqueCounter();
             ret = producers->buffer_acknowledgement(
                     opaque, Vbid(0), ackable_bytes);
@@ -88,6 +128,31 @@ ENGINE_ERROR_CODE FlowControl::handleFlowCtl(
     return ENGINE_FAILED;
 }
 
+bool FlowControl::isAckDelayed(uint32_t ackable_bytes) {
+    const auto now = std::chrono::steady_clock::now();
+    if (ackDelayedUntil) {
+        if (now < *ackDelayedUntil) {
+            return true;
+        }
+        ackDelayedUntil.reset();
+        return false;
+    }
+
+    auto& stats = engine_.getEpStats();
+    const auto delay = engine_.getKVBucket()->getMutationThrottle().getDelay(
+            ackable_bytes, stats.replicationThrottleThreshold, now);
+    if (delay.count() == 0) {
+        return false;
+    }
+    stats.dcpAckThrottleDelayTime +=
+            std::chrono::duration_cast<std::chrono::microseconds>(delay)
+                    .count();
+    ackDelayedUntil = now + delay;
+    ExecutorPool::get()->schedule(std::make_shared<DcpAckThrottleNotification>(
+            engine_, consumerConn->weak_from_this(), delay));
+    return true;
+}
+
 void FlowControl::incrFreedBytes(uint32_t bytes)
 {
     freedBytes.fetch_add(bytes);
@@ -21,6 +21,9 @@
 
 #include <relaxed_atomic.h>
 
+#include <chrono>
+#include <optional>
+
 class DcpConsumer;
 class EventuallyPersistentEngine;
 
@@ -58,6 +61,14 @@ private:
 
     bool isBufferSufficientlyDrained_UNLOCKED(uint32_t ackable_bytes);
 
+    /**
+     * Should acking the given bytes be held back (to pace the producer)
+     * because of memory pressure? Once an ack has been delayed it's held
+     * back until the delay has passed, when the consumer is notified so
+     * that it's sent.
+     */
+    bool isAckDelayed(uint32_t ackable_bytes);
+
     /* Associated consumer connection handler */
     DcpConsumer* consumerConn;
 
@@ -85,4 +96,7 @@ private:
 
     /* Bytes processed from the flow control buffer */
     std::atomic<uint64_t> freedBytes;
+
+    /* When a buffer ack delayed by memory pressure may be sent */
+    std::optional<std::chrono::steady_clock::time_point> ackDelayedUntil;
 };
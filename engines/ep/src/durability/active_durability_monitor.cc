@@ -435,24 +435,31 @@ void ActiveDurabilityMonitor::checkForResolvedSyncWrites() {
 void ActiveDurabilityMonitor::processCompletedSyncWriteQueue() {
     std::lock_guard<ResolvedQueue::ConsumerLock> lock(
             resolvedQueue->getConsumerLock());
-    while (auto sw = resolvedQueue->try_dequeue(lock)) {
-        switch (sw->getStatus()) {
-        case SyncWriteStatus::Pending:
-        case SyncWriteStatus::Completed:
-            throw std::logic_error(
-                    "ActiveDurabilityMonitor::processCompletedSyncWriteQueue "
-                    "found a SyncWrite with unexpected state: " +
-                    to_string(sw->getStatus()));
-            continue;
-        case SyncWriteStatus::ToCommit:
-            commit(*sw);
-            continue;
-        case SyncWriteStatus::ToAbort:
-            abort(*sw);
-            continue;
+    std::vector<ActiveSyncWrite> batch;
+    do {
+        batch.clear();
+        while (batch.size() < maxCompletionBatchSize) {
+            auto sw = resolvedQueue->try_dequeue(lock);
+            if (!sw) {
+                break;
+            }
+            switch (sw->getStatus()) {
+            case SyncWriteStatus::Pending:
+            case SyncWriteStatus::Completed:
+                throw std::logic_error(
+                        "ActiveDurabilityMonitor::"
+                        "processCompletedSyncWriteQueue "
+                        "found a SyncWrite with unexpected state: " +
+                        to_string(sw->getStatus()));
+            case SyncWriteStatus::ToCommit:
+            case SyncWriteStatus::ToAbort:
+                batch.push_back(std::move(*sw));
+                continue;
+            }
+            folly::assume_unreachable();
         }
-        folly::assume_unreachable();
-    };
+        completeBatch(batch);
+    } while (batch.size() == maxCompletionBatchSize);
 }
 
 void ActiveDurabilityMonitor::unresolveCompletedSyncWriteQueue() {
@@ -816,83 +823,89 @@ ActiveDurabilityMonitor::State::removeSyncWrite(Container::iterator it,
     return std::move(removed.front());
 }
 
-void ActiveDurabilityMonitor::commit(const ActiveSyncWrite& sw) {
-    const auto& key = sw.getKey();
-    auto cHandle = vb.lockCollections(key);
-
-    if (!cHandle.valid()) {
-        // collection no longer exists, cannot commit
-        vb.notifyClientOfSyncWriteComplete(sw.getCookie(),
-                                           ENGINE_SYNC_WRITE_AMBIGUOUS);
+void ActiveDurabilityMonitor::completeBatch(
+        const std::vector<ActiveSyncWrite>& batch) {
+    if (batch.empty()) {
         return;
     }
 
+    using Resolution = VBucket::SyncWriteCompletion::Resolution;
+    std::vector<VBucket::SyncWriteCompletion> completions;
+    completions.reserve(batch.size());
+
     const auto prepareEnd = std::chrono::steady_clock::now();
-    auto* cookie = sw.getCookie();
-    if (cookie) {
-        // Record a Span for the prepare phase duration. We do this before
-        // actually calling VBucket::commit() as we want to add a TraceSpan to
-        // the cookie before the response to the client is actually sent (and we
-        // report the end of the request), which is done within
-        // VBucket::commit().
-        TracerStopwatch prepareDuration(cookie,
-                                        cb::tracing::Code::SyncWritePrepare);
-        prepareDuration.start(sw.getStartTime());
-        prepareDuration.stop(prepareEnd);
-    }
-    auto result = vb.commit(key,
-                            sw.getBySeqno() /*prepareSeqno*/,
-                            {} /*commitSeqno*/,
-                            cHandle,
-                            sw.getCookie());
-    if (result != ENGINE_SUCCESS) {
-        throwException<std::logic_error>(
-                __func__, "failed with status:" + std::to_string(result));
+    for (const auto& sw : batch) {
+        const auto toCommit = sw.getStatus() == SyncWriteStatus::ToCommit;
+        auto* cookie = sw.getCookie();
+        if (toCommit && cookie) {
+            // Record a Span for the prepare phase duration. We do this before
+            // actually completing the batch as we want to add a TraceSpan to
+            // the cookie before the response to the client is actually sent
+            // (and we report the end of the request), which is done within
+            // VBucket::completeSyncWrites().
+            TracerStopwatch prepareDuration(
+                    cookie, cb::tracing::Code::SyncWritePrepare);
+            prepareDuration.start(sw.getStartTime());
+            prepareDuration.stop(prepareEnd);
+        }
+        completions.emplace_back(sw.getKey(),
+                                 sw.getBySeqno() /*prepareSeqno*/,
+                                 toCommit ? Resolution::Commit
+                                          : Resolution::Abort,
+                                 cookie);
     }
 
-    // Record the duration of the SyncWrite in histogram.
-    const auto index = size_t(sw.getDurabilityReqs().getLevel()) - 1;
-    const auto commitDuration =
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                    prepareEnd - sw.getStartTime());
-    stats.syncWriteCommitTimes.at(index).add(commitDuration);
+    vb.completeSyncWrites(completions);
 
-    {
-        auto s = state.wlock();
-        s->lastCommittedSeqno = sw.getBySeqno();
-        s->updateHighCompletedSeqno();
-        s->totalCommitted++;
-        // Note:
-        // - Level Majority locally-satisfied first at Active by-logic
-        // - Level MajorityAndPersistOnMaster and PersistToMajority must always
-        //     include the Active for being globally satisfied
-        Ensures(s->lastCommittedSeqno <= s->highPreparedSeqno);
-    }
-}
-
-void ActiveDurabilityMonitor::abort(const ActiveSyncWrite& sw) {
-    const auto& key = sw.getKey();
-
-    auto cHandle = vb.lockCollections(key);
-    if (cHandle.valid()) {
-        auto result = vb.abort(key,
-                               sw.getBySeqno() /*prepareSeqno*/,
-                               {} /*abortSeqno*/,
-                               cHandle,
-                               sw.getCookie());
-        if (result != ENGINE_SUCCESS) {
-            throwException<std::logic_error>(
-                    __func__, "failed with status:" + std::to_string(result));
+    auto s = state.wlock();
+    for (size_t i = 0; i < batch.size(); ++i) {
+        const auto& sw = batch[i];
+        const auto& completion = completions[i];
+
+        if (completion.resolution == Resolution::Commit) {
+            if (completion.status == ENGINE_UNKNOWN_COLLECTION) {
+                // collection no longer exists, cannot commit (client has
+                // been notified that the SyncWrite is ambiguous)
+                continue;
+            }
+            if (completion.status != ENGINE_SUCCESS) {
+                throwException<std::logic_error>(
+                        "commit",
+                        "failed with status:" +
+                                std::to_string(completion.status));
+            }
+
+            // Record the duration of the SyncWrite in histogram.
+            const auto index =
+                    size_t(sw.getDurabilityReqs().getLevel()) - 1;
+            const auto commitDuration =
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                            prepareEnd - sw.getStartTime());
+            stats.syncWriteCommitTimes.at(index).add(commitDuration);
+
+            s->lastCommittedSeqno = sw.getBySeqno();
+            s->updateHighCompletedSeqno();
+            s->totalCommitted++;
+            // Note:
+            // - Level Majority locally-satisfied first at Active by-logic
+            // - Level MajorityAndPersistOnMaster and PersistToMajority must
+            //     always include the Active for being globally satisfied
+            Ensures(s->lastCommittedSeqno <= s->highPreparedSeqno);
+        } else {
+            // If the collection no longer exists we don't generate an abort,
+            // but the SyncWrite is still considered completed.
+            if (completion.status != ENGINE_SUCCESS &&
+                completion.status != ENGINE_UNKNOWN_COLLECTION) {
+                throwException<std::logic_error>(
+                        "abort",
+                        "failed with status:" +
+                                std::to_string(completion.status));
+            }
+            s->lastAbortedSeqno = sw.getBySeqno();
+            s->updateHighCompletedSeqno();
+            s->totalAborted++;
         }
-    } else {
-        // collection no longer exists, don't generate an abort
-        vb.notifyClientOfSyncWriteComplete(sw.getCookie(),
-                                           ENGINE_SYNC_WRITE_AMBIGUOUS);
     }
-    auto s = state.wlock();
-    s->lastAbortedSeqno = sw.getBySeqno();
-    s->updateHighCompletedSeqno();
-    s->totalAborted++;
 }
 
 void ActiveDurabilityMonitor::eraseSyncWrite(const DocKey& key, int64_t seqno) {
@@ -360,18 +360,13 @@ protected:
                                      const std::string& error) const;
 
     /**
-     * Commit the given SyncWrite.
+     * Commit / abort (as per their status) the given batch of resolved
+     * SyncWrites via VBucket::completeSyncWrites(), then update the
+     * completed-seqno tracking for them.
      *
-     * @param sw The SyncWrite to commit
+     * @param batch The SyncWrites to complete, in prepare seqno order
      */
-    void commit(const ActiveSyncWrite& sw);
-
-    /**
-     * Abort the given SyncWrite.
-     *
-     * @param sw The SyncWrite to abort
-     */
-    void abort(const ActiveSyncWrite& sw);
+    void completeBatch(const std::vector<ActiveSyncWrite>& batch);
 
     /**
      * Test only (for now; shortly this will be probably needed at rollback).
@@ -438,14 +433,17 @@ protected:
      * VBucket.
      *
      * Uses unique_ptr for pimpl.
-     * @todo-perf: Consider performing the processing of the queue in a
-     * background task, moving the work from the "frontend" DCP thread.
      */
     std::unique_ptr<ResolvedQueue> resolvedQueue;
 
     // Maximum number of replicas which can be specified in topology.
     static const size_t maxReplicas = 3;
 
+    // Maximum number of resolved SyncWrites completed in a single batch by
+    // processCompletedSyncWriteQueue(); bounds how many HashBucketLocks are
+    // held (and for how long the CheckpointManager queueLock is held).
+    static const size_t maxCompletionBatchSize = 256;
+
     // Necessary for implementing PDM(ADM&&)
     friend class PassiveDurabilityMonitor;
 
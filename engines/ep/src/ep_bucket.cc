@@ -45,7 +45,9 @@
 
 #include <gsl.h>
 
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 /**
  * Callback class used by EpStore, for adding relevant keys
@@ -227,6 +229,10 @@ public:
             bucket.setAccessScannerSleeptime(value, false);
         } else if (key == "alog_task_time") {
             bucket.resetAccessScannerStartTime();
+        } else if (key == "compaction_max_concurrency") {
+            bucket.setCompactionMaxConcurrency(value);
+        } else if (key == "compaction_write_rate_limit") {
+            bucket.setCompactionWriteRateLimit(value);
         } else {
             EP_LOG_WARN("Failed to change value for unknown variable, {}", key);
         }
@@ -274,6 +280,16 @@ EPBucket::EPBucket(EventuallyPersistentEngine& theEngine)
             "retain_erroneous_tombstones",
             std::make_unique<ValueChangedListener>(*this));
 
+    compactionMaxConcurrency = config.getCompactionMaxConcurrency();
+    config.addValueChangedListener(
+            "compaction_max_concurrency",
+            std::make_unique<ValueChangedListener>(*this));
+
+    compactionWriteRateLimiter.setRate(config.getCompactionWriteRateLimit());
+    config.addValueChangedListener(
+            "compaction_write_rate_limit",
+            std::make_unique<ValueChangedListener>(*this));
+
     initializeWarmupTask();
 }
 
@@ -312,9 +328,61 @@ std::vector<ExTask> EPBucket::deinitialize() {
     stopFlusher();
     stopBgFetcher();
     stopWarmup();
+    if (!stats.forceShutdown) {
+        saveBloomFilters();
+    }
     return KVBucket::deinitialize();
 }
 
+std::string EPBucket::getBloomFilterFileName(Vbid vbid) {
+    const auto* store = vbMap.getShardByVbId(vbid)->getROUnderlying();
+    return store->getConfig().getDBName() + "/" + std::to_string(vbid.get()) +
+           ".bloomfilter";
+}
+
+/**
+ * Adds every key held in the HashTable to the vBucket's bloom filter. Under
+ * full eviction the filter only tracks keys which are not resident, but after
+ * a restart none of them are resident any more.
+ */
+class AddResidentKeysToFilterVisitor : public HashTableVisitor {
+public:
+    explicit AddResidentKeysToFilterVisitor(VBucket& vb) : vb(vb) {
+    }
+
+    bool visit(const HashTable::HashBucketLock& lh, StoredValue& v) override {
+        if (!v.isTempItem()) {
+            vb.addToFilter(v.getKey());
+        }
+        return true;
+    }
+
+private:
+    VBucket& vb;
+};
+
+void EPBucket::saveBloomFilters() {
+    if (!engine.getConfiguration().isBfilterEnabled()) {
+        return;
+    }
+
+    size_t saved = 0;
+    for (auto vbid : vbMap.getBuckets()) {
+        auto vb = getVBucket(vbid);
+        if (!vb) {
+            continue;
+        }
+        if (getItemEvictionPolicy() == EvictionPolicy::Full) {
+            AddResidentKeysToFilterVisitor visitor(*vb);
+            vb->ht.visit(visitor);
+        }
+        if (vb->saveFilter(getBloomFilterFileName(vbid))) {
+            ++saved;
+        }
+    }
+    EP_LOG_INFO("EPBucket::saveBloomFilters: saved {} bloom filter(s)", saved);
+}
+
 /**
  * @returns true if the item `candidate` can be de-duplicated (skipped) because
  * `lastFlushed` already supercedes it.
@@ -346,6 +414,7 @@ EPBucket::FlushResult EPBucket::flushVBucket(Vbid vbid) {
     auto vb = getLockedVBucket(vbid, std::try_to_lock);
     if (!vb.owns_lock()) {
         // Try another bucket if this one is locked to avoid blocking flusher.
+        ++stats.flusherStalls;
         return {MoreAvailable::Yes, 0, WakeCkptRemover::No};
     }
 
@@ -984,16 +1053,12 @@ ENGINE_ERROR_CODE EPBucket::scheduleCompaction(Vbid vbid,
     LockHolder lh(compactionLock);
     ExTask task = std::make_shared<CompactTask>(
             *this, c, vb->getPurgeSeqno(), cookie);
-    compactionTasks.push_back(std::make_pair(c.db_file_id, task));
-    if (compactionTasks.size() > 1) {
-        if ((stats.diskQueueSize > compactionWriteQueueCap &&
-             compactionTasks.size() > (vbMap.getNumShards() / 2)) ||
-            engine.getWorkLoadPolicy().getWorkLoadPattern() == READ_HEAVY) {
-            // Snooze a new compaction task.
-            // We will wake it up when one of the existing compaction tasks is
-            // done.
-            task->snooze(60);
-        }
+    compactionTasks.emplace_back(c.db_file_id, task);
+    if (compactionTasks.size() > 1 && isCompactionDeferred(lh)) {
+        // Snooze a new compaction task.
+        // We will wake it up when one of the existing compaction tasks is
+        // done.
+        task->snooze(60);
     }
 
     ExecutorPool::get()->schedule(task);
@@ -1012,8 +1077,8 @@ ENGINE_ERROR_CODE EPBucket::scheduleCompaction(Vbid vbid,
 
 ENGINE_ERROR_CODE EPBucket::cancelCompaction(Vbid vbid) {
     LockHolder lh(compactionLock);
-    for (const auto& task : compactionTasks) {
-        task.second->cancel();
+    for (const auto& entry : compactionTasks) {
+        entry.task->cancel();
     }
     return ENGINE_SUCCESS;
 }
@@ -1121,6 +1186,8 @@ std::shared_ptr<compaction_ctx> EPBucket::makeCompactionContext(
                                         this,
                                         std::placeholders::_1);
 
+    ctx->writeRateLimiter = &compactionWriteRateLimiter;
+
     return ctx;
 }
 
@@ -1140,7 +1207,17 @@ void EPBucket::compactInternal(CompactionConfig& config, uint64_t purgeSeqno) {
 
     KVShard* shard = vbMap.getShardByVbId(config.db_file_id);
     KVStore* store = shard->getRWUnderlying();
+    const auto start = std::chrono::steady_clock::now();
     bool result = store->compactDB(ctx);
+    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+
+    stats.compactionBytesWritten += ctx->stats.bytesWritten;
+    stats.compactionDuration += duration.count();
+    stats.compactionWriteThrottledTime +=
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                    ctx->stats.writeThrottledTime)
+                    .count();
 
     VBucketPtr vb = getVBucket(config.db_file_id);
     if (vb) {
@@ -1156,7 +1233,8 @@ void EPBucket::compactInternal(CompactionConfig& config, uint64_t purgeSeqno) {
             "purged tombstones:{}, prepares:{}, "
             "collection_items_erased:alive:{},deleted:{}, "
             "size/items/tombstones/purge_seqno pre{{{}, {}, {}, {}}}, "
-            "post{{{}, {}, {}, {}}}",
+            "post{{{}, {}, {}, {}}}, "
+            "took:{}ms, written:{} bytes, throttled:{}ms",
             config.db_file_id,
             result ? "ok" : "failed",
             ctx->stats.tombstonesPurged,
@@ -1170,7 +1248,12 @@ void EPBucket::compactInternal(CompactionConfig& config, uint64_t purgeSeqno) {
             ctx->stats.post.size,
             ctx->stats.post.items,
             ctx->stats.post.deletedItems,
-            ctx->stats.post.purgeSeqno);
+            ctx->stats.post.purgeSeqno,
+            duration.count() / 1000,
+            ctx->stats.bytesWritten,
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                    ctx->stats.writeThrottledTime)
+                    .count());
 }
 
 bool EPBucket::doCompact(CompactionConfig& config,
@@ -1223,24 +1306,131 @@ bool EPBucket::doCompact(CompactionConfig& config,
 
 void EPBucket::updateCompactionTasks(Vbid db_file_id) {
     LockHolder lh(compactionLock);
-    bool erased = false, woke = false;
-    auto it = compactionTasks.begin();
-    while (it != compactionTasks.end()) {
-        if ((*it).first == db_file_id) {
-            it = compactionTasks.erase(it);
-            erased = true;
-        } else {
-            ExTask& task = (*it).second;
-            if (task->getState() == TASK_SNOOZED) {
-                ExecutorPool::get()->wake(task->getId());
-                woke = true;
+    compactionTasks.remove_if([db_file_id](const CompTaskEntry& entry) {
+        return entry.vbid == db_file_id;
+    });
+    wakeCompactionTasks(lh);
+}
+
+bool EPBucket::isCompactionDeferred(const LockHolder&) const {
+    return (stats.diskQueueSize > compactionWriteQueueCap &&
+            compactionTasks.size() > (vbMap.getNumShards() / 2)) ||
+           engine.getWorkLoadPolicy().getWorkLoadPattern() == READ_HEAVY;
+}
+
+void EPBucket::wakeCompactionTasks(const LockHolder& lh) {
+    size_t running = 0;
+    std::vector<const CompTaskEntry*> waiting;
+    for (const auto& entry : compactionTasks) {
+        if (entry.running) {
+            ++running;
+        } else if (entry.task->getState() == TASK_SNOOZED) {
+            waiting.push_back(&entry);
+        }
+    }
+
+    const size_t maxConcurrency = compactionMaxConcurrency;
+    size_t toWake = running < maxConcurrency ? maxConcurrency - running : 0;
+    if (isCompactionDeferred(lh)) {
+        // New compactions are held back (see scheduleCompaction); only let
+        // one through each time a compaction completes.
+        toWake = std::min(toWake, size_t(1));
+    }
+    toWake = std::min(toWake, waiting.size());
+
+    // Tasks which have not yet been measured (fragmentation < 0) rank below
+    // every measured one; ties go to the oldest task.
+    std::stable_sort(waiting.begin(),
+                     waiting.end(),
+                     [](const CompTaskEntry* a, const CompTaskEntry* b) {
+                         return a->fragmentation > b->fragmentation;
+                     });
+    for (size_t ii = 0; ii < toWake; ++ii) {
+        ExecutorPool::get()->wake(waiting[ii]->task->getId());
+    }
+}
+
+double EPBucket::getFileFragmentation(Vbid vbid) {
+    try {
+        auto* store = vbMap.getShardByVbId(vbid)->getRWUnderlying();
+        const auto info = store->getDbFileInfo(vbid);
+        if (info.fileSize == 0 || info.spaceUsed >= info.fileSize) {
+            return 0;
+        }
+        return 1.0 - (double(info.spaceUsed) / info.fileSize);
+    } catch (const std::exception& e) {
+        EP_LOG_WARN(
+                "EPBucket::getFileFragmentation: Failed to get file info "
+                "for {}: {}",
+                vbid,
+                e.what());
+        return 0;
+    }
+}
+
+bool EPBucket::acquireCompactionSlot(GlobalTask& task, Vbid vbid) {
+    // Only read the file info the first time the task runs; it is a disk
+    // access so it's done outside of compactionLock.
+    double fragmentation = -1;
+    {
+        LockHolder lh(compactionLock);
+        for (const auto& entry : compactionTasks) {
+            if (entry.task.get() == &task) {
+                fragmentation = entry.fragmentation;
+                break;
             }
-            ++it;
         }
-        if (erased && woke) {
-            break;
+    }
+    if (fragmentation < 0) {
+        fragmentation = getFileFragmentation(vbid);
+    }
+
+    LockHolder lh(compactionLock);
+    auto self = std::find_if(
+            compactionTasks.begin(),
+            compactionTasks.end(),
+            [&task](const CompTaskEntry& e) { return e.task.get() == &task; });
+    if (self == compactionTasks.end() || self->running) {
+        // Not tracked (shouldn't happen) or already holds a slot (e.g. it
+        // is retrying after finding the vBucket locked).
+        return true;
+    }
+    self->fragmentation = fragmentation;
+
+    size_t running = 0;
+    for (const auto& entry : compactionTasks) {
+        if (entry.running) {
+            ++running;
         }
     }
+    if (running >= compactionMaxConcurrency) {
+        // Wait for a running compaction to complete; updateCompactionTasks
+        // will wake us (or a more fragmented vBucket's task) then.
+        task.snooze(60);
+        return false;
+    }
+
+    self->running = true;
+    // Let the waiting tasks (the most fragmented first) claim any remaining
+    // slots, unless new compactions are being held back.
+    if (!isCompactionDeferred(lh)) {
+        wakeCompactionTasks(lh);
+    }
+    return true;
+}
+
+void EPBucket::setCompactionMaxConcurrency(size_t value) {
+    const auto previous = compactionMaxConcurrency.exchange(value);
+    if (value <= previous) {
+        return;
+    }
+    // More slots available - let the waiting tasks try to claim them.
+    LockHolder lh(compactionLock);
+    wakeCompactionTasks(lh);
+}
+
+void EPBucket::setCompactionWriteRateLimit(size_t bytesPerSec) {
+    compactionWriteRateLimiter.setRate(bytesPerSec);
 }
 
 std::pair<uint64_t, bool> EPBucket::getLastPersistedCheckpointId(Vbid vb) {
@@ -1986,8 +2176,9 @@ void EPBucket::warmupCompleted() {
 }
 
 void EPBucket::stopWarmup() {
-    // forcefully stop current warmup task
-    if (isWarmingUp()) {
+    // forcefully stop current warmup task (including any values still being
+    // loaded in the background by an online warmup)
+    if (isWarmingUp() || (warmupTask && warmupTask->isBackgroundLoading())) {
         EP_LOG_INFO(
                 "Stopping warmup while engine is loading "
                 "data from underlying storage, shutdown = {}",
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "io_rate_limiter.h"
 #include "kv_bucket.h"
 
 namespace VB {
@@ -108,12 +109,35 @@ public:
     /// Stops the background fetcher for each shard.
     void stopBgFetcher();
 
+    /**
+     * @return the file the bloom filter of the given vBucket is saved to
+     *         on shutdown (next to the vBucket's data file).
+     */
+    std::string getBloomFilterFileName(Vbid vbid);
+
     ENGINE_ERROR_CODE scheduleCompaction(Vbid vbid,
                                          const CompactionConfig& c,
                                          const void* ck) override;
 
     ENGINE_ERROR_CODE cancelCompaction(Vbid vbid) override;
 
+    /**
+     * Called by a CompactTask before it compacts. Grants the task one of the
+     * compaction_max_concurrency slots if one is free (waking the waiting
+     * tasks with the most fragmented files to claim any others). Otherwise
+     * the task is snoozed until a running compaction completes and wakes the
+     * next best task(s).
+     *
+     * @param task the calling task
+     * @param vbid the vBucket the task compacts
+     * @return true if the task may compact now
+     */
+    bool acquireCompactionSlot(GlobalTask& task, Vbid vbid);
+
+    void setCompactionMaxConcurrency(size_t value);
+
+    void setCompactionWriteRateLimit(size_t bytesPerSec);
+
     /**
      * Compaction of a database file
      *
@@ -251,14 +275,39 @@ protected:
     void compactionCompletionCallback(compaction_ctx& ctx);
 
     /**
-     * Remove completed compaction tasks or wake snoozed tasks
+     * Remove the completed compaction task(s) of the given vBucket, freeing
+     * their compaction slot, and wake the waiting task(s) with the most
+     * fragmented file.
      *
      * @param db_file_id vbucket id for couchstore
      */
     void updateCompactionTasks(Vbid db_file_id);
 
+    /**
+     * Should new compactions be held back, as the disk write queue is large
+     * or the workload is read heavy?
+     */
+    bool isCompactionDeferred(const LockHolder& lh) const;
+
+    /**
+     * Wake the waiting (snoozed) compaction tasks with the most fragmented
+     * files; one per free compaction slot, or at most one if compactions
+     * are being held back (see isCompactionDeferred).
+     */
+    void wakeCompactionTasks(const LockHolder& lh);
+
+    /// @return the fraction (0-1) of the vBucket's file which is stale
+    double getFileFragmentation(Vbid vbid);
+
     void stopWarmup();
 
+    /**
+     * Save the bloom filter of every vBucket so that warmup can load them
+     * instead of running without filters until the next compaction. Only
+     * valid once the flusher has persisted everything (clean shutdown).
+     */
+    void saveBloomFilters();
+
     /// function which is passed down to compactor for dropping keys
     void dropKey(Vbid vbid,
                  const DiskDocKey& key,
@@ -321,6 +370,13 @@ protected:
      */
     cb::RelaxedAtomic<bool> retainErroneousTombstones;
 
+    /// Number of compactions allowed to run at the same time
+    std::atomic<size_t> compactionMaxConcurrency;
+
+    /// Limits the rate at which compaction writes to disk (shared by all of
+    /// the bucket's compactions)
+    IORateLimiter compactionWriteRateLimiter;
+
     std::unique_ptr<Warmup> warmupTask;
 };
 
@@ -43,6 +43,7 @@
 #include "hash_table_stat_visitor.h"
 #include "htresizer.h"
 #include "kvstore.h"
+#include "mutation_throttle.h"
 #include "replicationthrottle.h"
 #include "server_document_iface_border_guard.h"
 #include "stats-info.h"
@@ -580,6 +581,10 @@ cb::mcbp::Status EventuallyPersistentEngine::setFlushParam(
             getConfiguration().setDurabilityMinLevel(val);
         } else if (key == "mutation_mem_threshold") {
             getConfiguration().setMutationMemThreshold(std::stoull(val));
+        } else if (key == "mutation_throttle_enabled") {
+            getConfiguration().setMutationThrottleEnabled(cb_stob(val));
+        } else if (key == "mutation_throttle_max_delay_ms") {
+            getConfiguration().setMutationThrottleMaxDelayMs(std::stoull(val));
         } else if (key == "timing_log") {
             EPStats& stats = getEpStats();
             std::ostream* old = stats.timingLog;
@@ -608,6 +613,10 @@ cb::mcbp::Status EventuallyPersistentEngine::setFlushParam(
             getConfiguration().setExpPagerInitialRunTime(std::stoll(val));
         } else if (key == "flusher_total_batch_limit") {
             getConfiguration().setFlusherTotalBatchLimit(std::stoll(val));
+        } else if (key == "compaction_max_concurrency") {
+            getConfiguration().setCompactionMaxConcurrency(std::stoull(val));
+        } else if (key == "compaction_write_rate_limit") {
+            getConfiguration().setCompactionWriteRateLimit(std::stoull(val));
         } else if (key == "getl_default_timeout") {
             getConfiguration().setGetlDefaultTimeout(std::stoull(val));
         } else if (key == "getl_max_timeout") {
@@ -654,6 +663,8 @@ cb::mcbp::Status EventuallyPersistentEngine::setFlushParam(
             getConfiguration().setWarmupMinMemoryThreshold(std::stoull(val));
         } else if (key == "warmup_min_items_threshold") {
             getConfiguration().setWarmupMinItemsThreshold(std::stoull(val));
+        } else if (key == "warmup_online_throttle_ms") {
+            getConfiguration().setWarmupOnlineThrottleMs(std::stoull(val));
         } else if (key == "num_reader_threads") {
             ssize_t value = std::stoll(val);
             getConfiguration().setNumReaderThreads(value);
@@ -2053,8 +2064,12 @@ void EventuallyPersistentEngine::setUnknownCollectionErrorContext(
 template <typename T>
 void EventuallyPersistentEngine::notifyIOComplete(T cookies,
                                                   ENGINE_ERROR_CODE status) {
-    NonBucketAllocationGuard guard;
     for (auto& cookie : cookies) {
+        if (status != ENGINE_SUCCESS && kvBucket) {
+            // The command fails without being retried.
+            kvBucket->getMutationThrottle().mutationComplete(cookie);
+        }
+        NonBucketAllocationGuard guard;
         serverApi->cookie->notify_io_complete(cookie, status);
     }
 }
@@ -2582,6 +2597,33 @@ cb::EngineErrorCasPair EventuallyPersistentEngine::storeIfInner(
         }
     }
 
+    // Pace the mutation if memory usage is approaching the mutation
+    // threshold. If it has already been delayed it's now its turn (and it
+    // isn't delayed again if it then blocks, e.g. on a background fetch).
+    // A non-null engineSpecific is a SyncWrite which has already been
+    // admitted.
+    auto& throttle = kvBucket->getMutationThrottle();
+    const bool delayed = throttle.isDelayed(cookie);
+    if (!delayed && getEngineSpecific(cookie) == nullptr &&
+        throttle.delayMutation(cookie, item.size())) {
+        return {cb::engine_errc::would_block, 0};
+    }
+
+    auto rv = storeIfUnthrottled(
+            cookie, item, cas, operation, predicate, preserveTtl);
+    if (delayed && rv.status != cb::engine_errc::would_block) {
+        throttle.mutationComplete(cookie);
+    }
+    return rv;
+}
+
+cb::EngineErrorCasPair EventuallyPersistentEngine::storeIfUnthrottled(
+        const void* cookie,
+        Item& item,
+        uint64_t cas,
+        ENGINE_STORE_OPERATION operation,
+        const cb::StoreIfPredicate& predicate,
+        bool preserveTtl) {
     // Check if this is a in-progress durable store which has now completed -
     // (see 'case EWOULDBLOCK' at the end of this function where we record
     // the fact we must block the client until the SyncWrite is durable).
@@ -2786,6 +2828,26 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doEngineStats(
                         VBucket::getCheckpointFlushTimeout().count(),
                         add_stat,
                         cookie);
+        add_casted_stat(
+                "ep_flusher_stalls", epstats.flusherStalls, add_stat, cookie);
+
+        const size_t compactionBytes = epstats.compactionBytesWritten;
+        const size_t compactionDuration = epstats.compactionDuration;
+        add_casted_stat("ep_compaction_bytes_written",
+                        compactionBytes,
+                        add_stat,
+                        cookie);
+        add_casted_stat("ep_compaction_bytes_per_sec",
+                        compactionDuration
+                                ? uint64_t(compactionBytes * 1000000.0 /
+                                           compactionDuration)
+                                : 0,
+                        add_stat,
+                        cookie);
+        add_casted_stat("ep_compaction_write_throttled_us",
+                        epstats.compactionWriteThrottledTime,
+                        add_stat,
+                        cookie);
     }
     add_casted_stat("ep_vbucket_del",
                     epstats.vbucketDeletions, add_stat, cookie);
@@ -2842,6 +2904,18 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doEngineStats(
     add_casted_stat("ep_oom_errors", stats.oom_errors, add_stat, cookie);
     add_casted_stat(
             "ep_tmp_oom_errors", stats.tmp_oom_errors, add_stat, cookie);
+    add_casted_stat("ep_mutation_throttle_delayed",
+                    stats.mutationThrottleDelayed,
+                    add_stat,
+                    cookie);
+    add_casted_stat("ep_mutation_throttle_delay_us",
+                    stats.mutationThrottleDelayTime,
+                    add_stat,
+                    cookie);
+    add_casted_stat("ep_dcp_ack_throttle_delay_us",
+                    stats.dcpAckThrottleDelayTime,
+                    add_stat,
+                    cookie);
     add_casted_stat("ep_mem_tracker_enabled",
                     EPStats::isMemoryTrackingEnabled(),
                     add_stat,
@@ -4115,6 +4189,10 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doTimingStats(
     // Regular commands
     add_casted_stat("get_cmd", stats.getCmdHisto, add_stat, cookie);
     add_casted_stat("store_cmd", stats.storeCmdHisto, add_stat, cookie);
+    add_casted_stat("mutation_throttle",
+                    stats.mutationThrottleHisto,
+                    add_stat,
+                    cookie);
     add_casted_stat("arith_cmd", stats.arithCmdHisto, add_stat, cookie);
     add_casted_stat("get_stats_cmd", stats.getStatsCmdHisto, add_stat, cookie);
     // Admin commands
@@ -6111,6 +6189,10 @@ void EventuallyPersistentEngine::notifyIOComplete(const void* cookie,
         EP_LOG_WARN("Tried to signal a NULL cookie!");
     } else {
         HdrMicroSecBlockTimer bt(&stats.notifyIOHisto);
+        if (status != ENGINE_SUCCESS && kvBucket) {
+            // The command fails without being retried.
+            kvBucket->getMutationThrottle().mutationComplete(cookie);
+        }
         NonBucketAllocationGuard guard;
         serverApi->cookie->notify_io_complete(cookie, status);
     }
@@ -6264,6 +6346,9 @@ ConnHandler* EventuallyPersistentEngine::getConnHandler(const void* cookie,
 
 void EventuallyPersistentEngine::handleDisconnect(const void *cookie) {
     dcpConnMap_->disconnect(cookie);
+    if (kvBucket) {
+        kvBucket->getMutationThrottle().mutationComplete(cookie);
+    }
     /**
      * Decrement session_cas's counter, if the connection closes
      * before a control command (that returned ENGINE_EWOULDBLOCK
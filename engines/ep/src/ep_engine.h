@@ -492,6 +492,15 @@ public:
                                         const cb::StoreIfPredicate& predicate,
                                         bool preserveTtl);
 
+    /// storeIfInner() once the MutationThrottle has admitted the mutation
+    cb::EngineErrorCasPair storeIfUnthrottled(
+            const void* cookie,
+            Item& itm,
+            uint64_t cas,
+            ENGINE_STORE_OPERATION operation,
+            const cb::StoreIfPredicate& predicate,
+            bool preserveTtl);
+
     ENGINE_ERROR_CODE dcpOpen(const void* cookie,
                               uint32_t opaque,
                               uint32_t seqno,
@@ -707,13 +707,16 @@ VBNotifyCtx EPVBucket::commitStoredValue(HashTable::FindUpdateResult& values,
             values.pending.getHBL(), *values.pending.getSV(), queueItmCtx);
 }
 
-VBNotifyCtx EPVBucket::abortStoredValue(const HashTable::HashBucketLock& hbl,
-                                        StoredValue& v,
-                                        int64_t prepareSeqno,
-                                        std::optional<int64_t> abortSeqno) {
+VBNotifyCtx EPVBucket::abortStoredValue(
+        const HashTable::HashBucketLock& hbl,
+        StoredValue& v,
+        int64_t prepareSeqno,
+        std::optional<int64_t> abortSeqno,
+        CheckpointQueueBatch* checkpointBatch) {
     // Note: We have to enqueue the item into the CM /before/ removing it from
     //     the HT as the removal is synchronous and deallocates the StoredValue
     VBQueueItemCtx queueItmCtx;
+    queueItmCtx.checkpointBatch = checkpointBatch;
     if (abortSeqno) {
         queueItmCtx.genBySeqno = GenerateBySeqno::No;
         v.setBySeqno(*abortSeqno);
@@ -847,13 +850,15 @@ void EPVBucket::scheduleDeferredDeletion(EventuallyPersistentEngine& engine) {
 MutationStatus EPVBucket::insertFromWarmup(Item& itm,
                                            bool eject,
                                            bool keyMetaDataOnly,
-                                           bool checkMemUsed) {
+                                           bool checkMemUsed,
+                                           bool restoreOnly) {
     if (checkMemUsed &&
         !hasMemoryForStoredValue(stats, itm, UseActiveVBMemThreshold::Yes)) {
         return MutationStatus::NoMem;
     }
 
-    return ht.insertFromWarmup(itm, eject, keyMetaDataOnly, eviction);
+    return ht.insertFromWarmup(
+            itm, eject, keyMetaDataOnly, eviction, restoreOnly);
 }
 
 void EPVBucket::loadOutstandingPrepares(
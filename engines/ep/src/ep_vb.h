@@ -179,13 +179,16 @@ public:
      *                        item
      * @param checkMemUsed true if the insert should check if there's memory
      *        for the item.
+     * @param restoreOnly true if only the value of an existing key may be
+     *        restored (see HashTable::insertFromWarmup)
      *
      * @return the result of the operation
      */
     MutationStatus insertFromWarmup(Item& itm,
                                     bool eject,
                                     bool keyMetaDataOnly,
-                                    bool checkMemUsed);
+                                    bool checkMemUsed,
+                                    bool restoreOnly = false);
 
     /**
      * Restores the state of outstanding Prepared SyncWrites during warmup.
@@ -272,10 +275,16 @@ private:
                                   const VBQueueItemCtx& queueItmCtx,
                                   std::optional<int64_t> commitSeqno) override;
 
-    VBNotifyCtx abortStoredValue(const HashTable::HashBucketLock& hbl,
-                                 StoredValue& v,
-                                 int64_t prepareSeqno,
-                                 std::optional<int64_t> abortSeqno) override;
+    VBNotifyCtx abortStoredValue(
+            const HashTable::HashBucketLock& hbl,
+            StoredValue& v,
+            int64_t prepareSeqno,
+            std::optional<int64_t> abortSeqno,
+            CheckpointQueueBatch* checkpointBatch) override;
+
+    bool canBatchCheckpointQueueing() const override {
+        return true;
+    }
 
     VBNotifyCtx addNewAbort(const HashTable::HashBucketLock& hbl,
                             const DocKey& key,
@@ -316,6 +316,8 @@ void EphemeralBucket::appendAggregatedVBucketStats(VBucketCountVisitor& active,
     ARP_STAT("seqlist_count", seqlistCount);
     ARP_STAT("seqlist_deleted_count", seqlistDeletedCount);
     ARP_STAT("seqlist_purged_count", seqListPurgeCount);
+    ARP_STAT("seqlist_purge_duration_us", seqListPurgeDurationMicros);
+    ARP_STAT("seqlist_purge_max_pause_us", seqListPurgeMaxPauseMicros);
     ARP_STAT("seqlist_read_range_count", seqlistReadRangeCount);
     ARP_STAT("seqlist_stale_count", seqlistStaleCount);
     ARP_STAT("seqlist_stale_value_bytes", seqlistStaleValueBytes);
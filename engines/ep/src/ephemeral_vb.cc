@@ -184,6 +184,20 @@ void EphemeralVBucket::addStats(VBucketStatsDetailLevel detail,
                 add_stat,
                 c);
         addStat("seqlist_purged_count", seqListPurgeCount.load(), add_stat, c);
+        addStat("seqlist_purge_duration_us",
+                seqListPurgeDurationMicros.load(),
+                add_stat,
+                c);
+        const auto purgeMicros = seqListPurgeDurationMicros.load();
+        addStat("seqlist_purge_items_per_sec",
+                purgeMicros ? (seqListPurgeCount.load() * 1000000) / purgeMicros
+                            : 0,
+                add_stat,
+                c);
+        addStat("seqlist_purge_max_pause_us",
+                seqList->getMaxPurgePauseMicros(),
+                add_stat,
+                c);
 
         uint64_t rr_begin, rr_end;
         std::tie(rr_begin, rr_end) = seqList->getRangeRead();
@@ -318,8 +332,8 @@ EphemeralVBucket::inMemoryBackfill(uint64_t start, uint64_t end) {
 }
 
 std::optional<SequenceList::RangeIterator> EphemeralVBucket::makeRangeIterator(
-        bool isBackfill) {
-    return seqList->makeRangeIterator(isBackfill);
+        bool isBackfill, seqno_t startSeqno) {
+    return seqList->makeRangeIterator(isBackfill, startSeqno);
 }
 
 bool EphemeralVBucket::isKeyLogicallyDeleted(const DocKey& key,
@@ -360,13 +374,18 @@ size_t EphemeralVBucket::purgeStaleItems(std::function<bool()> shouldPauseCbk) {
                                      std::placeholders::_2,
                                      std::placeholders::_3);
 
+    const auto start = std::chrono::steady_clock::now();
     auto seqListPurged = seqList->purgeTombstones(
             static_cast<seqno_t>(seqList->getHighSeqno()) - 1,
             droppedCallback,
             shouldPauseCbk);
+    const auto duration = std::chrono::steady_clock::now() - start;
 
     // Update stats and return.
     seqListPurgeCount += seqListPurged;
+    seqListPurgeDurationMicros +=
+            std::chrono::duration_cast<std::chrono::microseconds>(duration)
+                    .count();
     setPurgeSeqno(seqList->getHighestPurgedDeletedSeqno());
 
     return seqListPurged;
@@ -700,7 +719,8 @@ VBNotifyCtx EphemeralVBucket::abortStoredValue(
         const HashTable::HashBucketLock& hbl,
         StoredValue& prepared,
         int64_t prepareSeqno,
-        std::optional<int64_t> abortSeqno) {
+        std::optional<int64_t> abortSeqno,
+        CheckpointQueueBatch* checkpointBatch) {
     // From MB-36650 this function is enabled to accept also Completed Prepares
     // (Committed/Aborted) for converting/updating the SV in input to
     // PrepareAborted.
@@ -719,6 +739,7 @@ VBNotifyCtx EphemeralVBucket::abortStoredValue(
     // that would make the code less readable.
 
     VBQueueItemCtx queueItmCtx;
+    queueItmCtx.checkpointBatch = checkpointBatch;
     VBNotifyCtx notifyCtx;
 
     // Need the sequenceLock as we may be generating a new seqno
@@ -156,12 +156,14 @@ public:
      * the SequenceList, new range iterator will not be allowed
      *
      * @param isBackfill indicates if the iterator is for backfill (for debug)
+     * @param startSeqno the lowest seqno the caller is interested in; see
+     *                   SequenceList::makeRangeIterator
      *
      * @return range iterator object when possible
      *         null when not possible
      */
     std::optional<SequenceList::RangeIterator> makeRangeIterator(
-            bool isBackfill);
+            bool isBackfill, seqno_t startSeqno = 1);
 
     void dump() const override;
 
@@ -298,10 +300,18 @@ private:
                                   const VBQueueItemCtx& queueItmCtx,
                                   std::optional<int64_t> commitSeqno) override;
 
-    VBNotifyCtx abortStoredValue(const HashTable::HashBucketLock& hbl,
-                                 StoredValue& v,
-                                 int64_t prepareSeqno,
-                                 std::optional<int64_t> abortSeqno) override;
+    VBNotifyCtx abortStoredValue(
+            const HashTable::HashBucketLock& hbl,
+            StoredValue& v,
+            int64_t prepareSeqno,
+            std::optional<int64_t> abortSeqno,
+            CheckpointQueueBatch* checkpointBatch) override;
+
+    /// Ephemeral must acquire the sequenceLock and seqList write lock before
+    /// the CheckpointManager queueLock, so cannot hold the latter up-front.
+    bool canBatchCheckpointQueueing() const override {
+        return false;
+    }
 
     VBNotifyCtx addNewAbort(const HashTable::HashBucketLock& hbl,
                             const DocKey& key,
@@ -399,6 +409,12 @@ private:
      *  (removed from seqList and deleted).
      */
     EPStats::Counter seqListPurgeCount;
+
+    /**
+     * Total time (in microseconds) spent purging items from the sequence
+     * list; together with seqListPurgeCount gives the purge throughput.
+     */
+    EPStats::Counter seqListPurgeDurationMicros;
 };
 
 using EphemeralVBucketPtr = std::shared_ptr<EphemeralVBucket>;
@@ -22,6 +22,8 @@
 #include "vb_count_visitor.h"
 #include "vbucket.h"
 
+#include <algorithm>
+
 void EphemeralVBucket::CountVisitor::visitBucket(const VBucketPtr& vb) {
     // Handle base class counts
     VBucketCountVisitor::visitBucket(vb);
@@ -34,6 +36,10 @@ void EphemeralVBucket::CountVisitor::visitBucket(const VBucketPtr& vb) {
         seqlistCount += ephVB.seqList->getNumItems();
         seqlistDeletedCount += ephVB.seqList->getNumDeletedItems();
         seqListPurgeCount += ephVB.seqListPurgeCount;
+        seqListPurgeDurationMicros += ephVB.seqListPurgeDurationMicros;
+        seqListPurgeMaxPauseMicros =
+                std::max(seqListPurgeMaxPauseMicros,
+                         ephVB.seqList->getMaxPurgePauseMicros());
 
         uint64_t rrBegin, rrEnd;
         std::tie(rrBegin, rrEnd) = ephVB.seqList->getRangeRead();
@@ -37,6 +37,8 @@ public:
     uint64_t seqlistCount = 0;
     uint64_t seqlistDeletedCount = 0;
     size_t seqListPurgeCount = 0;
+    size_t seqListPurgeDurationMicros = 0;
+    uint64_t seqListPurgeMaxPauseMicros = 0;
     uint64_t seqlistReadRangeCount = 0;
     uint64_t seqlistStaleCount = 0;
     size_t seqlistStaleValueBytes = 0;
@@ -28,6 +28,7 @@
 
 #include <logtags.h>
 #include <nlohmann/json.hpp>
+#include <algorithm>
 #include <cstring>
 
 static const ssize_t prime_size_table[] = {
@@ -96,6 +97,61 @@ HashTable::StoredValueProxy::StoredValueProxy(HashBucketLock&& hbl,
       pre(valueStats.get().prologue(sv)) {
 }
 
+HashTable::MultiBucketLock::MultiBucketLock(HashTable& ht,
+                                            const std::vector<DocKey>& keys)
+    : ht(ht) {
+    if (!ht.isActive()) {
+        throw std::logic_error(
+                "HashTable::MultiBucketLock: Cannot call on a "
+                "non-active object");
+    }
+    while (true) {
+        for (const auto& key : keys) {
+            const auto bucket = ht.getBucketForHash(key.hash());
+            locks.emplace(ht.mutexForBucket(bucket),
+                          std::unique_lock<std::mutex>{});
+        }
+        // std::map iterates in ascending key order; acquire in that order.
+        for (auto& lock : locks) {
+            lock.second = std::unique_lock<std::mutex>(ht.mutexes[lock.first]);
+        }
+
+        // A resize may have completed between calculating the buckets and
+        // acquiring the mutexes. Now we hold (at least) one mutex a resize
+        // cannot be in progress, so re-check every key maps to a held mutex.
+        const bool stable = std::all_of(
+                keys.begin(), keys.end(), [this, &ht](const DocKey& key) {
+                    const auto bucket = ht.getBucketForHash(key.hash());
+                    return locks.count(ht.mutexForBucket(bucket)) != 0;
+                });
+        if (stable) {
+            return;
+        }
+        locks.clear();
+    }
+}
+
+HashTable::HashBucketLock HashTable::MultiBucketLock::lend(const DocKey& key) {
+    const auto bucket = ht.getBucketForHash(key.hash());
+    auto it = locks.find(ht.mutexForBucket(bucket));
+    if (it == locks.end() || !it->second.owns_lock()) {
+        throw std::logic_error(
+                "HashTable::MultiBucketLock::lend: lock for bucket " +
+                std::to_string(bucket) + " is not available");
+    }
+    return {bucket, std::move(it->second)};
+}
+
+void HashTable::MultiBucketLock::giveBack(HashBucketLock&& hbl) {
+    auto it = locks.find(ht.mutexForBucket(hbl.getBucketNum()));
+    if (it == locks.end() || it->second.owns_lock()) {
+        throw std::logic_error(
+                "HashTable::MultiBucketLock::giveBack: bucket " +
+                std::to_string(hbl.getBucketNum()) + " was not lent out");
+    }
+    it->second = std::move(hbl.getHTLock());
+}
+
 HashTable::StoredValueProxy::~StoredValueProxy() {
     if (value) {
         valueStats.get().epilogue(pre, value);
@@ -312,7 +368,16 @@ HashTable::FindInnerResult HashTable::findInner(const DocKey& key) {
                 "HashTable::find: Cannot call on a "
                 "non-active object");
     }
-    HashBucketLock hbl = getLockedBucket(key);
+    return findInner(getLockedBucket(key), key);
+}
+
+HashTable::FindInnerResult HashTable::findInner(HashBucketLock&& hbl,
+                                                const DocKey& key) {
+    if (!hbl.getHTLock()) {
+        throw std::invalid_argument(
+                "HashTable::findInner: htLock not held for key:" +
+                key.to_string());
+    }
     // Scan through all elements in the hash bucket chain looking for Committed
     // and Pending items with the same key.
     StoredValue* foundCmt = nullptr;
@@ -391,10 +456,13 @@ HashTable::UpdateResult HashTable::unlocked_updateStoredValue(
 
     /* setValue() will mark v as undeleted if required */
     v.setValue(itm);
-    updateFreqCounter(v);
 
     valueStats.epilogue(preProps, &v);
 
+    // After the epilogue, as updateFreqCounter() accounts for the change of
+    // frequency counter itself.
+    updateFreqCounter(v);
+
     return {status, &v};
 }
 
@@ -442,6 +510,13 @@ HashTable::Statistics::StoredValueProperties::StoredValueProperties(
     isSystemItem = sv->getKey().isInSystemCollection();
     isPreparedSyncWrite = sv->isPending() || sv->isCompleted();
     cid = sv->getKey().getCollectionID();
+    freqCounter = sv->getFreqCounterValue();
+}
+
+/// @return true if the value should be counted by the freqCounts histogram
+static bool isEvictable(const StoredValue& v) {
+    return v.isResident() && !v.isDeleted() && !v.isTempItem() &&
+           !v.isPending() && !v.isCompleted();
 }
 
 HashTable::Statistics::StoredValueProperties HashTable::Statistics::prologue(
@@ -496,6 +571,10 @@ struct HashTable::Statistics::CacheLocalStatistics {
 
     /// Memory consumed if the items were uncompressed.
     std::atomic<ssize_t> uncompressedMemSize = {};
+
+    /// Count of evictable values with each frequency counter value.
+    std::array<std::atomic<ssize_t>, std::numeric_limits<uint8_t>::max() + 1>
+            freqCounts = {};
 };
 
 HashTable::Statistics::Statistics(EPStats& epStats) : epStats(epStats) {
@@ -591,6 +670,31 @@ size_t HashTable::Statistics::getUncompressedMemSize() const {
     return result;
 }
 
+HashTable::FreqCounterHistogram
+HashTable::Statistics::getFreqCounterHistogram() const {
+    std::array<ssize_t, std::tuple_size<FreqCounterHistogram>::value> sum{};
+    for (const auto& stripe : llcLocal) {
+        for (size_t i = 0; i < sum.size(); ++i) {
+            sum[i] += stripe.freqCounts[i];
+        }
+    }
+    FreqCounterHistogram result;
+    for (size_t i = 0; i < sum.size(); ++i) {
+        result[i] = std::max(sum[i], ssize_t(0));
+    }
+    return result;
+}
+
+void HashTable::Statistics::freqCounterChanged(const StoredValue& v,
+                                               uint8_t oldValue) {
+    const auto newValue = v.getFreqCounterValue();
+    if (newValue != oldValue && isEvictable(v)) {
+        auto& local = llcLocal.get();
+        --local.freqCounts[oldValue];
+        ++local.freqCounts[newValue];
+    }
+}
+
 void HashTable::Statistics::epilogue(StoredValueProperties pre,
                                      const StoredValue* v) {
     // After performing updates to sv; compare with the previous properties and
@@ -682,6 +786,22 @@ void HashTable::Statistics::epilogue(StoredValueProperties pre,
     if (postNonTemp && !post.isDeleted && !post.isPreparedSyncWrite) {
         ++local.datatypeCounts[post.datatype];
     }
+
+    // Update the frequency counter histogram of evictable values (the same
+    // population as datatypes, but only resident values).
+    const bool preEvictable = preNonTemp && pre.isResident &&
+                              !pre.isDeleted && !pre.isPreparedSyncWrite;
+    const bool postEvictable = postNonTemp && post.isResident &&
+                               !post.isDeleted && !post.isPreparedSyncWrite;
+    if (preEvictable != postEvictable ||
+        (preEvictable && pre.freqCounter != post.freqCounter)) {
+        if (preEvictable) {
+            --local.freqCounts[pre.freqCounter];
+        }
+        if (postEvictable) {
+            ++local.freqCounts[post.freqCounter];
+        }
+    }
 }
 
 void HashTable::Statistics::reset() {
@@ -695,6 +815,9 @@ void HashTable::Statistics::reset() {
         core.memSize.store(0);
         core.cacheSize.store(0);
         core.uncompressedMemSize.store(0);
+        for (auto& entry : core.freqCounts) {
+            entry = 0;
+        }
     }
 }
 
@@ -924,6 +1047,15 @@ HashTable::FindUpdateResult HashTable::findForUpdate(const DocKey& key) {
     return {std::move(prepare), result.committedSV};
 }
 
+HashTable::FindUpdateResult HashTable::findForUpdate(HashBucketLock&& hbl,
+                                                     const DocKey& key) {
+    auto result = findInner(std::move(hbl), key);
+
+    StoredValueProxy prepare{
+            std::move(result.lock), result.pendingSV, valueStats};
+    return {std::move(prepare), result.committedSV};
+}
+
 HashTable::FindResult HashTable::findOnlyCommitted(const DocKey& key) {
     auto result = findInner(key);
     return {result.committedSV, std::move(result.lock)};
@@ -983,12 +1115,17 @@ StoredValue::UniquePtr HashTable::unlocked_release(
 MutationStatus HashTable::insertFromWarmup(const Item& itm,
                                            bool eject,
                                            bool keyMetaDataOnly,
-                                           EvictionPolicy evictionPolicy) {
+                                           EvictionPolicy evictionPolicy,
+                                           bool restoreOnly) {
     auto htRes = findInner(itm.getKey());
     auto* v = (itm.isCommitted() ? htRes.committedSV : htRes.pendingSV);
     auto& hbl = htRes.lock;
 
     if (v == nullptr) {
+        if (restoreOnly) {
+            return MutationStatus::InvalidCas;
+        }
+
         v = unlocked_addNewStoredValue(hbl, itm);
 
         // TODO: Would be faster if we just skipped creating the value in the
@@ -1313,6 +1450,12 @@ void HashTable::unlocked_restoreMeta(const std::unique_lock<std::mutex>& htLock,
     valueStats.epilogue(preProps, &v);
 }
 
+void HashTable::setFreqCounterValue(StoredValue& v, uint8_t newValue) {
+    const auto freqCounterValue = v.getFreqCounterValue();
+    v.setFreqCounterValue(newValue);
+    valueStats.freqCounterChanged(v, freqCounterValue);
+}
+
 uint8_t HashTable::generateFreqValue(uint8_t counter) {
     return probabilisticCounter.generateValue(counter);
 }
@@ -1322,8 +1465,10 @@ void HashTable::updateFreqCounter(StoredValue& v) {
     // value.  Because a probabilistic counter is used the new
     // value will either be the same or an increment of the
     // current value.
-    auto updatedFreqCounterValue = generateFreqValue(v.getFreqCounterValue());
+    const auto freqCounterValue = v.getFreqCounterValue();
+    auto updatedFreqCounterValue = generateFreqValue(freqCounterValue);
     v.setFreqCounterValue(updatedFreqCounterValue);
+    valueStats.freqCounterChanged(v, freqCounterValue);
 
     if (updatedFreqCounterValue == std::numeric_limits<uint8_t>::max()) {
         // Invoke the registered callback function which
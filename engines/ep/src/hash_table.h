@@ -26,6 +26,8 @@
 
 #include <array>
 #include <functional>
+#include <limits>
+#include <map>
 
 class AbstractStoredValueFactory;
 class HashTableVisitor;
@@ -173,6 +175,13 @@ public:
     using AtomicDatatypeCombo = std::array<std::atomic<ssize_t>,
             mcbp::datatype::highest + 1>;
 
+    /**
+     * Count of evictable (resident, alive, committed) values with each
+     * frequency counter value.
+     */
+    using FreqCounterHistogram =
+            std::array<size_t, std::numeric_limits<uint8_t>::max() + 1>;
+
     /**
      * Represents a position within the hashtable.
      *
@@ -253,6 +262,7 @@ public:
             bool isTempItem = false;
             bool isSystemItem = false;
             bool isPreparedSyncWrite = false;
+            uint8_t freqCounter = 0;
         };
 
         /**
@@ -293,6 +303,14 @@ public:
          */
         void epilogue(StoredValueProperties pre, const StoredValue* post);
 
+        /**
+         * Update the frequency counter histogram after the frequency counter
+         * (only) of a StoredValue changed from oldValue. A cheaper
+         * alternative to prologue() / epilogue() for the (frequent) case of
+         * a value being referenced.
+         */
+        void freqCounterChanged(const StoredValue& v, uint8_t oldValue);
+
         /// Reset the values of all statistics to zero.
         void reset();
 
@@ -318,6 +336,8 @@ public:
 
         size_t getUncompressedMemSize() const;
 
+        FreqCounterHistogram getFreqCounterHistogram() const;
+
     private:
         struct CacheLocalStatistics;
 
@@ -341,6 +361,11 @@ public:
             : bucketNum(bucketNum), htLock(mutex) {
         }
 
+        /// Construct from an already-locked mutex (see MultiBucketLock).
+        HashBucketLock(int bucketNum, std::unique_lock<std::mutex>&& lock)
+            : bucketNum(bucketNum), htLock(std::move(lock)) {
+        }
+
         HashBucketLock(HashBucketLock&& other)
             : bucketNum(other.bucketNum), htLock(std::move(other.htLock)) {
         }
@@ -372,6 +397,47 @@ public:
         std::unique_lock<std::mutex> htLock;
     };
 
+    /**
+     * Holds the hash bucket locks for a set of keys at once.
+     *
+     * The underlying mutexes are acquired in ascending order - the same order
+     * MultiLockHolder uses when resizing - so concurrent multi-key lockers
+     * cannot deadlock against each other or a resize.
+     *
+     * As multiple buckets share a mutex, a single HashBucketLock for a key is
+     * lent out via lend(), and must be returned via giveBack() before another
+     * key sharing the same mutex can be lent.
+     */
+    class MultiBucketLock {
+    public:
+        MultiBucketLock(HashTable& ht, const std::vector<DocKey>& keys);
+
+        MultiBucketLock(const MultiBucketLock&) = delete;
+        MultiBucketLock& operator=(const MultiBucketLock&) = delete;
+
+        /**
+         * Lend out the HashBucketLock for the given key, which must be one of
+         * the keys this object was constructed with.
+         *
+         * @throws std::logic_error if the lock for the key is already lent.
+         */
+        HashBucketLock lend(const DocKey& key);
+
+        /// Return a HashBucketLock previously obtained via lend().
+        void giveBack(HashBucketLock&& hbl);
+
+        /// @returns the number of distinct mutexes held.
+        size_t size() const {
+            return locks.size();
+        }
+
+    private:
+        HashTable& ht;
+        /// Map of mutex index to its (owning) lock. Ordered, so the mutexes
+        /// are acquired in ascending index order.
+        std::map<size_t, std::unique_lock<std::mutex>> locks;
+    };
+
     /**
      * Create a HashTable.
      *
@@ -507,6 +573,23 @@ public:
         return valueStats.getUncompressedMemSize();
     }
 
+    /**
+     * Get the histogram of the frequency counters of the evictable values in
+     * this hash table; maintained as values are added, ejected and removed
+     * and as their counters change, so the ItemPager knows what threshold
+     * to use before it visits the hash table.
+     */
+    FreqCounterHistogram getFreqCounterHistogram() const {
+        return valueStats.getFreqCounterHistogram();
+    }
+
+    /**
+     * Set the frequency counter of a value in the hash table (e.g. to decay
+     * it), keeping the frequency counter histogram up to date.
+     * The caller must hold the value's HashBucketLock.
+     */
+    void setFreqCounterValue(StoredValue& v, uint8_t newValue);
+
     /**
      * Clear the hash table.
      *
@@ -793,6 +876,12 @@ public:
      */
     FindUpdateResult findForUpdate(const DocKey& key);
 
+    /**
+     * As findForUpdate(key), but using the given, already acquired, lock for
+     * the key's hash bucket (e.g. one lent from a MultiBucketLock).
+     */
+    FindUpdateResult findForUpdate(HashBucketLock&& hbl, const DocKey& key);
+
     /**
      * Find only a Committed item with the specified key. If no Committed item
      * exists for this key returns nullptr.
@@ -1185,11 +1274,16 @@ public:
      * @param keyMetaDataOnly Is the item being inserted metadata-only?
      * @param evictionPolicy What eviction policy should be used if eject is
      * true?
+     * @param restoreOnly Only restore the value of an existing StoredValue,
+     *        don't add the key if it's not present (returning InvalidCas).
+     *        Used when loading values after traffic has been enabled, where
+     *        a missing key has been deleted since.
      */
     MutationStatus insertFromWarmup(const Item& itm,
                                     bool eject,
                                     bool keyMetaDataOnly,
-                                    EvictionPolicy evictionPolicy);
+                                    EvictionPolicy evictionPolicy,
+                                    bool restoreOnly = false);
 
     /**
      * 'Defragment' the StoredValue, this really means reallocate the object
@@ -1297,6 +1391,9 @@ private:
      */
     FindInnerResult findInner(const DocKey& key);
 
+    /// As findInner(key), using the given already acquired HashBucketLock.
+    FindInnerResult findInner(HashBucketLock&& hbl, const DocKey& key);
+
     // The initial (and minimum) size of the HashTable.
     const size_t initialSize;
 
@@ -0,0 +1,62 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "io_rate_limiter.h"
+
+#include <algorithm>
+#include <thread>
+
+IORateLimiter::IORateLimiter(size_t bytesPerSec)
+    : rate(bytesPerSec), tokens(double(bytesPerSec)), lastRefill(Clock::now()) {
+}
+
+void IORateLimiter::setRate(size_t bytesPerSec) {
+    std::lock_guard<std::mutex> lh(mutex);
+    rate = bytesPerSec;
+    tokens = std::min(tokens, double(bytesPerSec));
+}
+
+std::chrono::nanoseconds IORateLimiter::acquire(size_t nbytes) {
+    const auto wait = reserve(nbytes, Clock::now());
+    if (wait.count() > 0) {
+        std::this_thread::sleep_for(wait);
+    }
+    return wait;
+}
+
+std::chrono::nanoseconds IORateLimiter::reserve(size_t nbytes,
+                                                Clock::time_point now) {
+    std::lock_guard<std::mutex> lh(mutex);
+    const auto bytesPerSec = double(rate.load());
+    if (bytesPerSec == 0) {
+        lastRefill = now;
+        return std::chrono::nanoseconds(0);
+    }
+
+    if (now > lastRefill) {
+        const std::chrono::duration<double> elapsed = now - lastRefill;
+        tokens = std::min(bytesPerSec, tokens + elapsed.count() * bytesPerSec);
+        lastRefill = now;
+    }
+
+    tokens -= double(nbytes);
+    if (tokens >= 0) {
+        return std::chrono::nanoseconds(0);
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::duration<double>(-tokens / bytesPerSec));
+}
@@ -0,0 +1,75 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+/**
+ * A token bucket limiting the rate of some I/O (in bytes per second).
+ *
+ * Callers account for each I/O with acquire() before issuing it. The bucket
+ * holds up to one second worth of bytes; once it's empty callers are put to
+ * sleep for as long as it takes the bucket to refill by the amount they
+ * asked for. Callers can overdraw the bucket, so concurrent users are
+ * serialised by the order they reserved their bytes in rather than all
+ * waking up together.
+ *
+ * A rate of zero means unlimited.
+ */
+class IORateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit IORateLimiter(size_t bytesPerSec = 0);
+
+    void setRate(size_t bytesPerSec);
+
+    size_t getRate() const {
+        return rate;
+    }
+
+    /**
+     * Account for nbytes of I/O, sleeping the calling thread if performing
+     * it now would exceed the rate.
+     *
+     * @return how long the caller was put to sleep
+     */
+    std::chrono::nanoseconds acquire(size_t nbytes);
+
+    /**
+     * Account for nbytes of I/O performed at the given time, without
+     * sleeping. Reserving zero bytes gives how long until the bucket is no
+     * longer overdrawn.
+     *
+     * @return how long the caller has to wait before performing the I/O
+     */
+    std::chrono::nanoseconds reserve(size_t nbytes, Clock::time_point now);
+
+private:
+    std::atomic<size_t> rate;
+
+    std::mutex mutex;
+    /// Bytes which may be transferred without waiting; negative when
+    /// callers have reserved more than the bucket held.
+    double tokens;
+    /// When tokens was last topped up
+    Clock::time_point lastRefill;
+};
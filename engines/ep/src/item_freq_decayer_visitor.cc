@@ -16,6 +16,7 @@
  */
 
 #include "item_freq_decayer_visitor.h"
+#include "vbucket.h"
 
 // AgeVisitor implementation ///////////////////////////////////////////
 
@@ -31,7 +32,13 @@ void ItemFreqDecayerVisitor::setDeadline(
 bool ItemFreqDecayerVisitor::visit(const HashTable::HashBucketLock& lh,
                                    StoredValue& v) {
     // age the value's frequency counter by the given percentage
-    v.setFreqCounterValue(v.getFreqCounterValue() * (percentage * 0.01));
+    const uint8_t freqCounterValue =
+            v.getFreqCounterValue() * (percentage * 0.01);
+    if (currentHashTable) {
+        currentHashTable->setFreqCounterValue(v, freqCounterValue);
+    } else {
+        v.setFreqCounterValue(freqCounterValue);
+    }
     visitedCount++;
 
     // See if we have done enough work for this chunk. If so
@@ -39,6 +46,10 @@ bool ItemFreqDecayerVisitor::visit(const HashTable::HashBucketLock& lh,
     return progressTracker.shouldContinueVisiting(visitedCount);
 }
 
+void ItemFreqDecayerVisitor::setCurrentVBucket(VBucket& vb) {
+    currentHashTable = &vb.ht;
+}
+
 void ItemFreqDecayerVisitor::clearStats() {
     visitedCount = 0;
 }
@@ -39,6 +39,8 @@ public:
     // constructed.
     bool visit(const HashTable::HashBucketLock& lh, StoredValue& v) override;
 
+    void setCurrentVBucket(VBucket& vb) override;
+
     // Resets any held stats to zero.
     void clearStats();
 
@@ -58,6 +60,10 @@ private:
     // Estimates how far we have got, and when we should pause.
     ProgressTracker progressTracker;
 
+    // The HashTable being visited; the frequency counters are updated via it
+    // so that its frequency counter histogram is kept up to date.
+    HashTable* currentHashTable = nullptr;
+
     /* Statistics */
     // How many documents have been visited.
     size_t visitedCount;
@@ -56,6 +56,7 @@
 #include "kvstore.h"
 #include "locks.h"
 #include "mutation_log.h"
+#include "mutation_throttle.h"
 #include "replicationthrottle.h"
 #include "rollback_result.h"
 #include "statwriter.h"
@@ -144,6 +145,9 @@ public:
             store.getEPEngine().getReplicationThrottle().setCapPercent(value);
         } else if (key.compare("max_ttl") == 0) {
             store.setMaxTtl(value);
+        } else if (key.compare("mutation_throttle_max_delay_ms") == 0) {
+            store.getMutationThrottle().setMaxDelay(
+                    std::chrono::milliseconds(value));
         } else {
             EP_LOG_WARN("Failed to change value for unknown variable, {}", key);
         }
@@ -168,6 +172,8 @@ public:
             }
         } else if (key.compare("xattr_enabled") == 0) {
             store.setXattrEnabled(value);
+        } else if (key.compare("mutation_throttle_enabled") == 0) {
+            store.getMutationThrottle().setEnabled(value);
         }
     }
 
@@ -375,6 +381,18 @@ KVBucket::KVBucket(EventuallyPersistentEngine& theEngine)
             "mutation_mem_threshold",
             std::make_unique<EPStoreValueChangeListener>(*this));
 
+    mutationThrottle = std::make_unique<MutationThrottle>(
+            engine,
+            stats,
+            config.isMutationThrottleEnabled(),
+            std::chrono::milliseconds(config.getMutationThrottleMaxDelayMs()));
+    config.addValueChangedListener(
+            "mutation_throttle_enabled",
+            std::make_unique<EPStoreValueChangeListener>(*this));
+    config.addValueChangedListener(
+            "mutation_throttle_max_delay_ms",
+            std::make_unique<EPStoreValueChangeListener>(*this));
+
     double backfill_threshold = static_cast<double>
                                       (config.getBackfillMemThreshold()) / 100;
     setBackfillMemoryThreshold(backfill_threshold);
@@ -29,6 +29,7 @@
 #include <deque>
 
 class DurabilityCompletionTask;
+class MutationThrottle;
 class ReplicationThrottle;
 class VBucketCountVisitor;
 namespace Collections {
@@ -93,7 +94,22 @@ private:
 const uint16_t EP_PRIMARY_SHARD = 0;
 class KVShard;
 
-typedef std::pair<Vbid, ExTask> CompTaskEntry;
+/**
+ * A compaction task scheduled against a vBucket, and what the compaction
+ * scheduler (see EPBucket::acquireCompactionSlot) knows about it.
+ */
+struct CompTaskEntry {
+    CompTaskEntry(Vbid vbid, ExTask task) : vbid(vbid), task(std::move(task)) {
+    }
+
+    Vbid vbid;
+    ExTask task;
+    /// Fraction of the vBucket's file which is stale, measured when the task
+    /// first runs (negative until then).
+    double fragmentation = -1;
+    /// Has the task been given one of the concurrent compaction slots?
+    bool running = false;
+};
 
 /**
  * KVBucket is the base class for concrete Key/Value bucket implementations
@@ -674,6 +690,13 @@ public:
         return *replicationThrottle;
     }
 
+    /**
+     * Returns the throttle pacing mutations under memory pressure
+     */
+    MutationThrottle& getMutationThrottle() {
+        return *mutationThrottle;
+    }
+
     /// return the buckets maxTtl value
     std::chrono::seconds getMaxTtl() const;
 
@@ -846,6 +869,9 @@ protected:
     /* Contains info about throttling the replication */
     std::unique_ptr<ReplicationThrottle> replicationThrottle;
 
+    /* Paces mutations as memory usage approaches the mutation threshold */
+    std::unique_ptr<MutationThrottle> mutationThrottle;
+
     std::atomic<size_t> maxTtl;
 
     /**
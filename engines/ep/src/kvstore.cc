@@ -178,6 +178,7 @@ void KVStoreStats::reset() {
     getMultiFsReadHisto.reset();
     getMultiFsReadPerDocHisto.reset();
     flusherWriteAmplificationHisto.reset();
+    getMultiReadAmplificationHisto.reset();
 
     fsStats.reset();
     fsStatsCompaction.reset();
@@ -481,6 +482,11 @@ void KVStore::addTimingStats(const AddStatFn& add_stat, const void* c) {
                       st.flusherWriteAmplificationHisto,
                       add_stat,
                       c);
+    add_prefixed_stat(prefix,
+                      "getMultiReadAmplificationRatio",
+                      st.getMultiReadAmplificationHisto,
+                      add_stat,
+                      c);
 
     //file ops stats
     add_prefixed_stat(
@@ -37,6 +37,7 @@
 /* Forward declarations */
 class BucketLogger;
 class DiskDocKey;
+class IORateLimiter;
 class Item;
 class KVStore;
 class KVStoreConfig;
@@ -98,6 +99,10 @@ struct CompactionStats {
     uint64_t preparesPurged = 0;
     FileInfo pre;
     FileInfo post;
+    /// Bytes written to the compacted file
+    size_t bytesWritten = 0;
+    /// Time compaction was made to wait by the write rate limiter
+    std::chrono::nanoseconds writeThrottledTime{0};
 };
 
 struct CompactionConfig {
@@ -133,6 +138,9 @@ struct compaction_ctx {
 
     /// The SyncRepl HCS, can purge any prepares before the HCS.
     uint64_t highCompletedSeqno = 0;
+
+    /// If set, the writes of the compacted file are throttled by it
+    IORateLimiter* writeRateLimiter = nullptr;
 };
 
 using MakeCompactionContextCallback =
@@ -437,6 +445,12 @@ public:
     HdrHistogram flusherWriteAmplificationHisto{
             0, 1000, 2, HdrHistogram::Iterator::IterMode::Percentiles};
 
+    /// Histogram of disk Read Amplification ratios for each getMulti()
+    /// request - bytes read from disk per byte of document fetched.
+    /// Encoded as integer, as per flusherWriteAmplificationHisto.
+    HdrHistogram getMultiReadAmplificationHisto{
+            0, 1000, 2, HdrHistogram::Iterator::IterMode::Percentiles};
+
     // Stats from the underlying OS file operations
     FileStats fsStats;
 
@@ -454,7 +468,8 @@ public:
                getMultiFsReadHisto.getMemFootPrint() +
                getMultiFsReadPerDocHisto.getMemFootPrint() +
                fsStats.getMemFootPrint() + fsStatsCompaction.getMemFootPrint() +
-               flusherWriteAmplificationHisto.getMemFootPrint();
+               flusherWriteAmplificationHisto.getMemFootPrint() +
+               getMultiReadAmplificationHisto.getMemFootPrint();
     }
 };
 
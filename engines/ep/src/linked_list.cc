@@ -53,6 +53,7 @@ BasicLinkedList::~BasicLinkedList() {
 
     /* Erase all the list elements (does not destroy elements, just removes
        them from the list) */
+    seqnoIndex.clear();
     seqList.clear();
 }
 
@@ -76,6 +77,7 @@ SequenceList::UpdateStatus BasicLinkedList::updateListElem(
 
     /* Since there is no other reads or writes happening in this range, we can
        move the item to the end of the list */
+    removeFromSeqnoIndex(writeLock, v);
     auto it = seqList.iterator_to(v);
     /* If the list is being updated at 'pausedPurgePoint', then we must save
        the new 'pausedPurgePoint' */
@@ -101,6 +103,7 @@ BasicLinkedList::rangeRead(seqno_t start, seqno_t end) {
     }
 
     RangeGuard range;
+    OrderedLL::iterator startIt;
 
     {
         std::lock_guard<std::mutex> listWriteLg(getListWriteLock());
@@ -122,8 +125,15 @@ BasicLinkedList::rangeRead(seqno_t start, seqno_t end) {
         end = std::min(end, static_cast<seqno_t>(highSeqno));
         end = std::max(end, static_cast<seqno_t>(highestDedupedSeqno));
 
+        /* Seek to the closest indexed element before start. Only the part of
+           the list from there on needs to be protected by the range lock;
+           the element itself cannot be moved or purged once it is locked */
+        startIt = seekToSeqno_UNLOCKED(start);
+        const seqno_t lockStart =
+                (startIt == seqList.begin()) ? 1 : startIt->getBySeqno();
+
         // the range lock will be released when the RangeGuard is destroyed.
-        range = tryLockSeqnoRangeShared(1, end);
+        range = tryLockSeqnoRangeShared(lockStart, end);
         if (!range) {
             return std::make_tuple(
                     ENGINE_TMPFAIL, std::vector<UniqueItemPtr>(), 0);
@@ -133,7 +143,8 @@ BasicLinkedList::rangeRead(seqno_t start, seqno_t end) {
     /* Read items in the range */
     std::vector<UniqueItemPtr> items;
 
-    for (const auto& osv : seqList) {
+    for (auto it = startIt; it != seqList.end(); ++it) {
+        const auto& osv = *it;
         int64_t currSeqno(osv.getBySeqno());
 
         if (currSeqno > end || currSeqno < 0) {
@@ -199,6 +210,7 @@ void BasicLinkedList::updateHighSeqno(std::lock_guard<std::mutex>& listWriteLg,
                 std::to_string(v.getBySeqno()) + " which is < 1");
     }
     highSeqno = v.getBySeqno();
+    maybeIndexTail(listWriteLg, v);
 }
 
 void BasicLinkedList::updateHighestDedupedSeqno(
@@ -266,10 +278,10 @@ size_t BasicLinkedList::purgeTombstones(
     // here - the only OSVs we can safely access are ones marked stale as they
     // are no longer in the HashTable (and hence subject to HashTable locks).
     // To check if an item is stale we need to acquire the writeLock
-    // (OSV::stale is guarded by it) for each list item. While this isn't
-    // ideal (that's the same lock needed by front-end operations), we can
-    // release the lock between each element so front-end operations can
-    // have the opportunity to acquire it.
+    // (OSV::stale is guarded by it). While this isn't ideal (that's the same
+    // lock needed by front-end operations), we only hold it for a bounded
+    // batch of elements at a time and release it in between so front-end
+    // operations have the opportunity to acquire it.
     //
     // Attempt to acquire the readRangeLock, to block anyone else concurrently
     // reading from the list while we remove elements from it.
@@ -347,57 +359,117 @@ size_t BasicLinkedList::purgeTombstones(
     // Iterate across all but the last item in the seqList, looking
     // for stale items. May stop early if the range lock could only
     // cover a section of the seqList (see BasicLinkedList::tryLockSeqnoRange)
+    //
+    // The list is processed in batches of up to purgeBatchSize elements, and
+    // the writeLock is acquired only twice per batch (never across batches):
+    //   1. to walk the batch and read the stale flag of each element,
+    //   2. to unlink the elements to be purged from the list.
+    // Checking for dropped collections and calling shouldPause happen without
+    // the writeLock, and the unlinked elements are only freed (and the stats
+    // updated) once the writeLock has been released. All elements of the
+    // batch are covered by our exclusive range lock, so no front-end op or
+    // range reader can touch them in between.
     size_t purgedCount = 0;
-    bool stale;
-    for (auto it = startIt; it != seqList.end();) {
-        if (it->getBySeqno() > lastLockedSeqno) {
-            if (lastLockedSeqno != purgeUpToSeqno) {
-                //  have reached the end of the locked range, but the original
-                //  requested end was higher i.e., the range lock was partial. Pause
-                //  so next time purge is attempted it will resume from here (the
-                //  range lock "blocking" part of the requested seqno range may have
-                //  moved/gone)
-                pausedPurgePoint = it;
+    bool done = false;
+    auto it = startIt;
+    std::vector<std::pair<OrderedStoredValue*, bool>> batch;
+    std::vector<std::pair<StoredValue::UniquePtr, bool>> unlinked;
+    batch.reserve(purgeBatchSize);
+    unlinked.reserve(purgeBatchSize);
+
+    while (!done) {
+        batch.clear();
+        {
+            std::lock_guard<std::mutex> writeGuard(getListWriteLock());
+            const auto lockStart = std::chrono::steady_clock::now();
+            while (it != seqList.end()) {
+                if (it->getBySeqno() > lastLockedSeqno) {
+                    if (lastLockedSeqno != purgeUpToSeqno) {
+                        // have reached the end of the locked range, but the
+                        // original requested end was higher i.e., the range
+                        // lock was partial. Pause so next time purge is
+                        // attempted it will resume from here (the range lock
+                        // "blocking" part of the requested seqno range may
+                        // have moved/gone)
+                        pausedPurgePoint = it;
+                    }
+                    // reached the end of the locked range, stop
+                    done = true;
+                    break;
+                }
+
+                if (it->getBySeqno() <= 0) {
+                    /* last item with no valid seqno yet */
+                    done = true;
+                    break;
+                }
+
+                if (batch.size() == purgeBatchSize) {
+                    break;
+                }
+
+                batch.emplace_back(&*it, it->isStale(writeGuard));
+                ++it;
             }
-            // reached the end of the locked range, stop
-            break;
-        }
-
-        if (it->getBySeqno() <= 0) {
-            /* last item with no valid seqno yet */
-            break;
+            if (it == seqList.end()) {
+                done = true;
+            }
+            recordPurgePause(std::chrono::steady_clock::now() - lockStart);
         }
 
-        // As we move past the items in the list, increment the begin of
-        // the range lock to reduce the window of creating stale items during
-        // updates
-        if (it->getBySeqno() > startSeqno) {
-            range.updateRangeStart(it->getBySeqno());
+        // Decide which elements of the batch to purge; stop at the first
+        // element after which we are asked to pause.
+        size_t processed = 0;
+        bool paused = false;
+        for (auto& candidate : batch) {
+            auto& osv = *candidate.first;
+            bool& purge = candidate.second;
+            if (!purge && isDroppedKeyCb) {
+                purge = isDroppedKeyCb(
+                        osv.getKey(), osv.getBySeqno(), osv.isPending());
+            }
+            ++processed;
+            if (shouldPause()) {
+                paused = true;
+                break;
+            }
         }
 
+        unlinked.clear();
         {
             std::lock_guard<std::mutex> writeGuard(getListWriteLock());
-            stale = it->isStale(writeGuard);
-        }
-
-        bool isDropped = false;
-        if (!stale && isDroppedKeyCb) {
-            isDropped = isDroppedKeyCb(
-                    it->getKey(), it->getBySeqno(), it->isPending());
+            const auto lockStart = std::chrono::steady_clock::now();
+            for (size_t ii = 0; ii < processed; ++ii) {
+                auto& osv = *batch[ii].first;
+                if (!batch[ii].second) {
+                    continue;
+                }
+                const bool stale = osv.isStale(writeGuard);
+                removeFromSeqnoIndex(writeGuard, osv);
+                seqList.erase(seqList.iterator_to(osv));
+                unlinked.emplace_back(StoredValue::UniquePtr(&osv), stale);
+            }
+            if (paused) {
+                // Resume from the first element we did not process
+                pausedPurgePoint = (processed < batch.size())
+                                           ? seqList.iterator_to(
+                                                     *batch[processed].first)
+                                           : it;
+                done = true;
+            }
+            recordPurgePause(std::chrono::steady_clock::now() - lockStart);
         }
 
-        // Only stale or dropped items are purged.
-        if (stale || isDropped) {
-            // Checks pass, remove from list and delete.
-            it = purgeListElem(it, stale);
-            ++purgedCount;
-        } else {
-            ++it;
+        for (auto& purged : unlinked) {
+            releasePurgedElem(std::move(purged.first), purged.second);
         }
+        purgedCount += unlinked.size();
 
-        if (shouldPause()) {
-            pausedPurgePoint = it;
-            break;
+        // As we move past the items in the list, increment the begin of
+        // the range lock to reduce the window of creating stale items during
+        // updates
+        if (!done && it->getBySeqno() > startSeqno) {
+            range.updateRangeStart(it->getBySeqno());
         }
     }
 
@@ -444,6 +516,10 @@ uint64_t BasicLinkedList::getHighestDedupedSeqno() const {
     return highestDedupedSeqno;
 }
 
+uint64_t BasicLinkedList::getMaxPurgePauseMicros() const {
+    return maxPurgePauseMicros;
+}
+
 seqno_t BasicLinkedList::getHighestPurgedDeletedSeqno() const {
     return highestPurgedDeletedSeqno;
 }
@@ -462,8 +538,8 @@ std::mutex& BasicLinkedList::getListWriteLock() const {
 }
 
 std::optional<SequenceList::RangeIterator> BasicLinkedList::makeRangeIterator(
-        bool isBackfill) {
-    auto pRangeItr = RangeIteratorLL::create(*this, isBackfill);
+        bool isBackfill, seqno_t startSeqno) {
+    auto pRangeItr = RangeIteratorLL::create(*this, isBackfill, startSeqno);
     return pRangeItr ? RangeIterator(std::move(pRangeItr))
                      : std::optional<SequenceList::RangeIterator>{};
 }
@@ -498,14 +574,8 @@ std::ostream& operator <<(std::ostream& os, const BasicLinkedList& ll) {
     return os;
 }
 
-OrderedLL::iterator BasicLinkedList::purgeListElem(OrderedLL::iterator it,
-                                                   bool isStale) {
-    StoredValue::UniquePtr purged(&*it);
-    {
-        std::lock_guard<std::mutex> lckGd(getListWriteLock());
-        it = seqList.erase(it);
-    }
-
+void BasicLinkedList::releasePurgedElem(StoredValue::UniquePtr purged,
+                                        bool isStale) {
     if (isStale) {
         /* Update the stats tracking the memory owned by the list */
         staleSize.fetch_sub(purged->size());
@@ -523,20 +593,66 @@ OrderedLL::iterator BasicLinkedList::purgeListElem(OrderedLL::iterator it,
         purged->getBySeqno() > highestPurgedDeletedSeqno.load()) {
         highestPurgedDeletedSeqno = purged->getBySeqno();
     }
-    return it;
+}
+
+void BasicLinkedList::recordPurgePause(
+        std::chrono::steady_clock::duration pause) {
+    atomic_setIfBigger(
+            maxPurgePauseMicros,
+            uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(
+                             pause)
+                             .count()));
+}
+
+void BasicLinkedList::maybeIndexTail(std::lock_guard<std::mutex>& listWriteLg,
+                                     const OrderedStoredValue& v) {
+    if (++appendsSinceLastIndexed < seqnoIndexInterval) {
+        return;
+    }
+
+    /* Only the tail is indexed, so that the index stays in list order. An
+       element which is not at the tail (or does not move the index forward)
+       is simply not indexed; we try again on the next append */
+    if (seqList.empty() || &seqList.back() != &v ||
+        (!seqnoIndex.empty() && seqnoIndex.rbegin()->first >= v.getBySeqno())) {
+        return;
+    }
+
+    seqnoIndex.emplace_hint(
+            seqnoIndex.end(), v.getBySeqno(), &seqList.back());
+    appendsSinceLastIndexed = 0;
+}
+
+void BasicLinkedList::removeFromSeqnoIndex(
+        std::lock_guard<std::mutex>& listWriteLg, const OrderedStoredValue& v) {
+    auto it = seqnoIndex.find(v.getBySeqno());
+    if (it != seqnoIndex.end() && it->second == &v) {
+        seqnoIndex.erase(it);
+    }
+}
+
+OrderedLL::iterator BasicLinkedList::seekToSeqno_UNLOCKED(seqno_t seqno) {
+    auto it = seqnoIndex.upper_bound(seqno);
+    if (it == seqnoIndex.begin()) {
+        return seqList.begin();
+    }
+    return seqList.iterator_to(*std::prev(it)->second);
 }
 
 std::unique_ptr<BasicLinkedList::RangeIteratorLL>
-BasicLinkedList::RangeIteratorLL::create(BasicLinkedList& ll, bool isBackfill) {
+BasicLinkedList::RangeIteratorLL::create(BasicLinkedList& ll,
+                                         bool isBackfill,
+                                         seqno_t startSeqno) {
     /* Note: cannot use std::make_unique because the constructor of
        RangeIteratorLL is private */
     std::unique_ptr<BasicLinkedList::RangeIteratorLL> pRangeItr(
-            new BasicLinkedList::RangeIteratorLL(ll, isBackfill));
+            new BasicLinkedList::RangeIteratorLL(ll, isBackfill, startSeqno));
     return pRangeItr->tryLater() ? nullptr : std::move(pRangeItr);
 }
 
 BasicLinkedList::RangeIteratorLL::RangeIteratorLL(BasicLinkedList& ll,
-                                                  bool isBackfill)
+                                                  bool isBackfill,
+                                                  seqno_t startSeqno)
     : list(ll),
       itrRange(0, 0),
       numRemaining(0),
@@ -544,7 +660,7 @@ BasicLinkedList::RangeIteratorLL::RangeIteratorLL(BasicLinkedList& ll,
       maxVisibleSeqno(0),
       isBackfill(isBackfill) {
 
-    std::lock_guard<std::mutex> listWriteLg(list.getListWriteLock());
+    std::unique_lock<std::mutex> listWriteLg(list.getListWriteLock());
 
     if (list.highSeqno < 1) {
         /* No need of holding a lock for the snapshot as there are no items;
@@ -552,11 +668,10 @@ BasicLinkedList::RangeIteratorLL::RangeIteratorLL(BasicLinkedList& ll,
         return;
     }
 
-    /* Iterator to the beginning of linked list */
-    currIt = list.seqList.begin();
-
-    /* Number of items that can be iterated over */
-    numRemaining = list.seqList.size();
+    /* Iterator to the closest indexed element before startSeqno (or the
+       beginning of linked list) */
+    currIt = list.seekToSeqno_UNLOCKED(startSeqno);
+    const auto lastIt = list.seqList.iterator_to(list.seqList.back());
 
     /* The minimum seqno in the iterator that must be read to get a consistent
        read snapshot */
@@ -585,6 +700,12 @@ BasicLinkedList::RangeIteratorLL::RangeIteratorLL(BasicLinkedList& ll,
     itrRange = SeqRange(currIt->getBySeqno(),
                         list.seqList.back().getBySeqno() + 1);
 
+    /* Number of items that can be iterated over; those from the seek
+       position to the end of the range. The range lock stops them being
+       moved or removed, so count them without blocking the front end */
+    listWriteLg.unlock();
+    numRemaining = std::distance(currIt, lastIt) + 1;
+
     auto severity = isBackfill ? spdlog::level::level_enum::info
                                : spdlog::level::level_enum::debug;
 
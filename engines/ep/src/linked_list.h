@@ -33,6 +33,9 @@
 #include <platform/non_negative_counter.h>
 #include <relaxed_atomic.h>
 
+#include <chrono>
+#include <map>
+
 /* This option will configure "list" to use the member hook */
 using MemberHookOption =
         boost::intrusive::member_hook<OrderedStoredValue,
@@ -42,6 +45,9 @@ using MemberHookOption =
 /* This list will use the member hook */
 using OrderedLL = boost::intrusive::list<OrderedStoredValue, MemberHookOption>;
 
+/* Sparse index of list elements keyed by their seqno */
+using SeqnoIndex = std::map<seqno_t, OrderedStoredValue*>;
+
 
 /**
  * This class implements SequenceList as a basic doubly linked list.
@@ -80,6 +86,16 @@ using OrderedLL = boost::intrusive::list<OrderedStoredValue, MemberHookOption>;
  * 'writeLock' and 'rangeLock' are held for short durations, typically for
  * single list element writes and reads.
  * 'rangeReadLock' is held for longer duration on the list (for entire range).
+ *
+ * Seeking:
+ * =======
+ * As the list is ordered by seqno, BasicLinkedList additionally keeps a sparse
+ * index (a single "express lane" of a skiplist) of every
+ * 'seqnoIndexInterval'-th element appended to the tail. Range reads and range
+ * iterators starting at a given seqno use it to seek close to the start in
+ * O(log n) rather than walking the list from the head, and only range-lock
+ * the part of the list they actually read. The index is guarded by the
+ * writeLock; an element is removed from it before it is moved or purged.
  */
 class BasicLinkedList : public SequenceList {
 public:
@@ -138,6 +154,8 @@ public:
 
     seqno_t getHighestPurgedDeletedSeqno() const override;
 
+    uint64_t getMaxPurgePauseMicros() const override;
+
     uint64_t getMaxVisibleSeqno() const override;
 
     std::pair<uint64_t, uint64_t> getRangeRead() const override;
@@ -145,7 +163,7 @@ public:
     std::mutex& getListWriteLock() const override;
 
     std::optional<SequenceList::RangeIterator> makeRangeIterator(
-            bool isBackfill) override;
+            bool isBackfill, seqno_t startSeqno) override;
 
     /**
      * Exclusively locks a range of seqnos in the sequence list. Prevents any
@@ -222,8 +240,54 @@ protected:
        list */
     cb::RelaxedAtomic<size_t> staleMetaDataSize;
 
+    /**
+     * Sparse index of the elements of 'seqList'. Only elements which were at
+     * the tail of the list when indexed are added, hence iterating the index
+     * visits the elements in list order. Guarded by writeLock.
+     */
+    SeqnoIndex seqnoIndex;
+
+    /* Number of tail appends between two consecutive index entries */
+    static const size_t seqnoIndexInterval = 128;
+
+    /* Max number of elements purgeTombstones() visits per writeLock
+       acquisition */
+    static const size_t purgeBatchSize = 64;
+
 private:
-    OrderedLL::iterator purgeListElem(OrderedLL::iterator it, bool isStale);
+    /**
+     * Updates the stats for, and deletes, an element which purgeTombstones()
+     * has already unlinked from the list. Called without the writeLock held.
+     */
+    void releasePurgedElem(StoredValue::UniquePtr purged, bool isStale);
+
+    /// Records the duration purgeTombstones() held the writeLock for.
+    void recordPurgePause(std::chrono::steady_clock::duration pause);
+
+    /**
+     * Adds the element 'v' (which must be the tail of the list) to the seqno
+     * index if 'seqnoIndexInterval' elements were appended since the last
+     * index entry was added.
+     */
+    void maybeIndexTail(std::lock_guard<std::mutex>& listWriteLg,
+                        const OrderedStoredValue& v);
+
+    /**
+     * Removes the element 'v' from the seqno index (if indexed). Must be
+     * called before 'v' is moved within, or removed from, the list.
+     */
+    void removeFromSeqnoIndex(std::lock_guard<std::mutex>& listWriteLg,
+                              const OrderedStoredValue& v);
+
+    /**
+     * Returns an iterator to the indexed element with the highest seqno not
+     * greater than 'seqno', or to the head of the list if there is no such
+     * element. Caller must hold writeLock.
+     */
+    OrderedLL::iterator seekToSeqno_UNLOCKED(seqno_t seqno);
+
+    /* Number of elements appended to the tail since the last index entry */
+    size_t appendsSinceLastIndexed = 0;
 
     /**
      * We need to keep track of the highest seqno separately because there is a
@@ -285,6 +349,10 @@ private:
     /* Point at which the tombstone purging was paused */
     OrderedLL::iterator pausedPurgePoint;
 
+    /* Longest time (in microseconds) purgeTombstones() held the writeLock
+       for in one go */
+    std::atomic<uint64_t> maxPurgePauseMicros{0};
+
     friend std::ostream& operator<<(std::ostream& os,
                                     const BasicLinkedList& ll);
 
@@ -299,12 +367,14 @@ private:
          * @param ll ref to the linkedlist on which the iterator is created
          * @param isBackfill indicates if the iterator is for backfill (for
          *                   debug)
+         * @param startSeqno seqno the caller wants to start reading from
          *
          * @return Non-null pointer on success, or null if a RangeIteratorLL
          *         already exists.
          */
         static std::unique_ptr<RangeIteratorLL> create(BasicLinkedList& ll,
-                                                       bool isBackfill);
+                                                       bool isBackfill,
+                                                       seqno_t startSeqno);
 
         ~RangeIteratorLL() override;
 
@@ -342,7 +412,9 @@ private:
     private:
         /* We have a private constructor because we want to create the iterator
            optionally, that is, only when it is possible to get a read lock */
-        RangeIteratorLL(BasicLinkedList& ll, bool isBackfill);
+        RangeIteratorLL(BasicLinkedList& ll,
+                        bool isBackfill,
+                        seqno_t startSeqno);
 
         /**
          * Indicates if the client should try creating the iterator at a later
@@ -0,0 +1,196 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "mutation_throttle.h"
+
+#include "ep_engine.h"
+#include "executorpool.h"
+#include "globaltask.h"
+#include "stats.h"
+#include "trace_helpers.h"
+#include "vbucket.h"
+
+#include <phosphor/phosphor.h>
+
+#include <algorithm>
+
+/**
+ * Notifies a delayed mutation's cookie once its delay has elapsed.
+ */
+class MutationThrottleNotification : public GlobalTask {
+public:
+    MutationThrottleNotification(EventuallyPersistentEngine& e,
+                                 const void* cookie,
+                                 cb::tracing::SpanId traceSpanId,
+                                 std::chrono::nanoseconds delay)
+        : GlobalTask(&e,
+                     TaskId::MutationThrottleNotification,
+                     std::chrono::duration<double>(delay).count(),
+                     true /*completeBeforeShutdown*/),
+          cookie(cookie),
+          traceSpanId(traceSpanId) {
+    }
+
+    std::string getDescription() override {
+        return "Notify mutation delayed by memory pressure";
+    }
+
+    std::chrono::microseconds maxExpectedDuration() override {
+        // Just notifies a single cookie.
+        return std::chrono::milliseconds(1);
+    }
+
+    bool run() override {
+        TRACE_EVENT0("ep-engine/task", "MutationThrottleNotification");
+        // Close the Throttled span begun by delayMutation()
+        auto* traceable = cookie2traceable(cookie);
+        if (traceable && traceable->isTracingEnabled()) {
+            NonBucketAllocationGuard guard;
+            traceable->getTracer().end(traceSpanId);
+        }
+        engine->notifyIOComplete(cookie, ENGINE_SUCCESS);
+        return false;
+    }
+
+private:
+    const void* cookie;
+    const cb::tracing::SpanId traceSpanId;
+};
+
+MutationThrottle::MutationThrottle(EventuallyPersistentEngine& engine,
+                                   EPStats& stats,
+                                   bool enabled,
+                                   std::chrono::milliseconds maxDelay)
+    : engine(engine),
+      stats(stats),
+      enabled(enabled),
+      maxDelay(maxDelay.count()),
+      sampleStart(Clock::now()) {
+}
+
+bool MutationThrottle::delayMutation(const void* cookie, size_t nbytes) {
+    const auto delay =
+            getDelay(nbytes, VBucket::getMutationMemoryThreshold());
+    if (delay.count() == 0) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lh(delayedMutex);
+        if (delayed.insert(cookie).second) {
+            ++numDelayed;
+        }
+    }
+
+    const auto us =
+            std::chrono::duration_cast<std::chrono::microseconds>(delay);
+    ++stats.mutationThrottleDelayed;
+    stats.mutationThrottleDelayTime += us.count();
+    stats.mutationThrottleHisto.add(us);
+
+    cb::tracing::SpanId traceSpanId = {};
+    auto* traceable = cookie2traceable(cookie);
+    if (traceable && traceable->isTracingEnabled()) {
+        NonBucketAllocationGuard guard;
+        traceSpanId =
+                traceable->getTracer().begin(cb::tracing::Code::Throttled);
+    }
+
+    ExecutorPool::get()->schedule(
+            std::make_shared<MutationThrottleNotification>(
+                    engine, cookie, traceSpanId, delay));
+    return true;
+}
+
+bool MutationThrottle::isDelayed(const void* cookie) {
+    if (numDelayed == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lh(delayedMutex);
+    return delayed.count(cookie) != 0;
+}
+
+void MutationThrottle::mutationComplete(const void* cookie) {
+    if (numDelayed == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lh(delayedMutex);
+    if (delayed.erase(cookie) != 0) {
+        --numDelayed;
+    }
+}
+
+std::chrono::nanoseconds MutationThrottle::getDelay(size_t nbytes,
+                                                    double limit,
+                                                    Clock::time_point now) {
+    if (!enabled) {
+        return std::chrono::nanoseconds(0);
+    }
+
+    // Beyond the limit the mutation is going to be rejected anyway, so
+    // there's no point delaying it.
+    const auto pressure = getPressure(limit);
+    if (pressure <= 0 || pressure >= 1) {
+        return std::chrono::nanoseconds(0);
+    }
+
+    updateDrainRate(now);
+    const std::chrono::nanoseconds max = std::chrono::milliseconds(maxDelay);
+    const double rate = drainRate;
+    if (rate == 0) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(max *
+                                                                    pressure);
+    }
+
+    const auto target = rate * (1 - pressure) / pressure;
+    limiter.setRate(std::max(size_t(target), size_t(1)));
+    return std::min(limiter.reserve(nbytes, now), max);
+}
+
+void MutationThrottle::recordDrained(size_t nbytes, Clock::time_point now) {
+    drained.fetch_add(nbytes);
+    updateDrainRate(now);
+}
+
+double MutationThrottle::getPressure(double limit) const {
+    const auto memUsed = double(stats.getEstimatedTotalMemoryUsed());
+    const auto start = double(stats.mem_high_wat.load());
+    const auto end = limit * stats.getMaxDataSize();
+    if (memUsed <= start) {
+        return 0;
+    }
+    if (end <= start) {
+        return 1;
+    }
+    return std::min(1.0, (memUsed - start) / (end - start));
+}
+
+void MutationThrottle::updateDrainRate(Clock::time_point now) {
+    std::unique_lock<std::mutex> lh(sampleMutex, std::try_to_lock);
+    if (!lh || now - sampleStart < SampleInterval) {
+        return;
+    }
+
+    const std::chrono::duration<double> elapsed = now - sampleStart;
+    const double sample = drained.exchange(0) / elapsed.count();
+    sampleStart = now;
+
+    // Weight recent samples heavily, as the point is to track the pager's
+    // progress whilst under pressure.
+    const double previous = drainRate;
+    drainRate = previous == 0 ? sample : 0.7 * previous + 0.3 * sample;
+}
@@ -0,0 +1,142 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include "io_rate_limiter.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_set>
+
+class EPStats;
+class EventuallyPersistentEngine;
+
+/**
+ * Paces mutations as memory usage approaches the point at which they would
+ * be rejected, so clients see throughput degrade gradually rather than a
+ * sudden switch to TMPFAIL / ENOMEM.
+ *
+ * Between the high watermark and the rejection threshold (the
+ * mutation_mem_threshold for front-end mutations, the
+ * replication_throttle_threshold for DCP) the "pressure" rises from 0 to 1.
+ * Mutations are admitted at
+ *
+ *     drainRate * (1 - pressure) / pressure
+ *
+ * bytes per second, where drainRate is the rate at which the item pager has
+ * recently been freeing memory: faster than memory is freed while there is
+ * plenty of headroom, the same rate at the midpoint and ever slower beyond
+ * it. Until a drain rate has been measured the delay is simply proportional
+ * to the pressure. No mutation is delayed by more than maxDelay.
+ */
+class MutationThrottle {
+public:
+    using Clock = IORateLimiter::Clock;
+
+    MutationThrottle(EventuallyPersistentEngine& engine,
+                     EPStats& stats,
+                     bool enabled,
+                     std::chrono::milliseconds maxDelay);
+
+    void setEnabled(bool value) {
+        enabled = value;
+    }
+
+    bool isEnabled() const {
+        return enabled;
+    }
+
+    void setMaxDelay(std::chrono::milliseconds value) {
+        maxDelay = value.count();
+    }
+
+    /**
+     * Delay a front-end mutation of nbytes if memory usage requires it.
+     * If so, the cookie is notified (with ENGINE_SUCCESS) once the delay has
+     * elapsed and the caller should return ENGINE_EWOULDBLOCK.
+     *
+     * @return true if the mutation was delayed
+     */
+    bool delayMutation(const void* cookie, size_t nbytes);
+
+    /**
+     * Has the cookie's mutation already been delayed? If so it isn't delayed
+     * again, however many times it's retried (e.g. after a background
+     * fetch), until mutationComplete() is called.
+     */
+    bool isDelayed(const void* cookie);
+
+    /**
+     * The cookie's mutation has completed (or failed), so its next one may
+     * be delayed again.
+     */
+    void mutationComplete(const void* cookie);
+
+    /**
+     * How long should a mutation of nbytes be delayed for?
+     *
+     * @param limit the memory usage (as a fraction of the bucket quota) at
+     *        which the mutation would be rejected
+     */
+    std::chrono::nanoseconds getDelay(size_t nbytes,
+                                      double limit,
+                                      Clock::time_point now = Clock::now());
+
+    /// Record that the item pager freed nbytes.
+    void recordDrained(size_t nbytes, Clock::time_point now = Clock::now());
+
+    /**
+     * @return how far memory usage is between the high watermark (0) and the
+     *         given limit (1, as a fraction of the bucket quota)
+     */
+    double getPressure(double limit) const;
+
+    /// @return the recent rate (bytes per second) of the item pager
+    double getDrainRate() const {
+        return drainRate;
+    }
+
+    /// How often the drain rate is sampled.
+    static constexpr std::chrono::milliseconds SampleInterval{100};
+
+private:
+    void updateDrainRate(Clock::time_point now);
+
+    EventuallyPersistentEngine& engine;
+    EPStats& stats;
+    std::atomic<bool> enabled;
+    std::atomic<std::chrono::milliseconds::rep> maxDelay;
+
+    /// Paces the admitted mutations at the current target rate
+    IORateLimiter limiter;
+
+    /// The cookies whose current mutation has been delayed. The size is
+    /// kept separately so the (common) case of no delayed mutations doesn't
+    /// need the mutex.
+    std::mutex delayedMutex;
+    std::unordered_set<const void*> delayed;
+    std::atomic<size_t> numDelayed{0};
+
+    /// Bytes freed since sampleStart
+    std::atomic<size_t> drained{0};
+    std::mutex sampleMutex;
+    Clock::time_point sampleStart;
+    /// Exponentially weighted moving average of the drain rate
+    std::atomic<double> drainRate{0};
+};
@@ -27,12 +27,14 @@
 #include "item_eviction.h"
 #include "kv_bucket.h"
 #include "kv_bucket_iface.h"
+#include "mutation_throttle.h"
 
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
 #include <limits>
 #include <list>
+#include <numeric>
 #include <string>
 #include <utility>
 
@@ -130,7 +132,12 @@ bool PagingVisitor::visit(const HashTable::HashBucketLock& lh, StoredValue& v) {
     uint64_t age = (maxCas > v.getCas()) ? (maxCas - v.getCas()) : 0;
     age = age >> ItemEviction::casBitsNotTime;
 
-    if ((storedValueFreqCounter <= freqCounterThreshold) &&
+    // Once the vbucket's share of the memory deficit has been evicted we
+    // carry on visiting (expiring items and completing the histograms) but
+    // don't evict anything else.
+    const bool targetReached = bytesEvicted >= bytesToEvict;
+
+    if (!targetReached && (storedValueFreqCounter <= freqCounterThreshold) &&
         ((storedValueFreqCounter < freqCounterAgeThreshold) ||
          (age >= ageThreshold))) {
         /*
@@ -154,7 +161,7 @@ bool PagingVisitor::visit(const HashTable::HashBucketLock& lh, StoredValue& v) {
         // we want to add the maximum value (255).
         if (!currentBucket->eligibleToPageOut(lh, v)) {
             storedValueFreqCounter = std::numeric_limits<uint8_t>::max();
-        } else {
+        } else if (!targetReached) {
             /*
              * MB-29333 - For items that we have visited and did not
              * evict just because their frequency counter was too high,
@@ -164,7 +171,8 @@ bool PagingVisitor::visit(const HashTable::HashBucketLock& lh, StoredValue& v) {
              * incremented in between visits of the item pager).
              */
             if (storedValueFreqCounter > 0) {
-                v.setFreqCounterValue(storedValueFreqCounter - 1);
+                currentBucket->ht.setFreqCounterValue(
+                        v, storedValueFreqCounter - 1);
             }
         }
     }
@@ -192,7 +200,8 @@ bool PagingVisitor::visit(const HashTable::HashBucketLock& lh, StoredValue& v) {
     if (itemEviction.isLearning() || itemEviction.isRequiredToUpdate()) {
         auto thresholds =
                 itemEviction.getThresholds(percent * 100.0, agePercentage);
-        freqCounterThreshold = thresholds.first;
+        freqCounterThreshold =
+                std::max(thresholds.first, minFreqCounterThreshold);
         ageThreshold = thresholds.second;
     }
 
@@ -220,6 +229,10 @@ void PagingVisitor::visitBucket(const VBucketPtr& vb) {
     auto high = static_cast<double>(stats.mem_high_wat);
     if (vb->getState() == vbucket_state_active && current < high &&
         store.getActiveResidentRatio() < store.getReplicaResidentRatio()) {
+        if (remainingEvictableBytes && vBucketFilter(vb->getId())) {
+            *remainingEvictableBytes -= std::min(*remainingEvictableBytes,
+                                                 getEvictableBytes(*vb));
+        }
         return;
     }
 
@@ -230,7 +243,15 @@ void PagingVisitor::visitBucket(const VBucketPtr& vb) {
             currentBucket = vb;
             maxCas = currentBucket->getMaxCas();
             itemEviction.reset();
-            freqCounterThreshold = 0;
+            // Use the precise memory usage for the deficit (which is only
+            // calculated once per vbucket), so we don't stop short of the
+            // low watermark.
+            setEvictionTargets(
+                    *vb,
+                    std::max(0.0,
+                             double(stats.getPreciseTotalMemoryUsed()) -
+                                     lower));
+            freqCounterThreshold = minFreqCounterThreshold;
 
             // Percent of items in the hash table to be visited
             // between updating the interval.
@@ -279,6 +300,58 @@ void PagingVisitor::visitBucket(const VBucketPtr& vb) {
     }
 }
 
+void PagingVisitor::setEvictionTargets(VBucket& vb, double deficit) {
+    if (!remainingEvictableBytes) {
+        size_t total = 0;
+        for (const auto vbid : store.getVBuckets().getBuckets()) {
+            auto other = store.getVBucket(vbid);
+            if (other && vBucketFilter(vbid)) {
+                total += getEvictableBytes(*other);
+            }
+        }
+        remainingEvictableBytes = total;
+    }
+
+    // This vbucket's share of the deficit is its share of the bytes which
+    // are left to evict from.
+    const auto evictable = getEvictableBytes(vb);
+    const double share =
+            *remainingEvictableBytes
+                    ? std::min(1.0, double(evictable) / *remainingEvictableBytes)
+                    : 1.0;
+    *remainingEvictableBytes -= std::min(*remainingEvictableBytes, evictable);
+    bytesToEvict = static_cast<size_t>(
+            std::min(double(evictable), std::ceil(deficit * share)));
+    bytesEvicted = 0;
+
+    // Start with the lowest frequency counter threshold which covers enough
+    // values to evict the target, rather than learning it whilst visiting.
+    const auto histogram = vb.ht.getFreqCounterHistogram();
+    const auto numValues =
+            std::accumulate(histogram.begin(), histogram.end(), size_t(0));
+    const auto valuesToEvict =
+            evictable ? std::ceil(numValues * (double(bytesToEvict) / evictable))
+                      : 0.0;
+    size_t count = 0;
+    minFreqCounterThreshold = 0;
+    while (minFreqCounterThreshold < histogram.size() - 1) {
+        count += histogram[minFreqCounterThreshold];
+        if (count >= valuesToEvict) {
+            break;
+        }
+        ++minFreqCounterThreshold;
+    }
+}
+
+size_t PagingVisitor::getEvictableBytes(const VBucket& vb) const {
+    // Value eviction only frees the values; full eviction the whole item.
+    const auto cacheSize = vb.ht.getCacheSize();
+    if (store.getItemEvictionPolicy() == ::EvictionPolicy::Value) {
+        return cacheSize - std::min(cacheSize, vb.ht.getMetadataMemory());
+    }
+    return cacheSize;
+}
+
 void PagingVisitor::update() {
     store.deleteExpiredItems(expired, ExpireBy::Pager);
 
@@ -371,9 +444,13 @@ bool PagingVisitor::doEviction(const HashTable::HashBucketLock& lh,
                                StoredValue* v) {
     auto policy = store.getItemEvictionPolicy();
     StoredDocKey key(v->getKey());
+    const size_t bytes =
+            policy == ::EvictionPolicy::Value ? v->valuelen() : v->size();
 
     if (currentBucket->pageOut(readHandle, lh, v)) {
         ++ejected;
+        bytesEvicted += bytes;
+        store.getMutationThrottle().recordDrained(bytes);
 
         /**
          * For FULL EVICTION MODE, add all items that are being
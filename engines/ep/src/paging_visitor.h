@@ -24,7 +24,9 @@
 #include "vb_visitors.h"
 
 #include <atomic>
+#include <limits>
 #include <list>
+#include <optional>
 
 class EPStats;
 class Item;
@@ -124,6 +126,16 @@ protected:
     // items from the hash table.
     uint64_t ageThreshold;
 
+    // The frequency counter threshold chosen from the vbucket's frequency
+    // counter histogram before visiting it; the threshold learnt while
+    // visiting is never allowed below it.
+    uint16_t minFreqCounterThreshold{0};
+
+    // The number of bytes to evict from the current vbucket (its share of the
+    // bucket's memory deficit), and the number evicted so far.
+    size_t bytesToEvict{std::numeric_limits<size_t>::max()};
+    size_t bytesEvicted{0};
+
 private:
     // Removes checkpoints that are both closed and unreferenced, thereby
     // freeing the associated memory.
@@ -132,6 +144,19 @@ private:
 
     void adjustPercent(double prob, vbucket_state_t state);
 
+    /**
+     * Set the byte target and initial frequency counter threshold for
+     * evicting from the given vbucket.
+     *
+     * @param deficit the number of bytes the bucket is above the low
+     *        watermark
+     */
+    void setEvictionTargets(VBucket& vb, double deficit);
+
+    /// @return the number of bytes which evicting every value of the vbucket
+    ///         would free
+    size_t getEvictableBytes(const VBucket& vb) const;
+
     bool doEviction(const HashTable::HashBucketLock& lh, StoredValue* v);
 
     std::list<Item> expired;
@@ -167,6 +192,10 @@ private:
     // visit all items in the vbucket.
     uint64_t maxCas;
 
+    // The evictable bytes of the vbuckets not yet visited, used to share out
+    // the memory deficit. Calculated on the first visit which evicts.
+    std::optional<size_t> remainingEvictableBytes;
+
     // The VB::Manifest read handle that we use to lock around HashBucket
     // visits. Will contain a nullptr if we aren't currently locking anything.
     Collections::VB::Manifest::ReadHandle readHandle;
@@ -30,8 +30,11 @@
 #include <phosphor/phosphor.h>
 #include <platform/cbassert.h>
 #include <platform/sysinfo.h>
+#include <mcbp/protocol/datatype.h>
+#include <rocksdb/compaction_filter.h>
 #include <rocksdb/convenience.h>
 #include <rocksdb/filter_policy.h>
+#include <rocksdb/perf_context.h>
 #include <nlohmann/json.hpp>
 
 #include <stdio.h>
@@ -39,6 +42,7 @@
 #include <algorithm>
 #include <gsl/gsl>
 #include <limits>
+#include <numeric>
 #include <thread>
 
 namespace rockskv {
@@ -286,6 +290,11 @@ public:
     const ColumnFamilyPtr defaultCFH;
     const ColumnFamilyPtr seqnoCFH;
     const Vbid vbid;
+
+    // Number of alive documents and of tombstones in the default CF. Updated
+    // by commit() and persisted in the same batch as the documents.
+    std::atomic<uint64_t> itemCount{0};
+    std::atomic<uint64_t> deleteCount{0};
 };
 
 RocksDBKVStore::RocksDBKVStore(RocksDBKVStoreConfig& configuration)
@@ -395,6 +404,7 @@ RocksDBKVStore::RocksDBKVStore(RocksDBKVStoreConfig& configuration)
     for (const auto vbh : vbHandles) {
         if (vbh) {
             loadVBStateCache(*vbh);
+            loadDocCounts(*vbh);
             // Update stats
             ++st.numLoadedVb;
         }
@@ -462,7 +472,8 @@ void RocksDBKVStore::openDB() {
                                            "' is in inconsistent state: CF " +
                                            seqnoCF + " not found.");
                 }
-                cfDescriptors.emplace_back(defaultCF, defaultCFOptions);
+                cfDescriptors.emplace_back(defaultCF,
+                                           getDefaultCFOptions(Vbid(vbid)));
                 cfDescriptors.emplace_back(seqnoCF, seqnoCFOptions);
             }
         }
@@ -511,7 +522,7 @@ std::shared_ptr<VBHandle> RocksDBKVStore::getVBHandle(Vbid vbid) {
     // the VBucket, i.e. we need to create the set of CFs on DB for vbid
     std::vector<rocksdb::ColumnFamilyDescriptor> cfDescriptors;
     auto vbid_ = std::to_string(vbid.get());
-    cfDescriptors.emplace_back("default_" + vbid_, defaultCFOptions);
+    cfDescriptors.emplace_back("default_" + vbid_, getDefaultCFOptions(vbid));
     cfDescriptors.emplace_back("local+seqno_" + vbid_, seqnoCFOptions);
 
     std::vector<rocksdb::ColumnFamilyHandle*> handles;
@@ -567,7 +578,8 @@ bool RocksDBKVStore::commit(VB::Commit& commitData) {
     auto vbid = transactionCtx->vbid;
 
     // Flush all documents to disk
-    auto status = saveDocs(vbid, commitData, commitBatch);
+    std::vector<DocState> docStates;
+    auto status = saveDocs(vbid, commitData, commitBatch, docStates);
     if (!status.ok()) {
         logger.warn(
                 "RocksDBKVStore::commit: saveDocs error:{}, "
@@ -577,7 +589,7 @@ bool RocksDBKVStore::commit(VB::Commit& commitData) {
         success = false;
     }
 
-    commitCallback(status, commitBatch);
+    commitCallback(status, commitBatch, docStates);
 
     // This behaviour is to replicate the one in Couchstore.
     // Set `in_transanction = false` only if `commit` is successful.
@@ -590,9 +602,11 @@ bool RocksDBKVStore::commit(VB::Commit& commitData) {
 }
 
 void RocksDBKVStore::commitCallback(rocksdb::Status status,
-                                    const PendingRequestQueue& commitBatch) {
+                                    const PendingRequestQueue& commitBatch,
+                                    const std::vector<DocState>& docStates) {
     const auto flushSuccess = (status.code() == rocksdb::Status::Code::kOk);
-    for (const auto& request : commitBatch) {
+    for (size_t ii = 0; ii < commitBatch.size(); ++ii) {
+        const auto& request = commitBatch[ii];
         auto dataSize = request.getDocMetaSlice().size() +
                         request.getDocBodySlice().size();
         const auto& key = request.getKey();
@@ -603,12 +617,9 @@ void RocksDBKVStore::commitCallback(rocksdb::Status status,
         if (request.isDelete()) {
             FlushStateDeletion state;
             if (flushSuccess) {
-                // TODO: Should set `state` to Success or DocNotFound depending
-                //  on if this is a delete to an existing (Success) or
-                //  non-existing (DocNotFound) item. However, to achieve this we
-                //  would need to perform a Get to RocksDB which is costly. For
-                //  now just assume that the item did not exist.
-                state = FlushStateDeletion::DocNotFound;
+                state = docStates[ii] == DocState::Alive
+                                ? FlushStateDeletion::Delete
+                                : FlushStateDeletion::DocNotFound;
                 st.delTimeHisto.add(request.getDelta() / 1000);
             } else {
                 state = FlushStateDeletion::Failed;
@@ -618,12 +629,9 @@ void RocksDBKVStore::commitCallback(rocksdb::Status status,
         } else {
             FlushStateMutation state;
             if (flushSuccess) {
-                // TODO: Should set `state` to Insert or Update depending on
-                // whether we had already an alive item on disk or not.
-                // However, to achieve this we would need to perform a Get to
-                // RocksDB which is costly. For now just assume that the item
-                // did not exist.
-                state = FlushStateMutation::Insert;
+                state = docStates[ii] == DocState::Alive
+                                ? FlushStateMutation::Update
+                                : FlushStateMutation::Insert;
                 st.writeTimeHisto.add(request.getDelta() / 1000);
                 st.writeSizeHisto.add(dataSize + key.size());
             } else {
@@ -636,11 +644,60 @@ void RocksDBKVStore::commitCallback(rocksdb::Status status,
 }
 
 size_t RocksDBKVStore::getItemCount(Vbid vbid) {
-    const auto vbh = getVBHandle(vbid);
-    std::string val;
-    // TODO: Maintain an accurate item count, not just an estimate.
-    rdb->GetProperty(vbh->defaultCFH.get(), "rocksdb.estimate-num-keys", &val);
-    return std::stoi(val);
+    const auto vbh = findVBHandle(vbid);
+    return vbh ? vbh->itemCount.load() : 0;
+}
+
+size_t RocksDBKVStore::getNumPersistedDeletes(Vbid vbid) {
+    const auto vbh = findVBHandle(vbid);
+    return vbh ? vbh->deleteCount.load() : 0;
+}
+
+DBFileInfo RocksDBKVStore::getDbFileInfo(Vbid vbid) {
+    const auto vbh = findVBHandle(vbid);
+    return vbh ? getDbFileInfo(*vbh) : DBFileInfo{};
+}
+
+DBFileInfo RocksDBKVStore::getAggrDbFileInfo() {
+    std::vector<std::shared_ptr<VBHandle>> handles;
+    {
+        std::lock_guard<std::mutex> lg(vbhMutex);
+        handles = vbHandles;
+    }
+
+    DBFileInfo info;
+    for (const auto& vbh : handles) {
+        if (vbh) {
+            const auto vbInfo = getDbFileInfo(*vbh);
+            info.fileSize += vbInfo.fileSize;
+            info.spaceUsed += vbInfo.spaceUsed;
+        }
+    }
+    return info;
+}
+
+DBFileInfo RocksDBKVStore::getDbFileInfo(const VBHandle& vbh) {
+    // Memtables aren't included; like couchstore's file info this only
+    // reports what has reached disk.
+    DBFileInfo info;
+    for (auto* cfh : {vbh.defaultCFH.get(), vbh.seqnoCFH.get()}) {
+        uint64_t value = 0;
+        if (rdb->GetIntProperty(
+                    cfh, rocksdb::DB::Properties::kTotalSstFilesSize, &value)) {
+            info.fileSize += value;
+        }
+        if (rdb->GetIntProperty(cfh,
+                                rocksdb::DB::Properties::kEstimateLiveDataSize,
+                                &value)) {
+            info.spaceUsed += value;
+        }
+    }
+    return info;
+}
+
+std::shared_ptr<VBHandle> RocksDBKVStore::findVBHandle(Vbid vbid) {
+    std::lock_guard<std::mutex> lg(vbhMutex);
+    return vbHandles[vbid.get()];
 }
 
 void RocksDBKVStore::rollback() {
@@ -693,29 +750,83 @@ GetValue RocksDBKVStore::getWithHeader(const DiskDocKey& key,
 }
 
 void RocksDBKVStore::getMulti(Vbid vb, vb_bgfetch_queue_t& itms) {
-    // TODO RDB: RocksDB supports a multi get which we should use here.
-    for (auto& it : itms) {
-        auto& key = it.first;
-        rocksdb::Slice keySlice = getKeySlice(key);
-        rocksdb::PinnableSlice value;
-        const auto vbh = getVBHandle(vb);
-        rocksdb::Status s = rdb->Get(rocksdb::ReadOptions(),
-                                     vbh->defaultCFH.get(),
-                                     keySlice,
-                                     &value);
-        if (s.ok()) {
-            it.second.value =
-                    makeGetValue(vb, key, value, it.second.isMetaOnly);
-            GetValue* rv = &it.second.value;
-            for (auto& fetch : it.second.bgfetched_list) {
+    if (itms.empty()) {
+        return;
+    }
+
+    // MultiGet batches the memtable, block cache and SST lookups of all the
+    // keys (reading the blocks of keys which share them only once), which
+    // is most effective when the keys are given in order.
+    std::vector<vb_bgfetch_queue_t::iterator> fetches;
+    fetches.reserve(itms.size());
+    for (auto it = itms.begin(); it != itms.end(); ++it) {
+        fetches.push_back(it);
+    }
+    std::sort(fetches.begin(),
+              fetches.end(),
+              [this](const auto& a, const auto& b) {
+                  return getKeySlice(a->first).compare(
+                                 getKeySlice(b->first)) < 0;
+              });
+
+    std::vector<rocksdb::Slice> keys;
+    keys.reserve(fetches.size());
+    for (const auto& it : fetches) {
+        keys.push_back(getKeySlice(it->first));
+    }
+    std::vector<rocksdb::PinnableSlice> values(keys.size());
+    std::vector<rocksdb::Status> statuses(keys.size());
+
+    // Count the block reads the lookups needed, to report the read
+    // amplification.
+    const auto perfLevel = rocksdb::GetPerfLevel();
+    rocksdb::SetPerfLevel(rocksdb::PerfLevel::kEnableCount);
+    auto* perfContext = rocksdb::get_perf_context();
+    perfContext->Reset();
+
+    const auto vbh = getVBHandle(vb);
+    rdb->MultiGet(rocksdb::ReadOptions(),
+                  vbh->defaultCFH.get(),
+                  keys.size(),
+                  keys.data(),
+                  values.data(),
+                  statuses.data(),
+                  true /*sorted_input*/);
+
+    const auto readCount = perfContext->block_read_count;
+    const auto readBytes = perfContext->block_read_byte;
+    rocksdb::SetPerfLevel(perfLevel);
+
+    size_t docBytes = 0;
+    for (size_t ii = 0; ii < fetches.size(); ++ii) {
+        auto& key = fetches[ii]->first;
+        auto& ctx = fetches[ii]->second;
+        if (statuses[ii].ok()) {
+            ++st.io_bg_fetch_docs_read;
+            docBytes += key.size() + values[ii].size();
+            ctx.value = makeGetValue(vb, key, values[ii], ctx.isMetaOnly);
+            GetValue* rv = &ctx.value;
+            for (auto& fetch : ctx.bgfetched_list) {
                 fetch->value = rv;
             }
         } else {
-            for (auto& fetch : it.second.bgfetched_list) {
+            if (!statuses[ii].IsNotFound()) {
+                ++st.numGetFailure;
+            }
+            for (auto& fetch : ctx.bgfetched_list) {
                 fetch->value->setStatus(ENGINE_KEY_ENOENT);
             }
         }
     }
+
+    st.io_bgfetch_doc_bytes += docBytes;
+    st.getMultiFsReadCount += readCount;
+    st.getMultiFsReadHisto.add(readCount);
+    st.getMultiFsReadPerDocHisto.add(readCount / itms.size());
+    if (docBytes) {
+        st.getMultiReadAmplificationHisto.addValue((readBytes * 10) /
+                                                   docBytes);
+    }
 }
 
 void RocksDBKVStore::getRange(Vbid vb,
@@ -924,16 +1035,45 @@ bool RocksDBKVStore::getStat(const char* name_, size_t& value) {
         return true;
     }
 
+    // BGFetch stats
+    else if (name == "io_bg_fetch_read_count") {
+        value = st.getMultiFsReadCount;
+        return true;
+    }
+
     return false;
 }
 
+bool RocksDBKVStore::compactDB(std::shared_ptr<compaction_ctx> ctx) {
+    const auto vbh = findVBHandle(ctx->compactConfig.db_file_id);
+    if (!vbh) {
+        return true;
+    }
+
+    // Only the default CF has the expiry filter, so there's nothing to gain
+    // from compacting the seqno CF. By default (kIfHaveCompactionFilter)
+    // RocksDB compacts the bottommost level only because of the filter, so
+    // every document is checked without rewriting the CF any more than a
+    // filtered compaction needs to.
+    rocksdb::CompactRangeOptions options;
+    auto status = rdb->CompactRange(
+            options, vbh->defaultCFH.get(), nullptr, nullptr);
+    if (!status.ok()) {
+        logger.warn(
+                "RocksDBKVStore::compactDB: CompactRange error:{} [CF: {}], "
+                "{}",
+                status.getState(),
+                vbh->defaultCFH->GetName(),
+                vbh->vbid);
+        return false;
+    }
+    return true;
+}
+
 StorageProperties RocksDBKVStore::getStorageProperties() {
     StorageProperties rv(StorageProperties::EfficientVBDump::Yes,
                          StorageProperties::EfficientVBDeletion::Yes,
                          StorageProperties::PersistedDeletion::No,
-                         // TODO RDB: Not strictly true, multiGet
-                         // does not yet use the underlying multi get
-                         // of RocksDB
                          StorageProperties::EfficientGet::Yes,
                          StorageProperties::ConcurrentWriteCompact::Yes,
                          StorageProperties::ByIdScan::No);
@@ -1152,6 +1292,122 @@ rocksdb::Status RocksDBKVStore::saveVBStateToBatch(const VBHandle& vbh,
     return batch.Put(vbh.seqnoCFH.get(), keySlice, json.dump());
 }
 
+rocksdb::Status RocksDBKVStore::readDocStates(
+        const VBHandle& vbh,
+        const PendingRequestQueue& commitBatch,
+        std::vector<DocState>& docStates) {
+    const auto size = commitBatch.size();
+    std::vector<rocksdb::Slice> keys;
+    keys.reserve(size);
+    for (const auto& request : commitBatch) {
+        keys.push_back(getKeySlice(request.getKey()));
+    }
+
+    // Look the keys up in order (as getMulti does). Sorting stably also
+    // leaves any key written more than once in the batch next to its
+    // previous write.
+    std::vector<size_t> order(size);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) {
+        return keys[a].compare(keys[b]) < 0;
+    });
+    std::vector<rocksdb::Slice> sortedKeys;
+    sortedKeys.reserve(size);
+    for (const auto idx : order) {
+        sortedKeys.push_back(keys[idx]);
+    }
+
+    std::vector<rocksdb::PinnableSlice> values(size);
+    std::vector<rocksdb::Status> statuses(size);
+    rdb->MultiGet(rocksdb::ReadOptions(),
+                  vbh.defaultCFH.get(),
+                  size,
+                  sortedKeys.data(),
+                  values.data(),
+                  statuses.data(),
+                  true /*sorted_input*/);
+
+    docStates.resize(size);
+    for (size_t ii = 0; ii < size; ++ii) {
+        const auto idx = order[ii];
+        if (ii > 0 && sortedKeys[ii - 1] == sortedKeys[ii]) {
+            docStates[idx] = commitBatch[order[ii - 1]].isDelete()
+                                     ? DocState::Deleted
+                                     : DocState::Alive;
+        } else if (statuses[ii].ok()) {
+            rockskv::MetaData meta;
+            std::memcpy(&meta, values[ii].data(), sizeof(meta));
+            docStates[idx] = meta.deleted ? DocState::Deleted : DocState::Alive;
+        } else if (statuses[ii].IsNotFound()) {
+            docStates[idx] = DocState::Missing;
+        } else {
+            return statuses[ii];
+        }
+    }
+    return rocksdb::Status::OK();
+}
+
+void RocksDBKVStore::loadDocCounts(VBHandle& vbh) {
+    auto key = getDocCountsKey();
+    std::string jsonStr;
+    auto status = rdb->Get(rocksdb::ReadOptions(),
+                           vbh.seqnoCFH.get(),
+                           getSeqnoSlice(&key),
+                           &jsonStr);
+    if (status.ok()) {
+        try {
+            const auto json = nlohmann::json::parse(jsonStr);
+            vbh.itemCount = json.at("item_count").get<uint64_t>();
+            vbh.deleteCount = json.at("deleted_count").get<uint64_t>();
+            return;
+        } catch (const nlohmann::json::exception& e) {
+            logger.warn(
+                    "RocksDBKVStore::loadDocCounts: Failed to parse the doc "
+                    "counts for {}, json:{} with reason:{}",
+                    vbh.vbid,
+                    jsonStr,
+                    e.what());
+        }
+    } else if (!status.IsNotFound()) {
+        logger.warn(
+                "RocksDBKVStore::loadDocCounts: error getting doc counts "
+                "error:{}, {}",
+                status.getState(),
+                vbh.vbid);
+    }
+
+    // No (valid) counts persisted, e.g. the vBucket was written before they
+    // were maintained - count the documents once; the next commit persists
+    // the result.
+    uint64_t itemCount = 0;
+    uint64_t deleteCount = 0;
+    std::unique_ptr<rocksdb::Iterator> it(
+            rdb->NewIterator(rocksdb::ReadOptions(), vbh.defaultCFH.get()));
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        rockskv::MetaData meta;
+        std::memcpy(&meta, it->value().data(), sizeof(meta));
+        if (meta.deleted) {
+            ++deleteCount;
+        } else {
+            ++itemCount;
+        }
+    }
+    vbh.itemCount = itemCount;
+    vbh.deleteCount = deleteCount;
+}
+
+rocksdb::Status RocksDBKVStore::saveDocCountsToBatch(
+        const VBHandle& vbh,
+        uint64_t itemCount,
+        uint64_t deleteCount,
+        rocksdb::WriteBatch& batch) {
+    auto key = getDocCountsKey();
+    rocksdb::Slice keySlice = getSeqnoSlice(&key);
+    nlohmann::json json{{"item_count", itemCount},
+                        {"deleted_count", deleteCount}};
+    return batch.Put(vbh.seqnoCFH.get(), keySlice, json.dump());
+}
+
 rocksdb::ColumnFamilyOptions RocksDBKVStore::getBaselineDefaultCFOptions() {
     rocksdb::ColumnFamilyOptions cfOptions;
     // Note: While we *mostly* use only point-lookup, still need to support
@@ -1176,6 +1432,121 @@ rocksdb::ColumnFamilyOptions RocksDBKVStore::getBaselineSeqnoCFOptions() {
     return cfOptions;
 }
 
+class RocksDBKVStore::ExpiryCompactionFilter : public rocksdb::CompactionFilter {
+public:
+    ExpiryCompactionFilter(RocksDBKVStore& kvstore,
+                           EventuallyPersistentEngine* engine,
+                           Vbid vbid,
+                           std::shared_ptr<compaction_ctx> ctx)
+        : kvstore(kvstore), engine(engine), vbid(vbid), ctx(std::move(ctx)) {
+    }
+
+    ~ExpiryCompactionFilter() override {
+        // The context was allocated against the bucket
+        BucketAllocationGuard guard(engine);
+        ctx.reset();
+    }
+
+    bool Filter(int,
+                const rocksdb::Slice& key,
+                const rocksdb::Slice& value,
+                std::string*,
+                bool*) const override {
+        rockskv::MetaData meta;
+        std::memcpy(&meta, value.data(), sizeof(meta));
+
+        // Only committed, alive documents expire; a Prepare is completed by
+        // its Commit / Abort instead.
+        const auto op = meta.getOperation();
+        if (meta.deleted || meta.exptime == 0 ||
+            (op != rockskv::MetaData::Operation::Mutation &&
+             op != rockskv::MetaData::Operation::CommittedSyncWrite)) {
+            return false;
+        }
+
+        time_t currTime = ep_real_time();
+        if (meta.exptime >= currTime) {
+            return false;
+        }
+
+        // Keep the document: the engine expires it as usual, so the
+        // tombstone gets a seqno (and is replicated) and is persisted by the
+        // flusher. This runs on a RocksDB background thread, so account the
+        // Item (and whatever the engine allocates) to the bucket.
+        BucketAllocationGuard guard(engine);
+        auto item = kvstore.makeItem(vbid,
+                                     DiskDocKey{key.data(), key.size()},
+                                     value,
+                                     GetMetaOnly::No);
+        if (mcbp::datatype::is_snappy(item->getDataType())) {
+            item->decompressValue();
+        }
+        item->setDeleted(DeleteSource::TTL);
+        ctx->expiryCallback->callback(*item, currTime);
+        return false;
+    }
+
+    const char* Name() const override {
+        return "ExpiryCompactionFilter";
+    }
+
+private:
+    RocksDBKVStore& kvstore;
+    EventuallyPersistentEngine* const engine;
+    const Vbid vbid;
+    std::shared_ptr<compaction_ctx> ctx;
+};
+
+class RocksDBKVStore::ExpiryCompactionFilterFactory
+    : public rocksdb::CompactionFilterFactory {
+public:
+    /// Created on a bucket thread; the engine is captured for the RocksDB
+    /// background threads which create and run the filters
+    ExpiryCompactionFilterFactory(RocksDBKVStore& kvstore, Vbid vbid)
+        : kvstore(kvstore),
+          engine(ObjectRegistry::getCurrentEngine()),
+          vbid(vbid) {
+    }
+
+    std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
+            const rocksdb::CompactionFilter::Context&) override {
+        // As for Magma's implicit compactions, RocksDB can compact as soon
+        // as the DB is opened, before warmup has completed and
+        // makeCompactionContextCallback is set. Until then the documents
+        // can't be expired, so don't filter.
+        if (!kvstore.makeCompactionContextCallback) {
+            return nullptr;
+        }
+
+        BucketAllocationGuard guard(engine);
+        CompactionConfig config{};
+        config.db_file_id = vbid;
+        auto ctx = kvstore.makeCompactionContextCallback(config,
+                                                         0 /*purgeSeqno*/);
+        if (!ctx || !ctx->expiryCallback) {
+            return nullptr;
+        }
+        return std::make_unique<ExpiryCompactionFilter>(
+                kvstore, engine, vbid, std::move(ctx));
+    }
+
+    const char* Name() const override {
+        return "ExpiryCompactionFilterFactory";
+    }
+
+private:
+    RocksDBKVStore& kvstore;
+    EventuallyPersistentEngine* const engine;
+    const Vbid vbid;
+};
+
+rocksdb::ColumnFamilyOptions RocksDBKVStore::getDefaultCFOptions(Vbid vbid) {
+    auto cfOptions = defaultCFOptions;
+    cfOptions.compaction_filter_factory =
+            std::make_shared<ExpiryCompactionFilterFactory>(*this, vbid);
+    return cfOptions;
+}
+
 void RocksDBKVStore::applyUserCFOptions(rocksdb::ColumnFamilyOptions& cfOptions,
                                         const std::string& newCfOptions,
                                         const std::string& newBbtOptions) {
@@ -1253,7 +1624,8 @@ rocksdb::Status RocksDBKVStore::writeAndTimeBatch(rocksdb::WriteBatch batch) {
 rocksdb::Status RocksDBKVStore::saveDocs(
         Vbid vbid,
         VB::Commit& commitData,
-        const PendingRequestQueue& commitBatch) {
+        const PendingRequestQueue& commitBatch,
+        std::vector<DocState>& docStates) {
     auto reqsSize = commitBatch.size();
     if (reqsSize == 0) {
         st.docsCommitted = 0;
@@ -1266,6 +1638,42 @@ rocksdb::Status RocksDBKVStore::saveDocs(
 
     const auto vbh = getVBHandle(vbid);
 
+    // RocksDB can't tell us whether a Put creates or replaces a document,
+    // so read the documents' current state to maintain exact item and
+    // tombstone counts (and to report inserts vs updates).
+    status = readDocStates(*vbh, commitBatch, docStates);
+    if (!status.ok()) {
+        logger.warn(
+                "RocksDBKVStore::saveDocs: readDocStates error:{}, "
+                "{}",
+                status.code(),
+                vbid);
+        return status;
+    }
+
+    int64_t itemCount = vbh->itemCount;
+    int64_t deleteCount = vbh->deleteCount;
+    for (size_t ii = 0; ii < reqsSize; ++ii) {
+        const auto previous = docStates[ii];
+        if (commitBatch[ii].isDelete()) {
+            if (previous == DocState::Alive) {
+                --itemCount;
+            }
+            if (previous != DocState::Deleted) {
+                ++deleteCount;
+            }
+        } else {
+            if (previous != DocState::Alive) {
+                ++itemCount;
+            }
+            if (previous == DocState::Deleted) {
+                --deleteCount;
+            }
+        }
+    }
+    itemCount = std::max(itemCount, int64_t(0));
+    deleteCount = std::max(deleteCount, int64_t(0));
+
     for (const auto& request : commitBatch) {
         int64_t bySeqno = request.getDocMeta().bySeqno;
         maxDBSeqno = std::max(maxDBSeqno, bySeqno);
@@ -1312,6 +1720,13 @@ rocksdb::Status RocksDBKVStore::saveDocs(
         return status;
     }
 
+    status = saveDocCountsToBatch(*vbh, itemCount, deleteCount, batch);
+    if (!status.ok()) {
+        logger.warn("RocksDBKVStore::saveDocs: saveDocCountsToBatch error:{}",
+                    status.code());
+        return status;
+    }
+
     status = writeAndTimeBatch(batch);
     if (!status.ok()) {
         logger.warn(
@@ -1322,6 +1737,9 @@ rocksdb::Status RocksDBKVStore::saveDocs(
         return status;
     }
 
+    vbh->itemCount = itemCount;
+    vbh->deleteCount = deleteCount;
+
     st.batchSize.add(reqsSize);
     st.docsCommitted = reqsSize;
 
@@ -1403,6 +1821,12 @@ int64_t RocksDBKVStore::getVbstateKey() {
     return -9999;
 }
 
+int64_t RocksDBKVStore::getDocCountsKey() {
+    // Like VBState, the item and tombstone counts live in the SeqnoCF under
+    // a reserved negative key.
+    return -9998;
+}
+
 RocksDBKVStore::RocksDBHandle::RocksDBHandle(RocksDBKVStore& kvstore,
                                              rocksdb::DB& rdb)
     : snapshot(rdb.GetSnapshot(), rdb) {
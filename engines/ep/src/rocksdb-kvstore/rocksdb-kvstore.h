@@ -218,12 +218,13 @@ public:
     void optimizeWrites(std::vector<queued_item>&) {
     }
 
-    bool compactDB(std::shared_ptr<compaction_ctx>) override {
-        // Explicit compaction is not needed.
-        // Compaction is continuously occurring in separate threads
-        // under RocksDB's control
-        return true;
-    }
+    /**
+     * Explicit compaction is not needed - compaction is continuously
+     * occurring in separate threads under RocksDB's control. However an
+     * explicit request compacts the whole vBucket immediately, which (like
+     * any compaction) expires the TTL-expired documents it finds.
+     */
+    bool compactDB(std::shared_ptr<compaction_ctx> ctx) override;
 
     Vbid getDBFileId(const cb::mcbp::Request&) override {
         // Not needed if there is no explicit compaction
@@ -234,22 +235,11 @@ public:
         return cachedVBStates[vbucketId.get()].get();
     }
 
-    size_t getNumPersistedDeletes(Vbid vbid) override {
-        // TODO vmx 2016-10-29: implement
-        return 0;
-    }
+    size_t getNumPersistedDeletes(Vbid vbid) override;
 
-    DBFileInfo getDbFileInfo(Vbid vbid) override {
-        // TODO vmx 2016-10-29: implement
-        DBFileInfo vbinfo;
-        return vbinfo;
-    }
+    DBFileInfo getDbFileInfo(Vbid vbid) override;
 
-    DBFileInfo getAggrDbFileInfo() override {
-        // TODO vmx 2016-10-29: implement
-        DBFileInfo vbinfo;
-        return vbinfo;
-    }
+    DBFileInfo getAggrDbFileInfo() override;
 
     size_t getItemCount(Vbid vbid) override;
 
@@ -384,6 +374,10 @@ private:
 
     rocksdb::ColumnFamilyOptions getBaselineSeqnoCFOptions();
 
+    // The options of the given vBucket's default CF: 'defaultCFOptions' plus
+    // the vBucket's ExpiryCompactionFilterFactory.
+    rocksdb::ColumnFamilyOptions getDefaultCFOptions(Vbid vbid);
+
     // Helper function to apply the string-format 'newCfOptions' and
     // 'newBbtOptions' on top of 'cfOptions'.
     void applyUserCFOptions(rocksdb::ColumnFamilyOptions& cfOptions,
@@ -466,21 +460,63 @@ private:
                                        const vbucket_state& vbState,
                                        rocksdb::WriteBatch& batch);
 
+    /// The state of a document on disk before a commit() writes it.
+    enum class DocState : uint8_t { Missing, Alive, Deleted };
+
+    /**
+     * Flush the batch to disk, along with the vbucket state and the updated
+     * item and tombstone counts.
+     *
+     * @param [out] docStates the state of each document of the batch before
+     *        it was written
+     */
     rocksdb::Status saveDocs(Vbid vbid,
                              VB::Commit& commitData,
-                             const PendingRequestQueue& commitBatch);
+                             const PendingRequestQueue& commitBatch,
+                             std::vector<DocState>& docStates);
+
+    /**
+     * Read the state of each document of the batch before it is written,
+     * using a single MultiGet. A key written more than once in the batch
+     * takes its state from its previous write.
+     */
+    rocksdb::Status readDocStates(const VBHandle& vbh,
+                                  const PendingRequestQueue& commitBatch,
+                                  std::vector<DocState>& docStates);
+
+    /**
+     * Load the persisted item and tombstone counts of the given vBucket,
+     * counting the documents if the counts haven't been persisted yet.
+     */
+    void loadDocCounts(VBHandle& vbh);
+
+    // Add the item and tombstone counts to the local CF in the specified
+    // batch of writes.
+    rocksdb::Status saveDocCountsToBatch(const VBHandle& vbh,
+                                         uint64_t itemCount,
+                                         uint64_t deleteCount,
+                                         rocksdb::WriteBatch& batch);
+
+    // Sizes of the vBucket's SST files, from their table properties.
+    DBFileInfo getDbFileInfo(const VBHandle& vbh);
+
+    // @return the VBHandle for vbid, or nullptr if the vBucket doesn't exist
+    std::shared_ptr<VBHandle> findVBHandle(Vbid vbid);
 
     rocksdb::Status addRequestToWriteBatch(const VBHandle& db,
                                            rocksdb::WriteBatch& batch,
                                            const RocksRequest& request);
 
     void commitCallback(rocksdb::Status status,
-                        const PendingRequestQueue& commitBatch);
+                        const PendingRequestQueue& commitBatch,
+                        const std::vector<DocState>& docStates);
 
     int64_t readHighSeqnoFromDisk(const VBHandle& db);
 
     int64_t getVbstateKey();
 
+    int64_t getDocCountsKey();
+
     // Helper function to retrieve stats from the RocksDB MemoryUtil API.
     bool getStatFromMemUsage(const rocksdb::MemoryUtil::UsageType type,
                              size_t& value);
@@ -552,5 +588,10 @@ private:
         SnapshotPtr snapshot;
     };
 
+    // Expires (via the compaction context's expiryCallback) the documents
+    // whose TTL has elapsed as RocksDB compacts a vBucket's default CF.
+    class ExpiryCompactionFilter;
+    class ExpiryCompactionFilterFactory;
+
     BucketLogger& logger;
 };
@@ -431,6 +431,13 @@ public:
      */
     virtual seqno_t getHighestPurgedDeletedSeqno() const = 0;
 
+    /**
+     * Returns the longest time (in microseconds) tombstone purging held the
+     * list write lock for in one go, i.e. the longest time front-end writes
+     * could have been blocked by it.
+     */
+    virtual uint64_t getMaxPurgePauseMicros() const = 0;
+
     virtual uint64_t getMaxVisibleSeqno() const = 0;
 
     /**
@@ -452,12 +459,15 @@ public:
      * the SequenceList, new range iterator will not be allowed
      *
      * @param isBackfill indicates if the iterator is for backfill (for debug)
+     * @param startSeqno the lowest seqno the caller is interested in. The
+     *                   iterator may seek ahead to (but not beyond) it, hence
+     *                   the caller must still skip any items below it.
      *
      * @return range iterator object when possible
      *         null when not possible
      */
     virtual std::optional<SequenceList::RangeIterator> makeRangeIterator(
-            bool isBackfill) = 0;
+            bool isBackfill, seqno_t startSeqno = 1) = 0;
 
     /**
      * Debug - prints a representation of the list to stderr.
@@ -0,0 +1,228 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "seqno_access_log.h"
+
+extern "C" {
+#include "crc32.h"
+}
+
+#include <mcbp/protocol/unsigned_leb128.h>
+#include <platform/compress.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+SeqnoAccessLog::Writer::Writer(std::string path, size_t blockSize)
+    : path(std::move(path)), blockSize(std::max(blockSize, size_t(64))) {
+    fp = fopen(this->path.c_str(), "wb");
+    if (fp) {
+        const uint32_t header[] = {Magic, Version};
+        writeBytes(header, sizeof(header));
+    }
+}
+
+SeqnoAccessLog::Writer::~Writer() {
+    if (fp) {
+        fclose(fp);
+        remove(path.c_str());
+    }
+}
+
+void SeqnoAccessLog::Writer::write(Vbid vbid, std::vector<uint64_t>& seqnos) {
+    std::sort(seqnos.begin(), seqnos.end());
+    seqnos.erase(std::unique(seqnos.begin(), seqnos.end()), seqnos.end());
+    if (!fp || seqnos.empty()) {
+        return;
+    }
+
+    // Encode the blocks first, as the vBucket header records their number.
+    std::vector<std::pair<std::string, uint32_t>> blocks;
+    std::string payload;
+    uint32_t count = 0;
+    uint64_t prev = 0;
+    for (const auto seqno : seqnos) {
+        if (payload.size() + cb::mcbp::unsigned_leb128<uint64_t>::getMaxSize() >
+            blockSize) {
+            blocks.emplace_back(std::move(payload), count);
+            payload.clear();
+            count = 0;
+            prev = 0;
+        }
+        cb::mcbp::unsigned_leb128<uint64_t> delta(seqno - prev);
+        payload.append(reinterpret_cast<const char*>(delta.data()),
+                       delta.size());
+        prev = seqno;
+        ++count;
+    }
+    blocks.emplace_back(std::move(payload), count);
+
+    const uint16_t id = vbid.get();
+    const uint32_t numBlocks = blocks.size();
+    writeBytes(&id, sizeof(id));
+    writeBytes(&numBlocks, sizeof(numBlocks));
+    for (const auto& block : blocks) {
+        writeBlock(block.first, block.second);
+    }
+    numItems += seqnos.size();
+    ++numVBuckets;
+}
+
+void SeqnoAccessLog::Writer::writeBlock(const std::string& payload,
+                                        uint32_t count) {
+    cb::compression::Buffer deflated;
+    if (!cb::compression::deflate(cb::compression::Algorithm::Snappy,
+                                  {payload.data(), payload.size()},
+                                  deflated)) {
+        failed = true;
+        return;
+    }
+    const uint32_t header[] = {
+            count,
+            uint32_t(deflated.size()),
+            crc32buf(reinterpret_cast<uint8_t*>(deflated.data()),
+                     deflated.size())};
+    writeBytes(header, sizeof(header));
+    writeBytes(deflated.data(), deflated.size());
+}
+
+void SeqnoAccessLog::Writer::writeBytes(const void* data, size_t size) {
+    if (!failed && fwrite(data, size, 1, fp) != 1) {
+        failed = true;
+    }
+}
+
+bool SeqnoAccessLog::Writer::close() {
+    if (!fp) {
+        return false;
+    }
+    const uint16_t marker = FooterMarker;
+    writeBytes(&marker, sizeof(marker));
+    writeBytes(&numVBuckets, sizeof(numVBuckets));
+    if (fclose(fp) != 0) {
+        failed = true;
+    }
+    fp = nullptr;
+    if (failed) {
+        remove(path.c_str());
+    }
+    return !failed;
+}
+
+SeqnoAccessLog::Reader::Reader(std::string path) : path(std::move(path)) {
+    fp = fopen(this->path.c_str(), "rb");
+    if (!fp) {
+        throw ReadException("Failed to open seqno access log '" + this->path +
+                            "': " + strerror(errno));
+    }
+    uint32_t header[2];
+    if (fread(header, sizeof(header), 1, fp) != 1 || header[0] != Magic ||
+        header[1] != Version) {
+        fclose(fp);
+        throw ReadException("Invalid seqno access log header in '" +
+                            this->path + "'");
+    }
+
+    // Remember the file size to check the lengths read from it against
+    const auto start = ftell(fp);
+    if (start < 0 || fseek(fp, 0, SEEK_END) != 0 ||
+        (fileSize = ftell(fp)) < start || fseek(fp, start, SEEK_SET) != 0) {
+        fclose(fp);
+        throw ReadException("Failed to get the size of seqno access log '" +
+                            this->path + "'");
+    }
+}
+
+SeqnoAccessLog::Reader::~Reader() {
+    fclose(fp);
+}
+
+bool SeqnoAccessLog::Reader::next(Vbid& vbid, std::vector<uint64_t>& seqnos) {
+    seqnos.clear();
+    if (atEnd) {
+        return false;
+    }
+
+    uint16_t id;
+    readBytes(&id, sizeof(id));
+    if (id == FooterMarker) {
+        uint32_t expected;
+        readBytes(&expected, sizeof(expected));
+        if (expected != numVBuckets || fgetc(fp) != EOF) {
+            throw ReadException("Invalid seqno access log footer in '" +
+                                path + "'");
+        }
+        atEnd = true;
+        return false;
+    }
+    vbid = Vbid(id);
+
+    uint32_t numBlocks;
+    readBytes(&numBlocks, sizeof(numBlocks));
+    std::string compressed;
+    cb::compression::Buffer inflated;
+    for (uint32_t block = 0; block < numBlocks; ++block) {
+        uint32_t header[3];
+        readBytes(header, sizeof(header));
+        // Don't trust the length enough to allocate more than the file
+        // could possibly hold
+        const auto offset = ftell(fp);
+        if (offset < 0 || header[1] > uint64_t(fileSize - offset)) {
+            throw ReadException("Invalid block length in seqno access log '" +
+                                path + "' for " + to_string(vbid));
+        }
+        compressed.resize(header[1]);
+        readBytes(&compressed[0], compressed.size());
+        if (crc32buf(reinterpret_cast<uint8_t*>(&compressed[0]),
+                     compressed.size()) != header[2] ||
+            !cb::compression::inflate(cb::compression::Algorithm::Snappy,
+                                      {compressed.data(), compressed.size()},
+                                      inflated)) {
+            throw ReadException("Corrupt block in seqno access log '" + path +
+                                "' for " + to_string(vbid));
+        }
+
+        cb::const_byte_buffer buf{
+                reinterpret_cast<const uint8_t*>(inflated.data()),
+                inflated.size()};
+        uint64_t prev = 0;
+        for (uint32_t ii = 0; ii < header[0]; ++ii) {
+            if (buf.empty()) {
+                throw ReadException("Truncated block in seqno access log '" +
+                                    path + "' for " + to_string(vbid));
+            }
+            auto decoded =
+                    cb::mcbp::unsigned_leb128<uint64_t>::decodeNoThrow(buf);
+            if (decoded.second.data() == nullptr) {
+                throw ReadException("Invalid seqno in seqno access log '" +
+                                    path + "' for " + to_string(vbid));
+            }
+            prev += decoded.first;
+            seqnos.push_back(prev);
+            buf = decoded.second;
+        }
+    }
+    ++numVBuckets;
+    return true;
+}
+
+void SeqnoAccessLog::Reader::readBytes(void* data, size_t size) {
+    if (size && fread(data, size, 1, fp) != 1) {
+        throw ReadException("Truncated seqno access log '" + path + "'");
+    }
+}
@@ -0,0 +1,158 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+/**
+ * Seqno Access Log
+ *
+ * An alternative to the MutationLog based access log (alog_format=seqno).
+ * Rather than the key of every resident item, the AccessScanner records the
+ * seqno of each (sufficiently frequently accessed) resident item, sorted per
+ * vBucket. Warmup can then load the hot items with a single by-seqno scan of
+ * each vBucket, skipping the values of items not in the log, instead of
+ * fetching keys one at a time in log order.
+ *
+ * As with the MutationLog access log the contents are only a hint - an item
+ * modified since the log was written has a different seqno on disk and is
+ * simply not loaded.
+ *
+ * File format (integers in host byte order):
+ *
+ *     header:  uint32 magic, uint32 version
+ *     vBucket: uint16 vbid, uint32 numBlocks, then numBlocks blocks
+ *     block:   uint32 numSeqnos, uint32 length, uint32 crc32, then length
+ *              bytes of Snappy compressed payload
+ *     footer:  uint16 0xffff, uint32 number of vBuckets in the log
+ *
+ * Each block's payload is numSeqnos unsigned LEB128 deltas, the first
+ * relative to zero and each subsequent one relative to the previous seqno.
+ * The footer allows a truncated log to be detected.
+ */
+
+#include <memcached/vbucket.h>
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class SeqnoAccessLog {
+public:
+    class ReadException : public std::runtime_error {
+    public:
+        explicit ReadException(const std::string& s) : std::runtime_error(s) {
+        }
+    };
+
+    /**
+     * Writes a new log. Any write failure is remembered and reported by
+     * close() (at which point the partial file is removed).
+     */
+    class Writer {
+    public:
+        /**
+         * @param path the file to create (truncated if it exists)
+         * @param blockSize the maximum uncompressed size of a block
+         */
+        Writer(std::string path, size_t blockSize);
+
+        ~Writer();
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        bool isOpen() const {
+            return fp != nullptr;
+        }
+
+        /**
+         * Append the given seqnos of a vBucket to the log. Each vBucket
+         * should be written at most once.
+         *
+         * @param seqnos the seqnos to record; sorted (and de-duplicated) in
+         *        place.
+         */
+        void write(Vbid vbid, std::vector<uint64_t>& seqnos);
+
+        /**
+         * Write the footer and close the file.
+         * @return true if the whole log was written successfully
+         */
+        bool close();
+
+        /// @return the number of seqnos written
+        size_t getNumItems() const {
+            return numItems;
+        }
+
+    private:
+        void writeBlock(const std::string& payload, uint32_t count);
+        void writeBytes(const void* data, size_t size);
+
+        const std::string path;
+        const size_t blockSize;
+        FILE* fp = nullptr;
+        bool failed = false;
+        size_t numItems = 0;
+        uint32_t numVBuckets = 0;
+    };
+
+    /**
+     * Reads a log, one vBucket at a time.
+     */
+    class Reader {
+    public:
+        /**
+         * @throws ReadException if the file cannot be opened or isn't a
+         *         seqno access log
+         */
+        explicit Reader(std::string path);
+
+        ~Reader();
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        /**
+         * Read the next vBucket of the log.
+         *
+         * @param [out] vbid the vBucket read
+         * @param [out] seqnos its seqnos, in ascending order
+         * @return false if the end of the log was reached
+         * @throws ReadException if the log is truncated or corrupt
+         */
+        bool next(Vbid& vbid, std::vector<uint64_t>& seqnos);
+
+        const std::string& getPath() const {
+            return path;
+        }
+
+    private:
+        void readBytes(void* data, size_t size);
+
+        const std::string path;
+        FILE* fp = nullptr;
+        long fileSize = 0;
+        uint32_t numVBuckets = 0;
+        bool atEnd = false;
+    };
+
+    static constexpr uint32_t Magic = 0x534c4f47; // "SLOG"
+    static constexpr uint32_t Version = 1;
+    static constexpr uint16_t FooterMarker = 0xffff;
+};
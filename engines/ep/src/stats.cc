@@ -77,11 +77,18 @@ EPStats::EPStats()
       forceShutdown(false),
       oom_errors(0),
       tmp_oom_errors(0),
+      mutationThrottleDelayed(0),
+      mutationThrottleDelayTime(0),
+      dcpAckThrottleDelayTime(0),
       pendingOps(0),
       pendingOpsTotal(0),
       pendingOpsMax(0),
       pendingOpsMaxDuration(0),
       pendingCompactions(0),
+      compactionBytesWritten(0),
+      compactionDuration(0),
+      compactionWriteThrottledTime(0),
+      flusherStalls(0),
       bg_fetched(0),
       bg_meta_fetched(0),
       numRemainingBgItems(0),
@@ -281,12 +288,19 @@ void EPStats::reset() {
     bgMaxLoad.store(0);
     oom_errors.store(0);
     tmp_oom_errors.store(0);
+    mutationThrottleDelayed.store(0);
+    mutationThrottleDelayTime.store(0);
+    dcpAckThrottleDelayTime.store(0);
     pendingOps.store(0);
     pendingOpsTotal.store(0);
     pendingOpsMax.store(0);
     pendingOpsMaxDuration.store(0);
     vbucketDelMaxWalltime.store(0);
     vbucketDelTotWalltime.store(0);
+    compactionBytesWritten.store(0);
+    compactionDuration.store(0);
+    compactionWriteThrottledTime.store(0);
+    flusherStalls.store(0);
 
     alogRuns.store(0);
     accessScannerSkips.store(0), defragNumVisited.store(0),
@@ -308,6 +322,7 @@ void EPStats::reset() {
     delVbucketCmdHisto.reset();
     getCmdHisto.reset();
     storeCmdHisto.reset();
+    mutationThrottleHisto.reset();
     arithCmdHisto.reset();
     notifyIOHisto.reset();
     getStatsCmdHisto.reset();
@@ -355,6 +370,7 @@ size_t EPStats::getMemFootPrint() const {
            setVbucketCmdHisto.getMemFootPrint() +
            delVbucketCmdHisto.getMemFootPrint() +
            getCmdHisto.getMemFootPrint() + storeCmdHisto.getMemFootPrint() +
+           mutationThrottleHisto.getMemFootPrint() +
            arithCmdHisto.getMemFootPrint() + notifyIOHisto.getMemFootPrint() +
            getStatsCmdHisto.getMemFootPrint() +
            chkPersistenceHisto.getMemFootPrint() +
@@ -296,6 +296,13 @@ public:
     Counter oom_errors;
     //! Number of times temporary oom errors encountered while processing operations.
     Counter tmp_oom_errors;
+    //! Number of mutations delayed by the MutationThrottle
+    Counter mutationThrottleDelayed;
+    //! Total time mutations were delayed by the MutationThrottle (usec)
+    Counter mutationThrottleDelayTime;
+    //! Total time DCP consumer buffer acks were delayed by the
+    //! MutationThrottle (usec)
+    Counter dcpAckThrottleDelayTime;
 
     //! Number of ops blocked on all vbuckets in pending state
     Counter pendingOps;
@@ -311,6 +318,15 @@ public:
 
     //! Number of pending vbucket compaction requests
     Counter pendingCompactions;
+    //! Total bytes written by compaction
+    Counter compactionBytesWritten;
+    //! Total time spent compacting (usec)
+    Counter compactionDuration;
+    //! Total time compaction writes were delayed by the rate limiter (usec)
+    Counter compactionWriteThrottledTime;
+    //! Number of times the flusher skipped a vBucket as it was locked (e.g.
+    //! by compaction)
+    Counter flusherStalls;
 
     //! Number of times background fetches occurred.
     Counter bg_fetched;
@@ -489,6 +505,9 @@ public:
     //! Histogram of store commands.
     Hdr1sfMicroSecHistogram storeCmdHisto;
 
+    //! Histogram of the delays applied to mutations by the MutationThrottle.
+    Hdr1sfMicroSecHistogram mutationThrottleHisto;
+
     //! Histogram of arithmetic commands.
     Hdr1sfMicroSecHistogram arithCmdHisto;
 
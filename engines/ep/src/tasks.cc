@@ -64,6 +64,11 @@ bool CompactTask::run() {
      */
     compactionConfig.retain_erroneous_tombstones =
                              bucket.isRetainErroneousTombstones();
+
+    if (!bucket.acquireCompactionSlot(*this, compactionConfig.db_file_id)) {
+        // Snoozed until a compaction slot is available.
+        return true;
+    }
     return bucket.doCompact(compactionConfig, purgeSeqno, cookie);
 }
 
@@ -47,6 +47,9 @@ TASK(VKeyStatBGFetchTask, READER_TASK_IDX, 3)
 
 // Aux IO tasks
 TASK(VBucketMemoryAndDiskDeletionTask, AUXIO_TASK_IDX, 1)
+// On AuxIO rather than a writer thread, so that it may be throttled
+// (see compaction_write_rate_limit) without holding up the flusher.
+TASK(CompactVBucketTask, AUXIO_TASK_IDX, 2)
 TASK(AccessScanner, AUXIO_TASK_IDX, 3)
 TASK(AccessScannerVisitor, AUXIO_TASK_IDX, 3)
 TASK(ActiveStreamCheckpointProcessorTask, AUXIO_TASK_IDX, 5)
@@ -55,13 +58,14 @@ TASK(BackfillManagerTask, AUXIO_TASK_IDX, 8)
 
 // Read/Write IO tasks
 TASK(RollbackTask, WRITER_TASK_IDX, 1)
-TASK(CompactVBucketTask, WRITER_TASK_IDX, 2)
 TASK(FlusherTask, WRITER_TASK_IDX, 5)
 TASK(StatSnap, WRITER_TASK_IDX, 9)
 
 // Non-IO tasks
 TASK(PendingOpsNotification, NONIO_TASK_IDX, 0)
 TASK(RespondAmbiguousNotification, NONIO_TASK_IDX, 0)
+TASK(MutationThrottleNotification, NONIO_TASK_IDX, 0)
+TASK(DcpAckThrottleNotification, NONIO_TASK_IDX, 0)
 TASK(NotifyHighPriorityReqTask, NONIO_TASK_IDX, 0)
 TASK(ItemPager, NONIO_TASK_IDX, 1)
 TASK(ExpiredItemPager, NONIO_TASK_IDX, 1)
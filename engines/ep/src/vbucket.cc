@@ -841,7 +841,34 @@ ENGINE_ERROR_CODE VBucket::commit(
         const Collections::VB::Manifest::CachingReadHandle& cHandle,
         const void* cookie) {
     Expects(cHandle.valid());
-    auto res = ht.findForUpdate(key);
+    VBNotifyCtx notify;
+    {
+        auto res = ht.findForUpdate(key);
+        ENGINE_ERROR_CODE status;
+        std::tie(status, notify) = commitInner(
+                res, key, prepareSeqno, commitSeqno, nullptr /*batch*/);
+        if (status != ENGINE_SUCCESS) {
+            return status;
+        }
+    }
+
+    notifyNewSeqno(notify);
+    doCollectionsStats(cHandle, notify);
+
+    // Cookie representing the client connection, provided only at Active
+    if (cookie) {
+        notifyClientOfSyncWriteComplete(cookie, ENGINE_SUCCESS);
+    }
+
+    return ENGINE_SUCCESS;
+}
+
+std::pair<ENGINE_ERROR_CODE, VBNotifyCtx> VBucket::commitInner(
+        HashTable::FindUpdateResult& res,
+        const DocKey& key,
+        uint64_t prepareSeqno,
+        std::optional<int64_t> commitSeqno,
+        CheckpointQueueBatch* checkpointBatch) {
     if (!res.pending) {
         // If we are committing we /should/ always find the pending item.
         EP_LOG_ERR(
@@ -851,7 +878,7 @@ ENGINE_ERROR_CODE VBucket::commit(
                 cb::UserDataView(key.to_string()),
                 prepareSeqno,
                 to_string_or_none(commitSeqno));
-        return ENGINE_KEY_ENOENT;
+        return {ENGINE_KEY_ENOENT, {}};
     }
 
     Expects(prepareSeqno);
@@ -877,30 +904,47 @@ ENGINE_ERROR_CODE VBucket::commit(
 
     queueItmCtx.durability =
             DurabilityItemCtx{res.pending->getBySeqno(), nullptr /*cookie*/};
+    queueItmCtx.checkpointBatch = checkpointBatch;
 
-    auto notify =
-            commitStoredValue(res, prepareSeqno, queueItmCtx, commitSeqno);
+    return {ENGINE_SUCCESS,
+            commitStoredValue(res, prepareSeqno, queueItmCtx, commitSeqno)};
+}
+
+ENGINE_ERROR_CODE VBucket::abort(
+        const DocKey& key,
+        uint64_t prepareSeqno,
+        std::optional<int64_t> abortSeqno,
+        const Collections::VB::Manifest::CachingReadHandle& cHandle,
+        const void* cookie) {
+    Expects(cHandle.valid());
+    VBNotifyCtx notify;
+    {
+        auto htRes = ht.findForUpdate(key);
+        ENGINE_ERROR_CODE status;
+        std::tie(status, notify) = abortInner(
+                htRes, key, prepareSeqno, abortSeqno, nullptr /*batch*/);
+        if (status != ENGINE_SUCCESS) {
+            return status;
+        }
+    }
 
     notifyNewSeqno(notify);
     doCollectionsStats(cHandle, notify);
 
     // Cookie representing the client connection, provided only at Active
     if (cookie) {
-        notifyClientOfSyncWriteComplete(cookie, ENGINE_SUCCESS);
+        notifyClientOfSyncWriteComplete(cookie, ENGINE_SYNC_WRITE_AMBIGUOUS);
     }
 
     return ENGINE_SUCCESS;
 }
 
-ENGINE_ERROR_CODE VBucket::abort(
+std::pair<ENGINE_ERROR_CODE, VBNotifyCtx> VBucket::abortInner(
+        HashTable::FindUpdateResult& htRes,
         const DocKey& key,
         uint64_t prepareSeqno,
         std::optional<int64_t> abortSeqno,
-        const Collections::VB::Manifest::CachingReadHandle& cHandle,
-        const void* cookie) {
-    Expects(cHandle.valid());
-    auto htRes = ht.findForUpdate(key);
-
+        CheckpointQueueBatch* checkpointBatch) {
     // This block handles the case where at Replica we receive an Abort but we
     // do not have any in-flight Prepare in the HT. That is possible when
     // Replica receives a Backfill (Disk) Snapshot (for both EP and Ephemeral
@@ -920,14 +964,14 @@ ENGINE_ERROR_CODE VBucket::abort(
                         "CommittedState::Pending - {}",
                         id,
                         cb::UserData(ss.str()));
-                return ENGINE_EINVAL;
+                return {ENGINE_EINVAL, {}};
             } else {
                 EP_LOG_ERR(
                         "VBucket::abort ({}) - active failed as no HashTable"
                         "item found with key:{}",
                         id,
                         cb::UserDataView(key.to_string()));
-                return ENGINE_KEY_ENOENT;
+                return {ENGINE_KEY_ENOENT, {}};
             }
         }
 
@@ -942,7 +986,7 @@ ENGINE_ERROR_CODE VBucket::abort(
                     id,
                     prepareSeqno,
                     to_string_or_none(abortSeqno));
-            return ENGINE_EINVAL;
+            return {ENGINE_EINVAL, {}};
         }
 
         // If we did not find the corresponding prepare for this abort then the
@@ -957,7 +1001,7 @@ ENGINE_ERROR_CODE VBucket::abort(
                     id,
                     prepareSeqno,
                     checkpointManager->getOpenSnapshotStartSeqno());
-            return ENGINE_EINVAL;
+            return {ENGINE_EINVAL, {}};
         }
 
         // Replica is receiving a legal Abort but we do not have any in-flight
@@ -967,6 +1011,8 @@ ENGINE_ERROR_CODE VBucket::abort(
         // 2) Else, if we have a Completed pending in the HT (possible only at
         //     Ephemeral) then we have to convert/update the existing pending
         //     into a new PersistedAborted item
+        // Batches are only used at Active, so never reach here.
+        Expects(!checkpointBatch);
         VBNotifyCtx ctx;
         if (!htRes.pending) {
             ctx = addNewAbort(
@@ -977,13 +1023,11 @@ ENGINE_ERROR_CODE VBucket::abort(
             ctx = abortStoredValue(htRes.pending.getHBL(),
                                    *htRes.pending.release(),
                                    prepareSeqno,
-                                   *abortSeqno);
+                                   *abortSeqno,
+                                   nullptr /*batch*/);
         }
 
-        notifyNewSeqno(ctx);
-        doCollectionsStats(cHandle, ctx);
-
-        return ENGINE_SUCCESS;
+        return {ENGINE_SUCCESS, ctx};
     }
 
     // If prepare seqno is not the same as our stored seqno then we should be
@@ -997,20 +1041,100 @@ ENGINE_ERROR_CODE VBucket::abort(
     // abortStoredValue deallocates the pending SV, releasing here so
     // ~StoredValueProxy will not attempt to update stats and lead to
     // use-after-free
-    auto notify = abortStoredValue(htRes.pending.getHBL(),
-                                   *htRes.pending.release(),
-                                   prepareSeqno,
-                                   abortSeqno);
+    return {ENGINE_SUCCESS,
+            abortStoredValue(htRes.pending.getHBL(),
+                             *htRes.pending.release(),
+                             prepareSeqno,
+                             abortSeqno,
+                             checkpointBatch)};
+}
 
-    notifyNewSeqno(notify);
-    doCollectionsStats(cHandle, notify);
+void VBucket::completeSyncWrites(std::vector<SyncWriteCompletion>& batch) {
+    if (batch.empty()) {
+        return;
+    }
 
-    // Cookie representing the client connection, provided only at Active
-    if (cookie) {
-        notifyClientOfSyncWriteComplete(cookie, ENGINE_SYNC_WRITE_AMBIGUOUS);
+    // Client notifications are deferred until all locks are released. The
+    // front-end also coalesces them into a single wakeup per worker thread.
+    std::vector<std::pair<const void*, ENGINE_ERROR_CODE>> toNotify;
+    toNotify.reserve(batch.size());
+
+    // Flusher / DCP only need notifying once, of the highest seqno queued.
+    VBNotifyCtx batchNotify;
+    {
+        // Lock order (as per commit() / abort()): collections manifest,
+        // HashBucketLock(s), CheckpointManager::queueLock.
+        auto collectionsRHandle = lockCollections();
+
+        std::vector<DocKey> keys;
+        keys.reserve(batch.size());
+        for (auto& sw : batch) {
+            if (collectionsRHandle.doesKeyContainValidCollection(sw.key)) {
+                keys.push_back(sw.key);
+            } else {
+                // Collection no longer exists, cannot complete.
+                sw.status = ENGINE_UNKNOWN_COLLECTION;
+            }
+        }
+
+        HashTable::MultiBucketLock bucketLocks(ht, keys);
+
+        std::optional<CheckpointQueueBatch> checkpointBatch;
+        if (canBatchCheckpointQueueing()) {
+            checkpointBatch.emplace(*checkpointManager);
+        }
+        auto* batchPtr = checkpointBatch ? &*checkpointBatch : nullptr;
+
+        for (auto& sw : batch) {
+            if (sw.status == ENGINE_UNKNOWN_COLLECTION) {
+                if (sw.cookie) {
+                    toNotify.emplace_back(sw.cookie,
+                                          ENGINE_SYNC_WRITE_AMBIGUOUS);
+                }
+                continue;
+            }
+
+            auto res = ht.findForUpdate(bucketLocks.lend(sw.key), sw.key);
+            VBNotifyCtx notify;
+            if (sw.resolution == SyncWriteCompletion::Resolution::Commit) {
+                std::tie(sw.status, notify) = commitInner(
+                        res, sw.key, sw.prepareSeqno, {}, batchPtr);
+            } else {
+                std::tie(sw.status, notify) = abortInner(
+                        res, sw.key, sw.prepareSeqno, {}, batchPtr);
+            }
+            // Take back the lock before the StoredValueProxy is destroyed;
+            // its stats epilogue still runs under the (held) mutex.
+            bucketLocks.giveBack(std::move(res.pending.getHBL()));
+
+            if (sw.status != ENGINE_SUCCESS) {
+                continue;
+            }
+
+            doCollectionsStats(
+                    collectionsRHandle, sw.key.getCollectionID(), notify);
+            batchNotify.bySeqno = notify.bySeqno;
+            batchNotify.notifyFlusher |= notify.notifyFlusher;
+            batchNotify.notifyReplication |= notify.notifyReplication;
+
+            // Cookie representing the client connection
+            if (sw.cookie) {
+                toNotify.emplace_back(
+                        sw.cookie,
+                        sw.resolution == SyncWriteCompletion::Resolution::Commit
+                                ? ENGINE_SUCCESS
+                                : ENGINE_SYNC_WRITE_AMBIGUOUS);
+            }
+        }
     }
 
-    return ENGINE_SUCCESS;
+    if (batchNotify.bySeqno) {
+        notifyNewSeqno(batchNotify);
+    }
+
+    for (const auto& entry : toNotify) {
+        notifyClientOfSyncWriteComplete(entry.first, entry.second);
+    }
 }
 
 void VBucket::notifyActiveDMOfLocalSyncWrite() {
@@ -1215,6 +1339,28 @@ size_t VBucket::getNumOfKeysInFilter() {
     }
 }
 
+bool VBucket::saveFilter(const std::string& fname) {
+    LockHolder lh(bfMutex);
+    if (!bFilter || bFilter->getStatus() != BFILTER_ENABLED) {
+        return false;
+    }
+    return bFilter->save(fname, getPersistenceSeqno());
+}
+
+bool VBucket::loadFilter(const std::string& fname, uint64_t persistedSeqno) {
+    auto filter = BloomFilter::load(fname, persistedSeqno);
+    if (!filter) {
+        return false;
+    }
+
+    LockHolder lh(bfMutex);
+    if (bFilter || tempFilter) {
+        return false;
+    }
+    bFilter = std::move(filter);
+    return true;
+}
+
 VBNotifyCtx VBucket::queueItem(queued_item& item, const VBQueueItemCtx& ctx) {
     // Ensure that durable writes are queued with the same seqno-order in both
     // Backfill/CheckpointManager Queues and DurabilityMonitor. Note that
@@ -1226,13 +1372,23 @@ VBNotifyCtx VBucket::queueItem(queued_item& item, const VBQueueItemCtx& ctx) {
     }
 
     VBNotifyCtx notifyCtx;
+    if (ctx.checkpointBatch) {
+        notifyCtx.notifyFlusher =
+                checkpointManager->queueDirty(*ctx.checkpointBatch,
+                                              *this,
+                                              item,
+                                              ctx.genBySeqno,
+                                              ctx.genCas,
+                                              ctx.preLinkDocumentContext);
+    } else {
         notifyCtx.notifyFlusher =
                 checkpointManager->queueDirty(*this,
                                               item,
                                               ctx.genBySeqno,
                                               ctx.genCas,
                                               ctx.preLinkDocumentContext);
-        notifyCtx.notifyReplication = true;
+    }
+    notifyCtx.notifyReplication = true;
     notifyCtx.bySeqno = item->getBySeqno();
     notifyCtx.syncWrite = item->isPending() ? SyncWriteOperation::Yes
                                             : SyncWriteOperation::No;
@@ -39,6 +39,7 @@
 class ActiveDurabilityMonitor;
 struct CheckpointSnapshotRange;
 class CheckpointManager;
+class CheckpointQueueBatch;
 class CheckpointConfig;
 class ConflictResolution;
 class Configuration;
@@ -697,6 +698,24 @@ public:
     size_t getFilterSize();
     size_t getNumOfKeysInFilter();
 
+    /**
+     * Write the (enabled) bloom filter to the given file so that the next
+     * warmup can load it rather than waiting for a compaction to rebuild it.
+     * The caller must ensure every key on disk is in the filter (i.e. the
+     * vBucket has been fully persisted).
+     *
+     * @return true if a filter was written
+     */
+    bool saveFilter(const std::string& fname);
+
+    /**
+     * Install the bloom filter saved in the given file, provided no filter
+     * exists yet and the file was saved at the given persisted seqno.
+     *
+     * @return true if the filter was loaded
+     */
+    bool loadFilter(const std::string& fname, uint64_t persistedSeqno);
+
     uint64_t nextHLCCas() {
         return hlc.nextHLC();
     }
@@ -1428,6 +1447,54 @@ public:
             const Collections::VB::Manifest::CachingReadHandle& cHandle,
             const void* cookie = nullptr);
 
+    /**
+     * A SyncWrite resolved by the ActiveDurabilityMonitor, to be completed
+     * as part of a batch via completeSyncWrites().
+     */
+    struct SyncWriteCompletion {
+        enum class Resolution { Commit, Abort };
+
+        SyncWriteCompletion(const DocKey& key,
+                            int64_t prepareSeqno,
+                            Resolution resolution,
+                            const void* cookie)
+            : key(key),
+              prepareSeqno(prepareSeqno),
+              resolution(resolution),
+              cookie(cookie) {
+        }
+
+        DocKey key;
+        int64_t prepareSeqno;
+        Resolution resolution;
+        /// The client cookie to notify (if any) once completed
+        const void* cookie;
+        /// The outcome of completing this SyncWrite; set by
+        /// completeSyncWrites().
+        ENGINE_ERROR_CODE status = ENGINE_SUCCESS;
+    };
+
+    /**
+     * Commit / abort a batch of SyncWrites resolved by the
+     * ActiveDurabilityMonitor, in the order given (which must be prepare
+     * seqno order). Active vBuckets only.
+     *
+     * Compared to calling commit() / abort() for each SyncWrite this:
+     * - acquires the collections manifest (shared) lock once;
+     * - acquires the HashBucketLocks of all keys up-front, in sorted order;
+     * - for EP vBuckets, acquires the CheckpointManager queueLock once;
+     * - notifies the flusher / DCP of new seqnos once for the whole batch;
+     * - notifies client cookies only once all locks have been released.
+     *
+     * On return, the status of each element is ENGINE_SUCCESS if it was
+     * completed, ENGINE_UNKNOWN_COLLECTION if its collection no longer exists
+     * (the client is notified that the SyncWrite is ambiguous), otherwise the
+     * error which commit() / abort() would have returned.
+     *
+     * @param batch SyncWrites to complete
+     */
+    void completeSyncWrites(std::vector<SyncWriteCompletion>& batch);
+
     /**
      * Notify the ActiveDurabilityMonitor that a SyncWrite has been locally
      * accepted into memory, and if that SyncWrite has met durability
@@ -1636,6 +1703,12 @@ public:
      */
     static void setMutationMemoryThreshold(size_t memThreshold);
 
+    /// @return the memory threshold (as a fraction of the bucket quota) for
+    ///         accepting a new mutation
+    static double getMutationMemoryThreshold() {
+        return mutationMemThreshold;
+    }
+
     /**
      * Check if this StoredValue has become logically non-existent.
      * By logically non-existent, the item has been deleted
@@ -2199,6 +2272,30 @@ private:
 
     void decrDirtyQueuePendingWrites(size_t decrementBy);
 
+    /**
+     * Inner implementation of commit(): commits the pending SyncWrite found
+     * in `res` (under its HashBucketLock) without notifying anyone.
+     *
+     * @param checkpointBatch If non-null, the batch to queue the commit under
+     * @return status of the commit, and who should be notified of it.
+     */
+    std::pair<ENGINE_ERROR_CODE, VBNotifyCtx> commitInner(
+            HashTable::FindUpdateResult& res,
+            const DocKey& key,
+            uint64_t prepareSeqno,
+            std::optional<int64_t> commitSeqno,
+            CheckpointQueueBatch* checkpointBatch);
+
+    /**
+     * Inner implementation of abort(); see commitInner().
+     */
+    std::pair<ENGINE_ERROR_CODE, VBNotifyCtx> abortInner(
+            HashTable::FindUpdateResult& htRes,
+            const DocKey& key,
+            uint64_t prepareSeqno,
+            std::optional<int64_t> abortSeqno,
+            CheckpointQueueBatch* checkpointBatch);
+
     /**
      * Updates an existing StoredValue in in-memory data structures like HT.
      * Assumes that HT bucket lock is grabbed.
@@ -2298,12 +2395,23 @@ private:
      * @param prepareSeqno The seqno of the Prepare sync-write being aborted
      * @param abortSeqno Optional seqno to use for the aborted item. If omitted
      *     then CheckpointManager will generate one.
+     * @param checkpointBatch If non-null, the batch (holding the
+     *     CheckpointManager queueLock) to queue the abort under.
      * @return Information on who should be notified of the commit.
      */
-    virtual VBNotifyCtx abortStoredValue(const HashTable::HashBucketLock& hbl,
-                                         StoredValue& v,
-                                         int64_t prepareSeqno,
-                                         std::optional<int64_t> abortSeqno) = 0;
+    virtual VBNotifyCtx abortStoredValue(
+            const HashTable::HashBucketLock& hbl,
+            StoredValue& v,
+            int64_t prepareSeqno,
+            std::optional<int64_t> abortSeqno,
+            CheckpointQueueBatch* checkpointBatch) = 0;
+
+    /**
+     * @returns true if the CheckpointManager queueLock can be acquired up-front
+     * (before per-item locks taken by commitStoredValue / abortStoredValue)
+     * when completing a batch of SyncWrites.
+     */
+    virtual bool canBatchCheckpointQueueing() const = 0;
 
     /**
      * Add a new abort item. To be used when an abort has been received, but the
@@ -23,6 +23,7 @@
 #include <optional>
 #include <variant>
 
+class CheckpointQueueBatch;
 class PreLinkDocumentContext;
 
 /**
@@ -89,4 +90,7 @@ struct VBQueueItemCtx {
     /// Passed into the durability monitor to instruct it to remove an old
     /// prepare with the given seqno
     std::optional<int64_t> overwritingPrepareSeqno = {};
+    /// If non-null, the item is queued into the CheckpointManager under the
+    /// queueLock already held by this batch (rather than acquiring it again).
+    CheckpointQueueBatch* checkpointBatch = nullptr;
 };
@@ -31,6 +31,7 @@
 #include "item.h"
 #include "kvstore.h"
 #include "mutation_log.h"
+#include "seqno_access_log.h"
 #include "statwriter.h"
 #include "vb_visitors.h"
 #include "vbucket_bgfetch_item.h"
@@ -42,6 +43,7 @@
 #include <utilities/logtags.h>
 
 #include <array>
+#include <cstdio>
 #include <limits>
 #include <memory>
 #include <random>
@@ -115,15 +117,88 @@ private:
 
 class LoadValueCallback : public StatusCallback<CacheLookup> {
 public:
-    LoadValueCallback(VBucketMap& vbMap, WarmupState::State warmupState)
-        : vbuckets(vbMap), warmupState(warmupState) {
+    /**
+     * @param batchRemaining if non-null, the number of values which may be
+     *        loaded before the scan is paused (decremented for each value)
+     */
+    LoadValueCallback(VBucketMap& vbMap,
+                      WarmupState::State warmupState,
+                      size_t* batchRemaining = nullptr)
+        : vbuckets(vbMap),
+          warmupState(warmupState),
+          batchRemaining(batchRemaining) {
     }
 
     void callback(CacheLookup& lookup) override;
 
+    /// @return true if the scan was paused as the batch was exhausted
+    bool isPaused() const {
+        return paused;
+    }
+
+    void resume() {
+        paused = false;
+    }
+
 private:
     VBucketMap& vbuckets;
     WarmupState::State warmupState;
+    size_t* batchRemaining;
+    bool paused = false;
+};
+
+/**
+ * Cache lookup callback used when loading a seqno access log; only the
+ * values of the items at the logged seqnos are read from disk, and the scan
+ * is cancelled once it is past the last of them.
+ */
+class AccessLogSeqnoLookup : public StatusCallback<CacheLookup> {
+public:
+    AccessLogSeqnoLookup(VBucketMap& vbMap, std::vector<uint64_t> seqnos)
+        : vbuckets(vbMap), seqnos(std::move(seqnos)) {
+    }
+
+    void callback(CacheLookup& lookup) override;
+
+    /// @return true if the scan was cancelled as all seqnos were visited
+    bool isExhausted() const {
+        return next == seqnos.size();
+    }
+
+private:
+    VBucketMap& vbuckets;
+    const std::vector<uint64_t> seqnos;
+    /// Index of the next logged seqno the scan hasn't yet passed
+    size_t next = 0;
+};
+
+/**
+ * Where a shard's background (online) load got to, so that its task can give
+ * up the reader thread between batches.
+ */
+struct Warmup::BackgroundLoad {
+    std::chrono::steady_clock::time_point start;
+
+    // LoadingAccessLog
+    /// The seqno access log being loaded, a vBucket per run
+    std::unique_ptr<SeqnoAccessLog::Reader> seqnoLog;
+    /// 0: the seqno access log, 1: its previous copy, 2: neither is usable
+    int seqnoLogIndex = 0;
+    /// The log being loaded; the shard's access log or, if that could not be
+    /// read, its previous copy (oldLog).
+    MutationLog* accessLog = nullptr;
+    std::unique_ptr<MutationLog> oldLog;
+    std::unique_ptr<MutationLogHarvester> harvester;
+    std::unique_ptr<MutationLog::iterator> accessLogPos;
+
+    // LoadingData
+    std::vector<Vbid> vbids;
+    /// Index into vbids of the vBucket being scanned
+    size_t vbIndex = 0;
+    std::unique_ptr<BySeqnoScanContext> scanCtx;
+    /// The lookup callback of scanCtx (owned by it)
+    LoadValueCallback* lookup = nullptr;
+    size_t batchRemaining = 0;
 };
 
 // Warmup Tasks ///////////////////////////////////////////////////////////////
@@ -434,7 +509,14 @@ public:
 
     bool run() override {
         TRACE_EVENT0("ep-engine/task", "WarmupLoadAccessLog");
-        _warmup->loadingAccessLog(_shardId);
+        if (_warmup->isBackgroundLoading()) {
+            if (_warmup->loadAccessLogBatch(_shardId)) {
+                snooze(_warmup->getBackgroundLoadDelay());
+                return true;
+            }
+        } else {
+            _warmup->loadingAccessLog(_shardId);
+        }
         _warmup->removeFromTaskSet(uid);
         return false;
     }
@@ -447,12 +529,14 @@ private:
 
 class WarmupLoadingKVPairs : public GlobalTask {
 public:
-    WarmupLoadingKVPairs(EPBucket& st, uint16_t sh, Warmup* w)
+    WarmupLoadingKVPairs(EPBucket& st, uint16_t sh, size_t part, Warmup* w)
         : GlobalTask(&st.getEPEngine(), TaskId::WarmupLoadingKVPairs, 0, false),
           _shardId(sh),
+          _part(part),
           _warmup(w),
           _description("Warmup - loading KV Pairs: shard " +
-                       std::to_string(_shardId)) {
+                       std::to_string(_shardId) + " part " +
+                       std::to_string(_part)) {
         _warmup->addToTaskSet(uid);
     }
 
@@ -471,25 +555,28 @@ public:
 
     bool run() override {
         TRACE_EVENT0("ep-engine/task", "WarmupLoadingKVPairs");
-        _warmup->loadKVPairsforShard(_shardId);
+        _warmup->loadKVPairsforShard(_shardId, _part);
         _warmup->removeFromTaskSet(uid);
         return false;
     }
 
 private:
     uint16_t _shardId;
+    size_t _part;
     Warmup* _warmup;
     const std::string _description;
 };
 
 class WarmupLoadingData : public GlobalTask {
 public:
-    WarmupLoadingData(EPBucket& st, uint16_t sh, Warmup* w)
+    WarmupLoadingData(EPBucket& st, uint16_t sh, size_t part, Warmup* w)
         : GlobalTask(&st.getEPEngine(), TaskId::WarmupLoadingData, 0, false),
           _shardId(sh),
+          _part(part),
           _warmup(w),
           _description("Warmup - loading data: shard " +
-                       std::to_string(_shardId)) {
+                       std::to_string(_shardId) + " part " +
+                       std::to_string(_part)) {
         _warmup->addToTaskSet(uid);
     }
 
@@ -508,13 +595,21 @@ public:
 
     bool run() override {
         TRACE_EVENT0("ep-engine/task", "WarmupLoadingData");
-        _warmup->loadDataforShard(_shardId);
+        if (_warmup->isBackgroundLoading()) {
+            if (_warmup->loadDataBatch(_shardId, _part)) {
+                snooze(_warmup->getBackgroundLoadDelay());
+                return true;
+            }
+        } else {
+            _warmup->loadDataforShard(_shardId, _part);
+        }
         _warmup->removeFromTaskSet(uid);
         return false;
     }
 
 private:
     uint16_t _shardId;
+    size_t _part;
     Warmup* _warmup;
     const std::string _description;
 };
@@ -725,7 +820,9 @@ void LoadStorageKVPairCallback::callback(GetValue &val) {
     }
 
     bool stopLoading = false;
-    if (i != NULL && !epstore.getWarmup()->isComplete()) {
+    auto* warmup = epstore.getWarmup();
+    const bool backgroundLoading = warmup->isBackgroundLoading();
+    if (i != NULL && (!warmup->isComplete() || backgroundLoading)) {
         VBucketPtr vb = vbuckets.getBucket(i->getVBucketId());
         if (!vb) {
             setStatus(ENGINE_NOT_MY_VBUCKET);
@@ -748,10 +845,13 @@ void LoadStorageKVPairCallback::callback(GetValue &val) {
                 return;
             }
 
+            // Once traffic is enabled (online warmup) a key missing from the
+            // HashTable has been deleted, so don't resurrect it.
             const auto res = epVb->insertFromWarmup(*i,
                                                     shouldEject(),
                                                     val.isPartial(),
-                                                    true /*check mem_used*/);
+                                                    true /*check mem_used*/,
+                                                    backgroundLoading);
             switch (res) {
             case MutationStatus::NoMem:
                 if (retry == 2) {
@@ -906,7 +1006,48 @@ void LoadValueCallback::callback(CacheLookup &lookup)
         return;
     }
 
-    // Otherwise - item value not in hashTable - continue with disk load.
+    // Otherwise - item value not in hashTable - continue with disk load,
+    // unless the batch is complete, in which case pause the scan before this
+    // item so it's the first one loaded when resumed.
+    if (batchRemaining) {
+        if (*batchRemaining == 0) {
+            paused = true;
+            setStatus(ENGINE_ENOMEM);
+            return;
+        }
+        --*batchRemaining;
+    }
+    setStatus(ENGINE_SUCCESS);
+}
+
+void AccessLogSeqnoLookup::callback(CacheLookup& lookup) {
+    if (lookup.getKey().isPrepared()) {
+        setStatus(ENGINE_KEY_EEXISTS);
+        return;
+    }
+
+    const auto seqno = uint64_t(lookup.getBySeqno());
+    while (next < seqnos.size() && seqnos[next] < seqno) {
+        ++next;
+    }
+    if (next == seqnos.size()) {
+        // Nothing more to load - cancel the scan
+        setStatus(ENGINE_ENOMEM);
+        return;
+    }
+    if (seqnos[next] != seqno) {
+        setStatus(ENGINE_KEY_EEXISTS);
+        return;
+    }
+
+    VBucketPtr vb = vbuckets.getBucket(lookup.getVBucketId());
+    if (vb) {
+        auto res = vb->ht.findOnlyCommitted(lookup.getKey().getDocKey());
+        if (res.storedValue && res.storedValue->isResident()) {
+            setStatus(ENGINE_KEY_EEXISTS);
+            return;
+        }
+    }
     setStatus(ENGINE_SUCCESS);
 }
 
@@ -921,6 +1062,7 @@ Warmup::Warmup(EPBucket& st, Configuration& config_)
       config(config_),
       shardVbStates(store.vbMap.getNumShards()),
       shardVbIds(store.vbMap.getNumShards()),
+      loadTasksPerShard(config.getWarmupTasksPerShard()),
       warmedUpVbuckets(config.getMaxVbuckets()) {
 }
 
@@ -1072,6 +1214,22 @@ void Warmup::createVBuckets(uint16_t shardId) {
                         entry.vb_uuid,
                         entry.by_seqno);
             }
+            // A bloom filter saved by a clean shutdown covers every key on
+            // disk (its seqno is checked against the persisted high seqno),
+            // so use it rather than running without one until the next
+            // compaction. Remove the file either way so a later unclean
+            // shutdown can't pick up a stale filter.
+            const auto bfFileName = store.getBloomFilterFileName(vbid);
+            if (config.isBfilterEnabled() && cleanShutdown &&
+                vb->loadFilter(bfFileName, vbs.highSeqno)) {
+                EP_LOG_INFO(
+                        "Warmup::createVBuckets: {} loaded bloom filter "
+                        "with {} keys",
+                        vbid,
+                        vb->getNumOfKeysInFilter());
+            }
+            remove(bfFileName.c_str());
+
             EPBucket* bucket = &this->store;
             vb->setFreqSaturatedCallback(
                     [bucket]() { bucket->wakeItemFreqDecayerTask(); });
@@ -1308,8 +1466,14 @@ void Warmup::keyDumpforShard(uint16_t shardId)
             auto errorCode = kvstore->scan(*ctx);
             if (errorCode == scan_again) { // ENGINE_ENOMEM
                 // skip loading remaining VBuckets as memory limit was reached
+                allKeysLoaded = false;
                 break;
             }
+            if (errorCode == scan_failed) {
+                allKeysLoaded = false;
+            }
+        } else {
+            allKeysLoaded = false;
         }
     }
 
@@ -1337,12 +1501,27 @@ void Warmup::checkForAccessLog()
         transition(WarmupState::State::Done);
     }
 
+    if (config.isWarmupOnline() && !isComplete()) {
+        if (store.getItemEvictionPolicy() == EvictionPolicy::Value &&
+            allKeysLoaded) {
+            enableTrafficOnline();
+        } else {
+            EP_LOG_INFO(
+                    "Warmup::checkForAccessLog: Not enabling traffic before "
+                    "data is loaded (warmup_online) as {}",
+                    allKeysLoaded ? "full eviction is in use"
+                                  : "not all keys were loaded");
+        }
+    }
+
     size_t accesslogs = 0;
     for (size_t i = 0; i < store.vbMap.shards.size(); i++) {
         std::string curr = store.accessLog[i].getLogFile();
         std::string old = store.accessLog[i].getLogFile();
         old.append(".old");
-        if (cb::io::isFile(curr) || cb::io::isFile(old)) {
+        const auto seqnoLog = getSeqnoAccessLogPath(i);
+        if (cb::io::isFile(curr) || cb::io::isFile(old) ||
+            cb::io::isFile(seqnoLog) || cb::io::isFile(seqnoLog + ".old")) {
             accesslogs++;
         }
     }
@@ -1372,7 +1551,15 @@ void Warmup::loadingAccessLog(uint16_t shardId)
     LoadStorageKVPairCallback load_cb(store, true, state.getState());
     bool success = false;
     auto stTime = std::chrono::steady_clock::now();
-    if (store.accessLog[shardId].exists()) {
+    // Prefer the seqno format log (or its previous copy) if there is one
+    const auto seqnoLog = getSeqnoAccessLogPath(shardId);
+    for (const auto& path : {seqnoLog, seqnoLog + ".old"}) {
+        if (!success && cb::io::isFile(path)) {
+            success = loadSeqnoAccessLog(shardId, path);
+        }
+    }
+
+    if (!success && store.accessLog[shardId].exists()) {
         try {
             store.accessLog[shardId].open();
             if (doWarmup(store.accessLog[shardId],
@@ -1405,6 +1592,108 @@ void Warmup::loadingAccessLog(uint16_t shardId)
         }
     }
 
+    completeLoadingAccessLog(success, stTime);
+}
+
+bool Warmup::loadAccessLogBatch(uint16_t shardId) {
+    // The access log isn't split, it's loaded by the shard's first task
+    auto& bg = getBackgroundLoad(shardId, 0);
+
+    // Prefer the seqno format log (or its previous copy) if there is one,
+    // falling back to the MutationLog format.
+    while (bg.seqnoLogIndex < 2) {
+        auto path = getSeqnoAccessLogPath(shardId);
+        if (bg.seqnoLogIndex == 1) {
+            path.append(".old");
+        }
+        try {
+            if (!bg.seqnoLog) {
+                if (!cb::io::isFile(path)) {
+                    ++bg.seqnoLogIndex;
+                    continue;
+                }
+                bg.start = std::chrono::steady_clock::now();
+                bg.seqnoLog = std::make_unique<SeqnoAccessLog::Reader>(path);
+            }
+            Vbid vbid;
+            std::vector<uint64_t> seqnos;
+            if (bg.seqnoLog->next(vbid, seqnos) &&
+                loadAccessLogSeqnos(shardId, vbid, std::move(seqnos))) {
+                return true;
+            }
+            bg.seqnoLog.reset();
+            completeLoadingAccessLog(true, bg.start);
+            return false;
+        } catch (const SeqnoAccessLog::ReadException& e) {
+            corruptAccessLog = true;
+            EP_LOG_WARN("Error reading warmup access log {}: {}",
+                        path,
+                        e.what());
+            bg.seqnoLog.reset();
+            ++bg.seqnoLogIndex;
+        }
+    }
+
+    try {
+        // Open the shard's access log, falling back to the previous one if
+        // it's missing or unreadable.
+        while (!bg.harvester) {
+            if (!bg.accessLog) {
+                bg.start = std::chrono::steady_clock::now();
+                bg.accessLog = &store.accessLog[shardId];
+            } else if (!bg.oldLog) {
+                bg.oldLog = std::make_unique<MutationLog>(
+                        store.accessLog[shardId].getLogFile() + ".old");
+                bg.accessLog = bg.oldLog.get();
+            } else {
+                completeLoadingAccessLog(false, bg.start);
+                return false;
+            }
+            if (bg.accessLog->exists()) {
+                bg.accessLog->open();
+                bg.harvester = std::make_unique<MutationLogHarvester>(
+                        *bg.accessLog, &store.getEPEngine());
+                for (const auto& vbState : shardVbStates[shardId]) {
+                    bg.harvester->setVBucket(vbState.first);
+                }
+                bg.accessLogPos = std::make_unique<MutationLog::iterator>(
+                        bg.accessLog->begin());
+            }
+        }
+
+        LoadStorageKVPairCallback load_cb(store, true, state.getState());
+        WarmupCookie cookie(&store, load_cb);
+        bg.accessLogPos = std::make_unique<MutationLog::iterator>(
+                bg.harvester->loadBatch(*bg.accessLogPos,
+                                        config.getWarmupBatchSize()));
+        bg.harvester->apply(&cookie, &batchWarmupCallback);
+
+        // Carry on unless the end of the log was reached or enough has been
+        // loaded (items were skipped).
+        if (*bg.accessLogPos != bg.accessLog->end() && cookie.skipped == 0) {
+            return true;
+        }
+        setEstimatedWarmupCount(bg.harvester->total());
+    } catch (MutationLog::ReadException& e) {
+        corruptAccessLog = true;
+        EP_LOG_WARN("Error reading warmup access log {}: {}",
+                    bg.accessLog->getLogFile(),
+                    e.what());
+        // Try the next log (if any) on the next run
+        bg.accessLogPos.reset();
+        bg.harvester.reset();
+        return true;
+    }
+
+    completeLoadingAccessLog(true, bg.start);
+    bg.accessLogPos.reset();
+    bg.harvester.reset();
+    bg.oldLog.reset();
+    return false;
+}
+
+void Warmup::completeLoadingAccessLog(
+        bool success, std::chrono::steady_clock::time_point stTime) {
     size_t numItems = store.getEPEngine().getEpStats().warmedUpValues;
     if (success && numItems) {
         EP_LOG_INFO("{} items loaded from access log, completed in {}",
@@ -1425,6 +1714,61 @@ void Warmup::loadingAccessLog(uint16_t shardId)
     }
 }
 
+std::string Warmup::getSeqnoAccessLogPath(uint16_t shardId) const {
+    return store.accessLog[shardId].getLogFile() + ".seqno";
+}
+
+bool Warmup::loadSeqnoAccessLog(uint16_t shardId, const std::string& path) {
+    try {
+        SeqnoAccessLog::Reader log(path);
+        Vbid vbid;
+        std::vector<uint64_t> seqnos;
+        size_t total = 0;
+        while (log.next(vbid, seqnos)) {
+            total += seqnos.size();
+            if (!loadAccessLogSeqnos(shardId, vbid, std::move(seqnos))) {
+                break;
+            }
+        }
+        setEstimatedWarmupCount(total);
+        return true;
+    } catch (const SeqnoAccessLog::ReadException& e) {
+        corruptAccessLog = true;
+        EP_LOG_WARN("Error reading warmup access log {}: {}", path, e.what());
+    }
+    return false;
+}
+
+bool Warmup::loadAccessLogSeqnos(uint16_t shardId,
+                                 Vbid vbid,
+                                 std::vector<uint64_t> seqnos) {
+    // The log may include vBuckets which have since been removed
+    if (seqnos.empty() || shardVbStates[shardId].count(vbid) == 0) {
+        return true;
+    }
+
+    KVStore* kvstore = store.getROUnderlyingByShard(shardId);
+    const auto startSeqno = seqnos.front();
+    auto lookup =
+            std::make_unique<AccessLogSeqnoLookup>(store.vbMap, std::move(seqnos));
+    const auto& seqnoLookup = *lookup;
+    auto ctx = kvstore->initBySeqnoScanContext(
+            std::make_unique<LoadStorageKVPairCallback>(
+                    store, true, state.getState()),
+            std::move(lookup),
+            vbid,
+            startSeqno,
+            DocumentFilter::NO_DELETES,
+            store.getValueFilterForCompressionMode(),
+            SnapshotSource::Head);
+    if (!ctx) {
+        return true;
+    }
+    // The scan is also cancelled (scan_again) once all the logged seqnos have
+    // been visited; otherwise it was stopped by the load callback.
+    return kvstore->scan(*ctx) != scan_again || seqnoLookup.isExhausted();
+}
+
 size_t Warmup::doWarmup(MutationLog& lf,
                         const std::map<Vbid, vbucket_state>& vbmap,
                         StatusCallback<GetValue>& cb) {
@@ -1479,13 +1823,16 @@ void Warmup::scheduleLoadingKVPairs()
 
     threadtask_count = 0;
     for (size_t i = 0; i < store.vbMap.shards.size(); i++) {
-        ExTask task = std::make_shared<WarmupLoadingKVPairs>(store, i, this);
-        ExecutorPool::get()->schedule(task);
+        for (size_t part = 0; part < loadTasksPerShard; ++part) {
+            ExTask task = std::make_shared<WarmupLoadingKVPairs>(
+                    store, i, part, this);
+            ExecutorPool::get()->schedule(task);
+        }
     }
 
 }
 
-void Warmup::loadKVPairsforShard(uint16_t shardId)
+void Warmup::loadKVPairsforShard(uint16_t shardId, size_t part)
 {
     bool maybe_enable_traffic = false;
     scan_error_t errorCode = scan_success;
@@ -1497,7 +1844,7 @@ void Warmup::loadKVPairsforShard(uint16_t shardId)
     KVStore* kvstore = store.getROUnderlyingByShard(shardId);
     ValueFilter valFilter = store.getValueFilterForCompressionMode();
 
-    for (const auto vbid : shardVbIds[shardId]) {
+    for (const auto vbid : getVbIdsForLoadTask(shardId, part)) {
         auto ctx = kvstore->initBySeqnoScanContext(
                 std::make_unique<LoadStorageKVPairCallback>(
                         store, maybe_enable_traffic, state.getState()),
@@ -1516,7 +1863,7 @@ void Warmup::loadKVPairsforShard(uint16_t shardId)
             }
         }
     }
-    if (++threadtask_count == store.vbMap.getNumShards()) {
+    if (++threadtask_count == getNumLoadTasks()) {
         transition(WarmupState::State::Done);
     }
 }
@@ -1528,19 +1875,22 @@ void Warmup::scheduleLoadingData()
 
     threadtask_count = 0;
     for (size_t i = 0; i < store.vbMap.shards.size(); i++) {
-        ExTask task = std::make_shared<WarmupLoadingData>(store, i, this);
-        ExecutorPool::get()->schedule(task);
+        for (size_t part = 0; part < loadTasksPerShard; ++part) {
+            ExTask task =
+                    std::make_shared<WarmupLoadingData>(store, i, part, this);
+            ExecutorPool::get()->schedule(task);
+        }
     }
 }
 
-void Warmup::loadDataforShard(uint16_t shardId)
+void Warmup::loadDataforShard(uint16_t shardId, size_t part)
 {
     scan_error_t errorCode = scan_success;
 
     KVStore* kvstore = store.getROUnderlyingByShard(shardId);
     ValueFilter valFilter = store.getValueFilterForCompressionMode();
 
-    for (const auto vbid : shardVbIds[shardId]) {
+    for (const auto vbid : getVbIdsForLoadTask(shardId, part)) {
         auto ctx = kvstore->initBySeqnoScanContext(
                 std::make_unique<LoadStorageKVPairCallback>(
                         store, true, state.getState()),
@@ -1560,11 +1910,115 @@ void Warmup::loadDataforShard(uint16_t shardId)
         }
     }
 
-    if (++threadtask_count == store.vbMap.getNumShards()) {
+    if (++threadtask_count == getNumLoadTasks()) {
         transition(WarmupState::State::Done);
     }
 }
 
+bool Warmup::loadDataBatch(uint16_t shardId, size_t part) {
+    auto& bg = getBackgroundLoad(shardId, part);
+    if (bg.vbIndex == 0 && !bg.scanCtx) {
+        bg.start = std::chrono::steady_clock::now();
+        bg.vbids = getVbIdsForLoadTask(shardId, part);
+    }
+    bg.batchRemaining = config.getWarmupBatchSize();
+
+    KVStore* kvstore = store.getROUnderlyingByShard(shardId);
+    const auto& vbids = bg.vbids;
+    while (bg.vbIndex < vbids.size()) {
+        if (!bg.scanCtx) {
+            auto lookup = std::make_unique<LoadValueCallback>(
+                    store.vbMap, state.getState(), &bg.batchRemaining);
+            bg.lookup = lookup.get();
+            bg.scanCtx = kvstore->initBySeqnoScanContext(
+                    std::make_unique<LoadStorageKVPairCallback>(
+                            store, true, state.getState()),
+                    std::move(lookup),
+                    vbids[bg.vbIndex],
+                    0,
+                    DocumentFilter::NO_DELETES,
+                    store.getValueFilterForCompressionMode(),
+                    SnapshotSource::Head);
+            if (!bg.scanCtx) {
+                ++bg.vbIndex;
+                continue;
+            }
+        }
+
+        bg.lookup->resume();
+        if (kvstore->scan(*bg.scanCtx) == scan_again) {
+            if (bg.lookup->isPaused()) {
+                // Batch complete, resume this vBucket on the next run
+                return true;
+            }
+            // ENGINE_ENOMEM - enough has been loaded; skip the remaining
+            // vBuckets.
+            break;
+        }
+        bg.scanCtx.reset();
+        ++bg.vbIndex;
+    }
+    bg.scanCtx.reset();
+
+    EP_LOG_INFO(
+            "Warmup::loadDataBatch: Background load of shard {} part {} done "
+            "in {}",
+            shardId,
+            part,
+            cb::time2text(std::chrono::steady_clock::now() - bg.start));
+    if (++threadtask_count == getNumLoadTasks()) {
+        transition(WarmupState::State::Done);
+    }
+    return false;
+}
+
+size_t Warmup::getNumLoadTasks() const {
+    return store.vbMap.getNumShards() * loadTasksPerShard;
+}
+
+std::vector<Vbid> Warmup::getVbIdsForLoadTask(uint16_t shardId,
+                                              size_t part) const {
+    // Deal the vBuckets out in turn, so that each task starts with the
+    // shard's highest priority (active) vBuckets.
+    std::vector<Vbid> vbids;
+    const auto& shardVbs = shardVbIds[shardId];
+    for (size_t i = part; i < shardVbs.size(); i += loadTasksPerShard) {
+        vbids.push_back(shardVbs[i]);
+    }
+    return vbids;
+}
+
+Warmup::BackgroundLoad& Warmup::getBackgroundLoad(uint16_t shardId,
+                                                  size_t part) {
+    return *backgroundLoads[shardId * loadTasksPerShard + part];
+}
+
+void Warmup::enableTrafficOnline() {
+    backgroundLoads.clear();
+    for (size_t i = 0; i < getNumLoadTasks(); ++i) {
+        backgroundLoads.push_back(std::make_unique<BackgroundLoad>());
+    }
+
+    // Must be set before warmup is complete so that loading isn't stopped
+    backgroundLoading = true;
+    if (setComplete()) {
+        setWarmupTime();
+        store.warmupCompleted();
+        logWarmupStats(store);
+    }
+    EP_LOG_INFO(
+            "Warmup::enableTrafficOnline: All keys loaded, traffic can be "
+            "enabled. Continuing to load values in the background");
+}
+
+double Warmup::getBackgroundLoadDelay() {
+    if (store.getEPEngine().getEpStats().numRemainingBgItems == 0) {
+        return 0;
+    }
+    ++backgroundLoadThrottled;
+    return config.getWarmupOnlineThrottleMs() / 1000.0;
+}
+
 void Warmup::scheduleCompletion() {
     ExTask task = std::make_shared<WarmupCompletion>(store, this);
     ExecutorPool::get()->schedule(task);
@@ -1577,6 +2031,15 @@ void Warmup::done()
         store.warmupCompleted();
         logWarmupStats(store);
     }
+    if (backgroundLoading.exchange(false)) {
+        std::lock_guard<std::mutex> lock(warmupStart.mutex);
+        EP_LOG_INFO(
+                "Warmup::done: Background loading complete, {} values loaded "
+                "in {}",
+                store.getEPEngine().getEpStats().warmedUpValues.load(),
+                cb::time2text(std::chrono::steady_clock::now() -
+                              warmupStart.time));
+    }
 }
 
 void Warmup::step() {
@@ -1625,11 +2088,37 @@ void Warmup::step() {
 void Warmup::transition(WarmupState::State to, bool force) {
     auto old = state.getState();
     if (old != WarmupState::State::Done) {
+        recordPhaseComplete(old);
         state.transition(to, force);
         step();
     }
 }
 
+void Warmup::recordPhaseComplete(WarmupState::State phase) {
+    const auto now = std::chrono::steady_clock::now();
+    const auto& stats = store.getEPEngine().getEpStats();
+    const size_t keys = stats.warmedUpKeys;
+    const size_t values = stats.warmedUpValues;
+
+    std::lock_guard<std::mutex> lh(phases.mutex);
+    switch (phase) {
+    case WarmupState::State::KeyDump:
+        phases.completed[phase] = {now - phases.start, keys - phases.keys};
+        break;
+    case WarmupState::State::LoadingAccessLog:
+    case WarmupState::State::LoadingKVPairs:
+    case WarmupState::State::LoadingData:
+        phases.completed[phase] = {now - phases.start,
+                                   values - phases.values};
+        break;
+    default:
+        break;
+    }
+    phases.start = now;
+    phases.keys = keys;
+    phases.values = values;
+}
+
 template <typename T>
 void addStat(const char* nm,
              const T& val,
@@ -1702,12 +2191,53 @@ void Warmup::addStats(const AddStatFn& add_stat, const void* c) const {
         addStat("access_log", "corrupt", add_stat, c);
     }
 
+    if (config.isWarmupOnline()) {
+        addStat("background_loading",
+                backgroundLoading ? "true" : "false",
+                add_stat,
+                c);
+        addStat("background_load_throttled",
+                backgroundLoadThrottled.load(),
+                add_stat,
+                c);
+    }
+
     size_t warmupCount = estimatedWarmupCount.load();
     if (warmupCount == std::numeric_limits<size_t>::max()) {
         addStat("estimated_value_count", "unknown", add_stat, c);
     } else {
         addStat("estimated_value_count", warmupCount, add_stat, c);
     }
+
+    // Duration and throughput of each loading phase which has completed
+    std::lock_guard<std::mutex> lh(phases.mutex);
+    for (const auto& phase : phases.completed) {
+        std::string prefix;
+        switch (phase.first) {
+        case WarmupState::State::KeyDump:
+            prefix = "key_dump";
+            break;
+        case WarmupState::State::LoadingAccessLog:
+            prefix = "loading_access_log";
+            break;
+        case WarmupState::State::LoadingKVPairs:
+            prefix = "loading_kv_pairs";
+            break;
+        case WarmupState::State::LoadingData:
+            prefix = "loading_data";
+            break;
+        default:
+            continue;
+        }
+        const auto usec = duration_cast<microseconds>(phase.second.first);
+        const auto items = phase.second.second;
+        addStat((prefix + "_time").c_str(), usec.count(), add_stat, c);
+        addStat((prefix + "_items").c_str(), items, add_stat, c);
+        addStat((prefix + "_items_per_sec").c_str(),
+                usec.count() ? uint64_t(items * 1000000.0 / usec.count()) : 0,
+                add_stat,
+                c);
+    }
 }
 
 /* In the case of CouchKVStore, all vbucket states of all the shards
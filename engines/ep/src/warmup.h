@@ -29,6 +29,7 @@
 #include <deque>
 #include <iosfwd>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_set>
@@ -216,6 +217,24 @@ private:
  * When Warmup::isComplete() returns true:
  *  1) all CRUD operations are fully processed.
  *  2) DCP consumers can be created.
+ *
+ * LoadingKVPairs and LoadingData run warmup_tasks_per_shard tasks per shard,
+ * each scanning a part of the shard's vBuckets, so that decoding and
+ * HashTable inserts of one task overlap with the disk reads of the others.
+ *
+ * Online warmup (warmup_online=true, value eviction only):
+ *
+ * Once KeyDump has loaded every key, every document is known to the
+ * HashTable and a read of a non-resident value is served by a BgFetch, so
+ * warmup is marked complete at CheckForAccessLog and traffic can be enabled.
+ * LoadingAccessLog and LoadingData then continue in the background
+ * (isBackgroundLoading() returns true) with the following differences:
+ *  1) Values are only restored into existing StoredValues; a key which is
+ *     no longer in the HashTable has been deleted since.
+ *  2) Each task loads a batch of warmup_batch_size items per run, then
+ *     yields its reader thread, pausing for warmup_online_throttle_ms while
+ *     front-end operations are waiting on BgFetches.
+ *  3) The AccessScanner doesn't run, so the log being loaded isn't replaced.
  */
 class Warmup {
 public:
@@ -248,6 +267,14 @@ public:
         return warmupComplete.load();
     }
 
+    /**
+     * @return true if warmup is complete (online warmup) but values are
+     *         still being loaded in the background.
+     */
+    bool isBackgroundLoading() const {
+        return backgroundLoading.load();
+    }
+
     bool setComplete() {
         bool inverse = false;
         return warmupComplete.compare_exchange_strong(inverse, true);
@@ -365,17 +392,84 @@ private:
      */
     void loadingAccessLog(uint16_t shardId);
 
+    /**
+     * [Online warmup] Loads the next batch of the access log for the given
+     * shardId in the background, moving on to the next phase once all shards
+     * have completed.
+     *
+     * @return true if there is more to load (the task should be rescheduled)
+     */
+    bool loadAccessLogBatch(uint16_t shardId);
+
+    /// Common completion of the (per-shard) LoadingAccessLog phase
+    void completeLoadingAccessLog(
+            bool success, std::chrono::steady_clock::time_point start);
+
+    /// @return the path of the given shard's seqno format access log
+    std::string getSeqnoAccessLogPath(uint16_t shardId) const;
+
+    /**
+     * Load the items of the given seqno format access log.
+     * @return false if the log could not be read
+     */
+    bool loadSeqnoAccessLog(uint16_t shardId, const std::string& path);
+
+    /**
+     * Load the items of a vBucket at the given (sorted) seqnos from a seqno
+     * access log, with a single by-seqno scan which stops after the last.
+     *
+     * @return false if loading should stop (e.g. memory is full)
+     */
+    bool loadAccessLogSeqnos(uint16_t shardId,
+                             Vbid vbid,
+                             std::vector<uint64_t> seqnos);
+
     /**
      * [Full-eviction only]
-     * Loads both keys and values into memory for each vBucket in the given
-     * shard.
+     * Loads both keys and values into memory for each of the vBuckets of the
+     * given shard which are assigned to the given part (task).
      */
-    void loadKVPairsforShard(uint16_t shardId);
+    void loadKVPairsforShard(uint16_t shardId, size_t part);
 
     /**
-     * Loads values into memory for each vBucket in the given shard.
+     * Loads values into memory for each of the vBuckets of the given shard
+     * which are assigned to the given part (task).
      */
-    void loadDataforShard(uint16_t shardId);
+    void loadDataforShard(uint16_t shardId, size_t part);
+
+    /**
+     * [Online warmup] Loads the next batch of values for the given part of
+     * the shard in the background, resuming the scan where the previous batch
+     * stopped.
+     *
+     * @return true if there is more to load (the task should be rescheduled)
+     */
+    bool loadDataBatch(uint16_t shardId, size_t part);
+
+    /**
+     * The data loading phases (LoadingKVPairs / LoadingData) run
+     * warmup_tasks_per_shard tasks for each shard, each loading a part of the
+     * shard's vBuckets.
+     *
+     * @return the total number of data loading tasks
+     */
+    size_t getNumLoadTasks() const;
+
+    /// @return the vBuckets the given part (task) of the shard loads
+    std::vector<Vbid> getVbIdsForLoadTask(uint16_t shardId, size_t part) const;
+
+    /**
+     * [Online warmup] Marks warmup as complete (enabling traffic) now that
+     * all metadata is loaded, leaving values to be loaded in the background.
+     */
+    void enableTrafficOnline();
+
+    /**
+     * [Online warmup] @return how long a background load task should sleep
+     * before loading its next batch - non-zero if front-end operations are
+     * waiting on disk.
+     */
+    double getBackgroundLoadDelay();
 
     /* Terminal state of warmup. Updates statistics and marks warmup as
      * completed
@@ -402,6 +496,10 @@ private:
 
     void transition(WarmupState::State to, bool force = false);
 
+    /// Record the duration and number of items loaded by the given phase,
+    /// which has just completed.
+    void recordPhaseComplete(WarmupState::State phase);
+
     WarmupState state;
 
     EPBucket& store;
@@ -430,11 +528,40 @@ private:
     /// contains all vBucket IDs which are present for the given shard.
     std::vector<std::vector<Vbid>> shardVbIds;
 
+    /// Number of tasks loading each shard's data
+    const size_t loadTasksPerShard;
+
+    /// When the current phase started, the number of keys and values loaded
+    /// at that point, and the duration / items loaded by each completed
+    /// phase.
+    struct {
+        mutable std::mutex mutex;
+        std::chrono::steady_clock::time_point start;
+        size_t keys = 0;
+        size_t values = 0;
+        std::map<WarmupState::State,
+                 std::pair<std::chrono::steady_clock::duration, size_t>>
+                completed;
+    } phases;
+
     cb::AtomicDuration<> estimateTime;
     std::atomic<size_t> estimatedItemCount{std::numeric_limits<size_t>::max()};
     bool cleanShutdown{true};
     bool corruptAccessLog{false};
     std::atomic<bool> warmupComplete{false};
+    /// Did KeyDump load the keys of every vBucket? (a pre-requisite of
+    /// online warmup)
+    std::atomic<bool> allKeysLoaded{true};
+    /// Online warmup is complete but still loading values in the background
+    std::atomic<bool> backgroundLoading{false};
+    /// Number of times background loading was paused for the front-end
+    std::atomic<size_t> backgroundLoadThrottled{0};
+
+    /// Where each load task's background load got to (see loadAccessLogBatch /
+    /// loadDataBatch)
+    struct BackgroundLoad;
+    std::vector<std::unique_ptr<BackgroundLoad>> backgroundLoads;
+    BackgroundLoad& getBackgroundLoad(uint16_t shardId, size_t part);
     std::atomic<bool> warmupOOMFailure{false};
     std::atomic<size_t> estimatedWarmupCount{
             std::numeric_limits<size_t>::max()};
@@ -7077,6 +7077,8 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_mem_used_merge_threshold_percent",
               "ep_min_compression_ratio",
               "ep_mutation_mem_threshold",
+              "ep_mutation_throttle_enabled",
+              "ep_mutation_throttle_max_delay_ms",
               "ep_num_auxio_threads",
               "ep_num_nonio_threads",
               "ep_num_reader_threads",
@@ -7109,6 +7111,9 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_warmup_batch_size",
               "ep_warmup_min_items_threshold",
               "ep_warmup_min_memory_threshold",
+              "ep_warmup_online",
+              "ep_warmup_online_throttle_ms",
+              "ep_warmup_tasks_per_shard",
               "ep_xattr_enabled"}},
             {"workload",
              {"ep_workload:num_readers",
@@ -7202,6 +7207,7 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_data_write_failed",
               "ep_data_traffic_enabled",
               "ep_dbname",
+              "ep_dcp_ack_throttle_delay_us",
               "ep_dcp_backfill_byte_limit",
               "ep_dcp_conn_buffer_size",
               "ep_dcp_conn_buffer_size_aggr_mem_threshold",
@@ -7302,6 +7308,10 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_meta_data_memory",
               "ep_min_compression_ratio",
               "ep_mutation_mem_threshold",
+              "ep_mutation_throttle_delay_us",
+              "ep_mutation_throttle_delayed",
+              "ep_mutation_throttle_enabled",
+              "ep_mutation_throttle_max_delay_ms",
               "ep_num_access_scanner_runs",
               "ep_num_access_scanner_skips",
               "ep_num_auxio_threads",
@@ -7409,6 +7419,9 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_warmup_batch_size",
               "ep_warmup_min_items_threshold",
               "ep_warmup_min_memory_threshold",
+              "ep_warmup_online",
+              "ep_warmup_online_throttle_ms",
+              "ep_warmup_tasks_per_shard",
               "ep_workload_pattern",
               "ep_xattr_enabled",
               "mem_used",
@@ -7590,17 +7603,25 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
                           "ep_item_flush_failed",
                           "ep_total_persisted",
                           "ep_uncommitted_items",
-                          "ep_chk_persistence_timeout"});
+                          "ep_chk_persistence_timeout",
+                          "ep_flusher_stalls",
+                          "ep_compaction_bytes_written",
+                          "ep_compaction_bytes_per_sec",
+                          "ep_compaction_write_throttled_us"});
 
         // Config variables only valid for persistent
         std::initializer_list<std::string> persistentConfig = {
                 "ep_access_scanner_enabled",
                 "ep_alog_block_size",
+                "ep_alog_format",
                 "ep_alog_max_stored_items",
+                "ep_alog_min_freq_count",
                 "ep_alog_path",
                 "ep_alog_resident_ratio_threshold",
                 "ep_alog_sleep_time",
                 "ep_alog_task_time",
+                "ep_compaction_max_concurrency",
+                "ep_compaction_write_rate_limit",
                 "ep_item_eviction_policy",
                 "ep_persistent_metadata_purge_age",
                 "ep_warmup"};
@@ -7645,6 +7666,8 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
                           "vb_active_seqlist_count",
                           "vb_active_seqlist_deleted_count",
                           "vb_active_seqlist_purged_count",
+                          "vb_active_seqlist_purge_duration_us",
+                          "vb_active_seqlist_purge_max_pause_us",
                           "vb_active_seqlist_read_range_count",
                           "vb_active_seqlist_stale_count",
                           "vb_active_seqlist_stale_value_bytes",
@@ -7655,6 +7678,8 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
                           "vb_replica_seqlist_count",
                           "vb_replica_seqlist_deleted_count",
                           "vb_replica_seqlist_purged_count",
+                          "vb_replica_seqlist_purge_duration_us",
+                          "vb_replica_seqlist_purge_max_pause_us",
                           "vb_replica_seqlist_read_range_count",
                           "vb_replica_seqlist_stale_count",
                           "vb_replica_seqlist_stale_value_bytes",
@@ -7665,6 +7690,8 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
                           "vb_pending_seqlist_count",
                           "vb_pending_seqlist_deleted_count",
                           "vb_pending_seqlist_purged_count",
+                          "vb_pending_seqlist_purge_duration_us",
+                          "vb_pending_seqlist_purge_max_pause_us",
                           "vb_pending_seqlist_read_range_count",
                           "vb_pending_seqlist_stale_count",
                           "vb_pending_seqlist_stale_value_bytes",
@@ -7678,6 +7705,9 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
                            "vb_0:seqlist_deleted_count",
                            "vb_0:seqlist_high_seqno",
                            "vb_0:seqlist_highest_deduped_seqno",
+                           "vb_0:seqlist_purge_duration_us",
+                           "vb_0:seqlist_purge_items_per_sec",
+                           "vb_0:seqlist_purge_max_pause_us",
                            "vb_0:seqlist_purged_count",
                            "vb_0:seqlist_range_read_begin",
                            "vb_0:seqlist_range_read_count",
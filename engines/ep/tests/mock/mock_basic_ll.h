@@ -45,6 +45,21 @@ public:
         return allSeqnos;
     }
 
+    /* Returns the seqnos of the elements in the sparse seqno index */
+    std::vector<seqno_t> getIndexedSeqnos() const {
+        std::vector<seqno_t> indexed;
+        std::lock_guard<std::mutex> lckGd(writeLock);
+
+        for (const auto& entry : seqnoIndex) {
+            indexed.push_back(entry.first);
+        }
+        return indexed;
+    }
+
+    static size_t getSeqnoIndexInterval() {
+        return seqnoIndexInterval;
+    }
+
     /* Register fake range lock for testing */
     RangeGuard registerFakeSharedRangeLock(seqno_t start, seqno_t end) {
         return tryLockSeqnoRangeShared(start, end);
@@ -94,3 +94,21 @@ void MockEPBucket::setDurabilityCompletionTask(
 Flusher* MockEPBucket::getFlusherNonConst(Vbid vbid) {
     return vbMap.getShardByVbId(vbid)->getFlusher();
 }
+
+void MockEPBucket::addCompactionTask(Vbid vbid,
+                                     ExTask task,
+                                     double fragmentation) {
+    LockHolder lh(compactionLock);
+    compactionTasks.emplace_back(vbid, std::move(task));
+    compactionTasks.back().fragmentation = fragmentation;
+}
+
+bool MockEPBucket::isCompactionRunning(const GlobalTask& task) {
+    LockHolder lh(compactionLock);
+    for (const auto& entry : compactionTasks) {
+        if (entry.task.get() == &task) {
+            return entry.running;
+        }
+    }
+    return false;
+}
@@ -64,4 +64,23 @@ public:
 
     /// @returns a non-const pointer to Flusher object.
     Flusher* getFlusherNonConst(Vbid vbid);
+
+    /**
+     * Track the task as a compaction of the given vBucket (as
+     * scheduleCompaction does), with the given file fragmentation rather than
+     * measuring it.
+     */
+    void addCompactionTask(Vbid vbid, ExTask task, double fragmentation);
+
+    /// @returns true if the task holds one of the compaction slots
+    bool isCompactionRunning(const GlobalTask& task);
+
+    /// Complete the compaction of the given vBucket, freeing its slot
+    void completeCompaction(Vbid vbid) {
+        updateCompactionTasks(vbid);
+    }
+
+    IORateLimiter& getCompactionWriteRateLimiter() {
+        return compactionWriteRateLimiter;
+    }
 };
@@ -64,6 +64,18 @@ public:
         freqCounterThreshold = threshold;
     }
 
+    size_t getBytesToEvict() const {
+        return bytesToEvict;
+    }
+
+    size_t getBytesEvicted() const {
+        return bytesEvicted;
+    }
+
+    uint16_t getMinFreqCounterThreshold() const {
+        return minFreqCounterThreshold;
+    }
+
     void setCurrentBucket(VBucketPtr _currentBucket) {
         currentBucket = _currentBucket;
     }
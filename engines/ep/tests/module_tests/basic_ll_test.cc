@@ -249,7 +249,8 @@ protected:
      * one always.
      */
     SequenceList::RangeIterator getRangeIterator() {
-        auto itrOptional = basicLL->makeRangeIterator(true /*isBackfill*/);
+        auto itrOptional = basicLL->makeRangeIterator(true /*isBackfill*/,
+                                                      1 /*startSeqno*/);
         EXPECT_TRUE(itrOptional);
         return std::move(*itrOptional);
     }
@@ -709,7 +710,8 @@ TEST_F(BasicLinkedListTest, MultipleRangeIterator_MB24474) {
        the function scope ends */
     auto itr1Optional =
             std::make_unique<std::optional<SequenceList::RangeIterator>>(
-                    basicLL->makeRangeIterator(true /*isBackfill*/));
+                    basicLL->makeRangeIterator(true /*isBackfill*/,
+                                               1 /*startSeqno*/));
     auto itr1 = std::move(**itr1Optional);
 
     /* Read all items */
@@ -1021,7 +1023,8 @@ TEST_F(BasicLinkedListTest, RangeIteratorRefusedDuringPurge) {
     addNewItemsToList(1, keyPrefix, numItems);
 
     basicLL->purgeTombstones(numItems, {}, [&]() {
-        auto itr = basicLL->makeRangeIterator(true /*isBackfill*/);
+        auto itr = basicLL->makeRangeIterator(true /*isBackfill*/,
+                                              1 /*startSeqno*/);
 
         // should not have been allowed to make a range iterator during purge
         EXPECT_FALSE(itr);
@@ -1036,7 +1039,8 @@ TEST_F(BasicLinkedListTest, PurgeEarlyExitsIfRangeIteratorExists) {
     /* Add 2 new items */
     addNewItemsToList(1, keyPrefix, numItems);
 
-    auto itr = basicLL->makeRangeIterator(true /*isBackfill*/);
+    auto itr = basicLL->makeRangeIterator(true /*isBackfill*/,
+                                          1 /*startSeqno*/);
     EXPECT_TRUE(itr);
 
     auto purgedCount = basicLL->purgeTombstones(numItems, {}, [&]() {
@@ -1260,6 +1264,126 @@ TEST_F(BasicLinkedListTest, PurgePauseResumeWithUpdateAtPausedPoint) {
     EXPECT_EQ(numItems, basicLL->getNumItems());
 }
 
+/* Purge a list spanning several purge batches, pausing in the middle of a
+   batch, and check every stale item is purged exactly once */
+TEST_F(BasicLinkedListTest, PurgeAcrossBatchesWithPause) {
+    const int numPairs = 100;
+    const std::string keyPrefix("key");
+    std::vector<seqno_t> expectedSeqno;
+
+    /* Interleave live and stale items */
+    seqno_t seqno = 1;
+    for (int ii = 0; ii < numPairs; ++ii) {
+        addNewItemsToList(seqno, keyPrefix, 1);
+        expectedSeqno.push_back(seqno++);
+        addStaleItem("stale" + std::to_string(ii), seqno++);
+    }
+    /* The last item is never purged by the vbucket; add a live one */
+    addNewItemsToList(seqno, keyPrefix, 1);
+    expectedSeqno.push_back(seqno);
+    ASSERT_EQ(numPairs, basicLL->getNumStaleItems());
+
+    /* Pause after 70 elements, i.e. part way through the second batch */
+    int calls = 0;
+    auto purged = basicLL->purgeTombstones(
+            seqno - 1, {}, [&calls]() { return ++calls == 70; });
+    EXPECT_EQ(35, purged);
+    EXPECT_EQ(numPairs - 35, basicLL->getNumStaleItems());
+
+    /* Resume from where we paused */
+    purged += basicLL->purgeTombstones(seqno - 1);
+    EXPECT_EQ(numPairs, purged);
+    EXPECT_EQ(0, basicLL->getNumStaleItems());
+    EXPECT_EQ(expectedSeqno, basicLL->getAllSeqnoForVerification());
+}
+
+TEST_F(BasicLinkedListTest, SeqnoIndexSeek) {
+    const int interval = MockBasicLinkedList::getSeqnoIndexInterval();
+    const int numItems = interval * 4;
+    addNewItemsToList(1, std::string("key"), numItems);
+
+    /* Every 'interval'-th appended element is indexed */
+    std::vector<seqno_t> expectedIndex = {
+            interval, 2 * interval, 3 * interval, 4 * interval};
+    EXPECT_EQ(expectedIndex, basicLL->getIndexedSeqnos());
+
+    /* A range read from the middle returns the same items as before, but only
+       locks the list from the closest indexed element - hence it is not
+       blocked by an exclusive range lock (e.g. the purger) below it */
+    const seqno_t start = 2 * interval + 10;
+    {
+        auto purgeLock = basicLL->registerFakeRangeLock(1, interval - 1);
+        ENGINE_ERROR_CODE status;
+        std::vector<UniqueItemPtr> items;
+        seqno_t endSeqno;
+        std::tie(status, items, endSeqno) = basicLL->rangeRead(start, numItems);
+        EXPECT_EQ(ENGINE_SUCCESS, status);
+        ASSERT_EQ(numItems - start + 1, items.size());
+        EXPECT_EQ(start, items.front()->getBySeqno());
+        EXPECT_EQ(numItems, items.back()->getBySeqno());
+        EXPECT_EQ(numItems, endSeqno);
+    }
+
+    /* A range iterator asked to start at 'start' begins at the closest indexed
+       element not after it */
+    auto itrOptional = basicLL->makeRangeIterator(true /*isBackfill*/, start);
+    ASSERT_TRUE(itrOptional);
+    auto& itr = *itrOptional;
+    EXPECT_EQ(2 * interval, itr.curr());
+    EXPECT_EQ(2 * interval, basicLL->getRangeRead().first);
+
+    /* Only the items from the seek position are counted */
+    seqno_t expected = 2 * interval;
+    while (itr.curr() != itr.end()) {
+        EXPECT_EQ(uint64_t(numItems - expected + 1), itr.count());
+        EXPECT_EQ(expected++, (*itr).getBySeqno());
+        ++itr;
+    }
+    EXPECT_EQ(numItems + 1, expected);
+    EXPECT_EQ(0, itr.count());
+}
+
+TEST_F(BasicLinkedListTest, SeqnoIndexUpdateAndPurge) {
+    const int interval = MockBasicLinkedList::getSeqnoIndexInterval();
+    const int numItems = interval * 2;
+    const std::string keyPrefix("key");
+    addNewItemsToList(1, keyPrefix, numItems);
+    ASSERT_EQ(std::vector<seqno_t>({interval, 2 * interval}),
+              basicLL->getIndexedSeqnos());
+
+    /* Moving an indexed element to the end of the list removes it from the
+       index */
+    updateItem(numItems, keyPrefix + std::to_string(interval));
+    EXPECT_EQ(std::vector<seqno_t>({2 * interval}),
+              basicLL->getIndexedSeqnos());
+
+    /* Purging an indexed element removes it from the index */
+    addStaleItem("stale", numItems + 2);
+    addNewItemsToList(numItems + 3, keyPrefix, interval - 2);
+    ASSERT_EQ(std::vector<seqno_t>({2 * interval, numItems + interval}),
+              basicLL->getIndexedSeqnos());
+    {
+        auto res = ht.findForWrite(makeStoredDocKey(
+                keyPrefix + std::to_string(numItems + interval)));
+        ASSERT_TRUE(res.storedValue);
+        auto ownedSv = ht.unlocked_release(res.lock, res.storedValue);
+        std::lock_guard<std::mutex> listWriteLg(basicLL->getListWriteLock());
+        basicLL->markItemStale(listWriteLg, std::move(ownedSv), nullptr);
+    }
+    EXPECT_EQ(2, basicLL->purgeTombstones(numItems + interval));
+    EXPECT_EQ(std::vector<seqno_t>({2 * interval}),
+              basicLL->getIndexedSeqnos());
+
+    /* Seeking past the removed elements still finds every item */
+    ENGINE_ERROR_CODE status;
+    std::vector<UniqueItemPtr> items;
+    std::tie(status, items, std::ignore) =
+            basicLL->rangeRead(interval, numItems + interval);
+    EXPECT_EQ(ENGINE_SUCCESS, status);
+    /* [interval + 1, numItems + 1] and [numItems + 3, numItems + interval) */
+    EXPECT_EQ((numItems - interval + 1) + (interval - 3), items.size());
+}
+
 TEST_F(BasicLinkedListTest, SeqRangeOverlapTest) {
     const auto diff = [](SeqRange a, SeqRange b, SeqRange expected) {
         SeqRange res = a.makeNonOverlapping(b);
@@ -14,9 +14,10 @@
  *   limitations under the License.
  */
 
-#include <unordered_set>
-
 #include <folly/portability/GTest.h>
+#include <cstdio>
+#include <cstring>
+#include <limits>
 #include <random>
 
 #include "bloomfilter.h"
@@ -25,7 +26,8 @@
 
 class BloomFilterTest : public ::testing::Test {};
 
-// Test the size calculation when creating a bloom filter.
+// Test the size calculation when creating a bloom filter. The filter is made
+// of 256-bit blocks and sets 8 bits (one per 32-bit word of a block) per key.
 // See: https://en.wikipedia.org/wiki/Bloom_filter
 TEST_F(BloomFilterTest, SizeCalculation) {
     struct Params {
@@ -33,12 +35,12 @@ TEST_F(BloomFilterTest, SizeCalculation) {
         size_t bits;
         size_t hashes;
     };
-    std::vector<Params> params{{1, 10, 7},
-                               {10, 96, 7},
-                               {100, 959, 7},
-                               {1000, 9585, 7},
-                               {10000, 95851, 7},
-                               {100000, 958506, 7}};
+    std::vector<Params> params{{1, 256, 8},
+                               {10, 256, 8},
+                               {100, 1280, 8},
+                               {1000, 10752, 8},
+                               {10000, 105472, 8},
+                               {100000, 1052928, 8}};
 
     for (const auto& p : params) {
         BloomFilter bf(p.keys, 0.01, BFILTER_ENABLED);
@@ -100,6 +102,86 @@ TEST_F(BloomFilterTest, FalsePositiveRate) {
                 expectedFalsePositives * 0.1);
 }
 
+// Test that a filter written to disk can be read back (and still contains
+// the same keys), but only if it was saved at the expected seqno.
+TEST_F(BloomFilterTest, SaveAndLoad) {
+    const int numKeys = 1000;
+    const std::string fname = "bloomfilter_test.bf";
+    BloomFilter bf(numKeys, 0.01, BFILTER_ENABLED);
+    for (int i = 0; i < numKeys; i++) {
+        bf.addKey(makeStoredDocKey("key_" + std::to_string(i)));
+    }
+    ASSERT_TRUE(bf.save(fname, 42));
+
+    EXPECT_FALSE(BloomFilter::load(fname, 41))
+            << "Should not load a filter saved at a different seqno";
+
+    auto loaded = BloomFilter::load(fname, 42);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(BFILTER_ENABLED, loaded->getStatus());
+    EXPECT_EQ(bf.getFilterSize(), loaded->getFilterSize());
+    EXPECT_EQ(bf.getNumOfKeysInFilter(), loaded->getNumOfKeysInFilter());
+    for (int i = 0; i < numKeys * 2; i++) {
+        auto key = makeStoredDocKey("key_" + std::to_string(i));
+        EXPECT_EQ(bf.maybeKeyExists(key), loaded->maybeKeyExists(key))
+                << "For key:" << key.to_string();
+    }
+
+    // A truncated file must be rejected
+    FILE* fp = fopen(fname.c_str(), "rb");
+    ASSERT_TRUE(fp);
+    std::vector<char> content(bf.getFilterSize() / 8 + 1024);
+    content.resize(fread(content.data(), 1, content.size(), fp));
+    fclose(fp);
+    fp = fopen(fname.c_str(), "wb");
+    ASSERT_TRUE(fp);
+    ASSERT_EQ(content.size() - 1,
+              fwrite(content.data(), 1, content.size() - 1, fp));
+    fclose(fp);
+    EXPECT_FALSE(BloomFilter::load(fname, 42));
+
+    // As must a file whose block count doesn't match its size (without
+    // trying to allocate the blocks it claims to have)
+    for (const uint64_t numBlocks : {uint64_t(1) << 60,
+                                     std::numeric_limits<uint64_t>::max()}) {
+        // numBlocks follows the magic, status, seqno and key count
+        std::memcpy(content.data() + 24, &numBlocks, sizeof(numBlocks));
+        fp = fopen(fname.c_str(), "wb");
+        ASSERT_TRUE(fp);
+        ASSERT_EQ(content.size(),
+                  fwrite(content.data(), 1, content.size(), fp));
+        fclose(fp);
+        EXPECT_FALSE(BloomFilter::load(fname, 42));
+    }
+
+    remove(fname.c_str());
+    EXPECT_FALSE(BloomFilter::load(fname, 42));
+}
+
+class BloomFilterBlockOpsTest : public BloomFilter, public ::testing::Test {
+public:
+    BloomFilterBlockOpsTest() : BloomFilter(1, 0.01, BFILTER_ENABLED) {
+    }
+};
+
+// The operations picked for the CPU must behave as the portable ones
+TEST_F(BloomFilterBlockOpsTest, SameAsScalar) {
+    const auto& ops = selectedBlockOps();
+    std::mt19937_64 gen(0);
+    for (int ii = 0; ii < 1000; ++ii) {
+        Block expected{};
+        Block actual{};
+        for (int keys = 0; keys < 16; ++keys) {
+            const auto hash = gen();
+            EXPECT_EQ(blockContainsScalar(expected, hash),
+                      ops.contains(actual, hash));
+            EXPECT_EQ(addToBlockScalar(expected, hash), ops.add(actual, hash));
+            EXPECT_EQ(expected.words, actual.words);
+            EXPECT_TRUE(ops.contains(actual, hash));
+        }
+    }
+}
+
 class BloomFilterDocKeyTest
     : public BloomFilter,
       public ::testing::TestWithParam<std::tuple<CollectionID, CollectionID>> {
@@ -113,24 +195,16 @@ public:
  * for all namespaces, not checking for distribution quality etc...
  */
 TEST_P(BloomFilterDocKeyTest, check_hashing) {
+    auto key1 = StoredDocKey("key", std::get<0>(GetParam()));
+    auto key2 = StoredDocKey("key", std::get<1>(GetParam()));
+    EXPECT_EQ(hashDocKey(key1), hashDocKey(key1));
     if (std::get<0>(GetParam()) != std::get<1>(GetParam())) {
-        auto key1 = StoredDocKey("key", std::get<0>(GetParam()));
-        auto key2 = StoredDocKey("key", std::get<1>(GetParam()));
-        std::unordered_set<uint64_t> key1_hashes;
-        std::unordered_set<uint64_t> key2_hashes;
-
-        // Always insert the first two hashes then check every subsequent hash
-        // has no match in the set.
-        key1_hashes.insert(hashDocKey(key1, 0));
-        key2_hashes.insert(hashDocKey(key2, 0));
-        for (size_t i = 1; i < noOfHashes; i++)  {
-            EXPECT_EQ(0, key1_hashes.count(hashDocKey(key1, i)));
-            EXPECT_EQ(0, key2_hashes.count(hashDocKey(key1, i)));
-            EXPECT_EQ(0, key1_hashes.count(hashDocKey(key2, i)));
-            EXPECT_EQ(0, key2_hashes.count(hashDocKey(key2, i)));
-            key1_hashes.insert(hashDocKey(key1, i));
-            key2_hashes.insert(hashDocKey(key2, i));
-        }
+        EXPECT_NE(hashDocKey(key1), hashDocKey(key2));
+
+        // The bits set within a block should differ too, not just the block
+        auto mask1 = makeMask(hashDocKey(key1));
+        auto mask2 = makeMask(hashDocKey(key2));
+        EXPECT_NE(mask1.words, mask2.words);
     }
 }
 
@@ -300,7 +300,7 @@ void CollectionsDcpTest::runEraser() {
 void CollectionsDcpTest::runEraser(Vbid id) {
     if (engine->getConfiguration().getBucketType() == "persistent") {
         std::string task = "Compact DB file " + std::to_string(id.get());
-        runNextTask(*task_executor->getLpTaskQ()[WRITER_TASK_IDX], task);
+        runNextTask(*task_executor->getLpTaskQ()[AUXIO_TASK_IDX], task);
         EXPECT_TRUE(store->getVBucket(id)
                             ->getShard()
                             ->getRWUnderlying()
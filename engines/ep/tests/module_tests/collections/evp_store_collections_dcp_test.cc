@@ -2034,7 +2034,7 @@ TEST_P(CollectionsDcpParameterizedTest, DefaultCollectionDropped) {
 
     if (persistent()) {
         // collection purger runs (was scheduled by the drop of default)
-        runNextTask(*task_executor->getLpTaskQ()[WRITER_TASK_IDX],
+        runNextTask(*task_executor->getLpTaskQ()[AUXIO_TASK_IDX],
                     "Compact DB file 0");
         runCompaction(ep_real_time() + 10000, 3);
     } else {
@@ -585,7 +585,7 @@ TEST_P(CollectionsEraserTest, MB_38313) {
 
     // Remove vbucket
     store->deleteVBucket(vbid, nullptr);
-    runNextTask(*task_executor->getLpTaskQ()[WRITER_TASK_IDX],
+    runNextTask(*task_executor->getLpTaskQ()[AUXIO_TASK_IDX],
                 "Compact DB file 0"); // would fault (gsl exception)
 }
 
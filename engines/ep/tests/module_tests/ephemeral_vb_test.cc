@@ -810,7 +810,8 @@ TEST_F(EphemeralVBucketTest, AppendUpdatesHighestDedupedSeqno) {
     ASSERT_EQ(0, mockEpheVB->getLL()->getHighestDedupedSeqno());
 
     {
-        auto itr = mockEpheVB->getLL()->makeRangeIterator(true /*isBackfill*/);
+        auto itr = mockEpheVB->getLL()->makeRangeIterator(true /*isBackfill*/,
+                                                          1 /*startSeqno*/);
 
         /* Update the items */
         setMany(keys, MutationStatus::WasClean);
@@ -827,7 +828,8 @@ TEST_F(EphemeralVBucketTest, SnapshotHasNoDuplicates) {
     setMany(keys, MutationStatus::WasClean);
 
     {
-        auto itr = mockEpheVB->getLL()->makeRangeIterator(true /*isBackfill*/);
+        auto itr = mockEpheVB->getLL()->makeRangeIterator(true /*isBackfill*/,
+                                                          1 /*startSeqno*/);
 
         /* Update the items  */
         setMany(keys, MutationStatus::WasClean);
@@ -850,7 +852,8 @@ TEST_F(EphemeralVBucketTest, SnapshotIncludesNonDuplicateStaleItems) {
     setMany(keys, MutationStatus::WasClean);
 
     {
-        auto itr = mockEpheVB->getLL()->makeRangeIterator(true /*isBackfill*/);
+        auto itr = mockEpheVB->getLL()->makeRangeIterator(true /*isBackfill*/,
+                                                          1 /*startSeqno*/);
 
         /* Update the items  */
         setMany(keys, MutationStatus::WasClean);
@@ -876,7 +879,8 @@ TEST_F(EphemeralVBucketTest, SnapshotHasNoDuplicatesWithInterveningItems) {
     EXPECT_EQ(MutationStatus::WasClean, setOne(firstFillerKey));
 
     {
-        auto itr = mockEpheVB->getLL()->makeRangeIterator(true /*isBackfill*/);
+        auto itr = mockEpheVB->getLL()->makeRangeIterator(true /*isBackfill*/,
+                                                          1 /*startSeqno*/);
 
         EXPECT_EQ(MutationStatus::WasClean, setOne(secondFillerKey));
 
@@ -906,7 +910,8 @@ TEST_F(EphemeralVBucketTest, SnapshotHasNoDuplicatesWithMultipleStale) {
         /* Set up a mock backfill, cover all items */
         {
             auto itr =
-                    mockEpheVB->getLL()->makeRangeIterator(true /*isBackfill*/);
+                    mockEpheVB->getLL()->makeRangeIterator(true /*isBackfill*/,
+                                                           1 /*startSeqno*/);
             /* Update the items  */
             setMany(keys, MutationStatus::WasClean);
         }
@@ -24,6 +24,7 @@
 #include "../mock/mock_dcp_conn_map.h"
 #include "../mock/mock_dcp_consumer.h"
 #include "../mock/mock_dcp_producer.h"
+#include "../mock/mock_ep_bucket.h"
 #include "../mock/mock_global_task.h"
 #include "../mock/mock_item_freq_decayer.h"
 #include "../mock/mock_stream.h"
@@ -334,7 +335,7 @@ void SingleThreadedKVBucketTest::runCompaction(uint64_t purgeBeforeTime,
     compactConfig.db_file_id = vbid;
     store->scheduleCompaction(vbid, compactConfig, nullptr);
     // run the compaction task
-    runNextTask(*task_executor->getLpTaskQ()[WRITER_TASK_IDX],
+    runNextTask(*task_executor->getLpTaskQ()[AUXIO_TASK_IDX],
                 "Compact DB file 0");
 }
 
@@ -342,7 +343,7 @@ void SingleThreadedKVBucketTest::runCollectionsEraser() {
     if (engine->getConfiguration().getBucketType() == "persistent") {
         // run the compaction task. assuming it was scheduled by the test, will
         // fail the runNextTask expect if not scheduled.
-        runNextTask(*task_executor->getLpTaskQ()[WRITER_TASK_IDX],
+        runNextTask(*task_executor->getLpTaskQ()[AUXIO_TASK_IDX],
                     "Compact DB file 0");
 
         EXPECT_TRUE(store->getVBucket(vbid)
@@ -783,6 +784,136 @@ TEST_F(SingleThreadedEPBucketTest, FlusherBatchSizeLimitWritersChange) {
     EXPECT_EQ(expected, bucket.getFlusherBatchSplitTrigger());
 }
 
+class CompactionSchedulerTest : public SingleThreadedEPBucketTest {
+protected:
+    /// Add a compaction task of the given vBucket; vBuckets with a higher
+    /// id have more fragmented files
+    ExTask addTask(Vbid vbid) {
+        ExTask task = std::make_shared<TestTask>(engine->getTaskable(),
+                                                 TaskId::CompactVBucketTask);
+        ExecutorPool::get()->schedule(task);
+        getBucket().addCompactionTask(vbid, task, 0.1 * (vbid.get() + 1));
+        return task;
+    }
+
+    MockEPBucket& getBucket() {
+        return static_cast<MockEPBucket&>(getEPBucket());
+    }
+};
+
+// Only compaction_max_concurrency compactions run at the same time; as they
+// complete the waiting task with the most fragmented file goes next.
+TEST_F(CompactionSchedulerTest, SlotsAndPriority) {
+    auto& bucket = getBucket();
+    bucket.setCompactionMaxConcurrency(2);
+    std::vector<ExTask> tasks;
+    for (uint16_t ii = 0; ii < 4; ++ii) {
+        tasks.push_back(addTask(Vbid(ii)));
+    }
+
+    EXPECT_TRUE(bucket.acquireCompactionSlot(*tasks[0], Vbid(0)));
+    EXPECT_TRUE(bucket.acquireCompactionSlot(*tasks[1], Vbid(1)));
+    EXPECT_FALSE(bucket.acquireCompactionSlot(*tasks[2], Vbid(2)));
+    EXPECT_FALSE(bucket.acquireCompactionSlot(*tasks[3], Vbid(3)));
+    EXPECT_TRUE(bucket.isCompactionRunning(*tasks[0]));
+    EXPECT_TRUE(bucket.isCompactionRunning(*tasks[1]));
+    EXPECT_EQ(TASK_SNOOZED, tasks[2]->getState());
+    EXPECT_EQ(TASK_SNOOZED, tasks[3]->getState());
+
+    // Only the most fragmented waiting task is woken for the freed slot
+    bucket.completeCompaction(Vbid(0));
+    EXPECT_EQ(TASK_SNOOZED, tasks[2]->getState());
+    EXPECT_EQ(TASK_RUNNING, tasks[3]->getState());
+    EXPECT_TRUE(bucket.acquireCompactionSlot(*tasks[3], Vbid(3)));
+
+    bucket.completeCompaction(Vbid(1));
+    EXPECT_EQ(TASK_RUNNING, tasks[2]->getState());
+    EXPECT_TRUE(bucket.acquireCompactionSlot(*tasks[2], Vbid(2)));
+    EXPECT_TRUE(bucket.isCompactionRunning(*tasks[2]));
+    EXPECT_TRUE(bucket.isCompactionRunning(*tasks[3]));
+}
+
+// A task takes a free slot even if a more fragmented one is waiting, and
+// wakes as many of the waiting tasks as there are slots left.
+TEST_F(CompactionSchedulerTest, WakeForFreeSlots) {
+    auto& bucket = getBucket();
+    bucket.setCompactionMaxConcurrency(1);
+    std::vector<ExTask> tasks;
+    for (uint16_t ii = 0; ii < 4; ++ii) {
+        tasks.push_back(addTask(Vbid(ii)));
+    }
+    EXPECT_TRUE(bucket.acquireCompactionSlot(*tasks[1], Vbid(1)));
+    for (auto ii : {0, 2, 3}) {
+        EXPECT_FALSE(bucket.acquireCompactionSlot(*tasks[ii], Vbid(ii)));
+    }
+
+    // Two more slots; the two most fragmented waiting tasks are woken
+    bucket.setCompactionMaxConcurrency(3);
+    EXPECT_EQ(TASK_SNOOZED, tasks[0]->getState());
+    EXPECT_EQ(TASK_RUNNING, tasks[2]->getState());
+    EXPECT_EQ(TASK_RUNNING, tasks[3]->getState());
+
+    // The least fragmented task runs if it gets to a free slot first, and
+    // wakes the other waiting task for the slot which is left
+    tasks[2]->snooze(60);
+    EXPECT_TRUE(bucket.acquireCompactionSlot(*tasks[0], Vbid(0)));
+    EXPECT_EQ(TASK_RUNNING, tasks[2]->getState());
+    EXPECT_TRUE(bucket.acquireCompactionSlot(*tasks[2], Vbid(2)));
+    EXPECT_FALSE(bucket.acquireCompactionSlot(*tasks[3], Vbid(3)));
+}
+
+// While compactions are being held back (here as the workload is read heavy)
+// only one waiting task is woken at a time.
+TEST_F(CompactionSchedulerTest, Deferred) {
+    auto& bucket = getBucket();
+    bucket.setCompactionMaxConcurrency(1);
+    std::vector<ExTask> tasks;
+    for (uint16_t ii = 0; ii < 4; ++ii) {
+        tasks.push_back(addTask(Vbid(ii)));
+    }
+    EXPECT_TRUE(bucket.acquireCompactionSlot(*tasks[0], Vbid(0)));
+    for (auto ii : {1, 2, 3}) {
+        EXPECT_FALSE(bucket.acquireCompactionSlot(*tasks[ii], Vbid(ii)));
+    }
+
+    auto& workload = engine->getWorkLoadPolicy();
+    const auto pattern = workload.getWorkLoadPattern();
+    workload.setWorkLoadPattern(READ_HEAVY);
+    bucket.setCompactionMaxConcurrency(3);
+    EXPECT_EQ(TASK_SNOOZED, tasks[1]->getState());
+    EXPECT_EQ(TASK_SNOOZED, tasks[2]->getState());
+    EXPECT_EQ(TASK_RUNNING, tasks[3]->getState());
+
+    // Taking a slot doesn't wake the others either
+    EXPECT_TRUE(bucket.acquireCompactionSlot(*tasks[3], Vbid(3)));
+    EXPECT_EQ(TASK_SNOOZED, tasks[1]->getState());
+    EXPECT_EQ(TASK_SNOOZED, tasks[2]->getState());
+    workload.setWorkLoadPattern(pattern);
+}
+
+// A compaction writing faster than compaction_write_rate_limit is made to
+// wait between its writes.
+TEST_F(CompactionSchedulerTest, WriteRateLimit) {
+    setVBucketStateAndRunPersistTask(vbid, vbucket_state_active);
+    store_item(vbid, makeStoredDocKey("key"), "value");
+    flushVBucketToDiskIfPersistent(vbid, 1);
+
+    // Use up the limiter's burst so every write of the compaction waits
+    const size_t rate = 100 * 1024;
+    auto& bucket = getBucket();
+    bucket.setCompactionWriteRateLimit(rate);
+    bucket.getCompactionWriteRateLimiter().reserve(
+            rate, IORateLimiter::Clock::now());
+
+    const auto start = std::chrono::steady_clock::now();
+    runCompaction();
+    EXPECT_NE(0, engine->getEpStats().compactionBytesWritten);
+    EXPECT_NE(0, engine->getEpStats().compactionWriteThrottledTime);
+    EXPECT_LE(std::chrono::microseconds(
+                      engine->getEpStats().compactionWriteThrottledTime.load()),
+              std::chrono::steady_clock::now() - start);
+}
+
 /*
  * The following test checks to see if we call handleSlowStream when in a
  * backfilling state, but the backfillTask is not running, we
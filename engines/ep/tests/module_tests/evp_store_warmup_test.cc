@@ -30,10 +30,13 @@
 #include "failover-table.h"
 #include "kvstore.h"
 #include "programs/engine_testapp/mock_cookie.h"
+#include "seqno_access_log.h"
 #include "test_helpers.h"
 #include "vbucket_state.h"
 #include "warmup.h"
 
+#include <platform/dirutils.h>
+
 class WarmupTest : public SingleThreadedKVBucketTest {
 public:
     void MB_31450(bool newCheckpoint);
@@ -117,6 +120,153 @@ TEST_F(WarmupTest, hlcEpoch) {
     EXPECT_TRUE(info2.cas_is_hlc);
 }
 
+// Test that the bloom filter of a vBucket is saved by a clean shutdown and
+// loaded by warmup (which would otherwise run without a filter until the next
+// compaction). Under full eviction the saved filter must also cover the keys
+// which were resident at shutdown.
+TEST_F(WarmupTest, BloomFilterSavedAndLoaded) {
+    resetEngineAndWarmup("item_eviction_policy=full_eviction");
+    setVBucketStateAndRunPersistTask(vbid, vbucket_state_active);
+
+    auto key = makeStoredDocKey("key1");
+    store_item(vbid, key, "value");
+    flush_vbucket_to_disk(vbid);
+    EXPECT_EQ(0, store->getVBucket(vbid)->getNumOfKeysInFilter());
+
+    // Record a clean shutdown so warmup trusts the saved filter
+    engine->getEpStats().isShutdown = true;
+    store->snapshotStats();
+    resetEngineAndWarmup("item_eviction_policy=full_eviction");
+
+    auto vb = store->getVBucket(vbid);
+    EXPECT_EQ("ENABLED", vb->getFilterStatusString());
+    EXPECT_EQ(1, vb->getNumOfKeysInFilter());
+    EXPECT_TRUE(vb->maybeKeyExistsInFilter(key));
+
+    // The file is consumed by warmup
+    EXPECT_FALSE(cb::io::isFile(
+            dynamic_cast<EPBucket&>(*store).getBloomFilterFileName(vbid)));
+}
+
+// Test that an online warmup completes once all keys are loaded and then
+// loads values in the background, without resurrecting a key which was
+// deleted after its vBucket's load started.
+TEST_F(WarmupTest, OnlineWarmup) {
+    setVBucketStateAndRunPersistTask(vbid, vbucket_state_active);
+    auto key1 = makeStoredDocKey("key1");
+    auto key2 = makeStoredDocKey("key2");
+    store_item(vbid, key1, "value");
+    store_item(vbid, key2, "value");
+    flush_vbucket_to_disk(vbid, 2);
+
+    resetEngineAndWarmup("warmup_online=true;warmup_batch_size=1");
+    auto* warmup = store->getWarmup();
+    ASSERT_TRUE(warmup);
+    EXPECT_FALSE(store->isWarmingUp());
+    EXPECT_TRUE(warmup->isBackgroundLoading());
+
+    // All keys are known but their values are still on disk
+    auto vb = store->getVBucket(vbid);
+    ASSERT_TRUE(vb->ht.findForRead(key1).storedValue);
+    ASSERT_TRUE(vb->ht.findForRead(key2).storedValue);
+    EXPECT_FALSE(vb->ht.findForRead(key1).storedValue->isResident());
+
+    // Run the background load until it has loaded its first batch (key1)
+    auto& readerQueue = *task_executor->getLpTaskQ()[READER_TASK_IDX];
+    while (!vb->ht.findForRead(key1).storedValue->isResident()) {
+        runNextTask(readerQueue);
+    }
+    EXPECT_FALSE(vb->ht.findForRead(key2).storedValue->isResident());
+
+    // Delete key2; once persisted it's removed from the HashTable, however
+    // it's still in the snapshot the background load is reading from.
+    delete_item(vbid, key2);
+    flush_vbucket_to_disk(vbid);
+    EXPECT_FALSE(vb->ht.findForRead(key2).storedValue);
+
+    while (warmup->isBackgroundLoading()) {
+        runNextTask(readerQueue);
+    }
+    EXPECT_FALSE(vb->ht.findForRead(key2).storedValue);
+    EXPECT_EQ(1, engine->getEpStats().warmDups);
+}
+
+// Test that warmup loads the items recorded in a seqno format access log
+// (and only those, when it has loaded enough to enable traffic).
+TEST_F(WarmupTest, SeqnoAccessLog) {
+    std::vector<StoredDocKey> keys;
+    for (int i = 0; i < 4; ++i) {
+        keys.push_back(makeStoredDocKey("key" + std::to_string(i)));
+        store_item(vbid, keys.back(), "value");
+    }
+    flush_vbucket_to_disk(vbid, keys.size());
+
+    // Record key1 and key3 as hot.
+    std::vector<uint64_t> seqnos;
+    {
+        auto vb = store->getVBucket(vbid);
+        for (const auto& key : {keys[1], keys[3]}) {
+            seqnos.push_back(
+                    vb->ht.findForRead(key).storedValue->getBySeqno());
+        }
+    }
+    const auto alogPath = test_dbname + "/access.log";
+    const auto numShards = store->getVBuckets().getNumShards();
+    for (size_t shard = 0; shard < numShards; ++shard) {
+        SeqnoAccessLog::Writer log(
+                alogPath + "." + std::to_string(shard) + ".seqno", 4096);
+        if (shard == vbid.get() % numShards) {
+            log.write(vbid, seqnos);
+        }
+        ASSERT_TRUE(log.close());
+    }
+
+    // Traffic is enabled once half of the values are loaded.
+    resetEngineAndWarmup("alog_path=" + alogPath +
+                         ";warmup_min_items_threshold=50");
+
+    auto vb = store->getVBucket(vbid);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto* sv = vb->ht.findForRead(keys[i]).storedValue;
+        ASSERT_TRUE(sv) << keys[i];
+        EXPECT_EQ(i % 2 == 1, sv->isResident()) << keys[i];
+    }
+}
+
+// Test that when each shard's data is loaded by multiple tasks, every
+// vBucket is loaded, and that the throughput of the phase is reported.
+TEST_F(WarmupTest, MultipleLoadTasksPerShard) {
+    const size_t numVbs = 8;
+    for (uint16_t i = 0; i < numVbs; ++i) {
+        setVBucketStateAndRunPersistTask(Vbid(i), vbucket_state_active);
+        store_item(Vbid(i), makeStoredDocKey("key"), "value");
+        flush_vbucket_to_disk(Vbid(i));
+    }
+
+    resetEngineAndWarmup("warmup_tasks_per_shard=3");
+
+    for (uint16_t i = 0; i < numVbs; ++i) {
+        auto vb = store->getVBucket(Vbid(i));
+        ASSERT_TRUE(vb);
+        auto* sv = vb->ht.findForRead(makeStoredDocKey("key")).storedValue;
+        ASSERT_TRUE(sv) << Vbid(i);
+        EXPECT_TRUE(sv->isResident()) << Vbid(i);
+    }
+
+    std::map<std::string, std::string> stats;
+    store->getWarmup()->addStats(
+            [&stats](std::string_view key,
+                     std::string_view value,
+                     gsl::not_null<const void*>) {
+                stats[std::string(key)] = std::string(value);
+            },
+            this);
+    EXPECT_EQ(std::to_string(numVbs), stats["ep_warmup_loading_data_items"]);
+    EXPECT_NE(stats.end(), stats.find("ep_warmup_loading_data_time"));
+    EXPECT_NE(stats.end(), stats.find("ep_warmup_loading_data_items_per_sec"));
+    EXPECT_EQ(std::to_string(numVbs), stats["ep_warmup_key_dump_items"]);
+}
+
 TEST_F(WarmupTest, fetchDocInDifferentCompressionModes) {
     setVBucketStateAndRunPersistTask(vbid, vbucket_state_active);
 
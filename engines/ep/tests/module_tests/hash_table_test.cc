@@ -34,6 +34,8 @@
 #include <signal.h>
 #include <algorithm>
 #include <limits>
+#include <numeric>
+#include <set>
 #include <string>
 #include <utility>
 
@@ -1043,6 +1045,33 @@ TEST_F(HashTableTest, PauseResumeHashBucket) {
     ht.pauseResumeVisit(mockVisitor, start);
 }
 
+// Check that MultiBucketLock holds each underlying mutex once (even when
+// multiple keys share it) and lends / takes back each key's lock.
+TEST_F(HashTableTest, MultiBucketLock) {
+    // Four buckets, two locks - keys in buckets 0 and 2 share a mutex.
+    HashTable ht(global_stats, makeFactory(), 4, 2);
+    auto keys = generateKeys(8);
+    storeMany(ht, keys);
+
+    std::set<size_t> expectedMutexes;
+    for (const auto& key : keys) {
+        expectedMutexes.insert(ht.getLockedBucket(key).getBucketNum() % 2);
+    }
+
+    std::vector<DocKey> docKeys(keys.begin(), keys.end());
+    HashTable::MultiBucketLock locks(ht, docKeys);
+    EXPECT_EQ(expectedMutexes.size(), locks.size());
+
+    for (const auto& key : keys) {
+        auto result = ht.findForUpdate(locks.lend(key), key);
+        ASSERT_TRUE(result.committed);
+        EXPECT_EQ(key, result.committed->getKey());
+        // A second lend of the same mutex before it is returned must fail.
+        EXPECT_THROW(locks.lend(key), std::logic_error);
+        locks.giveBack(std::move(result.pending.getHBL()));
+    }
+}
+
 // Test the itemFreqDecayerVisitor by adding 256 documents to the hash table.
 // Then set the frequency count of each document in the range 0 to 255.  We
 // then visit each document and decay it by 50%.  The test checks that the
@@ -1083,6 +1112,62 @@ TEST_F(HashTableTest, ItemFreqDecayerVisitorTest) {
        }
 }
 
+// The frequency counter histogram tracks the counters of evictable values as
+// they are added, referenced, decayed, ejected and removed.
+TEST_F(HashTableTest, FreqCounterHistogram) {
+    HashTable ht(global_stats, makeFactory(), 5, 1);
+    auto keys = generateKeys(10);
+    storeMany(ht, keys);
+
+    auto histogram = ht.getFreqCounterHistogram();
+    EXPECT_EQ(10, histogram[Item::initialFreqCount]);
+    EXPECT_EQ(10, std::accumulate(histogram.begin(), histogram.end(), 0));
+
+    // Set the counter of each key to its index, as the decayer would.
+    for (int ii = 0; ii < 10; ii++) {
+        auto result = ht.findForWrite(keys[ii]);
+        ASSERT_TRUE(result.storedValue);
+        ht.setFreqCounterValue(*result.storedValue, ii);
+    }
+    histogram = ht.getFreqCounterHistogram();
+    for (int ii = 0; ii < 10; ii++) {
+        EXPECT_EQ(1, histogram[ii]) << "freqCounter:" << ii;
+    }
+
+    // Referencing a value may only move it up.
+    {
+        auto result = ht.findForWrite(keys[0]);
+        for (int ii = 0; ii < 1000; ii++) {
+            ht.updateFreqCounter(*result.storedValue);
+        }
+        histogram = ht.getFreqCounterHistogram();
+        EXPECT_EQ(0, histogram[0]);
+        EXPECT_EQ(1, histogram[result.storedValue->getFreqCounterValue()]);
+    }
+
+    // Ejected (non-resident) and deleted values are no longer evictable.
+    {
+        auto result = ht.findForWrite(keys[1]);
+        ASSERT_TRUE(ht.unlocked_ejectItem(
+                result.lock, result.storedValue, EvictionPolicy::Value));
+    }
+    EXPECT_TRUE(del(ht, keys[2]));
+    histogram = ht.getFreqCounterHistogram();
+    EXPECT_EQ(0, histogram[1]);
+    EXPECT_EQ(0, histogram[2]);
+    EXPECT_EQ(8, std::accumulate(histogram.begin(), histogram.end(), 0));
+
+    // Updating a value takes the counter of the new item.
+    store(ht, keys[3]);
+    histogram = ht.getFreqCounterHistogram();
+    EXPECT_EQ(0, histogram[3]);
+    EXPECT_EQ(8, std::accumulate(histogram.begin(), histogram.end(), 0));
+
+    ht.clear();
+    histogram = ht.getFreqCounterHistogram();
+    EXPECT_EQ(0, std::accumulate(histogram.begin(), histogram.end(), 0));
+}
+
 // Test the reallocateStoredValue method.
 // Check it can reallocate and also ignores bogus input
 TEST_F(HashTableTest, reallocateStoredValue) {
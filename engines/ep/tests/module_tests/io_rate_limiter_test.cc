@@ -0,0 +1,90 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include "io_rate_limiter.h"
+
+using namespace std::chrono_literals;
+
+// A rate of zero never makes the caller wait.
+TEST(IORateLimiterTest, Unlimited) {
+    IORateLimiter limiter;
+    const auto now = IORateLimiter::Clock::now();
+    EXPECT_EQ(0ns, limiter.reserve(1024 * 1024 * 1024, now));
+    EXPECT_EQ(0ns, limiter.reserve(1024 * 1024 * 1024, now));
+}
+
+// The bucket starts full: one second worth of bytes is available
+// immediately, after which callers wait for it to refill.
+TEST(IORateLimiterTest, Burst) {
+    IORateLimiter limiter(1000);
+    const auto now = IORateLimiter::Clock::now();
+    EXPECT_EQ(0ns, limiter.reserve(1000, now));
+    EXPECT_EQ(500ms, limiter.reserve(500, now));
+    // Overdrawn - the next caller queues behind the previous one.
+    EXPECT_EQ(1000ms, limiter.reserve(500, now));
+}
+
+// Tokens accumulate with time, but never beyond one second's worth.
+TEST(IORateLimiterTest, Refill) {
+    IORateLimiter limiter(1000);
+    auto now = IORateLimiter::Clock::now();
+    EXPECT_EQ(0ns, limiter.reserve(1000, now));
+    now += 500ms;
+    EXPECT_EQ(0ns, limiter.reserve(500, now));
+    now += 10s;
+    EXPECT_EQ(0ns, limiter.reserve(1000, now));
+    EXPECT_EQ(100ms, limiter.reserve(100, now));
+}
+
+// Lowering the rate drops any tokens above the new burst size; setting it to
+// zero removes the limit.
+TEST(IORateLimiterTest, SetRate) {
+    IORateLimiter limiter(1000);
+    const auto now = IORateLimiter::Clock::now();
+    limiter.setRate(100);
+    EXPECT_EQ(100, limiter.getRate());
+    EXPECT_EQ(0ns, limiter.reserve(100, now));
+    EXPECT_EQ(1s, limiter.reserve(100, now));
+
+    limiter.setRate(0);
+    EXPECT_EQ(0ns, limiter.reserve(1000000, now));
+}
+
+// Reserving nothing gives how long until the bucket is no longer overdrawn.
+TEST(IORateLimiterTest, Overdrawn) {
+    IORateLimiter limiter(1000);
+    auto now = IORateLimiter::Clock::now();
+    EXPECT_EQ(0ns, limiter.reserve(0, now));
+    EXPECT_EQ(2s, limiter.reserve(3000, now));
+    EXPECT_EQ(2s, limiter.reserve(0, now));
+    now += 1500ms;
+    EXPECT_EQ(500ms, limiter.reserve(0, now));
+    now += 500ms;
+    EXPECT_EQ(0ns, limiter.reserve(0, now));
+}
+
+// acquire() puts the caller to sleep for as long as it has to wait.
+TEST(IORateLimiterTest, Acquire) {
+    IORateLimiter limiter(10000);
+    EXPECT_EQ(0ns, limiter.acquire(10000));
+    const auto start = IORateLimiter::Clock::now();
+    const auto wait = limiter.acquire(100);
+    EXPECT_LT(0ns, wait);
+    EXPECT_LE(wait, IORateLimiter::Clock::now() - start);
+}
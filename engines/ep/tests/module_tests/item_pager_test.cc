@@ -721,6 +721,49 @@ TEST_P(STItemPagerTest, doNotDecayIfCannotEvict) {
 
 }
 
+/**
+ * Test that the pager starts visiting a vbucket with the frequency counter
+ * threshold from its histogram, and stops evicting once the memory deficit
+ * has been evicted rather than evicting everything below the threshold.
+ */
+TEST_P(STItemPagerTest, EvictsMemoryDeficit) {
+    // Pager can't run in fail_new_data policy so test is invalid
+    if ((std::get<1>(GetParam()) == "fail_new_data")) {
+        return;
+    }
+
+    populateUntilAboveHighWaterMark(vbid);
+    flushDirectlyIfPersistent(vbid);
+
+    std::shared_ptr<std::atomic<bool>> available;
+    std::atomic<item_pager_phase> phase{ACTIVE_AND_PENDING_ONLY};
+    Configuration& cfg = engine->getConfiguration();
+    bool isEphemeral = std::get<0>(GetParam()) == "ephemeral";
+    std::unique_ptr<MockPagingVisitor> pv = std::make_unique<MockPagingVisitor>(
+            *engine->getKVBucket(),
+            engine->getEpStats(),
+            1.0,
+            available,
+            ITEM_PAGER,
+            false,
+            0.5,
+            VBucketFilter(),
+            &phase,
+            isEphemeral,
+            cfg.getItemEvictionAgePercentage(),
+            cfg.getItemEvictionFreqCounterAgeThreshold());
+
+    VBucketPtr vb = store->getVBucket(vbid);
+    pv->visitBucket(vb);
+
+    // All of the items were stored with a frequency counter of zero.
+    EXPECT_EQ(0, pv->getMinFreqCounterThreshold());
+    ASSERT_GT(pv->getBytesToEvict(), 0);
+    EXPECT_GE(pv->getBytesEvicted(), pv->getBytesToEvict());
+    // Eviction stops at the first item past the target.
+    EXPECT_LT(pv->getBytesEvicted(), pv->getBytesToEvict() + 512);
+}
+
 /**
  * MB-38315 found that when we BG Fetch a deleted item it can end up "stuck" in
  * the HashTable until the compactor removes the tombstone for it. This
@@ -18,6 +18,7 @@
 
 #include "bucket_logger.h"
 #include "couch-kvstore/couch-kvstore-config.h"
+#include "ep_time.h"
 #include "item.h"
 #include "kvstore.h"
 #include "kvstore_config.h"
@@ -328,9 +329,7 @@ TEST_P(KVStoreParamTest, TestPersistenceCallbacksForSet) {
     EXPECT_TRUE(kvstore->commit(flush));
 }
 
-// This test does not work under RocksDB because we assume that every
-// deletion is to an item that does not exist
-TEST_P(KVStoreParamTestSkipRocks, TestPersistenceCallbacksForDel) {
+TEST_P(KVStoreParamTest, TestPersistenceCallbacksForDel) {
     // Store an item
     auto key = makeStoredDocKey("key");
     auto qi = makeCommittedItem(key, "value");
@@ -642,6 +641,37 @@ TEST_P(KVStoreParamTest, GetRangeDeleted) {
     EXPECT_EQ("value_e"s, results.at(1).item->getValue()->to_s());
 }
 
+// Test the getMulti() function returns each key's value, in whatever order
+// the keys are in the queue.
+TEST_P(KVStoreParamTest, GetMultiBasic) {
+    // Setup: store 5 keys, a, b, c, d, e (with matching values)
+    kvstore->begin(std::make_unique<TransactionContext>(vbid));
+    int64_t seqno = 1;
+    for (char k = 'e'; k >= 'a'; k--) {
+        auto item = makeCommittedItem(makeStoredDocKey({k}),
+                                      "value_"s + std::string{k});
+        item->setBySeqno(seqno++);
+        kvstore->set(item);
+    }
+    kvstore->commit(flush);
+
+    // Test: Ask for b, d and the missing key f.
+    vb_bgfetch_queue_t itms;
+    for (const auto* k : {"d", "f", "b"}) {
+        vb_bgfetch_item_ctx_t ctx;
+        ctx.isMetaOnly = GetMetaOnly::No;
+        itms[makeDiskDocKey(k)] = std::move(ctx);
+    }
+    kvstore->getMulti(vbid, itms);
+
+    for (const auto* k : {"b", "d"}) {
+        auto& gv = itms[makeDiskDocKey(k)].value;
+        ASSERT_EQ(ENGINE_SUCCESS, gv.getStatus()) << k;
+        EXPECT_EQ("value_"s + k, gv.item->getValue()->to_s());
+    }
+    EXPECT_EQ(ENGINE_KEY_ENOENT, itms[makeDiskDocKey("f")].value.getStatus());
+}
+
 TEST_P(KVStoreParamTest, Durability_PersistPrepare) {
     StoredDocKey key = makeStoredDocKey("key");
     auto qi = makePendingItem(key, "value");
@@ -930,6 +960,99 @@ TEST_F(RocksDBKVStoreTest, StatsTest) {
     // Scan stats
     EXPECT_TRUE(kvstore->getStat("scan_totalSeqnoHits", value));
     EXPECT_TRUE(kvstore->getStat("scan_oldSeqnoHits", value));
+
+    // BGFetch stats
+    EXPECT_TRUE(kvstore->getStat("io_bg_fetch_read_count", value));
+}
+
+// Verify that the item and tombstone counts are exact, and survive the DB
+// being reopened.
+TEST_F(RocksDBKVStoreTest, ItemAndDeleteCounts) {
+    Vbid vbid(0);
+    int64_t seqno = 1;
+    auto flushItems = [this, &vbid, &seqno](std::vector<std::string> sets,
+                                            std::vector<std::string> dels) {
+        kvstore->begin(std::make_unique<TransactionContext>(vbid));
+        for (const auto& key : sets) {
+            auto item = makeCommittedItem(makeStoredDocKey(key), "value");
+            item->setBySeqno(seqno++);
+            kvstore->set(item);
+        }
+        for (const auto& key : dels) {
+            auto item = makeCommittedItem(makeStoredDocKey(key), "value");
+            item->setDeleted(DeleteSource::Explicit);
+            item->setBySeqno(seqno++);
+            kvstore->del(item);
+        }
+        flush.proposedVBState.lastSnapEnd = seqno - 1;
+        ASSERT_TRUE(kvstore->commit(flush));
+    };
+
+    flushItems({"a", "b", "c"}, {});
+    EXPECT_EQ(3, kvstore->getItemCount(vbid));
+    EXPECT_EQ(0, kvstore->getNumPersistedDeletes(vbid));
+
+    // Updates and deletes of missing / already deleted keys don't add items.
+    flushItems({"a"}, {"b", "d"});
+    EXPECT_EQ(2, kvstore->getItemCount(vbid));
+    EXPECT_EQ(2, kvstore->getNumPersistedDeletes(vbid));
+    flushItems({"b"}, {"d"});
+    EXPECT_EQ(3, kvstore->getItemCount(vbid));
+    EXPECT_EQ(1, kvstore->getNumPersistedDeletes(vbid));
+
+    kvstore.reset();
+    kvstore = setup_kv_store(*kvstoreConfig);
+    EXPECT_EQ(3, kvstore->getItemCount(vbid));
+    EXPECT_EQ(1, kvstore->getNumPersistedDeletes(vbid));
+
+    // A vBucket which doesn't exist has no items.
+    EXPECT_EQ(0, kvstore->getItemCount(Vbid(1)));
+}
+
+class ExpiredKeysCallback : public Callback<Item&, time_t&> {
+public:
+    void callback(Item& item, time_t&) override {
+        EXPECT_TRUE(item.isDeleted());
+        keys.push_back(item.getKey().c_str());
+    }
+
+    std::vector<std::string> keys;
+};
+
+// Verify that compaction passes the documents whose TTL has elapsed to the
+// expiry callback (and nothing else), leaving the documents in place.
+TEST_F(RocksDBKVStoreTest, CompactionExpiresItems) {
+    Vbid vbid(0);
+    kvstore->begin(std::make_unique<TransactionContext>(vbid));
+    int64_t seqno = 1;
+    auto store = [this, &seqno](const std::string& key, time_t exptime) {
+        auto item = makeCommittedItem(makeStoredDocKey(key), "value");
+        item->setExpTime(exptime);
+        item->setBySeqno(seqno++);
+        kvstore->set(item);
+    };
+    store("expired", ep_real_time() - 10);
+    store("live", ep_real_time() + 3600);
+    store("no_ttl", 0);
+    flush.proposedVBState.lastSnapEnd = seqno - 1;
+    ASSERT_TRUE(kvstore->commit(flush));
+
+    auto expired = std::make_shared<ExpiredKeysCallback>();
+    kvstore->setMakeCompactionContextCallback(
+            [expired](CompactionConfig& config, uint64_t purgeSeqno) {
+                auto ctx = std::make_shared<compaction_ctx>(config, purgeSeqno);
+                ctx->expiryCallback = expired;
+                return ctx;
+            });
+
+    CompactionConfig config;
+    config.db_file_id = vbid;
+    EXPECT_TRUE(kvstore->compactDB(std::make_shared<compaction_ctx>(config, 0)));
+    EXPECT_EQ(std::vector<std::string>{"expired"}, expired->keys);
+
+    // The engine deletes the expired document; compaction doesn't.
+    auto gv = kvstore->get(makeDiskDocKey("expired"), vbid);
+    checkGetValue(gv);
 }
 
 // Verify that a wrong value of 'rocksdb_statistics_option' is caught
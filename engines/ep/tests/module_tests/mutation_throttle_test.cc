@@ -0,0 +1,275 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "mutation_throttle.h"
+#include "dcp/flow-control.h"
+#include "evp_store_single_threaded_test.h"
+#include "item.h"
+#include "kv_bucket.h"
+#include "tests/mock/mock_dcp.h"
+#include "tests/mock/mock_dcp_conn_map.h"
+#include "tests/mock/mock_dcp_consumer.h"
+#include "tests/mock/mock_synchronous_ep_engine.h"
+#include "vbucket.h"
+
+#include <folly/portability/GTest.h>
+
+#include <thread>
+
+class MutationThrottleTest : public SingleThreadedKVBucketTest {
+protected:
+    void SetUp() override {
+        SingleThreadedKVBucketTest::SetUp();
+        store->setVBucketState(vbid, vbucket_state_active);
+    }
+
+    /**
+     * Set the quota and high watermark so memory usage is part way between
+     * the high watermark and the mutation_mem_threshold.
+     */
+    void setPressure() {
+        auto& config = engine->getConfiguration();
+        const auto memUsed =
+                engine->getEpStats().getPreciseTotalMemoryUsed();
+        config.setMaxSize(memUsed * 2);
+        config.setMemLowWat(memUsed * 0.4);
+        config.setMemHighWat(memUsed * 0.5);
+
+        const auto pressure = getThrottle().getPressure(limit);
+        ASSERT_GT(pressure, 0);
+        ASSERT_LT(pressure, 1);
+    }
+
+    MutationThrottle& getThrottle() {
+        return store->getMutationThrottle();
+    }
+
+    const double limit = 0.93;
+    const std::chrono::milliseconds maxDelay{100};
+};
+
+TEST_F(MutationThrottleTest, DisabledByDefault) {
+    setPressure();
+    EXPECT_FALSE(getThrottle().isEnabled());
+    EXPECT_EQ(0, getThrottle().getDelay(1024, limit).count());
+}
+
+TEST_F(MutationThrottleTest, NoDelayBelowHighWatermark) {
+    engine->getConfiguration().setMutationThrottleEnabled(true);
+    EXPECT_EQ(0, getThrottle().getPressure(limit));
+    EXPECT_EQ(0, getThrottle().getDelay(1024, limit).count());
+}
+
+// Beyond the limit the mutation is rejected, not delayed.
+TEST_F(MutationThrottleTest, NoDelayBeyondLimit) {
+    engine->getConfiguration().setMutationThrottleEnabled(true);
+    setPressure();
+    EXPECT_EQ(1, getThrottle().getPressure(0.1));
+    EXPECT_EQ(0, getThrottle().getDelay(1024, 0.1).count());
+}
+
+// Until the pager has freed anything the delay is proportional to the
+// pressure.
+TEST_F(MutationThrottleTest, DelayProportionalToPressure) {
+    engine->getConfiguration().setMutationThrottleEnabled(true);
+    setPressure();
+    const auto pressure = getThrottle().getPressure(limit);
+    const auto delay = getThrottle().getDelay(1024, limit);
+    EXPECT_GT(delay.count(), 0);
+    EXPECT_LE(delay, maxDelay);
+    EXPECT_NEAR(pressure,
+                std::chrono::duration<double>(delay).count() /
+                        std::chrono::duration<double>(maxDelay).count(),
+                0.05);
+}
+
+// Once a drain rate is known, mutations are paced relative to it and a burst
+// far beyond it is delayed by the maximum.
+TEST_F(MutationThrottleTest, PacedToDrainRate) {
+    engine->getConfiguration().setMutationThrottleEnabled(true);
+    setPressure();
+    auto& throttle = getThrottle();
+    auto now = MutationThrottle::Clock::now() + std::chrono::seconds(1);
+    throttle.recordDrained(1024 * 1024, now);
+    EXPECT_GT(throttle.getDrainRate(), 0);
+
+    // Spend the pacer's initial allowance.
+    now += MutationThrottle::SampleInterval;
+    throttle.getDelay(size_t(throttle.getDrainRate() * 10), limit, now);
+    EXPECT_EQ(maxDelay, throttle.getDelay(1024, limit, now));
+}
+
+// A delayed front-end mutation blocks, and succeeds once its cookie has been
+// notified.
+TEST_F(MutationThrottleTest, StoreWouldBlock) {
+    auto& config = engine->getConfiguration();
+    config.setMutationThrottleEnabled(true);
+    config.setMutationThrottleMaxDelayMs(1);
+    setPressure();
+
+    auto item = make_item(vbid, makeStoredDocKey("key"), "value");
+    uint64_t cas = 0;
+    EXPECT_EQ(ENGINE_EWOULDBLOCK,
+              engine->storeInner(cookie, item, cas, OPERATION_SET, false));
+    EXPECT_EQ(1, engine->getEpStats().mutationThrottleDelayed);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    auto& lpNonioQ = *task_executor->getLpTaskQ()[NONIO_TASK_IDX];
+    runNextTask(lpNonioQ, "Notify mutation delayed by memory pressure");
+
+    EXPECT_EQ(ENGINE_SUCCESS,
+              engine->storeInner(cookie, item, cas, OPERATION_SET, false));
+    EXPECT_EQ(1, engine->getEpStats().mutationThrottleDelayed);
+}
+
+class MutationThrottleFullEvictionTest : public MutationThrottleTest {
+protected:
+    void SetUp() override {
+        config_string += "item_eviction_policy=full_eviction";
+        MutationThrottleTest::SetUp();
+    }
+};
+
+// A delayed mutation which then has to wait for a background fetch isn't
+// delayed a second time when it's retried.
+TEST_F(MutationThrottleFullEvictionTest, NotDelayedAgainAfterBgFetch) {
+    auto key = makeStoredDocKey("key");
+    auto item = make_item(vbid, key, "value");
+    ASSERT_EQ(ENGINE_SUCCESS, store->set(item, cookie));
+    flushVBucketToDiskIfPersistent(vbid, 1);
+    evict_key(vbid, key);
+
+    auto& config = engine->getConfiguration();
+    config.setMutationThrottleEnabled(true);
+    config.setMutationThrottleMaxDelayMs(1);
+    setPressure();
+
+    auto added = make_item(vbid, key, "value2");
+    uint64_t cas = 0;
+    EXPECT_EQ(ENGINE_EWOULDBLOCK,
+              engine->storeInner(cookie, added, cas, OPERATION_ADD, false));
+    EXPECT_EQ(1, engine->getEpStats().mutationThrottleDelayed);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    auto& lpNonioQ = *task_executor->getLpTaskQ()[NONIO_TASK_IDX];
+    runNextTask(lpNonioQ, "Notify mutation delayed by memory pressure");
+
+    // Now it needs the key's metadata from disk
+    EXPECT_EQ(ENGINE_EWOULDBLOCK,
+              engine->storeInner(cookie, added, cas, OPERATION_ADD, false));
+    runBGFetcherTask();
+
+    EXPECT_EQ(ENGINE_NOT_STORED,
+              engine->storeInner(cookie, added, cas, OPERATION_ADD, false));
+    EXPECT_EQ(1, engine->getEpStats().mutationThrottleDelayed);
+    EXPECT_FALSE(getThrottle().isDelayed(cookie));
+    EXPECT_EQ(nullptr, engine->getEngineSpecific(cookie));
+}
+
+// A delayed mutation whose background fetch fails mustn't leave any state
+// behind which a later command on the connection (here a SyncDelete, which
+// treats a non-null engineSpecific as its completed SyncWrite) picks up.
+TEST_F(MutationThrottleFullEvictionTest, BgFetchFailureThenDurableDelete) {
+    setVBucketStateAndRunPersistTask(
+            vbid,
+            vbucket_state_active,
+            {{"topology", nlohmann::json::array({{"active", "replica"}})}});
+    auto key = makeStoredDocKey("key");
+    auto item = make_item(vbid, key, "value");
+    ASSERT_EQ(ENGINE_SUCCESS, store->set(item, cookie));
+    flushVBucketToDiskIfPersistent(vbid, 1);
+    evict_key(vbid, key);
+
+    auto& config = engine->getConfiguration();
+    config.setMutationThrottleEnabled(true);
+    config.setMutationThrottleMaxDelayMs(1);
+    setPressure();
+
+    auto added = make_item(vbid, key, "value2");
+    uint64_t cas = 0;
+    EXPECT_EQ(ENGINE_EWOULDBLOCK,
+              engine->storeInner(cookie, added, cas, OPERATION_ADD, false));
+    EXPECT_TRUE(getThrottle().isDelayed(cookie));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    auto& lpNonioQ = *task_executor->getLpTaskQ()[NONIO_TASK_IDX];
+    runNextTask(lpNonioQ, "Notify mutation delayed by memory pressure");
+    EXPECT_EQ(ENGINE_EWOULDBLOCK,
+              engine->storeInner(cookie, added, cas, OPERATION_ADD, false));
+
+    // The background fetch fails; the add isn't retried
+    store->getVBucket(vbid)->notifyAllPendingConnsFailed(*engine);
+    EXPECT_FALSE(getThrottle().isDelayed(cookie));
+    EXPECT_EQ(nullptr, engine->getEngineSpecific(cookie));
+
+    // A SyncDelete on the same connection has to actually run
+    cas = 0;
+    mutation_descr_t mutInfo;
+    EXPECT_EQ(ENGINE_EWOULDBLOCK,
+              engine->itemDelete(cookie,
+                                 key,
+                                 cas,
+                                 vbid,
+                                 cb::durability::Requirements(
+                                         cb::durability::Level::Majority, {}),
+                                 mutInfo));
+    EXPECT_EQ(0, cas);
+}
+
+// A DCP consumer holds back its buffer ack under memory pressure, and is
+// notified to send it once the delay has passed.
+TEST_F(MutationThrottleTest, BufferAckDelayed) {
+    auto& config = engine->getConfiguration();
+    config.setMutationThrottleEnabled(true);
+    config.setMutationThrottleMaxDelayMs(1);
+    setPressure();
+    ASSERT_GT(getThrottle().getPressure(
+                      engine->getEpStats().replicationThrottleThreshold),
+              0);
+
+    auto consumer = std::make_shared<MockDcpConsumer>(*engine, cookie, "test");
+    auto& flowControl = consumer->getFlowControl();
+    MockDcpMessageProducers producers(engine.get());
+
+    // The first message is the flow control buffer size
+    ASSERT_EQ(ENGINE_SUCCESS, flowControl.handleFlowCtl(&producers));
+    ASSERT_EQ(cb::mcbp::ClientOpcode::DcpControl, producers.last_op);
+
+    // The whole buffer has been processed, but the ack is held back
+    flowControl.incrFreedBytes(flowControl.getFlowControlBufSize());
+    producers.last_op = cb::mcbp::ClientOpcode::Invalid;
+    EXPECT_EQ(ENGINE_FAILED, flowControl.handleFlowCtl(&producers));
+    EXPECT_EQ(cb::mcbp::ClientOpcode::Invalid, producers.last_op);
+    EXPECT_NE(0, engine->getEpStats().dcpAckThrottleDelayTime);
+
+    // The (paused) consumer is notified once the delay has passed
+    consumer->pause();
+    consumer->setReserved(true);
+    auto& connMap = static_cast<MockDcpConnMap&>(engine->getDcpConnMap());
+    ASSERT_EQ(0, connMap.getPendingNotifications().size());
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    auto& lpNonioQ = *task_executor->getLpTaskQ()[NONIO_TASK_IDX];
+    runNextTask(lpNonioQ, "Notify DCP consumer delayed by memory pressure");
+    EXPECT_EQ(1, connMap.getPendingNotifications().size());
+
+    // ... when it sends the ack
+    EXPECT_EQ(ENGINE_SUCCESS, flowControl.handleFlowCtl(&producers));
+    EXPECT_EQ(cb::mcbp::ClientOpcode::DcpBufferAcknowledgement,
+              producers.last_op);
+    EXPECT_EQ(0, flowControl.getFreedBytes());
+    consumer->setReserved(false);
+}
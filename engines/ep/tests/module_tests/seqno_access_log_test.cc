@@ -0,0 +1,159 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "seqno_access_log.h"
+
+#include <folly/portability/GTest.h>
+#include <platform/dirutils.h>
+
+#include <fstream>
+#include <numeric>
+
+class SeqnoAccessLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = cb::io::mktemp("seqno_alog_test");
+    }
+
+    void TearDown() override {
+        cb::io::rmrf(path);
+    }
+
+    /// Write a log of vb:0 with the given seqnos and vb:1 with 1..10
+    void writeLog(std::vector<uint64_t> seqnos, size_t blockSize = 4096) {
+        SeqnoAccessLog::Writer writer(path, blockSize);
+        ASSERT_TRUE(writer.isOpen());
+        writer.write(Vbid(0), seqnos);
+        std::vector<uint64_t> vb1(10);
+        std::iota(vb1.begin(), vb1.end(), 1);
+        writer.write(Vbid(1), vb1);
+        ASSERT_TRUE(writer.close());
+    }
+
+    size_t getFileSize() const {
+        return std::ifstream(path, std::ios::binary | std::ios::ate).tellg();
+    }
+
+    std::string path;
+};
+
+// Seqnos are read back sorted and de-duplicated, a vBucket at a time.
+TEST_F(SeqnoAccessLogTest, RoundTrip) {
+    writeLog({30, 10, 20, 10, 1ull << 40});
+
+    SeqnoAccessLog::Reader reader(path);
+    Vbid vbid;
+    std::vector<uint64_t> seqnos;
+    ASSERT_TRUE(reader.next(vbid, seqnos));
+    EXPECT_EQ(Vbid(0), vbid);
+    EXPECT_EQ(std::vector<uint64_t>({10, 20, 30, 1ull << 40}), seqnos);
+    ASSERT_TRUE(reader.next(vbid, seqnos));
+    EXPECT_EQ(Vbid(1), vbid);
+    EXPECT_EQ(10, seqnos.size());
+    EXPECT_FALSE(reader.next(vbid, seqnos));
+    EXPECT_FALSE(reader.next(vbid, seqnos));
+}
+
+// A vBucket whose seqnos don't fit in one block is split across several.
+TEST_F(SeqnoAccessLogTest, MultipleBlocks) {
+    std::vector<uint64_t> expected;
+    for (uint64_t seqno = 1; seqno < 100000; seqno += 7) {
+        expected.push_back(seqno);
+    }
+    writeLog(expected, 64);
+
+    SeqnoAccessLog::Reader reader(path);
+    Vbid vbid;
+    std::vector<uint64_t> seqnos;
+    ASSERT_TRUE(reader.next(vbid, seqnos));
+    EXPECT_EQ(expected, seqnos);
+    // Sequential seqnos compress to much less than 8 bytes each.
+    EXPECT_LT(getFileSize(), expected.size() * 2);
+}
+
+TEST_F(SeqnoAccessLogTest, Truncated) {
+    writeLog({1, 2, 3});
+    const auto size = getFileSize();
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(in)),
+                            std::istreambuf_iterator<char>());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(content.data(), size - 1);
+    }
+
+    SeqnoAccessLog::Reader reader(path);
+    Vbid vbid;
+    std::vector<uint64_t> seqnos;
+    ASSERT_TRUE(reader.next(vbid, seqnos));
+    ASSERT_TRUE(reader.next(vbid, seqnos));
+    EXPECT_THROW(reader.next(vbid, seqnos), SeqnoAccessLog::ReadException);
+}
+
+TEST_F(SeqnoAccessLogTest, Corrupt) {
+    writeLog({1, 2, 3});
+    {
+        // Flip a bit of vb:0's compressed block (after the 8 byte header,
+        // the vBucket header and the block header).
+        std::fstream file(path,
+                          std::ios::binary | std::ios::in | std::ios::out);
+        file.seekg(8 + 6 + 12);
+        char c;
+        file.get(c);
+        file.seekp(8 + 6 + 12);
+        file.put(c ^ 1);
+    }
+
+    SeqnoAccessLog::Reader reader(path);
+    Vbid vbid;
+    std::vector<uint64_t> seqnos;
+    EXPECT_THROW(reader.next(vbid, seqnos), SeqnoAccessLog::ReadException);
+}
+
+// A block length larger than what is left of the file is rejected before
+// trying to allocate a buffer for it.
+TEST_F(SeqnoAccessLogTest, BlockLengthTooLarge) {
+    writeLog({1, 2, 3});
+    const auto size = getFileSize();
+    // vb:0's block length follows the 8 byte header, the vBucket header and
+    // the block's item count; the block data follows the length and CRC.
+    const size_t offset = 8 + 6 + 4;
+    const size_t remaining = size - (offset + 8);
+    for (const uint32_t length :
+         {uint32_t(remaining + 1), uint32_t(0xffffffff)}) {
+        {
+            std::fstream file(path,
+                              std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(offset);
+            file.write(reinterpret_cast<const char*>(&length),
+                       sizeof(length));
+        }
+        SeqnoAccessLog::Reader reader(path);
+        Vbid vbid;
+        std::vector<uint64_t> seqnos;
+        EXPECT_THROW(reader.next(vbid, seqnos), SeqnoAccessLog::ReadException)
+                << "For length:" << length;
+    }
+}
+
+TEST_F(SeqnoAccessLogTest, NotASeqnoLog) {
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "not a seqno access log";
+    }
+    EXPECT_THROW(SeqnoAccessLog::Reader{path}, SeqnoAccessLog::ReadException);
+}
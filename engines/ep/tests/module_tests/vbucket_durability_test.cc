@@ -1000,6 +1000,57 @@ TEST_P(VBucketDurabilityTest, Active_AbortSyncWrite) {
     EXPECT_EQ(1, monitor.getNumTracked());
 }
 
+// Check that completing a batch of resolved SyncWrites commits / aborts each
+// one (in the given order) and notifies every client cookie once.
+TEST_P(VBucketDurabilityTest, Active_CompleteSyncWritesBatch) {
+    storeSyncWrites({1, 2, 3});
+    ckptMgr->clear(*vbucket, ckptMgr->getHighSeqno());
+
+    const auto key1 = makeStoredDocKey("key1");
+    const auto key2 = makeStoredDocKey("key2");
+    const auto key3 = makeStoredDocKey("key3");
+
+    using Resolution = VBucket::SyncWriteCompletion::Resolution;
+    std::vector<VBucket::SyncWriteCompletion> batch;
+    batch.emplace_back(key1, 1, Resolution::Commit, cookie);
+    batch.emplace_back(key2, 2, Resolution::Abort, cookie);
+    batch.emplace_back(key3, 3, Resolution::Commit, cookie);
+    vbucket->completeSyncWrites(batch);
+
+    for (const auto& completion : batch) {
+        EXPECT_EQ(ENGINE_SUCCESS, completion.status);
+    }
+
+    // Each cookie notified once; the last with the outcome of key3's commit.
+    EXPECT_EQ(SWCompleteTrace(3 /*count*/, cookie, ENGINE_SUCCESS),
+              swCompleteTrace);
+
+    for (const auto& key : {key1, key3}) {
+        const auto sv = ht->findForRead(key).storedValue;
+        ASSERT_TRUE(sv);
+        EXPECT_EQ(CommittedState::CommittedViaPrepare, sv->getCommitted());
+    }
+    EXPECT_FALSE(ht->findForRead(key2).storedValue);
+
+    // Completions queued in batch order, with contiguous seqnos.
+    const auto& ckptList =
+            CheckpointManagerTestIntrospector::public_getCheckpointList(
+                    *ckptMgr);
+    ASSERT_EQ(1, ckptList.size());
+    std::vector<std::pair<queue_op, int64_t>> queued;
+    for (const auto& qi : *ckptList.front()) {
+        if (!qi->isCheckPointMetaItem()) {
+            queued.emplace_back(qi->getOperation(), qi->getPrepareSeqno());
+        }
+    }
+    const std::vector<std::pair<queue_op, int64_t>> expected{
+            {queue_op::commit_sync_write, 1},
+            {queue_op::abort_sync_write, 2},
+            {queue_op::commit_sync_write, 3}};
+    EXPECT_EQ(expected, queued);
+    EXPECT_EQ(6, ckptMgr->getHighSeqno());
+}
+
 /*
  * Base multi-frontend-thread test for durable writes.
  * The test spawns 2 threads doing set-durable on a number of writes.
@@ -0,0 +1,122 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include <memcached/isotime.h>
+
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+class AuditImpl;
+
+namespace cb::audit {
+
+/**
+ * The identity of a user in an audit event (and which events are filtered
+ * on); the domain (or source) the user is defined in and the user name
+ */
+struct Userid {
+    std::string_view domain;
+    std::string_view user;
+};
+
+/**
+ * The EventBuilder renders an audit event directly as the line of JSON
+ * written to the audit trail, rather than building a JSON object which is
+ * then dumped to text (and parsed and dumped again by the audit daemon).
+ *
+ * An event is started with Audit::begin_event() (which decides if the event
+ * should be audited at all), the event specific fields are added and it is
+ * completed by Audit::put_event(). The builder keeps its buffer (and the
+ * state of the audit daemon) between events so each thread should keep
+ * one around.
+ */
+class EventBuilder {
+public:
+    EventBuilder();
+
+    void add(std::string_view key, std::string_view value);
+    void add(std::string_view key, const char* value) {
+        add(key, std::string_view{value});
+    }
+    void add(std::string_view key, const std::string& value) {
+        add(key, std::string_view{value});
+    }
+    void add(std::string_view key, bool value);
+    void add(std::string_view key, const Userid& userid);
+
+    template <typename T,
+              typename = std::enable_if_t<std::is_integral_v<T> &&
+                                          !std::is_same_v<T, bool>>>
+    void add(std::string_view key, T value) {
+        if constexpr (std::is_signed_v<T>) {
+            addNumber(key, int64_t(value));
+        } else {
+            addNumber(key, uint64_t(value));
+        }
+    }
+
+    /// Add the current time as the "timestamp" of the event
+    void addTimestamp();
+
+    /// Get the JSON rendered so far
+    std::string_view getPayload() const {
+        return buffer;
+    }
+
+protected:
+    friend class ::AuditImpl;
+
+    /// Start a new event
+    void reset(uint32_t event_id,
+               std::string_view event_name,
+               std::string_view event_description);
+
+    /// Complete the event with the fields from its descriptor
+    void finish();
+
+    void addKey(std::string_view key);
+    void addNumber(std::string_view key, int64_t value);
+    void addNumber(std::string_view key, uint64_t value);
+
+    /// Add the value as a JSON string (escaping it as needed)
+    void addString(std::string_view value);
+
+    std::string buffer;
+
+    /// The event being built, and the name and description from its
+    /// descriptor
+    uint32_t id = 0;
+    std::string_view name;
+    std::string_view description;
+
+    /// The audit daemon's state used for the last event (which owns the
+    /// descriptors), and the generation of the state
+    std::shared_ptr<const void> state;
+    uint64_t generation = 0;
+
+    /// The last timestamp generated, and the second it is for
+    ISOTime::ISO8601String timestamp;
+    int timestampLength = 0;
+    time_t timestampSecond = 0;
+};
+
+} // namespace cb::audit
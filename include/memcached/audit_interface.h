@@ -16,8 +16,10 @@
  */
 #pragma once
 
+#include <memcached/audit_event_builder.h>
 #include <memcached/engine.h>
 #include <memory>
+#include <optional>
 
 namespace cb {
 namespace audit {
@@ -84,6 +86,35 @@ public:
      */
     virtual bool put_event(uint32_t eventid, std::string_view payload) = 0;
 
+    /**
+     * Start building an audit event in the builder, unless the event
+     * shouldn't be added to the audit trail (it is disabled, or filtered
+     * out for the users) in which case there is no need to build it.
+     *
+     * @param event the builder to use
+     * @param eventid The identifier for the event to build
+     * @param real_userid the user the event is for
+     * @param effective_userid the user the real user is acting as (if any)
+     * @return true if the event should be built and passed to put_event()
+     */
+    virtual bool begin_event(EventBuilder& event,
+                             uint32_t eventid,
+                             const Userid& real_userid,
+                             const std::optional<Userid>& effective_userid) = 0;
+
+    /**
+     * Complete the event built since begin_event() and put it into the
+     * audit trail. The event is written as is (it isn't parsed by the
+     * audit daemon)
+     *
+     * @param event the builder containing the event
+     * @return true if the event was successfully added to the audit
+     *              queue (may be dropped at a later time)
+     *         false if an error occurred while trying to insert the
+     *               event to the audit queue.
+     */
+    virtual bool put_event(EventBuilder& event) = 0;
+
     /**
      * Update the audit daemon with the specified configuration file
      *
@@ -25,6 +25,7 @@
 #include <memcached/dockey.h>
 #include <memcached/rbac/privileges.h>
 #include <nlohmann/json_fwd.hpp>
+#include <array>
 #include <bitset>
 #include <chrono>
 #include <cstdint>
@@ -299,7 +300,9 @@ public:
                      const PrivilegeMask& m,
                      std::shared_ptr<const Bucket> bucket)
         : generation(gen), domain(domain), mask(m), bucket(std::move(bucket)) {
-        // empty
+        if (hasScopePrivileges()) {
+            collectionCache = std::make_shared<CollectionCache>();
+        }
     }
 
     /**
@@ -360,9 +363,69 @@ public:
         return bucket && bucket->hasScopePrivileges();
     }
 
+    /**
+     * Is this context identical to the other (so that it would give the
+     * same result for all checks)?
+     */
+    bool isSameContext(const PrivilegeContext& other) const {
+        return generation == other.generation && domain == other.domain &&
+               mask == other.mask && bucket == other.bucket &&
+               collectionCache == other.collectionCache &&
+               droppedPrivileges == other.droppedPrivileges;
+    }
+
 protected:
     void setBucketPrivilegeBits(bool value);
 
+    /**
+     * A cache of the result of checking privileges for the scopes and
+     * collections of the bucket, so once warmed up a check for a
+     * collection is a single probe rather than the lookup of the scope
+     * and collection in the Bucket.
+     *
+     * The results only depend on the (immutable) Bucket, so the cache is
+     * valid for as long as the context; a new context (for a new
+     * generation of the privilege database, or another bucket) gets a
+     * new cache. The context is created for a connection and copied to
+     * each of its cookies (which share the cache), so the cache is only
+     * used by the thread serving the connection and isn't thread safe.
+     */
+    class CollectionCache {
+    public:
+        /**
+         * Check the privilege, using the cached result or checking it
+         * with the bucket (and caching the result)
+         */
+        PrivilegeAccess check(const Bucket& bucket,
+                              Privilege privilege,
+                              uint32_t sid,
+                              std::optional<uint32_t> cid);
+
+    protected:
+        struct Entry {
+            /// The scope and collection the entry is for; the collection is
+            /// NoCollection for checks against the scope
+            uint32_t sid = 0;
+            uint64_t cid = NoCollection;
+            /// The privileges which have been checked, and of those the
+            /// ones granted or failing with FailNoPrivileges
+            PrivilegeMask known;
+            PrivilegeMask granted;
+            PrivilegeMask noPrivileges;
+        };
+
+        /// Used as the collection of the checks against the scope (as all
+        /// uint32_t values are valid collection ids)
+        static constexpr uint64_t NoCollection =
+                std::numeric_limits<uint64_t>::max();
+
+        /// The number of entries; a power of two. The entries are direct
+        /// mapped, so an entry is simply replaced by the last (scope,
+        /// collection) which hashed to it.
+        static constexpr size_t Size = 32;
+        std::array<Entry, Size> entries;
+    };
+
     /// The Database version this mask belongs to
     uint32_t generation;
     /// The Domain the mask belongs to
@@ -375,6 +438,9 @@ protected:
 
     /// The list of dropped privileges
     std::vector<Privilege> droppedPrivileges;
+
+    /// [contexts with scope privileges only] The cache of collection checks
+    std::shared_ptr<CollectionCache> collectionCache;
 };
 
 /**
@@ -18,8 +18,12 @@
 
 #include <folly/Synchronized.h>
 #include <memcached/visibility.h>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace cb::tracing {
@@ -48,6 +52,10 @@ enum class Code : uint8_t {
     SyncWriteAckLocal,
     /// Time when a SyncWrite replica ACK is received by the Active.
     SyncWriteAckRemote,
+    /// Time spent validating a document is JSON (to determine its datatype)
+    JsonValidate,
+    /// Time a mutation was delayed by the bucket's mutation throttle
+    Throttled,
 };
 
 using SpanId = std::size_t;
@@ -58,22 +66,40 @@ public:
     /// gives maximum duration of 35.79minutes.
     using Duration = std::chrono::duration<int32_t, std::micro>;
 
+    Span() = default;
     Span(Code code,
          std::chrono::steady_clock::time_point start,
          Duration duration = Duration::max())
         : start(start), duration(duration), code(code) {
     }
     std::chrono::steady_clock::time_point start;
-    Duration duration;
-    Code code;
+    Duration duration = Duration::max();
+    Code code = Code::Request;
 };
 
 /**
  * Tracer maintains an ordered vector of tracepoints
  * with name:time(micros)
+ *
+ * A cookie's spans are almost always recorded by the front-end thread
+ * serving it (the "owner" of the tracer, which is the thread which last
+ * called clear()), so those are recorded in a fixed size array without any
+ * locking. Spans begun or ended by other threads (background fetches,
+ * SyncWrite acks etc.), and any spans which don't fit in the array, are
+ * recorded under a mutex and merged in when the spans are read.
+ *
+ * The other threads may only use the tracer while the cookie is blocked
+ * waiting for them (so the owner isn't using it), and the spans may only be
+ * read by the owner.
  */
 class MEMCACHED_PUBLIC_CLASS Tracer {
 public:
+    /// The number of spans recorded without locking
+    static constexpr size_t InlineSpans = 16;
+
+    Tracer() : owner(std::this_thread::get_id()) {
+    }
+
     /// Begin a Span starting from the specified time point (defaults to now)
     SpanId begin(Code tracecode,
                  std::chrono::steady_clock::time_point startTime =
@@ -87,6 +113,9 @@ public:
     // Extract the trace vector (and clears the internal trace vector)
     std::vector<Span> extractDurations();
 
+    /// Get all of the spans (in the order they were begun)
+    std::vector<Span> getSpans() const;
+
     Span::Duration getTotalMicros() const;
 
     uint16_t getEncodedMicros() const;
@@ -97,14 +126,36 @@ public:
 
     static std::chrono::microseconds decodeMicros(uint16_t encoded);
 
-    // clear the collected trace data;
+    // clear the collected trace data, and make the calling thread the owner
     void clear();
 
     /// Get a string representation of all of the spans
     std::string to_string() const;
 
 protected:
-    folly::Synchronized<std::vector<Span>, std::mutex> vecSpans;
+    bool isOwner() const {
+        return owner.load(std::memory_order_relaxed) ==
+               std::this_thread::get_id();
+    }
+
+    /// The spans recorded by the owner; only accessed by the owner (other
+    /// threads may read the number in use)
+    std::array<Span, InlineSpans> spans;
+    std::atomic<size_t> numSpans{0};
+
+    std::atomic<std::thread::id> owner;
+
+    struct Shared {
+        /// The spans begun by other threads (or which didn't fit in the
+        /// array), their ids follow the inline spans
+        std::vector<Span> spans;
+        /// The end times of inline spans ended by other threads
+        std::vector<std::pair<SpanId, std::chrono::steady_clock::time_point>>
+                ends;
+    };
+    folly::Synchronized<Shared, std::mutex> shared;
+    /// Set when anything is recorded in shared
+    std::atomic<bool> hasShared{false};
 };
 
 class MEMCACHED_PUBLIC_CLASS Traceable {
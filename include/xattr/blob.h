@@ -21,6 +21,7 @@
 #include <xattr/utils.h>
 #include <cstddef>
 #include <memory>
+#include <vector>
 
 namespace cb {
 namespace xattr {
@@ -28,6 +29,12 @@ namespace xattr {
 /**
  * The cb::xattr::Blob is a class that provides easy access to the
  * binary format of the blob.
+ *
+ * Once the blob has been scanned a few times it is indexed (the offset
+ * of each kv-pair plus a small hash table of the keys), and the index is
+ * kept up to date by the modifications, so a request operating on many
+ * xattrs doesn't walk the blob for each of them. As the index is built
+ * lazily by const methods a Blob must not be shared between threads.
  */
 class Blob {
 public:
@@ -267,9 +274,77 @@ protected:
      */
     void remove_segment(const size_t offset, const size_t size);
 
+    /// An indexed kv-pair
+    struct Entry {
+        /// Offset of the kv-pair (its length word) in the blob
+        uint32_t offset;
+        uint32_t keySize;
+        uint32_t valueSize;
+        uint32_t hash;
+        bool system;
+    };
+
+    /// Get the number of bytes used by the kv-pair (including its length)
+    static size_t pair_size(const Entry& entry) {
+        return 4 + entry.keySize + 1 + entry.valueSize + 1;
+    }
+
+    std::string_view key_of(const Entry& entry) const {
+        return {blob.data() + entry.offset + 4, entry.keySize};
+    }
+
+    /**
+     * Account for a scan of the blob (while it isn't indexed)
+     *
+     * @param pairs the number of kv-pairs the scan stepped over
+     * @return true if the blob has been scanned enough to index it
+     */
+    bool should_index(size_t pairs) const;
+
+    /// Index all of the kv-pairs in the blob
+    void build_index() const;
+
+    /// Insert the given entry into the hash table (unless its key is
+    /// already present; as with a scan the first pair for a key wins)
+    void insert_into_table(uint32_t index) const;
+
+    /// (Re)size the hash table for the current entries and fill it
+    void rebuild_table() const;
+
+    /**
+     * Locate the kv-pair for the key, using the index if the blob has been
+     * indexed and scanning it otherwise.
+     *
+     * @param key the key to look up
+     * @param [out] index the index of the entry (if the blob is indexed)
+     * @param [out] entry the location of the kv-pair
+     * @return true if the key was found
+     */
+    bool find_entry(std::string_view key, size_t& index, Entry& entry) const;
+
+    /**
+     * Remove the entry from the index after its kv-pair has been removed
+     * from the blob, moving the following entries down.
+     */
+    void erase_entry(size_t index);
+
 private:
     cb::char_buffer blob;
 
+    /// The kv-pairs in the blob, in the order they appear
+    mutable std::vector<Entry> entries;
+    /// Open addressing hash table of the keys; holds the index of the entry
+    /// plus one, or zero for an empty slot. The size is a power of two.
+    mutable std::vector<uint32_t> table;
+    /// The total size of the system kv-pairs (including their length words)
+    mutable size_t systemPairsSize = 0;
+    /// The number of kv-pairs scanned while the blob isn't indexed, and the
+    /// most stepped over by a single scan
+    mutable size_t scannedPairs = 0;
+    mutable size_t largestScan = 0;
+    /// Has the blob been indexed? (if not entries and table are unused)
+    mutable bool indexed = false;
+
     /// When the incoming data is compressed will auto-decompress into this
     cb::compression::Buffer decompressed;
 
@@ -464,12 +464,58 @@ PrivilegeAccess PrivilegeContext::check(Privilege privilege,
     }
 
     if (bucket && is_bucket_privilege(privilege)) {
+        if (collectionCache && sid) {
+            std::optional<uint32_t> collection;
+            if (cid) {
+                collection = uint32_t(*cid);
+            }
+            return collectionCache->check(
+                    *bucket, privilege, uint32_t(*sid), collection);
+        }
         return bucket->check(privilege, sid, cid);
     }
 
     return PrivilegeAccessFail;
 }
 
+PrivilegeAccess PrivilegeContext::CollectionCache::check(
+        const Bucket& bucket,
+        Privilege privilege,
+        uint32_t sid,
+        std::optional<uint32_t> cid) {
+    const uint64_t collection = cid ? *cid : NoCollection;
+    // Collection ids are allocated sequentially (as are scope ids), so mix
+    // them to spread the entries of the collections of a scope
+    const auto hash = (uint64_t(sid) * 0x9e3779b97f4a7c15ULL) ^ collection;
+    auto& entry = entries[(hash ^ (hash >> 32)) & (Size - 1)];
+    if (entry.sid != sid || entry.cid != collection) {
+        entry = Entry{sid, collection, {}, {}, {}};
+    }
+
+    const auto idx = size_t(privilege);
+    if (entry.known.test(idx)) {
+        if (entry.granted.test(idx)) {
+            return PrivilegeAccessOk;
+        }
+        return entry.noPrivileges.test(idx) ? PrivilegeAccessFailNoPrivileges
+                                            : PrivilegeAccessFail;
+    }
+
+    const auto status = bucket.check(privilege, sid, cid);
+    entry.known.set(idx);
+    switch (status.getStatus()) {
+    case PrivilegeAccess::Status::Ok:
+        entry.granted.set(idx);
+        break;
+    case PrivilegeAccess::Status::Fail:
+        break;
+    case PrivilegeAccess::Status::FailNoPrivileges:
+        entry.noPrivileges.set(idx);
+        break;
+    }
+    return status;
+}
+
 std::string PrivilegeContext::to_string() const {
     if (mask.all()) {
         return "[all]";
@@ -18,6 +18,7 @@
 #include <folly/portability/GTest.h>
 #include <memcached/rbac.h>
 #include <nlohmann/json.hpp>
+#include <sstream>
 
 namespace cb::rbac {
 class MockCollection : public Collection {
@@ -393,4 +394,87 @@ TEST_F(CollectionPrivVisibility, can_read_0x32_only) {
     EXPECT_EQ(cb::rbac::PrivilegeAccess::Status::Fail, status.getStatus());
 }
 
+class PrivilegeContextCollectionCache : public ::testing::Test {
+public:
+    // The user has Read for scope 0x32, and Read and Upsert for the even
+    // collections in scope 0x33
+    void SetUp() override {
+        nlohmann::json collections;
+        for (int cid = 8; cid < 136; cid += 2) {
+            std::stringstream key;
+            key << std::hex << cid;
+            collections[key.str()] = {{"privileges", {"Read", "Upsert"}}};
+        }
+        nlohmann::json access = {
+                {"privileges", {"Audit"}},
+                {"scopes",
+                 {{"0x32", {{"privileges", {"Read"}}}},
+                  {"0x33", {{"collections", collections}}}}}};
+        bucket = std::make_shared<Bucket>(access);
+        context = std::make_unique<PrivilegeContext>(
+                1, Domain::Local, PrivilegeMask{}, bucket);
+    }
+
+    /// Check the context gives the same result as the bucket for all of
+    /// the scopes / collections (and scopes only)
+    void expectSameAsBucket(const PrivilegeContext& ctx) {
+        for (const auto privilege :
+             {Privilege::Read, Privilege::Upsert, Privilege::Delete}) {
+            for (uint32_t sid : {0x31, 0x32, 0x33}) {
+                auto expected = bucket->check(privilege, sid, {});
+                EXPECT_EQ(expected.getStatus(),
+                          ctx.check(privilege, sid, {}).getStatus());
+                for (uint32_t cid = 8; cid < 138; ++cid) {
+                    expected = bucket->check(privilege, sid, cid);
+                    EXPECT_EQ(expected.getStatus(),
+                              ctx.check(privilege, sid, cid).getStatus())
+                            << sid << ":" << cid;
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<const Bucket> bucket;
+    std::unique_ptr<PrivilegeContext> context;
+};
+
+TEST_F(PrivilegeContextCollectionCache, SameAsBucket) {
+    ASSERT_TRUE(context->hasScopePrivileges());
+    // Repeat the checks so they're answered from the cache (including the
+    // entries replaced by colliding collections)
+    for (int ii = 0; ii < 3; ++ii) {
+        expectSameAsBucket(*context);
+    }
+}
+
+TEST_F(PrivilegeContextCollectionCache, Copies) {
+    // Copies of the context (as held by the cookies) share the cache
+    auto copy = *context;
+    EXPECT_TRUE(copy.isSameContext(*context));
+    expectSameAsBucket(*context);
+    expectSameAsBucket(copy);
+
+    // but a new context for the same bucket doesn't
+    const PrivilegeContext other(1, Domain::Local, PrivilegeMask{}, bucket);
+    EXPECT_FALSE(other.isSameContext(*context));
+    expectSameAsBucket(other);
+}
+
+TEST_F(PrivilegeContextCollectionCache, DropPrivilege) {
+    EXPECT_TRUE(context->check(Privilege::Read, 0x33, 8).success());
+    EXPECT_TRUE(context->check(Privilege::Read, 0x32, {}).success());
+
+    auto copy = *context;
+    context->dropPrivilege(Privilege::Read);
+    EXPECT_FALSE(copy.isSameContext(*context));
+    EXPECT_EQ(PrivilegeAccess::Status::Fail,
+              context->check(Privilege::Read, 0x33, 8).getStatus());
+    EXPECT_EQ(PrivilegeAccess::Status::Fail,
+              context->check(Privilege::Read, 0x32, {}).getStatus());
+    EXPECT_TRUE(context->check(Privilege::Upsert, 0x33, 8).success());
+
+    // The copy isn't affected
+    EXPECT_TRUE(copy.check(Privilege::Read, 0x33, 8).success());
+}
+
 } // namespace cb::rbac
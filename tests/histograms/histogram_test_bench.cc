@@ -21,10 +21,12 @@
 
 #include <benchmark/benchmark.h>
 #include <daemon/timing_histogram.h>
+#include <daemon/timings.h>
 #include <folly/portability/GTest.h>
 #include <nlohmann/json.hpp>
 #include <utilities/hdrhistogram.h>
 #include <random>
+#include <vector>
 
 #define LOG_NORMAL_MEAN 0
 #define LOG_NORMAL_STD 2.0
@@ -73,40 +75,41 @@ T LinearFillHistogram(benchmark::State& state) {
     return testHisto;
 }
 
+// static function to return the given number of log normal values scaled
+// by LOG_NORMAL_SCALE_UP_MULT, generated using std::lognormal_distribution.
+static std::vector<uint64_t> GetLogNormalValues(size_t count) {
+    // create a log normal distribution and random number generator
+    // so we can add random values in a log normal distribution which is a
+    // better representation of a production environment
+    std::random_device randomDevice;
+    std::mt19937 randomNumGen(randomDevice());
+    std::lognormal_distribution<long double> distribution(LOG_NORMAL_MEAN,
+                                                          LOG_NORMAL_STD);
+    // We have denormalize the log normal distribution with a min
+    // changing from 0 to 50000ns the max should remain at inf and set
+    // the mean to about 84000ns.
+    // Percentile values will vary as we use a random number generator to
+    // seed a X value when getting values from the distribution. However,
+    // the values below should give an idea of the distribution which
+    // modelled around an "ADD" op from stats.log p50:~84000ns |
+    // p90:~489000ns |p99:3424000ns |p99.9:20185000ns | p99.99:41418000ns
+    std::vector<uint64_t> values(count);
+    for (auto& currentVal : values) {
+        currentVal = static_cast<uint64_t>(
+                LOG_NORMAL_MIN + std::round(distribution(randomNumGen) *
+                                            LOG_NORMAL_SCALE_UP_MULT));
+    }
+    return values;
+}
+
 // static function to return a log normal value scaled by
-// LOG_NORMAL_SCALE_UP_MULT. It creates an array of 10000 static values that
-// using std::lognormal_distribution and returners them in an incrementing
-// linear fashion so that they can be used in the Add benchmarks.
+// LOG_NORMAL_SCALE_UP_MULT. It creates an array of 10000 static values
+// (see GetLogNormalValues) and returns them in an incrementing linear
+// fashion so that they can be used in the Add benchmarks. Not thread safe.
 static uint64_t GetNextLogNormalValue() {
-    static bool initialised = false;
-    static std::vector<uint64_t> valuesToAdd(10000);
+    static std::vector<uint64_t> valuesToAdd = GetLogNormalValues(10000);
     static unsigned int i = 0;
 
-    if (!initialised) {
-        // create a log normal distribution and random number generator
-        // so we can add random values in a log normal distribution which is a
-        // better representation of a production environment
-        std::random_device randomDevice;
-        std::mt19937 randomNumGen(randomDevice());
-        std::lognormal_distribution<long double> distribution(LOG_NORMAL_MEAN,
-                                                              LOG_NORMAL_STD);
-        // We have denormalize the log normal distribution with a min
-        // changing from 0 to 50000ns the max should remain at inf and set
-        // the mean to about 84000ns.
-        // Percentile values will vary as we use a random number generator to
-        // seed a X value when getting values from the distribution. However,
-        // the values below should give an idea of the distribution which
-        // modelled around an "ADD" op from stats.log p50:~84000ns |
-        // p90:~489000ns |p99:3424000ns |p99.9:20185000ns | p99.99:41418000ns
-        for (auto& currentVal : valuesToAdd) {
-            auto valToAdd = static_cast<uint64_t>(
-                    LOG_NORMAL_MIN + std::round(distribution(randomNumGen) *
-                                                LOG_NORMAL_SCALE_UP_MULT));
-            currentVal = valToAdd;
-        }
-        initialised = true;
-    }
-
     if (i >= valuesToAdd.size()) {
         i = 0;
     }
@@ -203,6 +206,48 @@ void HistogramToJson(benchmark::State& state) {
     }
 }
 
+/**
+ * Benchmark the cost of recording a command timing when all of the threads
+ * are recording the same opcode into the same (bucket) Timings instance,
+ * which is what the front-end threads do for a busy bucket.
+ */
+void TimingsCollect(benchmark::State& state) {
+    static Timings timings;
+    // Each thread has its own values so that generating them isn't part of
+    // what is measured. The threads only start recording once all of them
+    // have entered the timed loop, so the reset can't race with them.
+    const auto values = GetLogNormalValues(10000);
+    if (state.thread_index == 0) {
+        timings.reset();
+    }
+
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        timings.collect(cb::mcbp::ClientOpcode::Get,
+                        std::chrono::nanoseconds(values[i]));
+        if (++i == values.size()) {
+            i = 0;
+        }
+    }
+}
+
+/**
+ * Benchmark the cost of merging the per-core histograms of an opcode,
+ * which is paid by mctimings / "stats timings" instead of by every command.
+ */
+void TimingsGenerate(benchmark::State& state) {
+    Timings timings;
+    for (int i = 0; i < state.range(0); i++) {
+        timings.collect(cb::mcbp::ClientOpcode::Get,
+                        std::chrono::nanoseconds(GetNextLogNormalValue()));
+    }
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+                timings.generate(cb::mcbp::ClientOpcode::Get));
+    }
+}
+
 BENCHMARK_TEMPLATE(HistogramConstructionDestructionHeap, TimingHistogram);
 BENCHMARK_TEMPLATE(HistogramConstructionDestructionHeap, HdrHistogramBench);
 BENCHMARK_TEMPLATE(HistogramConstructionDestructionHeap, HdrHistogramEmpty);
@@ -239,4 +284,9 @@ BENCHMARK_TEMPLATE(HistogramReset, HdrHistogramEmpty);
 BENCHMARK_TEMPLATE(HistogramAggregation, TimingHistogram)->Arg(100);
 BENCHMARK_TEMPLATE(HistogramAggregation, HdrHistogramBench)->Arg(100);
 
+BENCHMARK(TimingsCollect)->Threads(1)->UseRealTime();
+BENCHMARK(TimingsCollect)->Threads(8)->UseRealTime();
+BENCHMARK(TimingsCollect)->Threads(32)->UseRealTime();
+BENCHMARK(TimingsGenerate)->Arg(10000);
+
 BENCHMARK_MAIN()
\ No newline at end of file
@@ -0,0 +1,61 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <string>
+
+/**
+ * Build a document of (roughly) the requested size from typical application
+ * records: short and long string fields, numbers, booleans, nulls, arrays
+ * and nested objects.
+ *
+ * @param size the minimum size of the document in bytes
+ * @param pretty pretty-print (indent) the document rather than compacting it
+ * @param ascii only use ASCII text, rather than mixing in multi-byte UTF-8
+ */
+inline std::string makeJsonDocument(size_t size, bool pretty, bool ascii) {
+    const std::string name = ascii ? "Jose Munoz" : "José Muñoz 山田";
+    const std::string text = ascii ? "Lorem ipsum dolor sit amet, consectetur "
+                                     "adipiscing elit, sed do eiusmod tempor "
+                                     "incididunt ut labore et dolore."
+                                   : "Größe, café, naïve: Ünïcödé tëxt with "
+                                     "日本語 and emoji 😀 mixed into the "
+                                     "otherwise ASCII description.";
+
+    nlohmann::json records = nlohmann::json::array();
+    std::string doc;
+    for (int ii = 0; doc.size() < size; ++ii) {
+        records.push_back({{"id", ii},
+                           {"name", name},
+                           {"email", "user" + std::to_string(ii) +
+                                             "@example.com"},
+                           {"active", ii % 2 == 0},
+                           {"balance", ii * 12.75 - 300.5},
+                           {"manager", nullptr},
+                           {"tags", {"alpha", "beta", "gamma\t\"quoted\""}},
+                           {"address",
+                            {{"street", std::to_string(ii) + " High Street"},
+                             {"city", "Manchester"},
+                             {"geo", {{"lat", 53.4808}, {"lon", -2.2426}}}}},
+                           {"description", text}});
+        doc = nlohmann::json{{"records", records}}.dump(pretty ? 4 : -1);
+    }
+    return doc;
+}
@@ -0,0 +1,69 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Benchmarks comparing cb::json::Validator with JSON_checker when checking
+ * documents of various sizes and formats, as done for every mutation to
+ * determine its datatype.
+ * Variables:
+ *  - range(0) : The size of the document
+ *  - range(1) : Pretty-printed (1) or compact (0)
+ *  - range(2) : ASCII only (1) or with multi-byte UTF-8 (0)
+ */
+
+#include "json_corpus.h"
+
+#include <JSON_checker.h>
+#include <benchmark/benchmark.h>
+#include <utilities/json_validator.h>
+
+#include <type_traits>
+
+template <typename ValidatorType>
+static void bench_validate(benchmark::State& state) {
+    const auto doc = makeJsonDocument(state.range(0), state.range(1) != 0,
+                                      state.range(2) != 0);
+    const auto* data = reinterpret_cast<const uint8_t*>(doc.data());
+    ValidatorType validator;
+    while (state.KeepRunning()) {
+        if (!validator.validate(data, doc.size())) {
+            state.SkipWithError("Document is not valid JSON");
+            break;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * doc.size());
+    if constexpr (std::is_same_v<ValidatorType, cb::json::Validator>) {
+        state.SetLabel(std::string(ValidatorType::getImplementation()));
+    }
+}
+
+static void documentArguments(benchmark::internal::Benchmark* b) {
+    for (auto size : {1024, 10 * 1024, 100 * 1024}) {
+        for (auto pretty : {0, 1}) {
+            for (auto ascii : {0, 1}) {
+                b->Args({size, pretty, ascii});
+            }
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(bench_validate, JSON_checker::Validator)
+        ->Apply(documentArguments);
+BENCHMARK_TEMPLATE(bench_validate, cb::json::Validator)
+        ->Apply(documentArguments);
+
+BENCHMARK_MAIN();
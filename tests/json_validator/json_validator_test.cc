@@ -0,0 +1,203 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Unit tests for cb::json::Validator, checking that it accepts and rejects
+ * the same documents as JSON_checker.
+ */
+
+#include "json_corpus.h"
+
+#include <JSON_checker.h>
+#include <folly/portability/GTest.h>
+#include <utilities/json_validator.h>
+
+class JsonValidatorTest : public ::testing::Test {
+protected:
+    /// Check both validators agree on the document, and return the verdict
+    bool validate(std::string_view doc) {
+        const auto* data = reinterpret_cast<const uint8_t*>(doc.data());
+        const bool expected = checker.validate(data, doc.size());
+        EXPECT_EQ(expected, validator.validate(doc)) << "document: " << doc;
+        return expected;
+    }
+
+    JSON_checker::Validator checker;
+    cb::json::Validator validator;
+};
+
+TEST_F(JsonValidatorTest, TopLevelValues) {
+    EXPECT_TRUE(validate("{}"));
+    EXPECT_TRUE(validate("[]"));
+    EXPECT_TRUE(validate("\"string\""));
+    EXPECT_TRUE(validate("0"));
+    EXPECT_TRUE(validate("-12.5e+3"));
+    EXPECT_TRUE(validate("true"));
+    EXPECT_TRUE(validate("false"));
+    EXPECT_TRUE(validate("null"));
+    EXPECT_TRUE(validate(" \t\r\n{ \"a\" : [ 1 , 2 ] } \n"));
+
+    EXPECT_FALSE(validate(""));
+    EXPECT_FALSE(validate("   "));
+    EXPECT_FALSE(validate("{} {}"));
+    EXPECT_FALSE(validate("1 2"));
+    EXPECT_FALSE(validate("nul"));
+    EXPECT_FALSE(validate("nulll"));
+    EXPECT_FALSE(validate("True"));
+}
+
+TEST_F(JsonValidatorTest, Structure) {
+    EXPECT_TRUE(validate(R"({"a":{"b":[{},[],{"c":null}]}})"));
+    EXPECT_TRUE(validate(R"([[[[]]],[{}]])"));
+
+    EXPECT_FALSE(validate("{"));
+    EXPECT_FALSE(validate("[1,2"));
+    EXPECT_FALSE(validate("[1,]"));
+    EXPECT_FALSE(validate("[,1]"));
+    EXPECT_FALSE(validate("[1 2]"));
+    EXPECT_FALSE(validate("[1}"));
+    EXPECT_FALSE(validate(R"({"a":1,})"));
+    EXPECT_FALSE(validate(R"({"a"})"));
+    EXPECT_FALSE(validate(R"({"a":})"));
+    EXPECT_FALSE(validate(R"({"a" 1})"));
+    EXPECT_FALSE(validate("{1:2}"));
+    EXPECT_FALSE(validate("{a:2}"));
+}
+
+TEST_F(JsonValidatorTest, Numbers) {
+    for (const auto* number : {"0", "-0", "1", "10", "0.5", "-0.5", "1e5",
+                               "1E5", "1e+5", "1e-5", "0e0", "12.34e-56"}) {
+        EXPECT_TRUE(validate(number)) << number;
+        EXPECT_TRUE(validate(std::string("[") + number + "]")) << number;
+    }
+    for (const auto* number :
+         {"-", "01", "-01", "1.", ".5", "1.e5", "1e", "1e+", "+1", "0x10",
+          "1.5.5", "--1", "NaN", "Infinity"}) {
+        EXPECT_FALSE(validate(number)) << number;
+        EXPECT_FALSE(validate(std::string("[") + number + "]")) << number;
+    }
+}
+
+TEST_F(JsonValidatorTest, Strings) {
+    EXPECT_TRUE(validate(R"("")"));
+    EXPECT_TRUE(validate(R"("\"\\\/\b\f\n\r\t")"));
+    EXPECT_TRUE(validate(R"("\u0000ꯍꯍ")"));
+
+    EXPECT_FALSE(validate(R"(")"));
+    EXPECT_FALSE(validate(R"("abc)"));
+    EXPECT_FALSE(validate(R"("\")"));
+    EXPECT_FALSE(validate(R"("\x")"));
+    EXPECT_FALSE(validate(R"("\u12")"));
+    EXPECT_FALSE(validate(R"("\u12G4")"));
+    EXPECT_FALSE(validate("'single'"));
+    for (int ch = 0; ch < 0x20; ++ch) {
+        EXPECT_FALSE(validate(std::string("\"") + char(ch) + "\"")) << ch;
+    }
+}
+
+TEST_F(JsonValidatorTest, Utf8) {
+    EXPECT_TRUE(validate("\"\xc3\xa9\""));  // U+00E9
+    EXPECT_TRUE(validate("\"\xe6\x97\xa5\"")); // U+65E5
+    EXPECT_TRUE(validate("\"\xef\xbf\xbf\"")); // U+FFFF
+    EXPECT_TRUE(validate("\"\xf0\x9f\x98\x80\"")); // U+1F600
+    EXPECT_TRUE(validate("\"\xf4\x8f\xbf\xbf\"")); // U+10FFFF
+
+    EXPECT_FALSE(validate("\"\x80\"")); // lone continuation byte
+    EXPECT_FALSE(validate("\"\xc3\"")); // truncated sequence
+    EXPECT_FALSE(validate("\"\xe6\x97\"")); // truncated sequence
+    EXPECT_FALSE(validate("\"\xc0\xaf\"")); // overlong '/'
+    EXPECT_FALSE(validate("\"\xe0\x80\xaf\"")); // overlong '/'
+    EXPECT_FALSE(validate("\"\xf5\x80\x80\x80\"")); // beyond U+10FFFF
+    EXPECT_FALSE(validate("\"\xff\""));
+    EXPECT_FALSE(validate("\xc3\xa9")); // outside of a string
+}
+
+// Move a special character through the positions of a long string, to cover
+// both the vectorised scanning and the tail of the string.
+TEST_F(JsonValidatorTest, SpecialCharacterAtEveryOffset) {
+    for (const std::string special :
+         {"\\n", "\\u00e9", "\xc3\xa9", "\x01", "\xc3"}) {
+        for (size_t offset = 0; offset < 100; ++offset) {
+            std::string doc = "\"" + std::string(100, 'x') + "\"";
+            doc.insert(offset + 1, special);
+            validate(doc);
+        }
+    }
+}
+
+TEST_F(JsonValidatorTest, DeepNesting) {
+    const size_t depth = 100000;
+    EXPECT_TRUE(validate(std::string(depth, '[') + std::string(depth, ']')));
+    EXPECT_FALSE(
+            validate(std::string(depth, '[') + std::string(depth - 1, ']')));
+
+    std::string objects;
+    for (size_t ii = 0; ii < depth; ++ii) {
+        objects += R"({"a":)";
+    }
+    objects += "null" + std::string(depth, '}');
+    EXPECT_TRUE(validate(objects));
+}
+
+class JsonValidatorCorpusTest
+    : public JsonValidatorTest,
+      public ::testing::WithParamInterface<std::tuple<bool, bool>> {
+protected:
+    std::string makeDocument(size_t size) {
+        return makeJsonDocument(
+                size, std::get<0>(GetParam()), std::get<1>(GetParam()));
+    }
+};
+
+TEST_P(JsonValidatorCorpusTest, Documents) {
+    for (auto size : {100, 1024, 10 * 1024, 100 * 1024}) {
+        EXPECT_TRUE(validate(makeDocument(size))) << size;
+    }
+}
+
+// Every truncation of a document is compared; all bar the full document
+// are invalid.
+TEST_P(JsonValidatorCorpusTest, Truncated) {
+    const auto doc = makeDocument(1024);
+    for (size_t length = 0; length < doc.size(); ++length) {
+        validate(std::string_view(doc.data(), length));
+    }
+}
+
+// Every byte of a document is replaced by a selection of significant bytes,
+// and the verdicts compared.
+TEST_P(JsonValidatorCorpusTest, Corrupted) {
+    const auto doc = makeDocument(1024);
+    for (size_t ii = 0; ii < doc.size(); ++ii) {
+        for (const char replacement :
+             {'"', '\\', '{', '}', '[', ']', ':', ',', '0', '-', 'e', ' ',
+              '\n', '\x01', '\x7f', '\x80', '\xc3', '\xff'}) {
+            auto corrupted = doc;
+            corrupted[ii] = replacement;
+            validate(corrupted);
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+        PrettyAndAscii,
+        JsonValidatorCorpusTest,
+        ::testing::Combine(::testing::Bool(), ::testing::Bool()),
+        [](const ::testing::TestParamInfo<std::tuple<bool, bool>>& info) {
+            return std::string(std::get<0>(info.param) ? "Pretty" : "Compact") +
+                   (std::get<1>(info.param) ? "Ascii" : "Utf8");
+        });
@@ -0,0 +1,112 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Benchmarks of the cb::xattr::Blob operations performed for a request
+ * against a document with range(0) xattrs (a quarter of which are system
+ * xattrs). Each iteration wraps the encoded xattrs in a new Blob as the
+ * daemon does for every request.
+ */
+
+#include <benchmark/benchmark.h>
+#include <xattr/blob.h>
+
+#include <string>
+#include <vector>
+
+static std::string makeKey(int64_t ii) {
+    return (ii % 4 == 0 ? "_sys" : "user") + std::to_string(ii);
+}
+
+static std::string makeXattrs(int64_t count) {
+    cb::xattr::Blob blob;
+    for (int64_t ii = 0; ii < count; ++ii) {
+        blob.set(makeKey(ii), R"({"field":")" + std::to_string(ii) + R"("})");
+    }
+    return std::string(blob.finalize());
+}
+
+/// Look up every xattr in the document
+static void XattrBlobGetAll(benchmark::State& state) {
+    const auto xattrs = makeXattrs(state.range(0));
+    std::vector<std::string> keys;
+    for (int64_t ii = 0; ii < state.range(0); ++ii) {
+        keys.push_back(makeKey(ii));
+    }
+    for (auto _ : state) {
+        cb::xattr::Blob blob({const_cast<char*>(xattrs.data()), xattrs.size()},
+                             false);
+        for (const auto& key : keys) {
+            benchmark::DoNotOptimize(blob.get(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Look up a single (the last) xattr and the system size, as done by a
+/// subdoc lookup of a single xattr path
+static void XattrBlobGetOne(benchmark::State& state) {
+    const auto xattrs = makeXattrs(state.range(0));
+    const auto key = makeKey(state.range(0) - 1);
+    for (auto _ : state) {
+        cb::xattr::Blob blob({const_cast<char*>(xattrs.data()), xattrs.size()},
+                             false);
+        benchmark::DoNotOptimize(blob.get(key));
+        benchmark::DoNotOptimize(blob.get_system_size());
+    }
+}
+
+/// Replace a couple of xattrs (one changing size), remove one and read the
+/// system size, as done by a subdoc mutation updating the xattrs
+static void XattrBlobUpdate(benchmark::State& state) {
+    const auto xattrs = makeXattrs(state.range(0));
+    const auto first = makeKey(0);
+    const auto last = makeKey(state.range(0) - 1);
+    const auto middle = makeKey(state.range(0) / 2);
+    std::unique_ptr<char[]> allocator;
+    for (auto _ : state) {
+        cb::xattr::Blob blob(
+                {const_cast<char*>(xattrs.data()), xattrs.size()},
+                allocator,
+                false);
+        cb::xattr::Blob copy(blob);
+        copy.set(first, R"({"field":"updated"})");
+        copy.set(last, R"({"field":"x"})");
+        copy.remove(middle);
+        benchmark::DoNotOptimize(copy.get_system_size());
+        benchmark::DoNotOptimize(copy.finalize());
+    }
+}
+
+/// Strip the user xattrs, as done when deleting a document
+static void XattrBlobPruneUserKeys(benchmark::State& state) {
+    const auto xattrs = makeXattrs(state.range(0));
+    for (auto _ : state) {
+        cb::xattr::Blob blob({const_cast<char*>(xattrs.data()), xattrs.size()},
+                             false);
+        cb::xattr::Blob copy(blob);
+        copy.prune_user_keys();
+        benchmark::DoNotOptimize(copy.get_system_size());
+    }
+}
+
+BENCHMARK(XattrBlobGetAll)->RangeMultiplier(2)->Range(1, 64);
+BENCHMARK(XattrBlobGetOne)->RangeMultiplier(2)->Range(1, 64);
+BENCHMARK(XattrBlobUpdate)->RangeMultiplier(2)->Range(1, 64);
+BENCHMARK(XattrBlobPruneUserKeys)->RangeMultiplier(2)->Range(1, 64);
+
+BENCHMARK_MAIN();
@@ -230,3 +230,67 @@ TEST(XattrBlob, iterator_insert) {
         }
     }
 }
+
+// Modify a blob with many keys (so the index has to be resized) and check
+// the lookups and system size match a blob built from scratch.
+TEST(XattrBlob, ManyKeys) {
+    cb::xattr::Blob blob;
+    for (int ii = 0; ii < 64; ++ii) {
+        const auto key = (ii % 4 == 0 ? "_key" : "key") + std::to_string(ii);
+        blob.set(key, std::to_string(ii));
+    }
+    for (int ii = 0; ii < 64; ++ii) {
+        const auto key = (ii % 4 == 0 ? "_key" : "key") + std::to_string(ii);
+        if (ii % 3 == 0) {
+            blob.remove(key);
+        } else if (ii % 3 == 1) {
+            // Grow the value so it is moved to the end
+            blob.set(key, R"({"value":)" + std::to_string(ii) + "}");
+        }
+    }
+    EXPECT_TRUE(cb::xattr::validate(blob.finalize()));
+
+    cb::xattr::Blob expected;
+    for (const auto& [key, value] : blob) {
+        expected.set(key, value);
+    }
+    for (int ii = 0; ii < 64; ++ii) {
+        const auto key = (ii % 4 == 0 ? "_key" : "key") + std::to_string(ii);
+        EXPECT_EQ(to_string(expected.get(key)), to_string(blob.get(key)))
+                << key;
+    }
+    EXPECT_EQ(expected.finalize(), blob.finalize());
+    EXPECT_EQ(expected.get_system_size(), blob.get_system_size());
+
+    // A copy keeps working independently
+    cb::xattr::Blob copy(blob);
+    copy.prune_user_keys();
+    EXPECT_TRUE(cb::xattr::validate(copy.finalize()));
+    EXPECT_EQ(blob.get_system_size(), copy.finalize().size());
+    EXPECT_EQ(copy.finalize().size(), copy.get_system_size());
+    EXPECT_EQ("2", to_string(blob.get("key2")));
+    EXPECT_TRUE(copy.get("key2").empty());
+    EXPECT_EQ("8", to_string(copy.get("_key8")));
+}
+
+// The system size is kept up to date as keys are modified
+TEST(XattrBlob, SystemSizeTracksModifications) {
+    cb::xattr::Blob blob;
+    EXPECT_EQ(0, blob.get_system_size());
+
+    blob.set("user", "1");
+    EXPECT_EQ(4, blob.get_system_size());
+    blob.set("_sync", "1");
+    EXPECT_EQ(4 + 4 + 6 + 2, blob.get_system_size());
+    blob.set("_sync", "123");
+    EXPECT_EQ(4 + 4 + 6 + 4, blob.get_system_size());
+    blob.set("_rbac", "1");
+    EXPECT_EQ(4 + 4 + 6 + 4 + 4 + 6 + 2, blob.get_system_size());
+    blob.remove("_sync");
+    EXPECT_EQ(4 + 4 + 6 + 2, blob.get_system_size());
+    blob.remove("user");
+    EXPECT_EQ(blob.finalize().size(), blob.get_system_size());
+    blob.remove("_rbac");
+    EXPECT_EQ(0, blob.finalize().size());
+    EXPECT_EQ(0, blob.get_system_size());
+}
@@ -502,6 +502,63 @@ TEST_P(StatsTest, TestTopkeysJson) {
     EXPECT_TRUE(found);
 }
 
+TEST_P(StatsTest, TestSlowOps) {
+    MemcachedConnection& conn = getConnection();
+
+    Document doc;
+    doc.info.cas = mcbp::cas::Wildcard;
+    doc.info.id = name;
+    doc.value = memcached_cfg.dump();
+    conn.mutate(doc, Vbid(0), MutationType::Set);
+
+    auto stats = conn.stats("slow_ops").front();
+    ASSERT_TRUE(stats.is_array());
+    EXPECT_EQ(6, stats.size());
+
+    // All of the intervals may have been filled by slower operations of
+    // the previous tests, so just check what is recorded
+    size_t count = 0;
+    for (const auto& interval : stats) {
+        ASSERT_TRUE(interval.is_array());
+        for (const auto& op : interval) {
+            EXPECT_NE(op.end(), op.find("opcode"));
+            EXPECT_NE(op.end(), op.find("duration_us"));
+            EXPECT_NE(op.end(), op.find("connection_id"));
+            ASSERT_FALSE(op["spans"].empty());
+            EXPECT_EQ("request", op["spans"][0]["code"]);
+            ++count;
+        }
+    }
+    EXPECT_NE(0, count);
+}
+
+TEST_P(StatsTest, TestStatCosts) {
+    MemcachedConnection& conn = getConnection();
+    conn.stats("");
+
+    auto stats = conn.stats("stat_costs").front();
+    ASSERT_TRUE(stats.is_object());
+    ASSERT_NE(stats.end(), stats.find("default"));
+    const auto& cost = stats["default"];
+    EXPECT_LE(1, cost["count"].get<uint64_t>());
+    EXPECT_LE(cost["max_us"].get<uint64_t>(), cost["total_us"].get<uint64_t>());
+}
+
+// The dcp stats are collected off the front-end thread
+TEST_P(StatsTest, TestStreamedStats) {
+    if (!mcd_env->getTestBucket().supportsPersistence()) {
+        GTEST_SKIP();
+    }
+    MemcachedConnection& conn = getConnection();
+    auto stats = conn.stats("dcp");
+    EXPECT_NE(stats.end(), stats.find("ep_dcp_count"));
+
+    stats = conn.stats("stat_costs").front();
+    ASSERT_NE(stats.end(), stats.find("dcp"));
+    EXPECT_LE(1, stats["dcp"]["count"].get<uint64_t>());
+    EXPECT_LT(0, stats["dcp"]["size"].get<uint64_t>());
+}
+
 TEST_P(StatsTest, TestSubdocExecute) {
     MemcachedConnection& conn = getConnection();
     auto stats = conn.stats("subdoc_execute");
@@ -26,6 +26,10 @@
  *
  * - Dict: As per Array, except start with an empty dictionary and add
  *         K/V pairs of the form <num>: value_<num>.
+ *
+ * - LargeDoc: Increment a counter / replace a short field of documents from
+ *             1KiB to 1MiB (with and without an xattr), 5,000 times for
+ *             each size.
  */
 
 #include "testapp_subdoc_common.h"
@@ -57,6 +61,8 @@ protected:
 
     void subdoc_perf_test_dict(cb::mcbp::ClientOpcode cmd, size_t iterations);
 
+    void subdoc_perf_test_large_doc(cb::mcbp::ClientOpcode cmd, bool xattr);
+
     size_t iterations;
 };
 
@@ -251,6 +257,80 @@ TEST_P(SubdocPerfTest, Dict_Exists) {
     subdoc_perf_test_dict(cb::mcbp::ClientOpcode::SubdocExists, iterations);
 }
 
+/* Create a JSON dictionary of (at least) the given size, with a counter
+ * and a short field followed by padding.
+ */
+static std::string subdoc_create_large_dict(size_t size) {
+    std::string dict(R"({"counter":0,"field":"value","padding":")");
+    if (size > dict.size() + 2) {
+        dict.append(size - dict.size() - 2, 'x');
+    }
+    dict.append("\"}");
+    return dict;
+}
+
+// Apply a mutation which changes just a few bytes to documents of 1KiB to
+// 1MiB, optionally with an xattr (which must be preserved).
+void SubdocPerfTest::subdoc_perf_test_large_doc(cb::mcbp::ClientOpcode cmd,
+                                                bool xattr) {
+    for (size_t size = 1024; size <= 1024 * 1024; size *= 4) {
+        store_document("large", subdoc_create_large_dict(size));
+        if (xattr) {
+            subdoc_verify_cmd(BinprotSubdocCommand(
+                    cb::mcbp::ClientOpcode::SubdocDictUpsert,
+                    "large",
+                    "meta.rev",
+                    "1",
+                    SUBDOC_FLAG_XATTR_PATH | SUBDOC_FLAG_MKDIR_P));
+        }
+
+        for (size_t i = 0; i < iterations; i++) {
+            if (cmd == cb::mcbp::ClientOpcode::SubdocCounter) {
+                subdoc_verify_cmd(BinprotSubdocCommand(cmd,
+                                                       "large",
+                                                       "counter",
+                                                       "1"),
+                                  cb::mcbp::Status::Success,
+                                  std::to_string(i + 1));
+            } else {
+                subdoc_verify_cmd(BinprotSubdocCommand(
+                        cmd,
+                        "large",
+                        "field",
+                        "\"value_" + std::to_string(i) + '"'));
+            }
+        }
+
+        if (xattr) {
+            subdoc_verify_cmd(
+                    BinprotSubdocCommand(cb::mcbp::ClientOpcode::SubdocGet,
+                                         "large",
+                                         "meta.rev",
+                                         {},
+                                         SUBDOC_FLAG_XATTR_PATH),
+                    cb::mcbp::Status::Success,
+                    "1");
+        }
+        delete_object("large");
+    }
+}
+
+TEST_P(SubdocPerfTest, LargeDoc_Counter) {
+    subdoc_perf_test_large_doc(cb::mcbp::ClientOpcode::SubdocCounter, false);
+}
+
+TEST_P(SubdocPerfTest, LargeDoc_Counter_Xattr) {
+    subdoc_perf_test_large_doc(cb::mcbp::ClientOpcode::SubdocCounter, true);
+}
+
+TEST_P(SubdocPerfTest, LargeDoc_Replace) {
+    subdoc_perf_test_large_doc(cb::mcbp::ClientOpcode::SubdocReplace, false);
+}
+
+TEST_P(SubdocPerfTest, LargeDoc_Replace_Xattr) {
+    subdoc_perf_test_large_doc(cb::mcbp::ClientOpcode::SubdocReplace, true);
+}
+
 
 /*****************************************************************************
  * Sub-document API Performance Tests - Multi path.
@@ -18,6 +18,7 @@
 #include "daemon/settings.h"
 #include "daemon/topkeys.h"
 #include <folly/portability/GTest.h>
+#include <nlohmann/json.hpp>
 #include <memory>
 
 class TopKeysTest : public ::testing::Test {
@@ -72,3 +73,50 @@ TEST_F(TopKeysTest, FewerThan80Keys) {
     testWithNKeys(5);
     testWithNKeys(20);
 }
+
+// A key accessed more often than all the others put together must be
+// reported as the top key, even when the number of distinct keys accessed
+// far exceeds the number of keys tracked.
+TEST_F(TopKeysTest, HeavyHitterSurvivesChurn) {
+    const std::string hot = "hot_key";
+    for (int ii = 0; ii < 10000; ii++) {
+        const auto cold = "cold_key_" + std::to_string(ii);
+        topkeys->updateKey(cold.data(), cold.size(), ii);
+        topkeys->updateKey(hot.data(), hot.size(), ii);
+        topkeys->updateKey(hot.data(), hot.size(), ii);
+    }
+
+    nlohmann::json json;
+    topkeys->json_stats(json, 0);
+    ASSERT_FALSE(json["topkeys"].empty());
+    EXPECT_EQ(hot, json["topkeys"][0]["key"].get<std::string>());
+    EXPECT_LE(20000, json["topkeys"][0]["access_count"].get<uint64_t>());
+}
+
+TEST_F(TopKeysTest, CollectionAndVBucketDimensions) {
+    const std::string key = "key";
+    for (int ii = 0; ii < 10; ii++) {
+        topkeys->updateKey(
+                key.data(), key.size(), 0, 100, CollectionID(8), Vbid(5));
+    }
+    topkeys->updateKey(
+            key.data(), key.size(), 0, 10, CollectionID::Default, Vbid(7));
+
+    nlohmann::json json;
+    topkeys->json_stats(json, 0);
+
+    // Only the access in the default collection is tracked by key
+    ASSERT_EQ(1, json["topkeys"].size());
+    EXPECT_EQ(1, json["topkeys"][0]["access_count"].get<uint64_t>());
+    EXPECT_EQ(10, json["topkeys"][0]["bytes"].get<uint64_t>());
+
+    ASSERT_EQ(2, json["collections"].size());
+    EXPECT_EQ("0x8", json["collections"][0]["cid"].get<std::string>());
+    EXPECT_EQ(10, json["collections"][0]["access_count"].get<uint64_t>());
+    EXPECT_EQ(1000, json["collections"][0]["bytes"].get<uint64_t>());
+
+    ASSERT_EQ(2, json["vbuckets"].size());
+    EXPECT_EQ(5, json["vbuckets"][0]["vbid"].get<int>());
+    EXPECT_EQ(10, json["vbuckets"][0]["access_count"].get<uint64_t>());
+    EXPECT_EQ(7, json["vbuckets"][1]["vbid"].get<int>());
+}
@@ -32,44 +32,105 @@ namespace cb::tracing {
 
 SpanId Tracer::begin(Code tracecode,
                      std::chrono::steady_clock::time_point startTime) {
-    return vecSpans.withLock([tracecode, startTime](auto& spans) {
-        spans.emplace_back(tracecode, startTime);
-        return spans.size() - 1;
+    if (isOwner()) {
+        const auto index = numSpans.load(std::memory_order_relaxed);
+        if (index < InlineSpans) {
+            spans[index] = Span(tracecode, startTime);
+            numSpans.store(index + 1, std::memory_order_release);
+            return index;
+        }
+    }
+
+    return shared.withLock([this, tracecode, startTime](auto& locked) {
+        locked.spans.emplace_back(tracecode, startTime);
+        hasShared.store(true, std::memory_order_release);
+        return InlineSpans + locked.spans.size() - 1;
     });
 }
 
 bool Tracer::end(SpanId spanId, std::chrono::steady_clock::time_point endTime) {
-    return vecSpans.withLock([spanId, endTime](auto& spans) {
-        if (spanId >= spans.size()) {
+    if (spanId < InlineSpans) {
+        if (spanId >= numSpans.load(std::memory_order_acquire)) {
             return false;
         }
+        if (isOwner()) {
+            auto& span = spans[spanId];
+            span.duration = std::chrono::duration_cast<Span::Duration>(
+                    endTime - span.start);
+        } else {
+            // Only the owner may touch the inline spans, so the end time is
+            // applied when the spans are read
+            shared.withLock([this, spanId, endTime](auto& locked) {
+                locked.ends.emplace_back(spanId, endTime);
+                hasShared.store(true, std::memory_order_release);
+            });
+        }
+        return true;
+    }
 
-        auto& span = spans.at(spanId);
+    return shared.withLock([spanId, endTime](auto& locked) {
+        const auto index = spanId - InlineSpans;
+        if (index >= locked.spans.size()) {
+            return false;
+        }
+        auto& span = locked.spans[index];
         span.duration = std::chrono::duration_cast<Span::Duration>(endTime -
                                                                    span.start);
         return true;
     });
 }
 
+std::vector<Span> Tracer::getSpans() const {
+    const auto count = numSpans.load(std::memory_order_relaxed);
+    std::vector<Span> ret(spans.begin(), spans.begin() + count);
+    if (!hasShared.load(std::memory_order_acquire)) {
+        return ret;
+    }
+
+    shared.withLock([&ret](auto& locked) {
+        for (const auto& [spanId, endTime] : locked.ends) {
+            if (spanId < ret.size()) {
+                auto& span = ret[spanId];
+                span.duration = std::chrono::duration_cast<Span::Duration>(
+                        endTime - span.start);
+            }
+        }
+        ret.insert(ret.end(), locked.spans.begin(), locked.spans.end());
+    });
+    // Keep the spans in the order they were begun (the first span is the
+    // Request, which is begun first)
+    std::stable_sort(ret.begin(), ret.end(), [](const auto& a, const auto& b) {
+        return a.start < b.start;
+    });
+    return ret;
+}
+
 std::vector<Span> Tracer::extractDurations() {
-    std::vector<Span> ret;
-    vecSpans.swap(ret);
+    auto ret = getSpans();
+    clear();
     return ret;
 }
 
 Span::Duration Tracer::getTotalMicros() const {
-    return vecSpans.withLock([](auto& spans) -> Span::Duration {
-        if (spans.empty()) {
+    Span top;
+    if (hasShared.load(std::memory_order_acquire)) {
+        const auto all = getSpans();
+        if (all.empty()) {
             return {};
         }
-        const auto& top = spans.at(0);
-        // If the Span has not yet been closed; return the duration up to now.
-        if (top.duration == Span::Duration::max()) {
-            return std::chrono::duration_cast<Span::Duration>(
-                    std::chrono::steady_clock::now() - top.start);
-        }
-        return top.duration;
-    });
+        top = all.front();
+    } else if (numSpans.load(std::memory_order_relaxed) != 0) {
+        top = spans.front();
+    } else {
+        return {};
+    }
+
+    // If the Span has not yet been closed; return the duration up to now.
+    if (top.duration == Span::Duration::max()) {
+        return std::chrono::duration_cast<Span::Duration>(
+                std::chrono::steady_clock::now() - top.start);
+    }
+    return top.duration;
 }
 
 /**
@@ -94,28 +155,35 @@ std::chrono::microseconds Tracer::decodeMicros(uint16_t encoded) {
 }
 
 void Tracer::clear() {
-    vecSpans.lock()->clear();
+    owner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    numSpans.store(0, std::memory_order_relaxed);
+    if (hasShared.load(std::memory_order_acquire)) {
+        shared.withLock([](auto& locked) {
+            locked.spans.clear();
+            locked.ends.clear();
+        });
+        hasShared.store(false, std::memory_order_relaxed);
+    }
 }
 
 std::string Tracer::to_string() const {
-    return vecSpans.withLock([](auto& spans) {
-        std::ostringstream os;
-        auto size = spans.size();
-        for (const auto& span : spans) {
-            os << ::to_string(span.code) << "="
-               << span.start.time_since_epoch().count() << ":";
-            if (span.duration == std::chrono::microseconds::max()) {
-                os << "--";
-            } else {
-                os << span.duration.count();
-            }
-            size--;
-            if (size > 0) {
-                os << " ";
-            }
+    const auto all = getSpans();
+    std::ostringstream os;
+    auto size = all.size();
+    for (const auto& span : all) {
+        os << ::to_string(span.code) << "="
+           << span.start.time_since_epoch().count() << ":";
+        if (span.duration == std::chrono::microseconds::max()) {
+            os << "--";
+        } else {
+            os << span.duration.count();
         }
-        return os.str();
-    });
+        size--;
+        if (size > 0) {
+            os << " ";
+        }
+    }
+    return os.str();
 }
 
 } // namespace cb::tracing
@@ -150,6 +218,10 @@ MEMCACHED_PUBLIC_API std::string to_string(const cb::tracing::Code tracecode) {
         return "sync_write.ack_local";
     case Code::SyncWriteAckRemote:
         return "sync_write.ack_remote";
+    case Code::JsonValidate:
+        return "json.validate";
+    case Code::Throttled:
+        return "throttled";
     }
     return "unknown tracecode";
 }
@@ -77,6 +77,65 @@ TEST_F(TracingTest, ErrorRate) {
     }
 }
 
+// Spans which don't fit in the inline array are still recorded
+TEST_F(TracingTest, Overflow) {
+    const auto count = cb::tracing::Tracer::InlineSpans + 4;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t ii = 0; ii < count; ++ii) {
+        const auto spanId = tracer.begin(cb::tracing::Code::Get,
+                                         start + std::chrono::microseconds(ii));
+        EXPECT_EQ(ii, spanId);
+        EXPECT_TRUE(tracer.end(spanId, start + std::chrono::microseconds(100)));
+    }
+    EXPECT_FALSE(tracer.end(cb::tracing::SpanId{count}));
+
+    const auto spans = tracer.extractDurations();
+    ASSERT_EQ(count, spans.size());
+    for (size_t ii = 0; ii < count; ++ii) {
+        EXPECT_EQ(100 - int(ii), spans[ii].duration.count());
+    }
+    EXPECT_TRUE(tracer.extractDurations().empty());
+}
+
+// Spans may be begun and ended by threads other than the owner (as done by
+// background fetches)
+TEST_F(TracingTest, OtherThreads) {
+    const auto start = std::chrono::steady_clock::now();
+    auto us = [start](int micros) {
+        return start + std::chrono::microseconds(micros);
+    };
+    EXPECT_EQ(0, tracer.begin(cb::tracing::Code::Request, us(0)));
+    const auto wait = tracer.begin(cb::tracing::Code::BackgroundWait, us(1));
+
+    std::thread other{[this, wait, &us]() {
+        EXPECT_TRUE(tracer.end(wait, us(5)));
+        const auto load =
+                tracer.begin(cb::tracing::Code::BackgroundLoad, us(5));
+        EXPECT_TRUE(tracer.end(load, us(10)));
+    }};
+    other.join();
+
+    // The owner's spans follow those of the other thread
+    const auto get = tracer.begin(cb::tracing::Code::Get, us(11));
+    EXPECT_TRUE(tracer.end(get, us(12)));
+    EXPECT_TRUE(tracer.end(0, us(20)));
+    EXPECT_EQ(20, tracer.getTotalMicros().count());
+
+    const auto spans = tracer.extractDurations();
+    ASSERT_EQ(4, spans.size());
+    EXPECT_EQ(cb::tracing::Code::Request, spans[0].code);
+    EXPECT_EQ(20, spans[0].duration.count());
+    EXPECT_EQ(cb::tracing::Code::BackgroundWait, spans[1].code);
+    EXPECT_EQ(4, spans[1].duration.count());
+    EXPECT_EQ(cb::tracing::Code::BackgroundLoad, spans[2].code);
+    EXPECT_EQ(5, spans[2].duration.count());
+    EXPECT_EQ(cb::tracing::Code::Get, spans[3].code);
+    EXPECT_EQ(1, spans[3].duration.count());
+
+    EXPECT_TRUE(tracer.extractDurations().empty());
+    EXPECT_EQ(0, tracer.getTotalMicros().count());
+}
+
 /// Text fixture for session tracing associated with a Cookie object.
 class TracingCookieTest : public ::testing::Test {
 protected:
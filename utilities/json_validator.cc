@@ -0,0 +1,437 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "json_validator.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CB_JSON_VALIDATOR_X86 1
+#include <immintrin.h>
+#endif
+
+namespace cb::json {
+
+/**
+ * Does the string scanner need to look at this byte? That is a quote, an
+ * escape, a control character (which must be escaped) or the start of a
+ * multi-byte UTF-8 sequence.
+ */
+static inline bool isStringSpecial(uint8_t c) {
+    return c == '"' || c == '\\' || c < 0x20 || c >= 0x80;
+}
+
+/// @return the first byte in [p, end) for which isStringSpecial() is true
+using FindStringSpecialFn = const uint8_t* (*)(const uint8_t* p,
+                                               const uint8_t* end);
+
+static const uint8_t* findStringSpecialScalar(const uint8_t* p,
+                                              const uint8_t* end) {
+    while (p < end && !isStringSpecial(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+#ifdef CB_JSON_VALIDATOR_X86
+// Compared as signed bytes, both control characters and bytes >= 0x80 are
+// less than 0x20, so a single comparison finds both.
+
+static const uint8_t* findStringSpecialSSE2(const uint8_t* p,
+                                            const uint8_t* end) {
+    const auto quote = _mm_set1_epi8('"');
+    const auto backslash = _mm_set1_epi8('\\');
+    const auto space = _mm_set1_epi8(0x20);
+    while (end - p >= 16) {
+        const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const auto special = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                             _mm_cmpeq_epi8(v, backslash)),
+                _mm_cmplt_epi8(v, space));
+        const auto mask = _mm_movemask_epi8(special);
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+    return findStringSpecialScalar(p, end);
+}
+
+__attribute__((target("avx2"))) static const uint8_t* findStringSpecialAVX2(
+        const uint8_t* p, const uint8_t* end) {
+    const auto quote = _mm256_set1_epi8('"');
+    const auto backslash = _mm256_set1_epi8('\\');
+    const auto space = _mm256_set1_epi8(0x20);
+    while (end - p >= 32) {
+        const auto v =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const auto special = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                                _mm256_cmpeq_epi8(v, backslash)),
+                _mm256_cmpgt_epi8(space, v));
+        const auto mask = uint32_t(_mm256_movemask_epi8(special));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+    return findStringSpecialSSE2(p, end);
+}
+#endif
+
+struct Implementation {
+    FindStringSpecialFn findStringSpecial;
+    std::string_view name;
+};
+
+static Implementation selectImplementation() {
+#ifdef CB_JSON_VALIDATOR_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {findStringSpecialAVX2, "avx2"};
+    }
+    return {findStringSpecialSSE2, "sse2"};
+#else
+    return {findStringSpecialScalar, "scalar"};
+#endif
+}
+
+static const Implementation& selectedImplementation() {
+    static const Implementation implementation = selectImplementation();
+    return implementation;
+}
+
+std::string_view Validator::getImplementation() {
+    return selectedImplementation().name;
+}
+
+static inline bool isWhitespace(uint8_t c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static inline bool isDigit(uint8_t c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline bool isHexDigit(uint8_t c) {
+    return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static inline bool isContinuation(uint8_t c) {
+    return (c & 0xc0) == 0x80;
+}
+
+/**
+ * Validate the (non-ASCII) UTF-8 sequence starting at p, rejecting overlong
+ * encodings, surrogates and code points beyond U+10FFFF.
+ *
+ * @return the byte following the sequence, or nullptr if it is invalid
+ */
+static const uint8_t* validateUtf8Sequence(const uint8_t* p,
+                                           const uint8_t* end) {
+    const auto c = p[0];
+    size_t length;
+    // The valid range of the second byte, which is narrower than a plain
+    // continuation byte for the lead bytes which could otherwise start an
+    // overlong encoding, a surrogate or a code point beyond U+10FFFF.
+    uint8_t min = 0x80;
+    uint8_t max = 0xbf;
+    if (c >= 0xc2 && c <= 0xdf) {
+        length = 2;
+    } else if (c >= 0xe0 && c <= 0xef) {
+        length = 3;
+        if (c == 0xe0) {
+            min = 0xa0;
+        } else if (c == 0xed) {
+            max = 0x9f;
+        }
+    } else if (c >= 0xf0 && c <= 0xf4) {
+        length = 4;
+        if (c == 0xf0) {
+            min = 0x90;
+        } else if (c == 0xf4) {
+            max = 0x8f;
+        }
+    } else {
+        return nullptr;
+    }
+
+    if (size_t(end - p) < length || p[1] < min || p[1] > max) {
+        return nullptr;
+    }
+    for (size_t ii = 2; ii < length; ++ii) {
+        if (!isContinuation(p[ii])) {
+            return nullptr;
+        }
+    }
+    return p + length;
+}
+
+namespace {
+/**
+ * The state of a single validation. Each parse method is called with p
+ * pointing at the first byte of the token, and returns false if the
+ * document is invalid or leaves p just past the token.
+ */
+class Parser {
+public:
+    Parser(const uint8_t* data, size_t size)
+        : p(data),
+          end(data + size),
+          findStringSpecial(selectedImplementation().findStringSpecial) {
+    }
+
+    void skipWhitespace() {
+        while (p < end && isWhitespace(*p)) {
+            ++p;
+        }
+    }
+
+    bool parseString() {
+        ++p; // opening quote
+        while (true) {
+            p = findStringSpecial(p, end);
+            if (p == end) {
+                return false;
+            }
+            const auto c = *p;
+            if (c == '"') {
+                ++p;
+                return true;
+            }
+            if (c == '\\') {
+                if (!parseEscape()) {
+                    return false;
+                }
+            } else if (c < 0x20) {
+                return false;
+            } else {
+                p = validateUtf8Sequence(p, end);
+                if (p == nullptr) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    bool parseEscape() {
+        ++p; // backslash
+        if (p == end) {
+            return false;
+        }
+        switch (*p) {
+        case '"':
+        case '\\':
+        case '/':
+        case 'b':
+        case 'f':
+        case 'n':
+        case 'r':
+        case 't':
+            ++p;
+            return true;
+        case 'u':
+            ++p;
+            if (end - p < 4) {
+                return false;
+            }
+            for (int ii = 0; ii < 4; ++ii) {
+                if (!isHexDigit(p[ii])) {
+                    return false;
+                }
+            }
+            p += 4;
+            return true;
+        }
+        return false;
+    }
+
+    bool parseDigits() {
+        if (p == end || !isDigit(*p)) {
+            return false;
+        }
+        do {
+            ++p;
+        } while (p < end && isDigit(*p));
+        return true;
+    }
+
+    bool parseNumber() {
+        if (*p == '-') {
+            ++p;
+            if (p == end) {
+                return false;
+            }
+        }
+        if (*p == '0') {
+            // No leading zeros; anything other than a fraction or exponent
+            // following the zero is rejected by the caller.
+            ++p;
+        } else if (!parseDigits()) {
+            return false;
+        }
+        if (p < end && *p == '.') {
+            ++p;
+            if (!parseDigits()) {
+                return false;
+            }
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            if (p < end && (*p == '+' || *p == '-')) {
+                ++p;
+            }
+            if (!parseDigits()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool parseLiteral(std::string_view literal) {
+        if (size_t(end - p) < literal.size() ||
+            std::memcmp(p, literal.data(), literal.size()) != 0) {
+            return false;
+        }
+        p += literal.size();
+        return true;
+    }
+
+    /// Parse a scalar value, starting at a byte other than '{' or '['
+    bool parseScalar() {
+        switch (*p) {
+        case '"':
+            return parseString();
+        case 't':
+            return parseLiteral("true");
+        case 'f':
+            return parseLiteral("false");
+        case 'n':
+            return parseLiteral("null");
+        case '-':
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+            return parseNumber();
+        }
+        return false;
+    }
+
+    /// Is there a byte left, and is it c?
+    bool peek(uint8_t c) const {
+        return p < end && *p == c;
+    }
+
+    const uint8_t* p;
+    const uint8_t* const end;
+    const FindStringSpecialFn findStringSpecial;
+};
+} // namespace
+
+bool Validator::validate(const uint8_t* data, size_t size) {
+    // What the parser expects next
+    enum class State {
+        // Any value
+        Value,
+        // An object member's key (and then its value)
+        Key,
+        // A ',' or the end of the enclosing container (or of the document
+        // at the top level)
+        Next
+    };
+
+    Parser parser(data, size);
+    stack.clear();
+    auto state = State::Value;
+    while (true) {
+        parser.skipWhitespace();
+        switch (state) {
+        case State::Value:
+            if (parser.p == parser.end) {
+                return false;
+            }
+            if (*parser.p == '{') {
+                ++parser.p;
+                parser.skipWhitespace();
+                if (parser.peek('}')) {
+                    ++parser.p;
+                    state = State::Next;
+                } else {
+                    stack.push_back(Container::Object);
+                    state = State::Key;
+                }
+            } else if (*parser.p == '[') {
+                ++parser.p;
+                parser.skipWhitespace();
+                if (parser.peek(']')) {
+                    ++parser.p;
+                    state = State::Next;
+                } else {
+                    stack.push_back(Container::Array);
+                }
+            } else if (parser.parseScalar()) {
+                state = State::Next;
+            } else {
+                return false;
+            }
+            break;
+
+        case State::Key:
+            if (!parser.peek('"') || !parser.parseString()) {
+                return false;
+            }
+            parser.skipWhitespace();
+            if (!parser.peek(':')) {
+                return false;
+            }
+            ++parser.p;
+            state = State::Value;
+            break;
+
+        case State::Next: {
+            if (stack.empty()) {
+                return parser.p == parser.end;
+            }
+            if (parser.p == parser.end) {
+                return false;
+            }
+            const auto container = stack.back();
+            const auto close = container == Container::Object ? '}' : ']';
+            if (*parser.p == ',') {
+                ++parser.p;
+                state = container == Container::Object ? State::Key
+                                                       : State::Value;
+            } else if (*parser.p == close) {
+                ++parser.p;
+                stack.pop_back();
+            } else {
+                return false;
+            }
+            break;
+        }
+        }
+    }
+}
+
+} // namespace cb::json
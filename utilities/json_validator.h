@@ -0,0 +1,73 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2020 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include <platform/sized_buffer.h>
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace cb::json {
+
+/**
+ * A drop-in replacement for JSON_checker::Validator, accepting and rejecting
+ * exactly the same documents (any JSON value at the top level, surrounded
+ * by optional whitespace, and encoded as valid UTF-8).
+ *
+ * JSON_checker runs every byte through a state machine. This validator
+ * instead parses the structure directly and, as the bulk of a typical
+ * document is string content, scans string bodies 16 (SSE2) or 32 (AVX2)
+ * bytes at a time for the next quote, escape, control character or
+ * non-ASCII byte. The widest implementation supported by the CPU is picked
+ * at runtime; non-ASCII bytes are validated as UTF-8 one sequence at a time.
+ *
+ * Instances are not thread safe, but may (and should) be reused to avoid
+ * reallocating the nesting stack for every document.
+ */
+class Validator {
+public:
+    /**
+     * Check if the provided data is valid JSON
+     *
+     * @param data the document to check
+     * @param size the number of bytes in the document
+     * @return true if the document is valid JSON, false otherwise
+     */
+    bool validate(const uint8_t* data, size_t size);
+
+    bool validate(cb::const_byte_buffer data) {
+        return validate(data.data(), data.size());
+    }
+
+    bool validate(std::string_view data) {
+        return validate(reinterpret_cast<const uint8_t*>(data.data()),
+                        data.size());
+    }
+
+    /// @return the name of the string scanning implementation in use
+    static std::string_view getImplementation();
+
+private:
+    enum class Container : uint8_t { Object, Array };
+
+    /// The containers enclosing the current position
+    std::vector<Container> stack;
+};
+
+} // namespace cb::json
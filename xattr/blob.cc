@@ -28,8 +28,24 @@
 
 namespace cb::xattr {
 
+/// FNV-1a hash of the key; xattr keys are short so this is cheaper than
+/// std::hash
+static uint32_t hash_key(std::string_view key) {
+    uint32_t hash = 2166136261U;
+    for (const auto c : key) {
+        hash = (hash ^ uint8_t(c)) * 16777619U;
+    }
+    return hash;
+}
+
 Blob::Blob(const Blob& other)
-    : allocator(default_allocator),
+    : entries(other.entries),
+      table(other.table),
+      systemPairsSize(other.systemPairsSize),
+      scannedPairs(other.scannedPairs),
+      largestScan(other.largestScan),
+      indexed(other.indexed),
+      allocator(default_allocator),
       alloc_size(other.blob.size()) {
     decompressed.resize(other.decompressed.size());
     std::copy_n(other.decompressed.data(),
@@ -81,70 +97,221 @@ Blob& Blob::assign(std::string_view buffer, bool compressed) {
         // empty blob
         blob = {};
     }
+    indexed = false;
+    scannedPairs = 0;
+    largestScan = 0;
     return *this;
 }
 
-cb::char_buffer Blob::get(std::string_view key) const {
+void Blob::build_index() const {
+    entries.clear();
+    // Avoid growing the vector for typically sized xattrs
+    entries.reserve(blob.size() / 32 + 1);
+    systemPairsSize = 0;
     try {
         size_t current = 4;
         while (current < blob.size()) {
             // Get the length of the next kv-pair
             const auto size = read_length(current);
-            current += 4;
-            if (size > key.size()) {
-                // This may be the next key
-                if (blob[current + key.size()] == '\0' &&
-                    std::memcmp(blob.data() + current,
-                                key.data(),
-                                key.size()) == 0) {
-                    // Yay this is the key!!!
-                    auto* value = blob.buf + current + key.size() + 1;
-                    return {value, strlen(value)};
-                } else {
-                    // jump to the next key!!
-                    current += size;
-                }
-            } else {
-                current += size;
+            const auto* key = blob.data() + current + 4;
+            const auto keySize = strlen(key);
+            if (keySize + 2 > size) {
+                break;
+            }
+            entries.push_back({uint32_t(current),
+                               uint32_t(keySize),
+                               uint32_t(size - keySize - 2),
+                               hash_key({key, keySize}),
+                               is_system_xattr({key, keySize})});
+            if (entries.back().system) {
+                systemPairsSize += 4 + size;
             }
+            current += 4 + size;
         }
     } catch (const std::out_of_range&) {
     }
+    rebuild_table();
+    indexed = true;
+}
 
-    // Not found!
-    return {nullptr, 0};
+bool Blob::should_index(size_t pairs) const {
+    scannedPairs += pairs;
+    largestScan = std::max(largestScan, pairs);
+    // Building the index costs roughly as much as scanning the blob a few
+    // times (plus the allocations), so once we've spent that on scanning
+    // it's worth it
+    return scannedPairs > 3 * largestScan + 16;
 }
 
-void Blob::prune_user_keys() {
+void Blob::insert_into_table(uint32_t index) const {
+    const auto& entry = entries[index];
+    const auto mask = table.size() - 1;
+    auto slot = entry.hash & mask;
+    while (table[slot] != 0) {
+        const auto& other = entries[table[slot] - 1];
+        if (other.hash == entry.hash && key_of(other) == key_of(entry)) {
+            return;
+        }
+        slot = (slot + 1) & mask;
+    }
+    table[slot] = index + 1;
+}
+
+void Blob::rebuild_table() const {
+    // Keep the load factor at most 0.5 so the probe sequences stay short
+    size_t capacity = 16;
+    while (capacity < entries.size() * 2) {
+        capacity *= 2;
+    }
+    table.assign(capacity, 0);
+    for (uint32_t ii = 0; ii < entries.size(); ++ii) {
+        insert_into_table(ii);
+    }
+}
+
+bool Blob::find_entry(std::string_view key, size_t& index, Entry& entry) const {
+    if (indexed) {
+        const auto hash = hash_key(key);
+        const auto mask = table.size() - 1;
+        for (auto slot = hash & mask; table[slot] != 0;
+             slot = (slot + 1) & mask) {
+            index = table[slot] - 1;
+            if (entries[index].hash == hash && key_of(entries[index]) == key) {
+                entry = entries[index];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Scan the blob; indexing it only pays off once it has been scanned a
+    // few times
+    size_t pairs = 0;
+    bool found = false;
     try {
         size_t current = 4;
         while (current < blob.size()) {
             // Get the length of the next kv-pair
             const auto size = read_length(current);
-
-            if (blob[current + 4] != '_') {
-                remove_segment(current, size + 4);
-            } else {
-                current += 4 + size;
+            ++pairs;
+            if (size >= key.size() + 2 &&
+                blob[current + 4 + key.size()] == '\0' &&
+                std::memcmp(blob.data() + current + 4,
+                            key.data(),
+                            key.size()) == 0) {
+                // Yay this is the key!!!
+                entry = {uint32_t(current),
+                         uint32_t(key.size()),
+                         uint32_t(size - key.size() - 2),
+                         0,
+                         is_system_xattr(key)};
+                found = true;
+                break;
             }
+            // jump to the next key!!
+            current += 4 + size;
         }
     } catch (const std::out_of_range&) {
     }
+
+    if (should_index(pairs)) {
+        // Index the blob for the following operations
+        build_index();
+        if (found) {
+            return find_entry(key, index, entry);
+        }
+    }
+    return found;
+}
+
+void Blob::erase_entry(size_t index) {
+    const auto removed = entries[index];
+    const auto size = pair_size(removed);
+    if (removed.system) {
+        systemPairsSize -= size;
+    }
+    entries.erase(entries.begin() + index);
+    for (auto it = entries.begin() + index; it != entries.end(); ++it) {
+        it->offset -= uint32_t(size);
+    }
+    rebuild_table();
+}
+
+cb::char_buffer Blob::get(std::string_view key) const {
+    size_t index;
+    Entry entry;
+    if (!find_entry(key, index, entry)) {
+        // Not found!
+        return {nullptr, 0};
+    }
+    return {blob.buf + entry.offset + 4 + entry.keySize + 1, entry.valueSize};
+}
+
+void Blob::prune_user_keys() {
+    if (!indexed) {
+        try {
+            size_t current = 4;
+            while (current < blob.size()) {
+                // Get the length of the next kv-pair
+                const auto size = read_length(current);
+
+                if (blob[current + 4] != '_') {
+                    remove_segment(current, size + 4);
+                } else {
+                    current += 4 + size;
+                }
+            }
+        } catch (const std::out_of_range&) {
+        }
+        return;
+    }
+
+    // Pack the system kv-pairs down over the user ones in a single pass
+    size_t current = 4;
+    size_t kept = 0;
+    for (auto entry : entries) {
+        if (!entry.system) {
+            continue;
+        }
+        const auto size = pair_size(entry);
+        if (entry.offset != current) {
+            std::memmove(blob.data() + current, blob.data() + entry.offset, size);
+            entry.offset = uint32_t(current);
+        }
+        entries[kept++] = entry;
+        current += size;
+    }
+
+    if (kept == entries.size()) {
+        // There wasn't any user xattrs
+        return;
+    }
+
+    entries.resize(kept);
+    rebuild_table();
+    if (kept == 0) {
+        // the last xattr removed... we could just nuke it..
+        blob.len = 0;
+    } else {
+        blob.len = current;
+        write_length(0, gsl::narrow<uint32_t>(blob.size()) - 4);
+    }
 }
 
 void Blob::remove(std::string_view key) {
     // Locate the old value
-    const auto old = get(key);
-    if (old.empty()) {
+    size_t index;
+    Entry old;
+    if (!find_entry(key, index, old)) {
         // it's not there
         return;
     }
 
     // there is no need to reallocate as we can just pack the buffer
-    const auto offset = old.data() - blob.data() - 1 - key.size() - 4;
-    const auto size = 4 + key.size() + 1 + old.size() + 1;
-
-    remove_segment(offset, size);
+    remove_segment(old.offset, pair_size(old));
+    if (indexed) {
+        erase_entry(index);
+    }
 }
 
 void Blob::set(std::string_view key, std::string_view value) {
@@ -154,40 +321,49 @@ void Blob::set(std::string_view key, std::string_view value) {
     }
 
     // Locate the old value
-    const auto old = get(key);
-    if (old.size() == value.size()) {
-        // lets do an in-place replacement
-        std::copy(value.begin(), value.end(), old.buf);
-        return;
-    } else if (old.size() == 0) {
+    size_t index;
+    Entry old;
+    if (!find_entry(key, index, old)) {
         // The old one didn't exist
         append_kvpair(key, value);
-    } else {
-        // we need to reorganize the buffer. Determine the size of
-        // the resulting document
-        const size_t newsize = blob.size() + value.size() - old.size();
-        const auto old_offset = old.data() - blob.data() - 1 - key.size() - 4;
-        const auto old_kv_size = 4 + key.size() + 1 + old.size() + 1;
-
-        if (newsize < alloc_size) {
-            // we can do an in-place removement
-            remove_segment(old_offset, old_kv_size);
-        } else {
-            std::unique_ptr<char[]> temp(new char[newsize]);
-            // copy everything up to the old one
-            std::copy(blob.data(), blob.data() + old_offset, temp.get());
-            // Skip the old value and copy the rest
-            std::copy(blob.data() + old_offset + old_kv_size,
-                      blob.data() + blob.size(),
-                      temp.get() + old_offset);
-            allocator.swap(temp);
-            blob = {allocator.get(),
-                    newsize - 4 - key.size() - 1 - value.size() - 1};
-            alloc_size = newsize;
-        }
+        return;
+    }
 
-        append_kvpair(key, value);
+    if (old.valueSize == value.size()) {
+        // lets do an in-place replacement
+        std::copy(value.begin(),
+                  value.end(),
+                  blob.data() + old.offset + 4 + old.keySize + 1);
+        return;
+    }
+
+    // we need to reorganize the buffer. Determine the size of
+    // the resulting document
+    const size_t newsize = blob.size() + value.size() - old.valueSize;
+    const size_t old_offset = old.offset;
+    const auto old_kv_size = pair_size(old);
+
+    if (newsize < alloc_size) {
+        // we can do an in-place removement
+        remove_segment(old_offset, old_kv_size);
+    } else {
+        std::unique_ptr<char[]> temp(new char[newsize]);
+        // copy everything up to the old one
+        std::copy(blob.data(), blob.data() + old_offset, temp.get());
+        // Skip the old value and copy the rest
+        std::copy(blob.data() + old_offset + old_kv_size,
+                  blob.data() + blob.size(),
+                  temp.get() + old_offset);
+        allocator.swap(temp);
+        blob = {allocator.get(),
+                newsize - 4 - key.size() - 1 - value.size() - 1};
+        alloc_size = newsize;
+    }
+    if (indexed) {
+        erase_entry(index);
     }
+
+    append_kvpair(key, value);
 }
 
 void Blob::grow_buffer(uint32_t size) {
@@ -231,6 +407,22 @@ void Blob::append_kvpair(std::string_view key, std::string_view value) {
 
     grow_buffer(gsl::narrow<uint32_t>(needed));
     write_kvpair(offset, key, value);
+
+    if (indexed) {
+        entries.push_back({uint32_t(offset),
+                           uint32_t(key.size()),
+                           uint32_t(value.size()),
+                           hash_key(key),
+                           is_system_xattr(key)});
+        if (entries.back().system) {
+            systemPairsSize += needed - offset;
+        }
+        if (entries.size() * 2 > table.size()) {
+            rebuild_table();
+        } else {
+            insert_into_table(uint32_t(entries.size() - 1));
+        }
+    }
 }
 
 void Blob::remove_segment(const size_t offset, const size_t size) {
@@ -287,7 +479,12 @@ size_t Blob::get_system_size() const {
 
     // The global length field should be calculated as part of the
     // system xattr's
+    if (indexed) {
+        return 4 + systemPairsSize;
+    }
+
     size_t ret = 4;
+    size_t pairs = 0;
     try {
         size_t current = 4;
         while (current < blob.size()) {
@@ -297,10 +494,14 @@ size_t Blob::get_system_size() const {
                 ret += size + 4;
             }
             current += 4 + size;
+            ++pairs;
         }
     } catch (const std::out_of_range&) {
     }
 
+    // Not worth building the index for the system size alone, but it counts
+    // towards doing so
+    should_index(pairs);
     return ret;
 }
 